@@ -0,0 +1,366 @@
+#include "previewaudio.h"
+#include "decoder/AudioDecoder.h"
+#include "engine/AudioCrossfade.h"
+#include <QAudioFormat>
+#include <QAudioSink>
+#include <QMediaDevices>
+#include <QAudioDevice>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace VideoCreator;
+
+// 单个音轨的解码状态，只在生产线程中使用
+struct PreviewAudio::MixLayer
+{
+    std::unique_ptr<AudioDecoder> decoder;
+    std::deque<float> channels[2];
+    qint64 delaySamples = 0;   // 音轨 start_offset 之前的静音
+    qint64 skipUntilPts = -1;  // seek 后丢弃该时间戳（采样）之前的数据
+    bool finished = false;
+};
+
+PreviewAudio::PreviewAudio(QObject *parent) : QIODevice(parent)
+{
+    open(QIODevice::ReadOnly);
+    m_producer = std::thread(&PreviewAudio::producerLoop, this);
+}
+
+PreviewAudio::~PreviewAudio()
+{
+    stop();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    if (m_producer.joinable()) {
+        m_producer.join();
+    }
+}
+
+void PreviewAudio::setProject(std::shared_ptr<const ProjectConfig> config, const std::vector<PreviewSceneSpan> &spans)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config = std::move(config);
+    m_spans.clear();
+    for (const auto &span : spans) {
+        const qint64 start = std::llround(span.start * kSampleRate);
+        const qint64 end = std::llround((span.start + span.duration) * kSampleRate);
+        m_spans.push_back({span.sceneIndex, start, end});
+    }
+    m_totalSamples = m_spans.empty() ? 0 : m_spans.back().end;
+    restartLocked(m_playStartSample + m_samplesRead);
+    m_cond.notify_one();
+}
+
+bool PreviewAudio::start(qint64 positionMs)
+{
+    stop();
+
+    QAudioFormat format;
+    format.setSampleRate(kSampleRate);
+    format.setChannelCount(kChannels);
+    format.setSampleFormat(QAudioFormat::Int16);
+    const QAudioDevice device = QMediaDevices::defaultAudioOutput();
+    if (device.isNull() || !device.isFormatSupported(format)) {
+        qWarning() << "PreviewAudio: 没有可用的音频输出设备，预览改用系统时钟";
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        restartLocked(std::max<qint64>(0, positionMs) * kSampleRate / 1000);
+        m_running = true;
+    }
+    m_cond.notify_one();
+
+    m_sink = new QAudioSink(device, format, this);
+    m_sink->setBufferSize(kSampleRate / 10 * kChannels * static_cast<int>(sizeof(qint16))); // 约 100ms 设备缓冲
+    m_sink->start(this);
+    if (m_sink->error() != QAudio::NoError) {
+        qWarning() << "PreviewAudio: 无法启动音频输出" << m_sink->error();
+        stop();
+        return false;
+    }
+    return true;
+}
+
+void PreviewAudio::stop()
+{
+    if (m_sink) {
+        m_sink->stop();
+        delete m_sink;
+        m_sink = nullptr;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_running = false;
+}
+
+qint64 PreviewAudio::clockMs() const
+{
+    if (!m_sink) {
+        return -1;
+    }
+    // 交给声卡但仍在设备缓冲里的部分还没有播出
+    const qint64 bytesPerSample = kChannels * static_cast<qint64>(sizeof(qint16));
+    const qint64 queuedSamples = std::max<qint64>(0, m_sink->bufferSize() - m_sink->bytesFree()) / bytesPerSample;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_running) {
+        return -1;
+    }
+    const qint64 played = std::max(m_playStartSample, m_playStartSample + m_samplesRead - queuedSamples);
+    return played * 1000 / kSampleRate;
+}
+
+qint64 PreviewAudio::bytesAvailable() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<qint64>(m_buffer.size() * sizeof(qint16)) + QIODevice::bytesAvailable();
+}
+
+qint64 PreviewAudio::readData(char *data, qint64 maxlen)
+{
+    const qint64 bytesPerSample = kChannels * static_cast<qint64>(sizeof(qint16));
+    std::unique_lock<std::mutex> lock(m_mutex);
+    const qint64 readHead = m_playStartSample + m_samplesRead;
+    const qint64 wanted = std::min(maxlen / bytesPerSample, std::max<qint64>(0, m_totalSamples - readHead));
+    if (!m_running || wanted <= 0) {
+        return 0;
+    }
+
+    // 欠载时补静音并照常推进时间线，保证时钟与真实时间一致（相当于丢掉这段音频）
+    qint16 *out = reinterpret_cast<qint16 *>(data);
+    const qint64 available = std::min<qint64>(wanted, static_cast<qint64>(m_buffer.size()) / kChannels);
+    std::copy(m_buffer.begin(), m_buffer.begin() + available * kChannels, out);
+    m_buffer.erase(m_buffer.begin(), m_buffer.begin() + available * kChannels);
+    if (available < wanted) {
+        std::fill(out + available * kChannels, out + wanted * kChannels, qint16(0));
+    }
+    m_samplesRead += wanted;
+    lock.unlock();
+    m_cond.notify_one();
+    return wanted * bytesPerSample;
+}
+
+qint64 PreviewAudio::writeData(const char *, qint64)
+{
+    return -1;
+}
+
+void PreviewAudio::restartLocked(qint64 sample)
+{
+    ++m_generation;
+    m_buffer.clear();
+    m_playStartSample = sample;
+    m_samplesRead = 0;
+    m_produceSample = sample;
+}
+
+std::vector<std::unique_ptr<PreviewAudio::MixLayer>> PreviewAudio::openLayers(const ProjectConfig &config,
+                                                                              const SampleSpan &span, qint64 localSample) const
+{
+    std::vector<std::unique_ptr<MixLayer>> layers;
+    const SceneConfig &scene = config.scenes[span.sceneIndex];
+    if (scene.type == SceneType::TRANSITION) {
+        return layers;
+    }
+    const double sceneDuration = static_cast<double>(span.end - span.start) / kSampleRate;
+
+    // 与 RenderEngine::renderScene 的音轨组合保持一致
+    auto addLayer = [&](const AudioConfig &audioConfig, bool applySceneEffect) {
+        if (audioConfig.path.empty()) {
+            return;
+        }
+        auto layer = std::make_unique<MixLayer>();
+        layer->decoder = std::make_unique<AudioDecoder>();
+        if (!layer->decoder->open(audioConfig.path)) {
+            qDebug() << "PreviewAudio: 无法打开音频" << QString::fromStdString(audioConfig.path);
+            return;
+        }
+        const bool effectOk = applySceneEffect ? layer->decoder->applyVolumeEffect(scene)
+                                               : layer->decoder->applyVolumeEffect(audioConfig.volume, nullptr, sceneDuration);
+        if (!effectOk) {
+            qDebug() << "PreviewAudio: 音量特效初始化失败" << layer->decoder->getErrorString().c_str();
+        }
+
+        // 从场景中途开始时，跳过 start_offset 已经过去的部分
+        layer->delaySamples = std::llround(audioConfig.start_offset * kSampleRate) - localSample;
+        if (layer->delaySamples < 0) {
+            const qint64 skip = -layer->delaySamples;
+            layer->delaySamples = 0;
+            if (layer->decoder->seek(static_cast<double>(skip) / kSampleRate)) {
+                layer->skipUntilPts = skip;
+            }
+        }
+        layers.push_back(std::move(layer));
+    };
+
+    addLayer(scene.resources.audio, true);
+    for (const auto &layerConfig : scene.resources.audio_layers) {
+        addLayer(layerConfig, false);
+    }
+    if (scene.type == SceneType::VIDEO_SCENE && scene.resources.video.use_audio && !scene.resources.video.path.empty()) {
+        AudioConfig videoAudio;
+        videoAudio.path = scene.resources.video.path;
+        const bool treatAsPrimary = scene.resources.audio.path.empty() && scene.resources.audio_layers.empty();
+        addLayer(videoAudio, treatAsPrimary);
+    }
+    return layers;
+}
+
+void PreviewAudio::mixLayer(MixLayer &layer, float *left, float *right, int count)
+{
+    int offset = 0;
+    if (layer.delaySamples > 0) {
+        offset = static_cast<int>(std::min<qint64>(layer.delaySamples, count));
+        layer.delaySamples -= offset;
+    }
+
+    while (offset < count) {
+        if (layer.channels[0].empty()) {
+            if (layer.finished) {
+                return;
+            }
+            FFmpegUtils::AvFramePtr frame;
+            if (layer.decoder->decodeFrame(frame) <= 0 || !frame) {
+                layer.finished = true;
+                return;
+            }
+            int skip = 0;
+            if (layer.skipUntilPts >= 0 && frame->pts != AV_NOPTS_VALUE && frame->pts < layer.skipUntilPts) {
+                skip = static_cast<int>(std::min<int64_t>(layer.skipUntilPts - frame->pts, frame->nb_samples));
+            }
+            const int channelCount = std::min(frame->ch_layout.nb_channels > 0 ? frame->ch_layout.nb_channels : 1, 2);
+            for (int ch = 0; ch < 2; ++ch) {
+                const float *samples = reinterpret_cast<const float *>(frame->data[std::min(ch, channelCount - 1)]);
+                layer.channels[ch].insert(layer.channels[ch].end(), samples + skip, samples + frame->nb_samples);
+            }
+            continue;
+        }
+
+        const int take = static_cast<int>(std::min<size_t>(count - offset, layer.channels[0].size()));
+        for (int i = 0; i < take; ++i) {
+            left[offset + i] += layer.channels[0][i];
+            right[offset + i] += layer.channels[1][i];
+        }
+        layer.channels[0].erase(layer.channels[0].begin(), layer.channels[0].begin() + take);
+        layer.channels[1].erase(layer.channels[1].begin(), layer.channels[1].begin() + take);
+        offset += take;
+    }
+}
+
+void PreviewAudio::producerLoop()
+{
+    std::shared_ptr<const ProjectConfig> config;
+    std::vector<SampleSpan> spans;
+    std::vector<std::unique_ptr<MixLayer>> layers;
+    quint64 generation = 0;
+    int layersSpan = -1;     // layers 所属的场景区间
+    qint64 layersSample = -1; // layers 已混合到的时间线位置
+    std::vector<float> left;
+    std::vector<float> right;
+    AudioCrossfade tail;       // 转场前一场景的混音末尾
+    int tailSpan = -1;         // tail 对应的转场区间
+    AudioClip transitionFrom;  // 当前转场两侧的音频
+    AudioClip transitionTo;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cond.wait(lock, [this] {
+            return m_stop || (m_running && m_config && m_produceSample < m_totalSamples
+                              && static_cast<qint64>(m_buffer.size()) / kChannels < kBufferAheadSamples);
+        });
+        if (m_stop) {
+            break;
+        }
+        if (generation != m_generation) {
+            generation = m_generation;
+            config = m_config;
+            spans = m_spans;
+            layers.clear();
+            layersSpan = -1;
+        }
+        // 欠载补静音后读指针可能已越过生产位置
+        const qint64 readHead = m_playStartSample + m_samplesRead;
+        if (m_produceSample < readHead) {
+            m_produceSample = readHead;
+        }
+        const qint64 chunkStart = m_produceSample;
+        lock.unlock();
+
+        auto spanIt = std::upper_bound(spans.begin(), spans.end(), chunkStart,
+                                       [](qint64 sample, const SampleSpan &span) { return sample < span.start; });
+        const int spanIndex = spanIt == spans.begin() ? -1 : static_cast<int>(spanIt - spans.begin()) - 1;
+        qint64 chunkEnd = chunkStart + kChunkSamples;
+        if (spanIndex >= 0) {
+            chunkEnd = std::min(chunkEnd, spans[spanIndex].end);
+        }
+        const int count = static_cast<int>(std::max<qint64>(1, chunkEnd - chunkStart));
+        chunkEnd = chunkStart + count;
+
+        const bool transition = spanIndex >= 0 && config->scenes[spans[spanIndex].sceneIndex].type == SceneType::TRANSITION;
+        if (spanIndex != layersSpan || chunkStart != layersSample) {
+            layers.clear();
+            if (transition) {
+                // 前一场景一直播到转场时才有完整末尾；seek 进来或中途跳过时只淡入后一场景
+                const qint64 total = spans[spanIndex].end - spans[spanIndex].start;
+                transitionFrom = (tailSpan == spanIndex && layersSpan == spanIndex - 1 && chunkStart == layersSample)
+                                     ? tail.takeTail() : AudioClip();
+                transitionTo = AudioClip();
+                const size_t toScene = static_cast<size_t>(spans[spanIndex].sceneIndex) + 1;
+                if (toScene < config->scenes.size()) {
+                    std::string error;
+                    transitionTo = AudioCrossfade::decodeHead(config->scenes[toScene], static_cast<size_t>(total), kSampleRate, &error);
+                    if (!error.empty()) {
+                        qDebug() << "PreviewAudio: 转场音频" << error.c_str();
+                    }
+                }
+                tailSpan = -1;
+            } else if (spanIndex >= 0) {
+                layers = openLayers(*config, spans[spanIndex], chunkStart - spans[spanIndex].start);
+                // 下一个区间是转场时记下本场景混音的末尾（只保留转场长度）
+                const int next = spanIndex + 1;
+                tailSpan = next < static_cast<int>(spans.size())
+                                   && config->scenes[spans[next].sceneIndex].type == SceneType::TRANSITION ? next : -1;
+                tail.startTail(tailSpan >= 0 ? static_cast<size_t>(spans[tailSpan].end - spans[tailSpan].start) : 0);
+            }
+            layersSpan = spanIndex;
+        }
+
+        left.assign(count, 0.0f);
+        right.assign(count, 0.0f);
+        if (transition) {
+            const qint64 total = spans[spanIndex].end - spans[spanIndex].start;
+            AudioCrossfade::mix(transitionFrom, transitionTo, static_cast<size_t>(chunkStart - spans[spanIndex].start),
+                                static_cast<size_t>(total), count, left.data(), right.data());
+        } else {
+            for (auto &layer : layers) {
+                mixLayer(*layer, left.data(), right.data(), count);
+            }
+            if (tail.recording()) {
+                tail.recordTail(left.data(), right.data(), count);
+            }
+        }
+        layersSample = chunkEnd;
+
+        std::vector<qint16> pcm(static_cast<size_t>(count) * kChannels);
+        for (int i = 0; i < count; ++i) {
+            pcm[i * 2] = static_cast<qint16>(std::clamp(left[i], -1.0f, 1.0f) * 32767.0f);
+            pcm[i * 2 + 1] = static_cast<qint16>(std::clamp(right[i], -1.0f, 1.0f) * 32767.0f);
+        }
+
+        lock.lock();
+        if (generation != m_generation) {
+            continue;
+        }
+        // 混合期间读指针若已越过本块开头（欠载），只追加尚未播出的部分
+        const qint64 bufferEnd = m_playStartSample + m_samplesRead + static_cast<qint64>(m_buffer.size()) / kChannels;
+        const qint64 skip = std::clamp<qint64>(bufferEnd - chunkStart, 0, count);
+        m_buffer.insert(m_buffer.end(), pcm.begin() + skip * kChannels, pcm.end());
+        m_produceSample = chunkEnd;
+    }
+}
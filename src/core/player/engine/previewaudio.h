@@ -0,0 +1,88 @@
+#ifndef PREVIEWAUDIO_H
+#define PREVIEWAUDIO_H
+
+#include <QIODevice>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "previewrenderer.h"
+
+class QAudioSink;
+
+/**
+ * PreviewAudio - 预览音频输出与播放时钟
+ *
+ * 后台线程按与画面相同的场景时间轴解码并混合每个场景的音轨
+ * （旁白、audio_layers、视频原声），以 44.1kHz 16 位立体声 PCM
+ * 通过拉模式送入 QAudioSink。clockMs() 返回声卡实际播出的位置，
+ * TimelineRenderer 以它作为主时钟调度画面。
+ *
+ * 转场场景与导出一致（AudioCrossfade）：前一场景混音的末尾淡出、后一场景主音轨的开头淡入。
+ * 直接 seek 进转场时没有前一场景的末尾，只淡入后一场景。
+ */
+class PreviewAudio : public QIODevice
+{
+    Q_OBJECT
+public:
+    explicit PreviewAudio(QObject *parent = nullptr);
+    ~PreviewAudio() override;
+
+    // 更新项目与场景时间轴（正在播放时从当前位置重新开始）
+    void setProject(std::shared_ptr<const VideoCreator::ProjectConfig> config, const std::vector<PreviewSceneSpan> &spans);
+
+    // 从 positionMs 开始播放；没有可用音频设备时返回 false，调用方应退回系统时钟
+    bool start(qint64 positionMs);
+    void stop();
+
+    // 已播出的时间线位置（毫秒），未在播放时返回 -1
+    qint64 clockMs() const;
+
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override;
+
+protected:
+    qint64 readData(char *data, qint64 maxlen) override;
+    qint64 writeData(const char *data, qint64 len) override;
+
+private:
+    struct SampleSpan
+    {
+        int sceneIndex = 0;
+        qint64 start = 0; // 采样
+        qint64 end = 0;
+    };
+    struct MixLayer;
+
+    void producerLoop();
+    std::vector<std::unique_ptr<MixLayer>> openLayers(const VideoCreator::ProjectConfig &config,
+                                                      const SampleSpan &span, qint64 localSample) const;
+    static void mixLayer(MixLayer &layer, float *left, float *right, int count);
+    void restartLocked(qint64 sample);
+
+    static constexpr int kSampleRate = 44100;
+    static constexpr int kChannels = 2;
+    static constexpr int kChunkSamples = 2048;
+    static constexpr int kBufferAheadSamples = kSampleRate / 2; // 预混合 0.5 秒
+
+    QAudioSink *m_sink = nullptr;
+    std::thread m_producer;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+
+    // 以下成员受 m_mutex 保护
+    bool m_stop = false;
+    bool m_running = false;
+    quint64 m_generation = 0; // 换项目 / 重新开始时递增，生产线程据此丢弃旧状态
+    std::shared_ptr<const VideoCreator::ProjectConfig> m_config;
+    std::vector<SampleSpan> m_spans;
+    qint64 m_totalSamples = 0;
+    std::deque<qint16> m_buffer; // 交错立体声，首个采样位于读指针处
+    qint64 m_playStartSample = 0; // start() 时的时间线位置
+    qint64 m_samplesRead = 0;     // 已交给声卡的采样数（含欠载时补的静音）
+    qint64 m_produceSample = 0;   // 下一个要混合的时间线位置
+};
+
+#endif // PREVIEWAUDIO_H
@@ -0,0 +1,587 @@
+#include "previewrenderer.h"
+#include "decoder/ImageDecoder.h"
+#include "decoder/VideoDecoder.h"
+#include "filter/LayerCompositor.h"
+#include "model/MediaInfoCache.h"
+#include <QPainter>
+#include <QPainterPath>
+#include <QFont>
+#include <QFontMetrics>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+using namespace VideoCreator;
+
+namespace {
+
+// 没有关键帧索引时，向前跳过该距离才真正 seek
+constexpr double kVideoSeekThreshold = 1.0;
+
+// 将 RGB32 的 AVFrame 零拷贝包装为 QImage，QImage 析构时释放帧；带透明度的素材用 Format_ARGB32
+QImage wrapRgbFrame(FFmpegUtils::AvFramePtr frame, QImage::Format format = QImage::Format_RGB32)
+{
+    if (!frame) {
+        return QImage();
+    }
+    AVFrame *raw = frame.release();
+    return QImage(raw->data[0], raw->width, raw->height, raw->linesize[0], format,
+                  [](void *info) {
+                      AVFrame *f = static_cast<AVFrame *>(info);
+                      av_frame_free(&f);
+                  },
+                  raw);
+}
+
+// 解析 FFmpeg 颜色写法，如 "white"、"black@0.5"、"0xRRGGBB"、"#RRGGBB"
+QColor parseFfmpegColor(const std::string &spec, const QColor &fallback)
+{
+    QString name = QString::fromStdString(spec).trimmed();
+    double alpha = -1.0;
+    const int at = name.indexOf('@');
+    if (at >= 0) {
+        alpha = name.mid(at + 1).toDouble();
+        name = name.left(at);
+    }
+    if (name.startsWith("0x", Qt::CaseInsensitive)) {
+        name = "#" + name.mid(2);
+    }
+    QColor color = QColor::fromString(name);
+    if (!color.isValid()) {
+        color = fallback;
+    }
+    if (alpha >= 0.0) {
+        color.setAlphaF(static_cast<float>(std::clamp(alpha, 0.0, 1.0)));
+    }
+    return color;
+}
+
+// 以原始尺寸解码图片，保留透明度
+QImage loadImage(const std::string &path)
+{
+    ImageDecoder decoder;
+    QImage image;
+    if (decoder.open(path)) {
+        auto frame = decoder.decode();
+        if (frame) {
+            image = wrapRgbFrame(decoder.scaleToSize(frame, frame->width, frame->height, AV_PIX_FMT_RGB32), QImage::Format_ARGB32);
+        }
+    }
+    if (image.isNull()) {
+        qWarning() << "PreviewRenderer: 无法加载图片" << QString::fromStdString(path) << decoder.getErrorString().c_str();
+    }
+    return image;
+}
+
+// 按 LayerCompositor 的规则摆放图片：fit 适配后以中心缩放、顺时针旋转，再平移 (x, y)；
+// 项目坐标按 target 与 project 之比换算到预览画面
+void drawPlacedImage(QPainter &painter, const QImage &image, const ImageConfig &config, LayerCompositor::Fit fit,
+                     const QSize &project, const QSizeF &target)
+{
+    if (image.isNull() || project.isEmpty() || !(config.scale > 0.0)) {
+        return;
+    }
+    const LayerCompositor::Rect fitted = LayerCompositor::fitRect(image.width(), image.height(), project.width(), project.height(), fit);
+    const double ratioX = target.width() / project.width();
+    const double ratioY = target.height() / project.height();
+    const QPointF center((fitted.x + fitted.width / 2.0 + config.x) * ratioX, (fitted.y + fitted.height / 2.0 + config.y) * ratioY);
+    const QSizeF placed(fitted.width * config.scale * ratioX, fitted.height * config.scale * ratioY);
+    painter.save();
+    painter.translate(center);
+    painter.rotate(config.rotation);
+    painter.drawImage(QRectF(QPointF(-placed.width() / 2.0, -placed.height() / 2.0), placed), image);
+    painter.restore();
+}
+
+LayerCompositor::Fit parseFitOr(const std::string &name, LayerCompositor::Fit defaultFit)
+{
+    LayerCompositor::Fit fit = defaultFit;
+    LayerCompositor::parseFit(name, defaultFit, fit);
+    return fit;
+}
+
+// Ken Burns 取景窗口的最大放大倍数，用于决定素材预缩放尺寸
+double kenBurnsMaxZoom(const KenBurnsEffect &effect)
+{
+    if (!effect.enabled) {
+        return 1.0;
+    }
+    if (effect.preset == "zoom_in" || effect.preset == "zoom_out") {
+        return 1.2;
+    }
+    if (effect.preset == "pan_right" || effect.preset == "pan_left") {
+        return 1.1;
+    }
+    return std::clamp(std::max(effect.start_scale, effect.end_scale), 1.0, 10.0);
+}
+
+// 与 EffectProcessor::startKenBurnsSequence 生成的 zoompan 表达式一致，
+// 直接按进度求出第 frame 帧的取景窗口（归一化坐标）
+QRectF kenBurnsWindow(const KenBurnsEffect &effect, int frame, int totalFrames, const QSizeF &project)
+{
+    const double t = totalFrames > 0 ? static_cast<double>(frame) / totalFrames : 0.0;
+    double zoom = 1.0;
+    double x = 0.0;
+    double y = 0.0;
+
+    if (effect.preset == "zoom_in" || effect.preset == "zoom_out") {
+        const double startZoom = (effect.preset == "zoom_in") ? 1.0 : 1.2;
+        const double endZoom = (effect.preset == "zoom_in") ? 1.2 : 1.0;
+        zoom = startZoom + (endZoom - startZoom) * t;
+    } else if (effect.preset == "pan_right" || effect.preset == "pan_left") {
+        const double panScale = 1.1;
+        const double travel = project.width() * (panScale - 1.0);
+        const double startX = (effect.preset == "pan_right") ? 0.0 : travel;
+        const double endX = (effect.preset == "pan_right") ? travel : 0.0;
+        zoom = panScale;
+        x = startX + (endX - startX) * t;
+        y = project.height() * (panScale - 1.0) / 2;
+    } else {
+        zoom = effect.start_scale + (effect.end_scale - effect.start_scale) * t;
+        x = effect.start_x + (effect.end_x - effect.start_x) * t;
+        y = effect.start_y + (effect.end_y - effect.start_y) * t;
+    }
+
+    // zoompan 会把 z 限制在 [1, 10]，x/y 限制在画面内
+    zoom = std::clamp(zoom, 1.0, 10.0);
+    const double w = project.width() / zoom;
+    const double h = project.height() / zoom;
+    x = std::clamp(x, 0.0, std::max(0.0, project.width() - w));
+    y = std::clamp(y, 0.0, std::max(0.0, project.height() - h));
+    return QRectF(x / project.width(), y / project.height(), w / project.width(), h / project.height());
+}
+
+} // namespace
+
+PreviewRenderer::PreviewRenderer() = default;
+
+PreviewRenderer::~PreviewRenderer() = default;
+
+void PreviewRenderer::setProject(const ProjectConfig &config)
+{
+    m_config = config;
+    m_fps = config.project.fps > 0 ? config.project.fps : 30;
+    m_background = parseFfmpegColor(config.project.background_color, Qt::black);
+
+    m_imageCache.clear();
+    m_overlayCache.clear();
+    m_subtitleCache.clear();
+    m_transitionEntry = -1;
+    m_transitionFrom = QImage();
+    m_transitionTo = QImage();
+    resetVideoSource();
+
+    m_timeline.clear();
+    m_sceneEntries.assign(m_config.scenes.size(), -1);
+    int startFrame = 0;
+    for (size_t i = 0; i < m_config.scenes.size(); ++i) {
+        const int frameCount = static_cast<int>(std::round(effectiveSceneDuration(m_config.scenes[i]) * m_fps));
+        if (frameCount <= 0) {
+            continue;
+        }
+        m_sceneEntries[i] = static_cast<int>(m_timeline.size());
+        m_timeline.push_back({startFrame, frameCount, static_cast<int>(i)});
+        startFrame += frameCount;
+    }
+    m_totalFrames = startFrame;
+    qDebug() << "PreviewRenderer: 时间轴已建立，场景数:" << m_timeline.size() << "总帧数:" << m_totalFrames;
+}
+
+double PreviewRenderer::effectiveSceneDuration(const SceneConfig &scene) const
+{
+    if (scene.type == SceneType::TRANSITION) {
+        return scene.duration;
+    }
+
+    // 与 RenderEngine::renderScene 保持一致：视频场景取视频时长，否则有音频时取最长音轨
+    // 时长来自 MediaInfoCache，ConfigLoader 加载时通常已探测过
+    MediaInfoCache &mediaInfo = MediaInfoCache::instance();
+    if (scene.type == SceneType::VIDEO_SCENE && !scene.resources.video.path.empty()) {
+        const double videoDuration = mediaInfo.duration(scene.resources.video.path, MediaKind::VIDEO);
+        if (videoDuration > 0) {
+            return videoDuration;
+        }
+    }
+
+    double longestAudio = -1.0;
+    auto probeAudio = [&](const std::string &path) {
+        if (!path.empty()) {
+            longestAudio = std::max(longestAudio, mediaInfo.duration(path, MediaKind::AUDIO));
+        }
+    };
+    probeAudio(scene.resources.audio.path);
+    for (const auto &layer : scene.resources.audio_layers) {
+        probeAudio(layer.path);
+    }
+    return longestAudio > 0 ? longestAudio : scene.duration;
+}
+
+std::vector<PreviewSceneSpan> PreviewRenderer::sceneSpans() const
+{
+    std::vector<PreviewSceneSpan> spans;
+    spans.reserve(m_timeline.size());
+    for (const auto &entry : m_timeline) {
+        spans.push_back({entry.sceneIndex, static_cast<double>(entry.startFrame) / m_fps,
+                         static_cast<double>(entry.frameCount) / m_fps});
+    }
+    return spans;
+}
+
+const PreviewRenderer::TimelineEntry *PreviewRenderer::findEntry(int frameIndex) const
+{
+    if (frameIndex < 0 || frameIndex >= m_totalFrames) {
+        return nullptr;
+    }
+    auto it = std::upper_bound(m_timeline.begin(), m_timeline.end(), frameIndex,
+                               [](int frame, const TimelineEntry &entry) { return frame < entry.startFrame; });
+    if (it == m_timeline.begin()) {
+        return nullptr;
+    }
+    return &*(it - 1);
+}
+
+const PreviewRenderer::TimelineEntry *PreviewRenderer::findEntryForScene(int sceneIndex) const
+{
+    if (sceneIndex < 0 || sceneIndex >= static_cast<int>(m_sceneEntries.size())) {
+        return nullptr;
+    }
+    const int entryIndex = m_sceneEntries[sceneIndex];
+    return entryIndex >= 0 ? &m_timeline[entryIndex] : nullptr;
+}
+
+QImage PreviewRenderer::renderFrame(int frameIndex, const QSize &size, QImage canvas)
+{
+    if (size.isEmpty()) {
+        return QImage();
+    }
+
+    if (canvas.size() != size || canvas.format() != QImage::Format_RGB32) {
+        canvas = QImage(size, QImage::Format_RGB32);
+    }
+    canvas.fill(m_background);
+
+    const TimelineEntry *entry = findEntry(frameIndex);
+    if (!entry) {
+        return canvas;
+    }
+
+    QPainter painter(&canvas);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    const int localFrame = frameIndex - entry->startFrame;
+    if (m_config.scenes[entry->sceneIndex].type == SceneType::TRANSITION) {
+        drawTransition(painter, *entry, localFrame, size);
+    } else {
+        drawScene(painter, *entry, localFrame, size);
+    }
+    return canvas;
+}
+
+QImage PreviewRenderer::renderSceneFrame(int sceneIndex, int localFrame, const QSize &size)
+{
+    const TimelineEntry *entry = findEntryForScene(sceneIndex);
+    if (!entry || m_config.scenes[sceneIndex].type == SceneType::TRANSITION) {
+        return QImage();
+    }
+
+    QImage canvas(size, QImage::Format_RGB32);
+    canvas.fill(m_background);
+    QPainter painter(&canvas);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    drawScene(painter, *entry, std::clamp(localFrame, 0, entry->frameCount - 1), size);
+    return canvas;
+}
+
+void PreviewRenderer::drawScene(QPainter &painter, const TimelineEntry &entry, int localFrame, const QSize &size)
+{
+    const SceneConfig &scene = m_config.scenes[entry.sceneIndex];
+    const QRectF target(QPointF(0, 0), QSizeF(size));
+
+    if (scene.type == SceneType::VIDEO_SCENE) {
+        // 与导出一致：源画面按 video.fit 放进画面，其余为背景色
+        QImage frame = videoFrameAt(entry.sceneIndex, static_cast<double>(localFrame) / m_fps, size);
+        if (!frame.isNull()) {
+            painter.drawImage(videoTargetRect(scene, size), frame);
+        }
+    } else {
+        QImage source = sourceImage(scene, size);
+        if (!source.isNull()) {
+            if (scene.effects.ken_burns.enabled) {
+                const QRectF window = kenBurnsWindow(scene.effects.ken_burns, localFrame, entry.frameCount, QSizeF(projectSize()));
+                const QRectF sourceRect(window.x() * source.width(), window.y() * source.height(),
+                                        window.width() * source.width(), window.height() * source.height());
+                painter.drawImage(target, source, sourceRect);
+            } else {
+                painter.drawImage(target, source);
+            }
+        }
+    }
+
+    for (const auto &overlay : scene.resources.overlays) {
+        auto it = m_overlayCache.find(overlay.path);
+        if (it == m_overlayCache.end()) {
+            it = m_overlayCache.emplace(overlay.path, loadImage(overlay.path)).first;
+        }
+        drawPlacedImage(painter, it->second, overlay, parseFitOr(overlay.fit, LayerCompositor::Fit::NONE), projectSize(), QSizeF(size));
+    }
+
+    drawSubtitle(painter, entry.sceneIndex, size);
+}
+
+void PreviewRenderer::drawTransition(QPainter &painter, const TimelineEntry &entry, int localFrame, const QSize &size)
+{
+    // 转场两端与导出一致：起始场景末帧 -> 目标场景首帧，整个转场只合成一次
+    const int entryIndex = static_cast<int>(&entry - m_timeline.data());
+    if (m_transitionEntry != entryIndex || m_transitionSize != size) {
+        m_transitionEntry = entryIndex;
+        m_transitionSize = size;
+        const int sceneIndex = entry.sceneIndex;
+        const TimelineEntry *fromEntry = findEntryForScene(sceneIndex - 1);
+        m_transitionFrom = fromEntry ? renderSceneFrame(sceneIndex - 1, fromEntry->frameCount - 1, size) : QImage();
+        m_transitionTo = renderSceneFrame(sceneIndex + 1, 0, size);
+    }
+
+    const SceneConfig &scene = m_config.scenes[entry.sceneIndex];
+    const double progress = static_cast<double>(localFrame) / entry.frameCount;
+    const QRectF target(QPointF(0, 0), QSizeF(size));
+
+    switch (scene.transition_type) {
+    case TransitionType::WIPE: {
+        const int wipeX = static_cast<int>(size.width() * progress);
+        painter.drawImage(target, m_transitionFrom);
+        const QRect revealed(0, 0, wipeX, size.height());
+        painter.drawImage(revealed, m_transitionTo, revealed);
+        break;
+    }
+    case TransitionType::SLIDE: {
+        const int offset = static_cast<int>(size.width() * progress);
+        painter.drawImage(QPoint(-offset, 0), m_transitionFrom);
+        painter.drawImage(QPoint(size.width() - offset, 0), m_transitionTo);
+        break;
+    }
+    case TransitionType::PUSH_RIGHT: {
+        const int offset = static_cast<int>(size.width() * progress);
+        painter.drawImage(QPoint(offset, 0), m_transitionFrom);
+        painter.drawImage(QPoint(offset - size.width(), 0), m_transitionTo);
+        break;
+    }
+    case TransitionType::PUSH_UP: {
+        const int offset = static_cast<int>(size.height() * progress);
+        painter.drawImage(QPoint(0, -offset), m_transitionFrom);
+        painter.drawImage(QPoint(0, size.height() - offset), m_transitionTo);
+        break;
+    }
+    case TransitionType::PUSH_DOWN: {
+        const int offset = static_cast<int>(size.height() * progress);
+        painter.drawImage(QPoint(0, offset), m_transitionFrom);
+        painter.drawImage(QPoint(0, offset - size.height()), m_transitionTo);
+        break;
+    }
+    case TransitionType::IRIS: {
+        const QPointF center = target.center();
+        const double radius = progress * std::hypot(center.x(), center.y());
+        painter.drawImage(target, m_transitionFrom);
+        QPainterPath iris;
+        iris.addEllipse(center, radius, radius);
+        painter.save();
+        painter.setClipPath(iris);
+        painter.drawImage(target, m_transitionTo);
+        painter.restore();
+        break;
+    }
+    case TransitionType::ZOOM_DISSOLVE: {
+        // 与导出 kernel 一致：起始画面最多放大 25%
+        const double zoom = 1.0 + 0.25 * progress;
+        painter.save();
+        painter.translate(target.center());
+        painter.scale(zoom, zoom);
+        painter.translate(-target.center());
+        painter.drawImage(target, m_transitionFrom);
+        painter.restore();
+        painter.setOpacity(progress);
+        painter.drawImage(target, m_transitionTo);
+        painter.setOpacity(1.0);
+        break;
+    }
+    // 预览中亮度遮罩擦除按淡入淡出近似，逐像素遮罩只在导出时计算
+    case TransitionType::LUMA_WIPE:
+    case TransitionType::CROSSFADE:
+    default:
+        painter.drawImage(target, m_transitionFrom);
+        painter.setOpacity(progress);
+        painter.drawImage(target, m_transitionTo);
+        painter.setOpacity(1.0);
+        break;
+    }
+}
+
+void PreviewRenderer::drawSubtitle(QPainter &painter, int sceneIndex, const QSize &size)
+{
+    const SubtitleConfig &subtitle = m_config.scenes[sceneIndex].effects.subtitle;
+    if (subtitle.text.empty()) {
+        return;
+    }
+    if (m_subtitleCacheSize != size) {
+        m_subtitleCache.clear();
+        m_subtitleCacheSize = size;
+    }
+    auto it = m_subtitleCache.find(sceneIndex);
+    if (it == m_subtitleCache.end()) {
+        it = m_subtitleCache.emplace(sceneIndex, buildSubtitleLayer(subtitle, size)).first;
+    }
+    if (!it->second.image.isNull()) {
+        painter.drawImage(it->second.position, it->second.image);
+    }
+}
+
+PreviewRenderer::SubtitleLayer PreviewRenderer::buildSubtitleLayer(const SubtitleConfig &subtitle, const QSize &size) const
+{
+    // 按预览尺寸等比缩放 drawtext 的字号、边距与底框
+    const double scale = m_config.project.height > 0 ? static_cast<double>(size.height()) / m_config.project.height : 1.0;
+    QFont font(QStringLiteral("Microsoft YaHei"));
+    font.setPixelSize(std::max(1, qRound(subtitle.font_size * scale)));
+    const QFontMetrics metrics(font);
+    const QString text = QString::fromStdString(subtitle.text);
+    const QSize textSize(metrics.horizontalAdvance(text), metrics.height());
+    const int border = std::max(1, qRound(10 * scale));
+    const int marginBottom = qRound(subtitle.margin_bottom * scale);
+
+    SubtitleLayer layer;
+    layer.image = QImage(textSize + QSize(border * 2, border * 2), QImage::Format_ARGB32_Premultiplied);
+    layer.image.fill(parseFfmpegColor(subtitle.bg_color, QColor(0, 0, 0, 128)));
+    QPainter painter(&layer.image);
+    painter.setFont(font);
+    painter.setPen(parseFfmpegColor(subtitle.font_color, Qt::white));
+    painter.drawText(QRect(QPoint(border, border), textSize), Qt::AlignCenter, text);
+    layer.position = QPoint((size.width() - textSize.width()) / 2 - border,
+                            size.height() - marginBottom - textSize.height() - border);
+    return layer;
+}
+
+QImage PreviewRenderer::sourceImage(const SceneConfig &scene, const QSize &size)
+{
+    const std::string &path = scene.resources.image.path;
+    if (path.empty()) {
+        return QImage();
+    }
+    if (m_imageCacheSize != size) {
+        m_imageCache.clear();
+        m_imageCacheSize = size;
+    }
+
+    // 背景色与摆放后的主图预合成到 输出尺寸 x 最大放大倍数 的画面，之后每帧只需小幅缩放
+    const ImageConfig &placement = scene.resources.image;
+    const double zoom = kenBurnsMaxZoom(scene.effects.ken_burns);
+    const QSize scaledSize(qRound(size.width() * zoom), qRound(size.height() * zoom));
+    const std::string key = path + "|" + std::to_string(scaledSize.width()) + "x" + std::to_string(scaledSize.height()) + "|" +
+                            placement.fit + "|" + std::to_string(placement.x) + "," + std::to_string(placement.y) + "|" +
+                            std::to_string(placement.scale) + "|" + std::to_string(placement.rotation);
+    auto it = m_imageCache.find(key);
+    if (it != m_imageCache.end()) {
+        return it->second;
+    }
+
+    const size_t maxCachedImages = 8;
+    if (m_imageCache.size() >= maxCachedImages) {
+        m_imageCache.clear();
+    }
+
+    QImage image;
+    const QImage loaded = loadImage(path);
+    if (!loaded.isNull()) {
+        image = QImage(scaledSize, QImage::Format_RGB32);
+        image.fill(m_background);
+        QPainter painter(&image);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        drawPlacedImage(painter, loaded, placement, parseFitOr(placement.fit, LayerCompositor::Fit::CONTAIN), projectSize(), QSizeF(scaledSize));
+    }
+    m_imageCache.emplace(key, image);
+    return image;
+}
+
+QImage PreviewRenderer::videoFrameAt(int sceneIndex, double seconds, const QSize &size)
+{
+    if (m_videoScene != sceneIndex) {
+        resetVideoSource();
+        m_videoScene = sceneIndex;
+        auto decoder = std::make_unique<VideoDecoder>();
+        if (decoder->open(m_config.scenes[sceneIndex].resources.video.path)) {
+            m_videoDecoder = std::move(decoder);
+        } else {
+            qWarning() << "PreviewRenderer: 无法打开视频" << decoder->getErrorString().c_str();
+        }
+    }
+    if (!m_videoDecoder) {
+        return QImage();
+    }
+
+    // 后退时必须 seek；向前时只有目标之前存在比当前位置更新的关键帧，seek 才比顺序解码快
+    // 容器没有关键帧索引时按距离阈值判断
+    const double epsilon = 1e-3;
+    const double currentTs = m_videoCurrent ? m_videoCurrentTs : 0.0;
+    bool needSeek = false;
+    if (m_videoCurrent && seconds < m_videoCurrentTs - epsilon) {
+        needSeek = true;
+    } else {
+        const double keyframe = m_videoDecoder->keyframeBefore(seconds);
+        needSeek = keyframe >= 0 ? keyframe > currentTs + epsilon : seconds > currentTs + kVideoSeekThreshold;
+    }
+    if (needSeek && m_videoDecoder->seek(seconds)) {
+        m_videoCurrent.reset();
+        m_videoPending.reset();
+        m_videoCurrentTs = -1.0;
+    }
+
+    const double frameDuration = m_videoDecoder->getFrameRate() > 0 ? 1.0 / m_videoDecoder->getFrameRate() : 1.0 / m_fps;
+    while (true) {
+        if (!m_videoPending) {
+            FFmpegUtils::AvFramePtr decoded;
+            if (m_videoDecoder->decodeFrame(decoded) <= 0 || !decoded) {
+                break; // EOF 或出错时保持最后一帧
+            }
+            m_videoPending = std::move(decoded);
+        }
+        double pendingTs = m_videoDecoder->frameTimestamp(m_videoPending.get());
+        if (pendingTs < 0) {
+            pendingTs = m_videoCurrentTs < 0 ? 0.0 : m_videoCurrentTs + frameDuration;
+        }
+        if (m_videoCurrent && pendingTs > seconds + epsilon) {
+            break;
+        }
+        m_videoCurrent = std::move(m_videoPending);
+        m_videoCurrentTs = pendingTs;
+    }
+
+    if (!m_videoCurrent) {
+        return QImage();
+    }
+    const QSize imageSize = videoTargetRect(m_config.scenes[sceneIndex], size).size().toSize().expandedTo(QSize(1, 1));
+    if (m_videoImage.isNull() || m_videoImageTs != m_videoCurrentTs || m_videoImage.size() != imageSize) {
+        m_videoImage = wrapRgbFrame(m_videoDecoder->scaleFrame(m_videoCurrent.get(), imageSize.width(), imageSize.height(), AV_PIX_FMT_RGB32));
+        m_videoImageTs = m_videoCurrentTs;
+    }
+    return m_videoImage;
+}
+
+QRectF PreviewRenderer::videoTargetRect(const SceneConfig &scene, const QSize &size) const
+{
+    if (!m_videoDecoder || m_config.project.width <= 0 || m_config.project.height <= 0) {
+        return QRectF(QPointF(0, 0), QSizeF(size));
+    }
+    const LayerCompositor::Rect rect = LayerCompositor::fitRect(m_videoDecoder->sourceWidth(), m_videoDecoder->sourceHeight(),
+                                                                m_config.project.width, m_config.project.height,
+                                                                parseFitOr(scene.resources.video.fit, LayerCompositor::Fit::CONTAIN));
+    const double ratioX = static_cast<double>(size.width()) / m_config.project.width;
+    const double ratioY = static_cast<double>(size.height()) / m_config.project.height;
+    return QRectF(rect.x * ratioX, rect.y * ratioY, rect.width * ratioX, rect.height * ratioY);
+}
+
+void PreviewRenderer::resetVideoSource()
+{
+    m_videoDecoder.reset();
+    m_videoCurrent.reset();
+    m_videoPending.reset();
+    m_videoCurrentTs = -1.0;
+    m_videoImage = QImage();
+    m_videoImageTs = -1.0;
+    m_videoScene = -1;
+}
@@ -0,0 +1,121 @@
+#ifndef PREVIEWRENDERER_H
+#define PREVIEWRENDERER_H
+
+#include <QImage>
+#include <QSize>
+#include <QColor>
+#include <QPoint>
+#include <QRectF>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "model/ProjectConfig.h"
+#include "ffmpeg_utils/AvFrameWrapper.h"
+
+namespace VideoCreator {
+class VideoDecoder;
+}
+
+class QPainter;
+
+// 时间轴上一个场景的区间（按帧对齐后的秒数），供预览音频与画面对齐
+struct PreviewSceneSpan
+{
+    int sceneIndex = 0;
+    double start = 0.0;
+    double duration = 0.0;
+};
+
+/**
+ * PreviewRenderer - 预览帧合成器
+ *
+ * 按 VideoCreator 的场景模型（图片 + Ken Burns、视频、转场、字幕）
+ * 直接合成任意帧号的画面，时长规则与 RenderEngine 导出保持一致。
+ * 时间轴按帧号二分定位场景，场景内的 Ken Burns / 转场按进度解析计算，
+ * 因此任意位置 seek 都不需要从场景开头逐帧推进。
+ *
+ * 非线程安全：只应在 StoryEngine 的预览工作线程中使用。
+ */
+class PreviewRenderer
+{
+public:
+    PreviewRenderer();
+    ~PreviewRenderer();
+
+    // 载入项目并建立时间轴（会探测音视频时长，可能较慢）
+    void setProject(const VideoCreator::ProjectConfig &config);
+
+    int frameRate() const { return m_fps; }
+    int totalFrames() const { return m_totalFrames; }
+    QSize projectSize() const { return QSize(m_config.project.width, m_config.project.height); }
+    const VideoCreator::ProjectConfig &project() const { return m_config; }
+    std::vector<PreviewSceneSpan> sceneSpans() const;
+
+    // 合成指定帧，输出尺寸为 size；canvas 尺寸匹配时直接复用其像素缓冲
+    QImage renderFrame(int frameIndex, const QSize &size, QImage canvas = QImage());
+
+private:
+    struct TimelineEntry
+    {
+        int startFrame = 0;
+        int frameCount = 0;
+        int sceneIndex = 0;
+    };
+
+    struct SubtitleLayer
+    {
+        QImage image;
+        QPoint position;
+    };
+
+    const TimelineEntry *findEntry(int frameIndex) const;
+    const TimelineEntry *findEntryForScene(int sceneIndex) const;
+    double effectiveSceneDuration(const VideoCreator::SceneConfig &scene) const;
+
+    void drawScene(QPainter &painter, const TimelineEntry &entry, int localFrame, const QSize &size);
+    void drawTransition(QPainter &painter, const TimelineEntry &entry, int localFrame, const QSize &size);
+    void drawSubtitle(QPainter &painter, int sceneIndex, const QSize &size);
+    SubtitleLayer buildSubtitleLayer(const VideoCreator::SubtitleConfig &subtitle, const QSize &size) const;
+    QImage renderSceneFrame(int sceneIndex, int localFrame, const QSize &size);
+
+    QImage sourceImage(const VideoCreator::SceneConfig &scene, const QSize &size);
+    QImage videoFrameAt(int sceneIndex, double seconds, const QSize &size);
+    // 视频画面按 video.fit 适配后在 size 大小画面中的位置
+    QRectF videoTargetRect(const VideoCreator::SceneConfig &scene, const QSize &size) const;
+    void resetVideoSource();
+
+    VideoCreator::ProjectConfig m_config;
+    std::vector<TimelineEntry> m_timeline;
+    std::vector<int> m_sceneEntries; // 场景下标 -> 时间轴下标，时长为 0 的场景为 -1
+    int m_fps = 30;
+    int m_totalFrames = 0;
+    QColor m_background = Qt::black;
+
+    // 主图按摆放配置预合成到背景上的画面，按路径、尺寸与摆放缓存
+    std::unordered_map<std::string, QImage> m_imageCache;
+    QSize m_imageCacheSize;
+    // 叠加图片（原始尺寸），按路径缓存
+    std::unordered_map<std::string, QImage> m_overlayCache;
+
+    // 每个场景的字幕层，按输出尺寸缓存
+    std::unordered_map<int, SubtitleLayer> m_subtitleCache;
+    QSize m_subtitleCacheSize;
+
+    // 转场两端的静止帧（整个转场期间不变）
+    int m_transitionEntry = -1;
+    QSize m_transitionSize;
+    QImage m_transitionFrom;
+    QImage m_transitionTo;
+
+    // 当前视频场景的解码状态：current 为已显示帧，pending 为已解码但时间未到的帧
+    int m_videoScene = -1;
+    std::unique_ptr<VideoCreator::VideoDecoder> m_videoDecoder;
+    FFmpegUtils::AvFramePtr m_videoCurrent;
+    FFmpegUtils::AvFramePtr m_videoPending;
+    double m_videoCurrentTs = -1.0;
+    QImage m_videoImage;
+    double m_videoImageTs = -1.0;
+};
+
+#endif // PREVIEWRENDERER_H
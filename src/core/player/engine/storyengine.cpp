@@ -1,43 +1,244 @@
-#include "StoryEngine.h"
-#include <QPainter>
+#include "storyengine.h"
+#include "previewrenderer.h"
+#include "model/ConfigLoader.h"
 #include <QDebug>
+#include <QMetaObject>
 #include <QJsonArray>
+#include <algorithm>
 
-StoryEngine::StoryEngine(QObject *parent) : QObject(parent) {}
+namespace {
+
+// 按项目宽高比把预览画面放进控件区域（整帧显示，不裁剪）
+QSize fitOutputSize(const QSize &projectSize, const QSize &viewSize)
+{
+    if (viewSize.isEmpty()) {
+        return QSize();
+    }
+    if (projectSize.isEmpty()) {
+        return viewSize;
+    }
+    return projectSize.scaled(viewSize, Qt::KeepAspectRatio).expandedTo(QSize(1, 1));
+}
+
+} // namespace
+
+StoryEngine::StoryEngine(QObject *parent) : QObject(parent)
+{
+    m_worker = std::thread(&StoryEngine::workerLoop, this);
+}
+
+StoryEngine::~StoryEngine()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
 
 void StoryEngine::loadConfig(const QJsonObject &config) {
-    m_config = config;
-    qDebug() << "Engine: 配置已加载，镜头数:" << config["track"].toArray().size();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingConfig = config;
+        m_hasPendingConfig = true;
+        m_totalFrames = 0;
+        m_requestedFrame = -1;
+        m_project.reset();
+        m_sceneSpans.clear();
+        restartAtLocked(0);
+    }
+    m_currentFrame = QImage();
+    m_currentFrameIndex = -1;
+    m_cond.notify_one();
+    qDebug() << "Engine: 配置已提交，场景数:" << config["scenes"].toArray().size();
 }
 
 void StoryEngine::setOutputSize(const QSize &size) {
-    m_size = size;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_viewSize = size;
+        const QSize fitted = fitOutputSize(m_projectSize, m_viewSize);
+        if (fitted == m_size) {
+            return;
+        }
+        m_size = fitted;
+        m_recycledFrames.clear();
+        restartAtLocked(std::max(m_requestedFrame, 0));
+    }
+    m_currentFrameIndex = -1; // 旧尺寸的画面继续显示，直到新尺寸的帧就绪
+    m_cond.notify_one();
 }
 
-// 【模拟渲染】这里随便画点什么，证明链路通了
 QImage StoryEngine::getFrame(int timestamp) {
-    if (m_size.isEmpty()) return QImage();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_totalFrames <= 0 || m_size.isEmpty()) {
+        return m_currentFrame;
+    }
 
-    // 创建一张画布
-    QImage image(m_size, QImage::Format_ARGB32);
+    const int target = std::clamp(static_cast<int>(static_cast<qint64>(std::max(timestamp, 0)) * m_fps / 1000),
+                                  0, m_totalFrames - 1);
+    m_requestedFrame = target;
 
-    // 根据时间变色 (模拟动画效果)
-    int r = (timestamp / 10) % 255;
-    int g = (timestamp / 20) % 255;
-    int b = (timestamp / 30) % 255;
+    // 取出所有不晚于目标的已就绪帧，保留最新一帧（落后于时钟时跳过中间帧）
+    int taken = 0;
+    while (!m_queue.empty() && m_queue.front().frameIndex <= target) {
+        recycleLocked(std::move(m_currentFrame));
+        m_currentFrame = std::move(m_queue.front().image);
+        m_currentFrameIndex = m_queue.front().frameIndex;
+        m_queue.pop_front();
+        ++taken;
+    }
+    if (taken > 1) {
+        m_droppedFrames += taken - 1;
+    }
+    if (target != m_lastTarget) {
+        // 时钟进入新的一帧但画面还没渲染好，只能继续显示上一帧
+        if (m_currentFrameIndex != target && m_lastTarget >= 0) {
+            ++m_repeatedFrames;
+        }
+        m_lastTarget = target;
+    }
 
-    image.fill(QColor(r, g, b));
+    if (m_currentFrameIndex != target) {
+        int windowStart = m_nextFrame;
+        if (!m_queue.empty()) {
+            windowStart = m_queue.front().frameIndex;
+        } else if (m_renderingFrame >= 0) {
+            windowStart = m_renderingFrame;
+        }
+        // 目标在预渲染窗口之外（后退或跳得太远），从目标帧重新开始
+        if (target < windowStart || target >= windowStart + kLookaheadFrames) {
+            restartAtLocked(target);
+        }
+    }
+    m_cond.notify_one();
+    return m_currentFrame;
+}
+
+int StoryEngine::duration() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_fps > 0 ? static_cast<int>(static_cast<qint64>(m_totalFrames) * 1000 / m_fps) : 0;
+}
 
-    QPainter p(&image);
-    p.setPen(Qt::white);
-    p.setFont(QFont("Arial", 40));
-    p.drawText(image.rect(), Qt::AlignCenter,
-               QString("预览模式\nTime: %1 ms").arg(timestamp));
+std::shared_ptr<const VideoCreator::ProjectConfig> StoryEngine::project() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_project;
+}
 
-    return image;
+std::vector<PreviewSceneSpan> StoryEngine::sceneSpans() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_sceneSpans;
+}
+
+int StoryEngine::currentFrameTime() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_currentFrameIndex < 0 || m_fps <= 0) {
+        return -1;
+    }
+    return static_cast<int>(static_cast<qint64>(m_currentFrameIndex) * 1000 / m_fps);
+}
+
+void StoryEngine::resetPlaybackStats() {
+    m_droppedFrames = 0;
+    m_repeatedFrames = 0;
+    m_lastTarget = -1;
 }
 
 void StoryEngine::exportVideo(const QString &outputPath) {
     qDebug() << "Engine: 正在调用 FFmpeg 导出到..." << outputPath;
     // 真正的导出逻辑待实现
 }
+
+void StoryEngine::restartAtLocked(int frameIndex) {
+    ++m_generation;
+    for (auto &queued : m_queue) {
+        recycleLocked(std::move(queued.image));
+    }
+    m_queue.clear();
+    m_nextFrame = frameIndex;
+}
+
+// 只保留当前尺寸的缓冲；界面仍持有引用时，工作线程写入前 QImage 会自动分离
+void StoryEngine::recycleLocked(QImage &&image) {
+    if (image.isNull() || image.size() != m_size
+        || static_cast<int>(m_recycledFrames.size()) >= kMaxRecycledFrames) {
+        return;
+    }
+    m_recycledFrames.push_back(std::move(image));
+}
+
+void StoryEngine::workerLoop() {
+    PreviewRenderer renderer;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cond.wait(lock, [this] {
+            return m_stop || m_hasPendingConfig
+                   || (m_totalFrames > 0 && !m_size.isEmpty()
+                       && static_cast<int>(m_queue.size()) < kLookaheadFrames && m_nextFrame < m_totalFrames);
+        });
+        if (m_stop) {
+            break;
+        }
+
+        if (m_hasPendingConfig) {
+            const QJsonObject json = m_pendingConfig;
+            m_pendingConfig = QJsonObject();
+            m_hasPendingConfig = false;
+            lock.unlock();
+
+            // 解析与时长探测都较慢，放在工作线程
+            VideoCreator::ProjectConfig config;
+            VideoCreator::ConfigLoader loader;
+            if (!loader.loadFromJsonObject(json, config)) {
+                qWarning() << "Engine: 配置解析失败:" << loader.errorString();
+                config = VideoCreator::ProjectConfig();
+            }
+            renderer.setProject(config);
+
+            lock.lock();
+            if (m_hasPendingConfig) {
+                continue; // 期间又来了新配置，以新的为准
+            }
+            m_fps = renderer.frameRate();
+            m_totalFrames = renderer.totalFrames();
+            m_projectSize = renderer.projectSize();
+            m_project = std::make_shared<const VideoCreator::ProjectConfig>(renderer.project());
+            m_sceneSpans = renderer.sceneSpans();
+            m_size = fitOutputSize(m_projectSize, m_viewSize);
+            m_recycledFrames.clear();
+            restartAtLocked(std::max(m_requestedFrame, 0));
+            QMetaObject::invokeMethod(this, [this] {
+                emit durationChanged();
+                emit frameReady();
+            }, Qt::QueuedConnection);
+            continue;
+        }
+
+        const int frameIndex = m_nextFrame++;
+        const quint64 generation = m_generation;
+        const QSize size = m_size;
+        QImage canvas;
+        if (!m_recycledFrames.empty()) {
+            canvas = std::move(m_recycledFrames.back());
+            m_recycledFrames.pop_back();
+        }
+        m_renderingFrame = frameIndex;
+        lock.unlock();
+
+        QImage image = renderer.renderFrame(frameIndex, size, std::move(canvas));
+
+        lock.lock();
+        m_renderingFrame = -1;
+        if (generation != m_generation) {
+            recycleLocked(std::move(image));
+            continue; // 渲染期间发生了 seek / 改尺寸，丢弃
+        }
+        m_queue.push_back({frameIndex, std::move(image)});
+        if (frameIndex == m_requestedFrame) {
+            QMetaObject::invokeMethod(this, &StoryEngine::frameReady, Qt::QueuedConnection);
+        }
+    }
+}
@@ -5,31 +5,103 @@
 #include <QJsonObject>
 #include <QImage>
 #include <QSize>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "previewrenderer.h"
 
-// 请在此类中实现核心渲染逻辑
+/**
+ * StoryEngine - 预览帧服务
+ *
+ * 后台线程用 PreviewRenderer 按帧号顺序预渲染（最多领先 kLookaheadFrames 帧），
+ * getFrame 只从队列中取已就绪的帧，不在 GUI 线程上做任何解码或合成。
+ * 请求的帧落在预渲染窗口之外时视为 seek：清空队列并从目标帧重新开始。
+ */
 class StoryEngine : public QObject
 {
     Q_OBJECT
 public:
     explicit StoryEngine(QObject *parent = nullptr);
+    ~StoryEngine() override;
 
-    // 1. 加载配置 (解析你传来的 huge JSON)
+    // 1. 加载配置（与导出相同的 VideoCreator 项目 JSON），时长探测在工作线程完成
     void loadConfig(const QJsonObject &config);
 
     // 2. 更新画布尺寸
     void setOutputSize(const QSize &size);
 
-    // 3. 【核心】获取当前这一帧的图像 (预览用)
-    // timestamp: 当前播放时间(毫秒)
+    // 3. 【核心】获取当前这一帧的图像 (预览用)，不阻塞
+    // timestamp: 当前播放时间(毫秒)，帧未就绪时返回最近一次的画面
     QImage getFrame(int timestamp);
 
+    // 项目总时长（毫秒），配置尚未就绪时为 0
+    int duration() const;
+
+    // 已解析的项目与场景时间轴，供预览音频对齐画面；配置尚未就绪时为空
+    std::shared_ptr<const VideoCreator::ProjectConfig> project() const;
+    std::vector<PreviewSceneSpan> sceneSpans() const;
+
+    // 最近一次 getFrame 返回的画面对应的时间（毫秒），没有画面时为 -1
+    int currentFrameTime() const;
+
+    // 播放统计：为追上时钟跳过的帧 / 帧未就绪而重复显示上一帧的次数
+    int droppedFrames() const { return m_droppedFrames; }
+    int repeatedFrames() const { return m_repeatedFrames; }
+    void resetPlaybackStats();
+
     // 4. 导出视频 (调用 FFmpeg)
     void exportVideo(const QString &outputPath);
 
+signals:
+    // 请求的帧已渲染完成，可重新调用 getFrame
+    void frameReady();
+    void durationChanged();
+
 private:
-    QJsonObject m_config;
+    struct QueuedFrame
+    {
+        int frameIndex = 0;
+        QImage image;
+    };
+
+    void workerLoop();
+    void restartAtLocked(int frameIndex);
+    void recycleLocked(QImage &&image);
+
+    static constexpr int kLookaheadFrames = 6;
+    static constexpr int kMaxRecycledFrames = 2;
+
+    std::thread m_worker;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_stop = false;
+
+    // 以下成员受 m_mutex 保护
+    QJsonObject m_pendingConfig;
+    bool m_hasPendingConfig = false;
+    std::deque<QueuedFrame> m_queue;
+    std::vector<QImage> m_recycledFrames; // 已不再显示的帧缓冲，供工作线程复用
+    quint64 m_generation = 0; // 每次 seek / 改尺寸 / 换配置递增，丢弃过期帧
+    int m_nextFrame = 0;      // 工作线程下一帧要渲染的帧号
+    int m_renderingFrame = -1;
+    int m_requestedFrame = -1;
     QSize m_size;
-    // 这里未来会存放他的解码器、OpenGL上下文等
+    QSize m_viewSize;
+    QSize m_projectSize;
+    int m_fps = 30;
+    int m_totalFrames = 0;
+    std::shared_ptr<const VideoCreator::ProjectConfig> m_project;
+    std::vector<PreviewSceneSpan> m_sceneSpans;
+
+    // 仅 GUI 线程访问
+    QImage m_currentFrame;
+    int m_currentFrameIndex = -1;
+    int m_lastTarget = -1;
+    int m_droppedFrames = 0;
+    int m_repeatedFrames = 0;
 };
 
 #endif // STORYENGINE_H
@@ -1,18 +1,94 @@
-#include "TimelineRenderer.h"
-#include "engine/StoryEngine.h" // 引用上面的引擎
-#include <QPainter>
+#include "timelinerenderer.h"
+#include "engine/storyengine.h" // 引用上面的引擎
+#include "engine/previewaudio.h"
+#include <QQuickWindow>
+#include <QSGImageNode>
+#include <QSGRectangleNode>
+#include <QSGRendererInterface>
+#include <QSGTexture>
+#include <rhi/qrhi.h>
 #include <QDebug>
 
+namespace {
+
+// 常驻的画面纹理：尺寸与格式不变时在原 QRhiTexture 上覆盖上传，不再每帧 createTextureFromImage 新建纹理。
+// 上传在渲染器提交材质时进行（commitTextureOperations），提交后即放掉 QImage，引擎的帧缓冲池才能复用它
+class FrameTexture : public QSGTexture
+{
+public:
+    ~FrameTexture() override { delete m_texture; }
+
+    void setImage(QImage image)
+    {
+        m_size = image.size();
+        m_hasAlpha = image.hasAlphaChannel();
+        m_pending = std::move(image);
+    }
+
+    qint64 comparisonKey() const override { return qint64(quintptr(this)); }
+    QRhiTexture *rhiTexture() const override { return m_texture; }
+    QSize textureSize() const override { return m_size; }
+    bool hasAlphaChannel() const override { return m_hasAlpha; }
+    bool hasMipmaps() const override { return false; }
+
+    void commitTextureOperations(QRhi *rhi, QRhiResourceUpdateBatch *resourceUpdates) override
+    {
+        if (m_pending.isNull()) return;
+
+        // 预览帧是 RGB32（内存中为 BGRA），后端支持 BGRA8 时直接上传，否则转成 RGBA8888
+        QRhiTexture::Format format = QRhiTexture::RGBA8;
+        if ((m_pending.format() == QImage::Format_RGB32 || m_pending.format() == QImage::Format_ARGB32_Premultiplied)
+            && rhi->isTextureFormatSupported(QRhiTexture::BGRA8)) {
+            format = QRhiTexture::BGRA8;
+        } else if (m_pending.format() != QImage::Format_RGBA8888_Premultiplied) {
+            m_pending = m_pending.convertToFormat(QImage::Format_RGBA8888_Premultiplied);
+        }
+
+        if (!m_texture || m_texture->pixelSize() != m_pending.size() || m_texture->format() != format) {
+            if (m_texture) {
+                m_texture->deleteLater(); // 可能仍被正在提交的帧引用
+            }
+            m_texture = rhi->newTexture(format, m_pending.size());
+            if (!m_texture->create()) {
+                qWarning() << "Preview: 创建纹理失败" << m_pending.size();
+                delete m_texture;
+                m_texture = nullptr;
+                m_pending = QImage();
+                return;
+            }
+        }
+        resourceUpdates->uploadTexture(m_texture, m_pending);
+        m_pending = QImage();
+    }
+
+private:
+    QRhiTexture *m_texture = nullptr;
+    QImage m_pending;
+    QSize m_size;
+    bool m_hasAlpha = false;
+};
+
+} // namespace
+
 // 构造函数
 TimelineRenderer::TimelineRenderer(QQuickItem *parent)
-    : QQuickPaintedItem(parent), m_isPlaying(false), m_currentTime(0)
+    : QQuickItem(parent), m_isPlaying(false), m_currentTime(0)
 {
+    setFlag(ItemHasContents, true);
+
     // 实例化引擎
     m_engine = new StoryEngine(this);
+    // 后台线程渲染好请求的帧后再重绘
+    connect(m_engine, &StoryEngine::frameReady, this, &TimelineRenderer::fetchFrame);
+    connect(m_engine, &StoryEngine::durationChanged, this, &TimelineRenderer::durationChanged);
+    connect(m_engine, &StoryEngine::durationChanged, this, &TimelineRenderer::onProjectReady);
 
-    // 设置刷新定时器 (约 30 FPS)
+    m_audio = new PreviewAudio(this);
+
+    // 取帧定时器：按显示刷新节奏采样播放时钟，掉帧/重复帧由引擎按时钟决定
     m_renderTimer = new QTimer(this);
-    m_renderTimer->setInterval(33);
+    m_renderTimer->setTimerType(Qt::PreciseTimer);
+    m_renderTimer->setInterval(16);
     connect(m_renderTimer, &QTimer::timeout, this, &TimelineRenderer::onTimerTick);
 }
 
@@ -28,22 +104,87 @@ void TimelineRenderer::setConfig(const QJsonObject &config)
 
     // 2. 重置播放进度
     m_currentTime = 0;
-    update(); // 触发重绘 (paint)
+    emit positionChanged();
+    fetchFrame();
+}
+
+int TimelineRenderer::duration() const
+{
+    return m_engine ? m_engine->duration() : 0;
+}
+
+void TimelineRenderer::onProjectReady()
+{
+    m_audio->setProject(m_engine->project(), m_engine->sceneSpans());
+    if (m_isPlaying) {
+        startClock();
+    }
+}
+
+void TimelineRenderer::startClock()
+{
+    m_audioClock = m_audio->start(m_currentTime);
+    m_clockBase = m_currentTime;
+    m_wallClock.start();
+}
+
+int TimelineRenderer::clockTime() const
+{
+    if (m_audioClock) {
+        const qint64 audioTime = m_audio->clockMs();
+        if (audioTime >= 0) {
+            return static_cast<int>(audioTime);
+        }
+    }
+    return m_clockBase + static_cast<int>(m_wallClock.elapsed());
 }
 
 // 播放控制
 void TimelineRenderer::play() {
+    if (m_isPlaying) return;
+    const int total = duration();
+    if (total > 0 && m_currentTime >= total) {
+        m_currentTime = 0; // 已在结尾时从头播放
+    }
     m_isPlaying = true;
+    m_engine->resetPlaybackStats();
+    m_avDrift = 0;
+    m_driftSum = 0;
+    m_driftMax = 0;
+    m_driftSamples = 0;
+    m_driftOutOfSync = 0;
+    startClock();
     m_renderTimer->start();
     emit isPlayingChanged();
 }
 
 void TimelineRenderer::pause() {
+    if (!m_isPlaying) return;
     m_isPlaying = false;
     m_renderTimer->stop();
+    m_audio->stop();
+    if (m_driftSamples > 0) {
+        qDebug() << "Preview: A/V 偏差 平均" << m_driftSum / m_driftSamples << "ms，最大" << m_driftMax
+                 << "ms，超出 ±" << kLipSyncToleranceMs << "ms" << m_driftOutOfSync << "/" << m_driftSamples
+                 << "，跳帧" << m_engine->droppedFrames() << "重复帧" << m_engine->repeatedFrames();
+    } else {
+        qDebug() << "Preview: 系统时钟播放（无音频设备），跳帧" << m_engine->droppedFrames()
+                 << "重复帧" << m_engine->repeatedFrames();
+    }
+    m_audioClock = false;
     emit isPlayingChanged();
 }
 
+void TimelineRenderer::seek(int position) {
+    const int total = duration();
+    m_currentTime = qBound(0, position, total > 0 ? total : 0);
+    if (m_isPlaying) {
+        startClock();
+    }
+    emit positionChanged();
+    fetchFrame();
+}
+
 void TimelineRenderer::exportVideo(const QString &path) {
     // 转发给引擎
     if(m_engine) {
@@ -51,30 +192,107 @@ void TimelineRenderer::exportVideo(const QString &path) {
     }
 }
 
-// 定时器回调：推进时间 -> 触发重绘
+// 定时器回调：推进时间 -> 取帧
 void TimelineRenderer::onTimerTick() {
     if (m_isPlaying) {
-        m_currentTime += 33; // 每次加 33ms
-        update(); // 这一句会触发 paint() 函数
+        m_currentTime = clockTime();
+        // 采样的是上一次上屏的帧，即用户此刻看到的画面
+        if (m_audioClock && m_presentedTime >= 0) {
+            m_avDrift = m_currentTime - m_presentedTime;
+            m_driftSum += m_avDrift;
+            m_driftMax = qMax(m_driftMax, qAbs(m_avDrift));
+            if (qAbs(m_avDrift) > kLipSyncToleranceMs) {
+                ++m_driftOutOfSync;
+            }
+            ++m_driftSamples;
+        }
+        const int total = duration();
+        if (total > 0 && m_currentTime >= total) {
+            m_currentTime = total;
+            pause(); // 播放到结尾自动暂停
+        }
+        emit positionChanged();
+        fetchFrame();
     }
 }
 
-// 【核心绘制函数】Qt 会自动调用这个函数把画面画在 QML 上
-void TimelineRenderer::paint(QPainter *painter)
+void TimelineRenderer::fetchFrame()
 {
     if (!m_engine) return;
 
-    // 1. 告诉引擎当前窗口有多大 (响应窗口缩放)
-    m_engine->setOutputSize(QSize(width(), height()));
-
-    // 2. 找引擎要当前这一帧的图像
+    // 只取已渲染好的帧，不会阻塞界面；帧没变就不重新上传纹理
     QImage frame = m_engine->getFrame(m_currentTime);
+    if (frame.cacheKey() == m_frameKey) return;
 
-    // 3. 画在屏幕上
-    if (!frame.isNull()) {
-        painter->drawImage(boundingRect(), frame);
-    } else {
-        // 如果没图，画个黑底
-        painter->fillRect(boundingRect(), Qt::black);
+    m_frameKey = frame.cacheKey();
+    m_frameTime = m_engine->currentFrameTime();
+    m_frame = std::move(frame);
+    m_frameDirty = true;
+    update(); // 触发 updatePaintNode
+}
+
+// 控件尺寸变化时通知引擎（引擎按项目宽高比重新渲染）
+void TimelineRenderer::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+    if (m_engine && newGeometry.size() != oldGeometry.size()) {
+        m_engine->setOutputSize(newGeometry.size().toSize());
+        update(); // 黑底与画面位置需要跟着尺寸更新
+    }
+}
+
+// 【核心绘制函数】节点结构：黑底矩形 -> 画面纹理（无画面时不挂纹理节点）
+// 只用 QSGRectangleNode / QSGImageNode，software 场景图后端同样可用（该后端没有 QRhi，仍按帧创建纹理）
+QSGNode *TimelineRenderer::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
+{
+    QSGRectangleNode *background = static_cast<QSGRectangleNode *>(oldNode);
+    if (!background) {
+        background = window()->createRectangleNode();
+        background->setColor(Qt::black);
+        m_frameDirty = true;
+    }
+    background->setRect(boundingRect());
+
+    QSGImageNode *imageNode = static_cast<QSGImageNode *>(background->firstChild());
+    if (m_frameDirty) {
+        m_frameDirty = false;
+        m_presentedTime = m_frame.isNull() ? -1 : m_frameTime;
+        if (m_frame.isNull()) {
+            delete imageNode; // 节点析构时会自动从父节点移除，并释放纹理
+            imageNode = nullptr;
+        } else {
+            const bool software = window()->rendererInterface()->graphicsApi() == QSGRendererInterface::Software;
+            const bool newNode = !imageNode;
+            if (newNode) {
+                imageNode = window()->createImageNode();
+                imageNode->setOwnsTexture(true);
+                imageNode->setFiltering(QSGTexture::Linear);
+                if (!software) {
+                    imageNode->setTexture(new FrameTexture);
+                }
+            }
+            if (software) {
+                // 旧纹理由节点释放（setOwnsTexture）
+                imageNode->setTexture(window()->createTextureFromImage(m_frame));
+                m_frame = QImage();
+            } else {
+                // 纹理对象不变，标记材质脏使渲染器调用 commitTextureOperations 上传新帧
+                static_cast<FrameTexture *>(imageNode->texture())->setImage(std::move(m_frame));
+                m_frame = QImage();
+                imageNode->markDirty(QSGNode::DirtyMaterial);
+            }
+            if (newNode) {
+                // software 后端挂入节点时就读取纹理，须先设置纹理再挂入
+                background->appendChildNode(imageNode);
+            }
+        }
+    }
+
+    // 帧已按控件尺寸渲染，居中 1:1 显示，无需再缩放
+    if (imageNode) {
+        const QSizeF frameSize = imageNode->texture()->textureSize();
+        imageNode->setRect(QRectF(QPointF((width() - frameSize.width()) / 2.0, (height() - frameSize.height()) / 2.0),
+                                  frameSize));
     }
+    return background;
 }
@@ -1,17 +1,23 @@
 #ifndef TIMELINERENDERER_H
 #define TIMELINERENDERER_H
 
-#include <QQuickPaintedItem> // 注意：改用 PaintedItem 方便画图
+#include <QQuickItem> // 通过 updatePaintNode 直接提交纹理，不再走 QPainter 光栅化
 #include <QJsonObject>
+#include <QImage>
 #include <QTimer>
+#include <QElapsedTimer>
 
 class StoryEngine; // 前置声明
+class PreviewAudio;
 
-class TimelineRenderer : public QQuickPaintedItem
+class TimelineRenderer : public QQuickItem
 {
     Q_OBJECT
     Q_PROPERTY(QJsonObject config READ config WRITE setConfig NOTIFY configChanged)
     Q_PROPERTY(bool isPlaying READ isPlaying NOTIFY isPlayingChanged)
+    Q_PROPERTY(int position READ position NOTIFY positionChanged)
+    Q_PROPERTY(int duration READ duration NOTIFY durationChanged)
+    Q_PROPERTY(int avDrift READ avDrift NOTIFY positionChanged)
 
 public:
     explicit TimelineRenderer(QQuickItem *parent = nullptr);
@@ -20,28 +26,68 @@ public:
     void setConfig(const QJsonObject &config);
 
     bool isPlaying() const { return m_isPlaying; }
+    int position() const { return m_currentTime; }
+    int duration() const;
+    // 最近一次采样的 A/V 偏差（ms）：音频时钟 - 屏幕上那一帧的时间戳，正值表示画面落后；不由音频驱动时为 0
+    int avDrift() const { return m_avDrift; }
 
     Q_INVOKABLE void play();
     Q_INVOKABLE void pause();
+    Q_INVOKABLE void seek(int position);
     Q_INVOKABLE void exportVideo(const QString &path);
 
-    // 重写绘制函数
-    void paint(QPainter *painter) override;
+protected:
+    // 在渲染线程上更新场景图节点（GUI 线程此时处于阻塞状态）
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
 
 signals:
     void configChanged();
     void isPlayingChanged();
+    void positionChanged();
+    void durationChanged();
 
 private slots:
     void onTimerTick();
 
 private:
+    // 向引擎取当前时间的帧，有新帧时才请求重绘
+    void fetchFrame();
+
+    // 从 m_currentTime 开始（重新）启动播放时钟：优先用音频时钟，无音频设备时用系统时钟
+    void startClock();
+    int clockTime() const;
+
+    // 引擎时间轴就绪后同步给预览音频
+    void onProjectReady();
+
     QJsonObject m_config;
     bool m_isPlaying;
     int m_currentTime; // 当前播放时间 (ms)
 
+    // m_frame 为已取到、待上传的帧，交给纹理后即清空；m_frameKey 记录最近取到的帧，用来判断是否有新帧
+    QImage m_frame;
+    qint64 m_frameKey = 0;
+    bool m_frameDirty = false;
+
     StoryEngine *m_engine; // 持有引擎实例
-    QTimer *m_renderTimer; // 驱动动画的定时器
+    PreviewAudio *m_audio; // 预览音频，同时作为主时钟
+    QTimer *m_renderTimer; // 驱动取帧的定时器（只负责采样时钟，不再决定播放速度）
+
+    bool m_audioClock = false;  // 当前是否由音频驱动时钟
+    QElapsedTimer m_wallClock;  // 无音频时的后备时钟
+    int m_clockBase = 0;        // 时钟启动时的播放位置 (ms)
+
+    int m_frameTime = -1;     // m_frame 的时间戳 (ms)
+    int m_presentedTime = -1; // 已交给纹理、正在显示的帧的时间戳，在 updatePaintNode（GUI 线程阻塞期间）写入
+
+    // A/V 偏差统计（音频时钟 - 显示帧时间戳），每次取帧定时器触发时采样，暂停时与跳帧 / 重复帧一起输出
+    static constexpr int kLipSyncToleranceMs = 45;
+    int m_avDrift = 0;
+    qint64 m_driftSum = 0;
+    int m_driftMax = 0;
+    int m_driftSamples = 0;
+    int m_driftOutOfSync = 0; // 偏差超出 ±kLipSyncToleranceMs 的采样数
 };
 
 #endif
@@ -1,9 +1,6 @@
 #include "videogenerator.h"
 #include "VideoCreatorAPI.h"
 
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
 #include <QVariantMap>
 #include <QDebug>
 #include <QFileInfo>
@@ -53,10 +50,10 @@ void VideoGenerator::generateVideo(const QVariantList &shots,
         dir.mkpath(".");
     }
 
-    // 构建 JSON 配置
-    QString jsonConfig = buildJsonConfig(shots, outputPath, width, height, fps);
+    // 构建项目配置
+    VideoCreator::ProjectConfig config = buildProjectConfig(shots, outputPath, width, height, fps);
     qDebug() << "VideoGenerator: Output path:" << outputPath;
-    qDebug() << "VideoGenerator: JSON config:" << jsonConfig;
+    qDebug() << "VideoGenerator: Scenes:" << config.scenes.size();
 
     // 设置状态
     m_isGenerating = true;
@@ -74,12 +71,15 @@ void VideoGenerator::generateVideo(const QVariantList &shots,
     // 连接信号
     connect(m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
     connect(m_worker, &VideoGeneratorWorker::progress, this, &VideoGenerator::onWorkerProgress);
+    connect(m_worker, &VideoGeneratorWorker::previewAvailable, this, &VideoGenerator::onWorkerPreviewAvailable);
     connect(m_worker, &VideoGeneratorWorker::finished, this, &VideoGenerator::onWorkerFinished);
 
     // 启动线程并开始渲染
     m_workerThread->start();
-    QMetaObject::invokeMethod(m_worker, "doRender", Qt::QueuedConnection,
-                              Q_ARG(QString, jsonConfig));
+    VideoGeneratorWorker *worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker, config]() {
+        worker->doRender(config);
+    }, Qt::QueuedConnection);
 }
 
 void VideoGenerator::cancel()
@@ -95,6 +95,13 @@ void VideoGenerator::onWorkerProgress(int percent)
     emit progressChanged();
 }
 
+void VideoGenerator::onWorkerPreviewAvailable()
+{
+    if (m_isGenerating) {
+        emit previewAvailable(m_outputPath);
+    }
+}
+
 void VideoGenerator::onWorkerFinished(bool success, const QString &error)
 {
     m_isGenerating = false;
@@ -119,136 +126,104 @@ void VideoGenerator::onWorkerFinished(bool success, const QString &error)
     emit finished(success, success ? m_outputPath : QString());
 }
 
-QString VideoGenerator::buildJsonConfig(const QVariantList &shots,
-                                        const QString &outputPath,
-                                        int width, int height, int fps)
+VideoCreator::ProjectConfig VideoGenerator::buildProjectConfig(const QVariantList &shots,
+                                                              const QString &outputPath,
+                                                              int width, int height, int fps)
 {
-    QJsonObject root;
+    using namespace VideoCreator;
+
+    ProjectConfig config;
 
     // 项目配置
-    QJsonObject project;
-    project["name"] = "StoryFlow Video";
-    project["output_path"] = outputPath;
-    project["width"] = width;
-    project["height"] = height;
-    project["fps"] = fps;
-    project["background_color"] = "#000000";
-    root["project"] = project;
+    config.project.name = "StoryFlow Video";
+    config.project.output_path = outputPath.toUtf8().toStdString();
+    config.project.width = width;
+    config.project.height = height;
+    config.project.fps = fps;
+    config.project.background_color = "#000000";
+    // fMP4：预览页可在后续场景仍在编码时开始播放
+    config.project.output_format = "fragmented_mp4";
 
     // 场景列表
-    QJsonArray scenes;
+    config.scenes.reserve(shots.size() * 2);
     int sceneId = 1;
 
     for (int i = 0; i < shots.size(); ++i) {
         QVariantMap shot = shots[i].toMap();
 
         // 图片场景
-        QJsonObject scene;
-        scene["id"] = sceneId;
-        scene["type"] = "IMAGE_SCENE";
-        scene["duration"] = shot.value("duration", 3.0).toDouble();
-
-        // 资源配置
-        QJsonObject resources;
-
-        // 图片
-        QJsonObject image;
-        image["path"] = shot.value("imagePath").toString();
-        image["x"] = 0;
-        image["y"] = 0;
-        image["scale"] = 1.0;
-        image["rotation"] = 0.0;
-        resources["image"] = image;
+        SceneConfig scene;
+        scene.id = sceneId;
+        scene.type = SceneType::IMAGE_SCENE;
+        scene.duration = shot.value("duration", 3.0).toDouble();
+
+        // 图片（位置/缩放/旋转使用默认值）
+        scene.resources.image.path = shot.value("imagePath").toString().toUtf8().toStdString();
 
         // 音频
         QString audioPath = shot.value("audioPath").toString();
         if (!audioPath.isEmpty()) {
-            QJsonObject audio;
-            audio["path"] = audioPath;
-            audio["volume"] = shot.value("volume", 1.0).toDouble();
-            audio["start_offset"] = 0.0;
-            resources["audio"] = audio;
+            scene.resources.audio.path = audioPath.toUtf8().toStdString();
+            scene.resources.audio.volume = shot.value("volume", 1.0).toDouble();
+            scene.resources.audio.start_offset = 0.0;
         }
 
-        scene["resources"] = resources;
-
         // 特效配置（可选的 Ken Burns 效果）
-        QJsonObject effects;
-        QJsonObject kenBurns;
-        kenBurns["enabled"] = shot.value("kenBurnsEnabled", false).toBool();
-        if (kenBurns["enabled"].toBool()) {
-            kenBurns["preset"] = shot.value("kenBurnsPreset", "zoom_in").toString();
-            kenBurns["start_scale"] = shot.value("kenBurnsStartScale", 1.0).toDouble();
-            kenBurns["end_scale"] = shot.value("kenBurnsEndScale", 1.2).toDouble();
+        KenBurnsEffect &kenBurns = scene.effects.ken_burns;
+        kenBurns.enabled = shot.value("kenBurnsEnabled", false).toBool();
+        if (kenBurns.enabled) {
+            kenBurns.preset = shot.value("kenBurnsPreset", "zoom_in").toString().toStdString();
+            kenBurns.start_scale = shot.value("kenBurnsStartScale", 1.0).toDouble();
+            kenBurns.end_scale = shot.value("kenBurnsEndScale", 1.2).toDouble();
         }
-        effects["ken_burns"] = kenBurns;
 
         // 字幕配置
         QString subtitleText = shot.value("subtitle", "").toString();
         if (!subtitleText.isEmpty()) {
-            QJsonObject subtitle;
-            subtitle["text"] = subtitleText;
-            subtitle["font_size"] = shot.value("subtitleFontSize", 48).toInt();
-            subtitle["font_color"] = shot.value("subtitleFontColor", "white").toString();
-            subtitle["bg_color"] = shot.value("subtitleBgColor", "black@0.5").toString();
-            subtitle["margin_bottom"] = shot.value("subtitleMarginBottom", 60).toInt();
-            effects["subtitle"] = subtitle;
+            SubtitleConfig &subtitle = scene.effects.subtitle;
+            subtitle.text = subtitleText.toUtf8().toStdString();
+            subtitle.font_size = shot.value("subtitleFontSize", 48).toInt();
+            subtitle.font_color = shot.value("subtitleFontColor", "white").toString().toUtf8().toStdString();
+            subtitle.bg_color = shot.value("subtitleBgColor", "black@0.5").toString().toUtf8().toStdString();
+            subtitle.margin_bottom = shot.value("subtitleMarginBottom", 60).toInt();
         }
 
-        scene["effects"] = effects;
-
-        scenes.append(scene);
+        config.scenes.push_back(std::move(scene));
         int currentSceneId = sceneId;
         sceneId++;
 
         // 添加转场（如果不是最后一个镜头）
         if (i < shots.size() - 1) {
-            QString transitionType = shot.value("transitionType", "crossfade").toString().toUpper();
+            QString transitionType = shot.value("transitionType", "crossfade").toString();
             double transitionDuration = shot.value("transitionDuration", 0.5).toDouble();
 
             if (transitionDuration > 0) {
-                QJsonObject transition;
-                transition["id"] = sceneId;
-                transition["type"] = "TRANSITION";
-                transition["duration"] = transitionDuration;
-                transition["transition_type"] = transitionType;
-                transition["from_scene"] = currentSceneId;
-                transition["to_scene"] = sceneId + 1;  // 下一个场景的ID
-
-                scenes.append(transition);
+                SceneConfig transition;
+                transition.id = sceneId;
+                transition.type = SceneType::TRANSITION;
+                transition.duration = transitionDuration;
+                transition.transition_type = transitionTypeFromString(transitionType.toStdString());
+                transition.from_scene = currentSceneId;
+                transition.to_scene = sceneId + 1;  // 下一个场景的ID
+
+                config.scenes.push_back(std::move(transition));
                 sceneId++;
             }
         }
     }
 
-    root["scenes"] = scenes;
-
-    // 全局效果配置
-    QJsonObject globalEffects;
-
-    QJsonObject audioNorm;
-    audioNorm["enabled"] = false;
-    audioNorm["target_level"] = -16.0;
-    globalEffects["audio_normalization"] = audioNorm;
-
-    QJsonObject videoEnc;
-    videoEnc["codec"] = "libx264";
-    videoEnc["bitrate"] = "5000k";
-    videoEnc["preset"] = "medium";
-    videoEnc["crf"] = 23;
-    globalEffects["video_encoding"] = videoEnc;
-
-    QJsonObject audioEnc;
-    audioEnc["codec"] = "aac";
-    audioEnc["bitrate"] = "192k";
-    audioEnc["channels"] = 2;
-    globalEffects["audio_encoding"] = audioEnc;
-
-    root["global_effects"] = globalEffects;
-
-    // 转换为 JSON 字符串
-    QJsonDocument doc(root);
-    return QString::fromUtf8(doc.toJson(QJsonDocument::Compact));
+    // 全局效果配置：音频标准化关闭，libx264 5000k medium crf 23，aac 192k 双声道
+    config.global_effects.audio_normalization.enabled = false;
+    config.global_effects.audio_normalization.target_level = -16.0;
+    config.global_effects.video_encoding.codec = "libx264";
+    config.global_effects.video_encoding.bitrate = "5000k";
+    config.global_effects.video_encoding.preset = "medium";
+    config.global_effects.video_encoding.crf = 23;
+    config.global_effects.audio_encoding.codec = "aac";
+    config.global_effects.audio_encoding.bitrate = "192k";
+    config.global_effects.audio_encoding.channels = 2;
+
+    return config;
 }
 
 // ============== VideoGeneratorWorker ==============
@@ -258,7 +233,7 @@ VideoGeneratorWorker::VideoGeneratorWorker(QObject *parent)
 {
 }
 
-void VideoGeneratorWorker::doRender(const QString &jsonConfig)
+void VideoGeneratorWorker::doRender(const VideoCreator::ProjectConfig &config)
 {
     m_cancelled = false;
 
@@ -266,7 +241,18 @@ void VideoGeneratorWorker::doRender(const QString &jsonConfig)
 
     // 调用 VideoCreator API
     std::string error;
-    bool success = VideoCreator::RenderFromJsonString(jsonConfig.toStdString(), &error);
+    VideoCreator::RenderMetrics metrics;
+    const bool progressive = config.project.output_format == "fragmented_mp4";
+    bool previewEmitted = false;
+    bool success = VideoCreator::RenderFromConfig(config, &error, [this, progressive, &previewEmitted](int percent, const VideoCreator::RenderMetrics &current) {
+        emit progress(percent);
+        // 第一个分片已写入文件（写后台时 I/O 线程已写过它的末尾），文件可以边写边播
+        if (progressive && !previewEmitted && current.playableBytes > 0) {
+            previewEmitted = true;
+            emit previewAvailable();
+        }
+    }, &metrics);
+    qDebug() << "VideoGeneratorWorker: Render metrics:" << metrics.summary().c_str();
 
     if (m_cancelled) {
         emit finished(false, "Cancelled by user");
@@ -5,14 +5,15 @@
 #include <QVariantList>
 #include <QString>
 #include <QThread>
+#include "ProjectConfig.h"
 
 class VideoGeneratorWorker;
 
 /**
  * VideoGenerator - 视频生成桥接类
  *
- * 用于将 StoryFlow 的分镜数据转换为 VideoCreator 需要的 JSON 配置，
- * 并调用 VideoCreator::RenderFromJsonString() 生成视频。
+ * 用于将 StoryFlow 的分镜数据直接转换为 VideoCreator::ProjectConfig，
+ * 并调用 VideoCreator::RenderFromConfig() 生成视频（不经过 JSON 中转）。
  *
  * QML 调用示例：
  *   videoGenerator.generateVideo(shots, "C:/output/video.mp4")
@@ -64,14 +65,18 @@ signals:
     // 生成完成信号
     void finished(bool success, const QString &outputPath);
 
+    // 分片输出已有可播放的内容（生成仍在进行），QML 可提前开始预览
+    void previewAvailable(const QString &outputPath);
+
 private slots:
     void onWorkerProgress(int percent);
+    void onWorkerPreviewAvailable();
     void onWorkerFinished(bool success, const QString &error);
 
 private:
-    QString buildJsonConfig(const QVariantList &shots,
-                           const QString &outputPath,
-                           int width, int height, int fps);
+    VideoCreator::ProjectConfig buildProjectConfig(const QVariantList &shots,
+                                                   const QString &outputPath,
+                                                   int width, int height, int fps);
 
     bool m_isGenerating = false;
     int m_progress = 0;
@@ -92,11 +97,12 @@ public:
     explicit VideoGeneratorWorker(QObject *parent = nullptr);
 
 public slots:
-    void doRender(const QString &jsonConfig);
+    void doRender(const VideoCreator::ProjectConfig &config);
     void cancel();
 
 signals:
     void progress(int percent);
+    void previewAvailable();
     void finished(bool success, const QString &error);
 
 private:
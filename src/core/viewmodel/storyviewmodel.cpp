@@ -1,5 +1,6 @@
 #include "StoryViewModel.h"
 #include "FileManager/FileManager.h"
+#include "decoder/MediaSource.h"
 #include <QDebug>
 #include <QNetworkReply>
 #include <QNetworkAccessManager>
@@ -245,8 +246,11 @@ void StoryViewModel::downloadAndSaveImage(const QString &shotId, const QString &
             QString basePath = m_savePath;
             if (basePath.startsWith("file:///")) basePath = QUrl(basePath).toLocalFile();
             m_fileManager->setBaseAppPath(basePath);
-            QUrl localUrl = m_fileManager->saveShotImage(m_currentProjectId, shotId, reply->readAll());
+            const QByteArray bytes = reply->readAll();
+            QUrl localUrl = m_fileManager->saveShotImage(m_currentProjectId, shotId, bytes);
             if (localUrl.isValid()) {
+                // 登记下载的数据，渲染时直接从内存解码，不再重新读取刚写入的文件
+                VideoCreator::MediaSourceRegistry::instance().add(localUrl.toLocalFile().toUtf8().toStdString(), VideoCreator::MediaBuffer::fromBytes(bytes));
                 QVariantList sb = m_pendingProjectData["storyboards"].toList();
                 if (index < sb.size()) { QVariantMap s = sb[index].toMap(); s["localImagePath"] = localUrl.toString(); s["status"] = "generated"; sb[index] = s; m_pendingProjectData["storyboards"] = sb; }
             }
@@ -266,8 +270,11 @@ void StoryViewModel::downloadAndSaveAudio(const QString &shotId, const QString &
             QString basePath = m_savePath;
             if (basePath.startsWith("file:///")) basePath = QUrl(basePath).toLocalFile();
             m_fileManager->setBaseAppPath(basePath);
-            QUrl localUrl = m_fileManager->saveShotAudio(m_currentProjectId, shotId, reply->readAll());
+            const QByteArray bytes = reply->readAll();
+            QUrl localUrl = m_fileManager->saveShotAudio(m_currentProjectId, shotId, bytes);
             if (localUrl.isValid()) {
+                // 同上，音频也从内存解码
+                VideoCreator::MediaSourceRegistry::instance().add(localUrl.toLocalFile().toUtf8().toStdString(), VideoCreator::MediaBuffer::fromBytes(bytes));
                 QVariantList sb = m_pendingProjectData["storyboards"].toList();
                 if (index < sb.size()) { QVariantMap s = sb[index].toMap(); s["audioPath"] = localUrl.toString(); sb[index] = s; m_pendingProjectData["storyboards"] = sb; }
             }
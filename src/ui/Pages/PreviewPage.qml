@@ -6,7 +6,7 @@ import QtMultimedia
 /**
  * 视频预览页面
  * 1. 进入页面时自动调用 VideoGenerator 生成视频
- * 2. 生成完成后使用 MediaPlayer 播放视频
+ * 2. 第一个 fMP4 分片写出后即开始边生成边播放，生成完成后重新加载完整文件
  */
 Rectangle {
     id: previewPage
@@ -17,6 +17,7 @@ Rectangle {
     property var currentProjectData: null   // 当前项目数据
     property string videoOutputPath: ""     // 生成的视频路径
     property bool videoReady: false         // 视频是否准备好
+    property int resumePosition: -1         // 重新加载后要恢复的播放位置，媒体加载完成时生效
 
     // ==================== 信号定义 ====================
     signal navigateTo(string page)
@@ -104,16 +105,28 @@ Rectangle {
     Connections {
         target: videoGenerator
 
+        // 文件仍在写入：先播放已完成的分片
+        function onPreviewAvailable(outputPath) {
+            console.log("Video preview available:", outputPath)
+            previewPage.videoOutputPath = outputPath
+            previewPage.videoReady = true
+            previewPage.resumePosition = -1
+            videoPlayer.source = "file:///" + outputPath.replace(/\\/g, "/")
+            videoPlayer.play()
+        }
+
         function onFinished(success, outputPath) {
             console.log("Video generation finished:", success, "outputPath:", outputPath)
             if (success && outputPath) {
+                // 边生成边播放时保留当前播放位置
+                previewPage.resumePosition = previewPage.videoReady ? videoPlayer.position : 0
                 previewPage.videoOutputPath = outputPath
                 previewPage.videoReady = true
-                // 设置视频源并播放
+                // 重新加载以获得完整时长，加载完成后恢复位置并播放（onMediaStatusChanged）
                 var videoSource = "file:///" + outputPath.replace(/\\/g, "/")
                 console.log("Video source:", videoSource)
+                videoPlayer.source = ""
                 videoPlayer.source = videoSource
-                videoPlayer.play()
             } else {
                 console.error("Video generation failed:", videoGenerator.errorMessage)
             }
@@ -194,9 +207,14 @@ Rectangle {
                     console.log("Playback state:", playbackState)
                 }
 
-                // 播放完毕后循环
+                // 播放完毕后循环；仍在生成时追上了写入进度，等待 onFinished 重新加载
                 onMediaStatusChanged: {
-                    if (mediaStatus === MediaPlayer.EndOfMedia) {
+                    if (mediaStatus === MediaPlayer.LoadedMedia && previewPage.resumePosition >= 0) {
+                        // 加载完成前 setPosition 会被忽略
+                        videoPlayer.setPosition(previewPage.resumePosition)
+                        previewPage.resumePosition = -1
+                        videoPlayer.play()
+                    } else if (mediaStatus === MediaPlayer.EndOfMedia && !videoGenerator.isGenerating) {
                         videoPlayer.setPosition(0)
                         videoPlayer.play()
                     }
@@ -478,7 +496,7 @@ Rectangle {
                 text: "导出视频"
                 Layout.fillWidth: true
                 Layout.preferredHeight: 52
-                enabled: previewPage.videoReady
+                enabled: previewPage.videoReady && !videoGenerator.isGenerating
 
                 background: Rectangle {
                     radius: 12
@@ -1,69 +1,157 @@
 #include "VideoCreatorAPI.h"
 
 #include <mutex>
+#include <set>
+#include <QFile>
 #include <QString>
 
 #include "model/ConfigLoader.h"
 #include "engine/RenderEngine.h"
+#include "trace/TraceRecorder.h"
 #include "ffmpeg_utils/FFmpegHeaders.h"
 
 namespace VideoCreator
 {
-    namespace
+    // 渲染期间把 RenderControl 绑定到引擎，并补上渲染开始前的取消 / 暂停
+    class RenderControlScope
     {
-        bool ensureFFmpegInitialized(std::string *error)
+    public:
+        RenderControlScope(RenderControl *control, RenderEngine &engine)
+            : m_control(control)
         {
-            static std::once_flag initFlag;
-            static int initResult = 0;
-            static std::string initError;
-
-            std::call_once(initFlag, [&]() {
-                initResult = avformat_network_init();
-                if (initResult < 0)
-                {
-                    char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
-                    av_strerror(initResult, errbuf, sizeof(errbuf));
-                    initError = std::string("FFmpeg network init failed: ") + errbuf;
-                }
-            });
+            if (!m_control)
+            {
+                return;
+            }
+            engine.setThreadBudget(m_control->m_threadBudget);
+            std::lock_guard<std::mutex> lock(m_control->m_mutex);
+            m_control->m_engine = &engine;
+            if (m_control->m_cancelled)
+            {
+                engine.requestCancel();
+            }
+            if (m_control->m_paused)
+            {
+                engine.setPaused(true);
+            }
+        }
 
-            if (initResult < 0)
+        ~RenderControlScope()
+        {
+            if (m_control)
             {
-                if (error)
-                {
-                    *error = initError;
-                }
-                return false;
+                std::lock_guard<std::mutex> lock(m_control->m_mutex);
+                m_control->m_engine = nullptr;
             }
-            return true;
         }
 
-        bool renderWithConfig(const ProjectConfig &config, std::string *error)
+        RenderControlScope(const RenderControlScope &) = delete;
+        RenderControlScope &operator=(const RenderControlScope &) = delete;
+
+    private:
+        RenderControl *m_control;
+    };
+
+    namespace
+    {
+        bool renderWithConfig(const ProjectConfig &config, std::string *error, const RenderProgressCallback &progress,
+                              RenderMetrics *report, RenderControl *control)
         {
-            RenderEngine engine;
-            if (!engine.initialize(config))
+            bool ok = false;
+            std::set<std::string> createdOutputs;
             {
-                if (error)
+                RenderEngine engine;
+                if (progress)
                 {
-                    *error = engine.errorString();
+                    engine.setProgressCallback([&engine, &progress](int percent) {
+                        progress(percent, engine.metrics());
+                    });
                 }
-                return false;
+                RenderControlScope scope(control, engine);
+                if (!engine.isCancelled())
+                {
+                    ok = engine.initialize(config) && engine.render();
+                }
+                if (report)
+                {
+                    *report = engine.metrics();
+                }
+                if (!ok && error)
+                {
+                    *error = engine.isCancelled() ? std::string("渲染已取消") : engine.errorString();
+                }
+                createdOutputs = engine.createdOutputs();
             }
-            if (!engine.render())
+
+            // 引擎析构后输出已关闭，再删除本次渲染创建的不完整文件；输出尚未打开就失败时不动已有文件
+            if (!ok && control && control->removeIncompleteOutput())
             {
-                if (error)
+                for (const std::string &path : createdOutputs)
                 {
-                    *error = engine.errorString();
+                    QFile::remove(QString::fromStdString(path));
                 }
-                return false;
             }
-            return true;
+            return ok;
         }
     } // namespace
 
-    bool RenderFromJson(const std::string &config_path, std::string *error)
+    void RenderControl::requestCancel()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cancelled = true;
+        if (m_engine)
+        {
+            m_engine->requestCancel();
+        }
+    }
+
+    bool RenderControl::isCancelled() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_cancelled;
+    }
+
+    void RenderControl::setPaused(bool paused)
     {
-        if (!ensureFFmpegInitialized(error))
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_paused = paused;
+        if (m_engine)
+        {
+            m_engine->setPaused(paused);
+        }
+    }
+
+    bool InitializeFFmpeg(std::string *error)
+    {
+        static std::once_flag initFlag;
+        static int initResult = 0;
+        static std::string initError;
+
+        std::call_once(initFlag, [&]() {
+            initResult = avformat_network_init();
+            if (initResult < 0)
+            {
+                char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
+                av_strerror(initResult, errbuf, sizeof(errbuf));
+                initError = std::string("FFmpeg network init failed: ") + errbuf;
+            }
+        });
+
+        if (initResult < 0)
+        {
+            if (error)
+            {
+                *error = initError;
+            }
+            return false;
+        }
+        return true;
+    }
+
+    bool RenderFromJson(const std::string &config_path, std::string *error, const RenderProgressCallback &progress,
+                        RenderMetrics *report, RenderControl *control)
+    {
+        if (!InitializeFFmpeg(error))
         {
             return false;
         }
@@ -79,12 +167,13 @@ namespace VideoCreator
             return false;
         }
 
-        return renderWithConfig(config, error);
+        return renderWithConfig(config, error, progress, report, control);
     }
 
-    bool RenderFromJsonString(const std::string &json_string, std::string *error)
+    bool RenderFromJsonString(const std::string &json_string, std::string *error, const RenderProgressCallback &progress,
+                              RenderMetrics *report, RenderControl *control)
     {
-        if (!ensureFFmpegInitialized(error))
+        if (!InitializeFFmpeg(error))
         {
             return false;
         }
@@ -100,6 +189,31 @@ namespace VideoCreator
             return false;
         }
 
-        return renderWithConfig(config, error);
+        return renderWithConfig(config, error, progress, report, control);
+    }
+
+    bool RenderFromConfig(const ProjectConfig &config, std::string *error, const RenderProgressCallback &progress,
+                          RenderMetrics *report, RenderControl *control)
+    {
+        if (!InitializeFFmpeg(error))
+        {
+            return false;
+        }
+
+        ProjectConfig resolved = config;
+        ConfigLoader loader;
+        loader.deriveMissingDurations(resolved);
+
+        return renderWithConfig(resolved, error, progress, report, control);
+    }
+
+    void StartTrace()
+    {
+        TraceRecorder::instance().start();
+    }
+
+    bool StopTrace(const std::string &output_path, std::string *error)
+    {
+        return TraceRecorder::instance().stop(output_path, error);
     }
 } // namespace VideoCreator
@@ -1,15 +1,79 @@
 #ifndef VIDEO_CREATOR_API_H
 #define VIDEO_CREATOR_API_H
 
+#include <functional>
+#include <mutex>
 #include <string>
+#include "model/ProjectConfig.h"
+#include "engine/RenderMetrics.h"
 
 namespace VideoCreator
 {
+    // 初始化 FFmpeg 全局状态（线程安全，只执行一次）；各 Render* 函数会自动调用
+    bool InitializeFFmpeg(std::string *error = nullptr);
+
+    // 渲染进度回调（在渲染线程中调用）：percent 为 0-100，metrics 为截至当前的运行指标，仅在回调期间有效
+    using RenderProgressCallback = std::function<void(int percent, const RenderMetrics &metrics)>;
+
+    class RenderEngine;
+
+    /**
+     * RenderControl - 从其他线程取消 / 暂停 Render* 中进行的渲染
+     *
+     * 渲染开始前调用的 requestCancel / setPaused 在渲染开始时生效；同一对象同一时间只用于一次渲染。
+     */
+    class RenderControl
+    {
+    public:
+        // 在下一帧中止渲染，Render* 返回 false
+        void requestCancel();
+        bool isCancelled() const;
+
+        // 在帧边界挂起 / 继续
+        void setPaused(bool paused);
+
+        // 编码线程预算，0 为自动（min(8, 硬件线程数)）；须在渲染开始前设置
+        void setThreadBudget(int threads) { m_threadBudget = threads; }
+        int threadBudget() const { return m_threadBudget; }
+
+        // 失败或取消时删除本次渲染已创建的不完整输出（hls / dash 连同其写出的子播放列表与分片）；输出打开前失败时不删除任何文件
+        void setRemoveIncompleteOutput(bool remove) { m_removeIncompleteOutput = remove; }
+        bool removeIncompleteOutput() const { return m_removeIncompleteOutput; }
+
+    private:
+        friend class RenderControlScope;
+
+        mutable std::mutex m_mutex;
+        RenderEngine *m_engine = nullptr; // 仅在渲染期间有效
+        bool m_cancelled = false;
+        bool m_paused = false;
+        int m_threadBudget = 0;
+        bool m_removeIncompleteOutput = false;
+    };
+
+    // 以下 Render* 函数的 progress（可选）在进度变化时回调，report（可选）在渲染结束后写入最终指标（失败时为已完成部分），
+    // control（可选）用于取消、暂停与线程预算
+
     // 从 JSON 文件路径渲染视频，返回成功/失败，错误信息写入 error（可选）
-    bool RenderFromJson(const std::string &config_path, std::string *error = nullptr);
+    bool RenderFromJson(const std::string &config_path, std::string *error = nullptr,
+                        const RenderProgressCallback &progress = nullptr, RenderMetrics *report = nullptr,
+                        RenderControl *control = nullptr);
 
     // 从 JSON 字符串渲染视频，返回成功/失败，错误信息写入 error（可选）
-    bool RenderFromJsonString(const std::string &json_string, std::string *error = nullptr);
+    bool RenderFromJsonString(const std::string &json_string, std::string *error = nullptr,
+                              const RenderProgressCallback &progress = nullptr, RenderMetrics *report = nullptr,
+                              RenderControl *control = nullptr);
+
+    // 直接从内存中的配置渲染，省去 JSON 序列化/解析；时长 <= 0 的场景按素材推导
+    bool RenderFromConfig(const ProjectConfig &config, std::string *error = nullptr,
+                          const RenderProgressCallback &progress = nullptr, RenderMetrics *report = nullptr,
+                          RenderControl *control = nullptr);
+
+    // 开始记录渲染热路径的追踪区间（进程内所有渲染共用一份记录）
+    void StartTrace();
+
+    // 停止记录并导出 Chrome trace JSON（chrome://tracing 或 Perfetto 可直接打开）
+    bool StopTrace(const std::string &output_path, std::string *error = nullptr);
 }
 
 #endif // VIDEO_CREATOR_API_H
@@ -0,0 +1,181 @@
+// 配置解析基准：比较 QJsonDocument DOM 解析、流式解析与 JSON 往返（旧 VideoGenerator 路径）
+// 用法: config_parse_bench [场景数 ...]，默认 10 1000 10000
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <vector>
+#include "model/ConfigLoader.h"
+
+using namespace VideoCreator;
+
+namespace
+{
+    // 生成带音频、字幕、Ken Burns 与转场的合成配置；显式给出时长，避免计时混入素材探测
+    QJsonObject makeSyntheticConfig(int sceneCount)
+    {
+        QJsonObject project;
+        project["name"] = "bench";
+        project["output_path"] = "bench.mp4";
+        project["width"] = 1920;
+        project["height"] = 1080;
+        project["fps"] = 30;
+
+        QJsonArray scenes;
+        for (int i = 0; i < sceneCount; ++i)
+        {
+            QJsonObject scene;
+            if (i % 2 == 1)
+            {
+                scene["type"] = "TRANSITION";
+                scene["duration"] = 0.5;
+                scene["transition_type"] = i % 3 == 0 ? "WIPE" : "CROSSFADE";
+                scene["from_scene"] = i;
+                scene["to_scene"] = i + 2;
+                scenes.append(scene);
+                continue;
+            }
+
+            scene["type"] = "IMAGE_SCENE";
+            scene["duration"] = 3.0;
+
+            QJsonObject image;
+            image["path"] = QString("assets/shot_%1.png").arg(i);
+            QJsonObject audio;
+            audio["path"] = QString("assets/voice_%1.mp3").arg(i);
+            audio["volume"] = 0.8;
+            QJsonObject resources;
+            resources["image"] = image;
+            resources["audio"] = audio;
+            scene["resources"] = resources;
+
+            QJsonObject kenBurns;
+            kenBurns["enabled"] = true;
+            kenBurns["preset"] = "zoom_in";
+            kenBurns["start_scale"] = 1.0;
+            kenBurns["end_scale"] = 1.2;
+            QJsonObject subtitle;
+            subtitle["text"] = QString("第 %1 个镜头的字幕，\"引号\" 与换行\\n").arg(i);
+            QJsonObject effects;
+            effects["ken_burns"] = kenBurns;
+            effects["subtitle"] = subtitle;
+            scene["effects"] = effects;
+            scenes.append(scene);
+        }
+
+        QJsonObject root;
+        root["project"] = project;
+        root["scenes"] = scenes;
+        return root;
+    }
+
+    // 重复运行至少 minRuns 次且累计超过 200ms，返回单次耗时中位数（毫秒）
+    double measure(const std::function<bool()> &body, int minRuns = 5)
+    {
+        std::vector<double> samples;
+        QElapsedTimer total;
+        total.start();
+        while (static_cast<int>(samples.size()) < minRuns || total.elapsed() < 200)
+        {
+            QElapsedTimer timer;
+            timer.start();
+            if (!body())
+            {
+                return -1.0;
+            }
+            samples.push_back(timer.nsecsElapsed() / 1e6);
+        }
+        std::sort(samples.begin(), samples.end());
+        return samples[samples.size() / 2];
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    std::vector<int> sizes;
+    for (int i = 1; i < argc; ++i)
+    {
+        const int count = QString::fromLocal8Bit(argv[i]).toInt();
+        if (count > 0)
+        {
+            sizes.push_back(count);
+        }
+    }
+    if (sizes.empty())
+    {
+        sizes = {10, 1000, 10000};
+    }
+
+    QTemporaryDir tempDir;
+    if (!tempDir.isValid())
+    {
+        std::fprintf(stderr, "无法创建临时目录\n");
+        return 1;
+    }
+
+    std::printf("%8s %10s %12s %12s %12s %10s\n", "scenes", "json KB", "dom ms", "stream ms", "roundtrip ms", "speedup");
+    for (int sceneCount : sizes)
+    {
+        const QJsonObject root = makeSyntheticConfig(sceneCount);
+        const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+        const QString path = tempDir.filePath(QString("story_%1.json").arg(sceneCount));
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size())
+        {
+            std::fprintf(stderr, "无法写入 %s\n", qPrintable(path));
+            return 1;
+        }
+        file.close();
+
+        size_t domScenes = 0;
+        size_t streamScenes = 0;
+
+        // 旧的文件路径：readAll + QJsonDocument + 逐字段读取
+        const double domMs = measure([&]() {
+            QFile input(path);
+            if (!input.open(QIODevice::ReadOnly))
+            {
+                return false;
+            }
+            ConfigLoader loader;
+            ProjectConfig config;
+            const bool ok = loader.loadFromString(QString::fromUtf8(input.readAll()), config);
+            domScenes = config.scenes.size();
+            return ok;
+        });
+
+        // 新的文件路径：ConfigStreamParser
+        const double streamMs = measure([&]() {
+            ConfigLoader loader;
+            ProjectConfig config;
+            const bool ok = loader.loadFromFile(path, config);
+            streamScenes = config.scenes.size();
+            return ok;
+        });
+
+        // 旧的 VideoGenerator 路径：构建 JSON → 序列化 → 再解析（RenderFromConfig 直接省掉这一步）
+        const double roundTripMs = measure([&]() {
+            const QByteArray text = QJsonDocument(makeSyntheticConfig(sceneCount)).toJson(QJsonDocument::Compact);
+            ConfigLoader loader;
+            ProjectConfig config;
+            return loader.loadFromString(QString::fromUtf8(text), config);
+        });
+
+        if (domMs < 0 || streamMs < 0 || roundTripMs < 0 || domScenes != streamScenes)
+        {
+            std::fprintf(stderr, "%d 个场景解析失败或结果不一致\n", sceneCount);
+            return 1;
+        }
+        std::printf("%8d %10.1f %12.3f %12.3f %12.3f %9.2fx\n", sceneCount, json.size() / 1024.0,
+                    domMs, streamMs, roundTripMs, streamMs > 0 ? domMs / streamMs : 0.0);
+    }
+    return 0;
+}
@@ -0,0 +1,1438 @@
+// 渲染基准：在本地生成合成故事（testsrc 图片/视频、正弦波旁白、全部转场类型、Ken Burns 预设与字幕），
+// 分别测量解码器、EffectProcessor、混音、编码器以及 RenderEngine 端到端的 fps、ms/帧与内存分配次数。
+// 编码器另按 fastest / concurrent 线程档位分别测量单任务与多任务并行时的总吞吐，
+// 并在同一目标码率下比较 crf、crf+VBV、abr 与 two_pass 码控的耗时与实际码率。
+// 转场 kernel 另单独测量 SIMD 与标量版本（复用输出帧，不含分配）。
+// 解码调度另比较逐场景建线程与共享工作窃取执行器的耗时、线程创建数与任务排队等待。
+// 图片解码另比较从文件与从内存（自定义 AVIOContext）打开；端到端另比较写后台输出与渲染线程同步写文件。
+// 共享解复用另验证视频解码器停滞、只读音频时各包队列都不超过上限，且视频之后仍能完整读出。
+// 分配次数只统计 C++ operator new（含 Qt 与标准库容器），FFmpeg 内部的 av_malloc 不在其中。
+// 用法: render_bench [--width W] [--height H] [--fps N] [--images N] [--videos N] [--seconds S] [--frames N]
+//                    [--codec NAME] [--preset NAME] [--bitrate R] [--json PATH] [--baseline PATH] [--tolerance R]
+//                    [--keep DIR] [--trace PATH] [--verbose]
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <thread>
+#include <vector>
+#include "SyntheticStory.h"
+#include "VideoCreatorAPI.h"
+#include "decoder/AudioDecoder.h"
+#include "decoder/ImageDecoder.h"
+#include "decoder/MediaSource.h"
+#include "decoder/SharedDemuxer.h"
+#include "decoder/VideoDecoder.h"
+#include "engine/EncoderSettings.h"
+#include "engine/RenderEngine.h"
+#include "engine/TaskExecutor.h"
+#include "filter/EffectProcessor.h"
+#include "filter/LayerCompositor.h"
+#include "filter/TransitionKernels.h"
+#include "ffmpeg_utils/AvCodecContextWrapper.h"
+#include "ffmpeg_utils/AvPacketWrapper.h"
+
+namespace
+{
+    std::atomic<unsigned long long> g_allocations{0};
+}
+
+// 替换全局 operator new 以统计分配次数
+void *operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *pointer = std::malloc(size ? size : 1))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+using namespace VideoCreator;
+
+namespace
+{
+    struct BenchOptions
+    {
+        SyntheticStoryOptions story;
+        int frames = 120; // 组件基准每项处理的帧数
+        QString jsonPath;
+        QString baselinePath;
+        double tolerance = 0.10; // fps 低于基线的比例超过该值视为回退
+        QString keepDirectory;
+        QString tracePath; // 非空时端到端渲染期间记录 Chrome trace
+        std::string bitrate = "2000k"; // 码控基准的目标码率
+        bool verbose = false;
+    };
+
+    struct BenchResult
+    {
+        std::string name;
+        int frames = 0;
+        double seconds = 0.0;
+        unsigned long long allocations = 0;
+        QJsonObject extra;
+
+        double fps() const { return seconds > 0 ? frames / seconds : 0.0; }
+        double msPerFrame() const { return frames > 0 ? seconds * 1000.0 / frames : 0.0; }
+        double allocationsPerFrame() const { return frames > 0 ? static_cast<double>(allocations) / frames : 0.0; }
+    };
+
+    using BenchBody = std::function<bool(int &frames, std::string &error, QJsonObject &extra)>;
+
+    void quietMessageHandler(QtMsgType type, const QMessageLogContext &, const QString &message)
+    {
+        if (type == QtDebugMsg || type == QtInfoMsg)
+        {
+            return;
+        }
+        std::fprintf(stderr, "%s\n", qPrintable(message));
+    }
+
+    bool runCase(const std::string &name, const BenchBody &body, std::vector<BenchResult> &results)
+    {
+        BenchResult result;
+        result.name = name;
+        std::string error;
+
+        const unsigned long long allocationsBefore = g_allocations.load(std::memory_order_relaxed);
+        QElapsedTimer timer;
+        timer.start();
+        const bool ok = body(result.frames, error, result.extra);
+        result.seconds = timer.nsecsElapsed() / 1e9;
+        result.allocations = g_allocations.load(std::memory_order_relaxed) - allocationsBefore;
+
+        if (!ok)
+        {
+            std::fprintf(stderr, "%s 失败: %s\n", name.c_str(), error.c_str());
+            return false;
+        }
+        std::printf("%-24s %8d %10.2f %10.3f %12.1f\n", name.c_str(), result.frames, result.fps(),
+                    result.msPerFrame(), result.allocationsPerFrame());
+        std::fflush(stdout);
+        results.push_back(result);
+        return true;
+    }
+
+    // 图片解码 + 缩放到项目分辨率（与 RenderEngine::renderScene 相同的调用序列）；
+    // fromMemory 时先把图片登记到 MediaSourceRegistry，解码器经自定义 AVIOContext 读取内存
+    bool benchImageDecode(const SyntheticStory &story, const BenchOptions &options, bool fromMemory, int &frames, std::string &error)
+    {
+        const auto &paths = story.imagePaths();
+        if (paths.empty())
+        {
+            return true;
+        }
+        struct RegistryGuard
+        {
+            const std::vector<std::string> *paths = nullptr;
+            ~RegistryGuard()
+            {
+                if (!paths)
+                {
+                    return;
+                }
+                for (const std::string &path : *paths)
+                {
+                    MediaSourceRegistry::instance().remove(path);
+                }
+            }
+        } registryGuard;
+        if (fromMemory)
+        {
+            registryGuard.paths = &paths;
+            for (const std::string &path : paths)
+            {
+                QFile file(QString::fromStdString(path));
+                if (!file.open(QIODevice::ReadOnly) || !MediaSourceRegistry::instance().add(path, MediaBuffer::fromBytes(file.readAll())))
+                {
+                    error = "无法把图片载入内存: " + path;
+                    return false;
+                }
+            }
+        }
+        const int runs = std::max<int>(static_cast<int>(paths.size()), 10);
+        for (int i = 0; i < runs; ++i)
+        {
+            ImageDecoder decoder;
+            if (!decoder.open(paths[i % paths.size()]))
+            {
+                error = decoder.getErrorString();
+                return false;
+            }
+            auto frame = decoder.decodeAndCache();
+            auto scaled = frame ? decoder.scaleToSize(frame, options.story.width, options.story.height, AV_PIX_FMT_YUV420P) : nullptr;
+            if (!scaled)
+            {
+                error = decoder.getErrorString();
+                return false;
+            }
+            ++frames;
+        }
+        return true;
+    }
+
+    bool benchVideoDecode(const SyntheticStory &story, const BenchOptions &options, int &frames, std::string &error)
+    {
+        for (const auto &path : story.videoPaths())
+        {
+            VideoDecoder decoder;
+            if (!decoder.open(path))
+            {
+                error = decoder.getErrorString();
+                return false;
+            }
+            FFmpegUtils::AvFramePtr frame;
+            int ret = 0;
+            while ((ret = decoder.decodeFrame(frame)) > 0)
+            {
+                auto scaled = decoder.scaleFrame(frame.get(), options.story.width, options.story.height, AV_PIX_FMT_YUV420P);
+                if (!scaled)
+                {
+                    error = decoder.getErrorString();
+                    return false;
+                }
+                ++frames;
+            }
+            if (ret < 0)
+            {
+                error = decoder.getErrorString();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 只计解码（不缩放），衡量 VideoDecoder 线程数与线程模式对吞吐的影响
+    bool benchDecodeThreads(const std::string &path, int threads, int threadType, int &frames, std::string &error, QJsonObject &extra)
+    {
+        VideoDecoder decoder;
+        decoder.setThreading(threads, threadType);
+        if (!decoder.open(path))
+        {
+            error = decoder.getErrorString();
+            return false;
+        }
+        extra["threads"] = decoder.activeThreadCount();
+        extra["active_thread_type"] = decoder.activeThreadType() == FF_THREAD_FRAME   ? "frame"
+                                      : decoder.activeThreadType() == FF_THREAD_SLICE ? "slice"
+                                                                                      : "none";
+        extra["source_width"] = decoder.sourceWidth();
+        extra["source_height"] = decoder.sourceHeight();
+
+        FFmpegUtils::AvFramePtr frame;
+        int ret = 0;
+        while ((ret = decoder.decodeFrame(frame)) > 0)
+        {
+            ++frames;
+        }
+        if (ret < 0)
+        {
+            error = decoder.getErrorString();
+            return false;
+        }
+        return true;
+    }
+
+    // 把视频与音频流复制封装进同一个 MP4（按时间交织），作为共享解复用的素材
+    bool muxVideoWithAudio(const std::string &videoPath, const std::string &audioPath, const std::string &outputPath,
+                           std::string &error)
+    {
+        const std::string inputPaths[2] = {videoPath, audioPath};
+        AVFormatContext *inputs[2] = {nullptr, nullptr};
+        int inputStreams[2] = {-1, -1};
+        AVFormatContext *output = nullptr;
+        auto closeAll = [&]() {
+            for (AVFormatContext *&input : inputs)
+            {
+                avformat_close_input(&input);
+            }
+            if (output)
+            {
+                avio_closep(&output->pb);
+                avformat_free_context(output);
+                output = nullptr;
+            }
+        };
+        auto fail = [&](const std::string &message) {
+            closeAll();
+            error = message;
+            return false;
+        };
+
+        if (avformat_alloc_output_context2(&output, nullptr, "mp4", outputPath.c_str()) < 0)
+        {
+            return fail("无法创建 MP4 封装器");
+        }
+        for (int i = 0; i < 2; ++i)
+        {
+            const AVMediaType type = i == 0 ? AVMEDIA_TYPE_VIDEO : AVMEDIA_TYPE_AUDIO;
+            if (avformat_open_input(&inputs[i], inputPaths[i].c_str(), nullptr, nullptr) < 0 ||
+                avformat_find_stream_info(inputs[i], nullptr) < 0 ||
+                (inputStreams[i] = av_find_best_stream(inputs[i], type, -1, -1, nullptr, 0)) < 0)
+            {
+                return fail("无法读取 " + inputPaths[i]);
+            }
+            AVStream *stream = avformat_new_stream(output, nullptr);
+            if (!stream || avcodec_parameters_copy(stream->codecpar, inputs[i]->streams[inputStreams[i]]->codecpar) < 0)
+            {
+                return fail("无法创建输出流");
+            }
+            stream->codecpar->codec_tag = 0;
+            stream->time_base = inputs[i]->streams[inputStreams[i]]->time_base;
+        }
+        if (avio_open(&output->pb, outputPath.c_str(), AVIO_FLAG_WRITE) < 0 || avformat_write_header(output, nullptr) < 0)
+        {
+            return fail("无法写入 " + outputPath);
+        }
+
+        // 两路依次读完，交给 av_interleaved_write_frame 按 dts 交织
+        auto packet = FFmpegUtils::createAvPacket();
+        for (int i = 0; i < 2; ++i)
+        {
+            while (av_read_frame(inputs[i], packet.get()) >= 0)
+            {
+                if (packet->stream_index != inputStreams[i])
+                {
+                    av_packet_unref(packet.get());
+                    continue;
+                }
+                av_packet_rescale_ts(packet.get(), inputs[i]->streams[inputStreams[i]]->time_base, output->streams[i]->time_base);
+                packet->stream_index = i;
+                packet->pos = -1;
+                if (av_interleaved_write_frame(output, packet.get()) < 0)
+                {
+                    return fail("写入 " + outputPath + " 失败");
+                }
+            }
+        }
+        if (av_write_trailer(output) < 0)
+        {
+            return fail("写入 " + outputPath + " 失败");
+        }
+        closeAll();
+        return true;
+    }
+
+    // 共享解复用：视频解码器停滞，只读音频直到文件结束，再读视频。
+    // 两个队列都不得超过上限，两条流读出的包数须与直接读文件一致（视频在转为自行读包后不丢不重）
+    bool benchSharedDemuxStall(const std::string &path, int &frames, std::string &error, QJsonObject &extra)
+    {
+        SharedDemuxer demuxer;
+        if (!demuxer.open(path))
+        {
+            error = demuxer.getErrorString();
+            return false;
+        }
+        const int video = demuxer.videoStreamIndex();
+        const int audio = demuxer.audioStreamIndex();
+        if (audio < 0)
+        {
+            error = "素材没有音频流";
+            return false;
+        }
+
+        int expectedVideo = 0;
+        int expectedAudio = 0;
+        {
+            AVFormatContext *input = nullptr;
+            if (avformat_open_input(&input, path.c_str(), nullptr, nullptr) < 0)
+            {
+                error = "无法打开 " + path;
+                return false;
+            }
+            auto packet = FFmpegUtils::createAvPacket();
+            while (av_read_frame(input, packet.get()) >= 0)
+            {
+                expectedVideo += packet->stream_index == video ? 1 : 0;
+                expectedAudio += packet->stream_index == audio ? 1 : 0;
+                av_packet_unref(packet.get());
+            }
+            avformat_close_input(&input);
+        }
+
+        demuxer.attach(video);
+        demuxer.attach(audio);
+        demuxer.start();
+        auto packet = FFmpegUtils::createAvPacket();
+        int audioPackets = 0;
+        int videoPackets = 0;
+        int ret = 0;
+        while ((ret = demuxer.readPacket(audio, packet.get())) == 0)
+        {
+            ++audioPackets;
+            av_packet_unref(packet.get());
+        }
+        if (ret == AVERROR_EOF)
+        {
+            while ((ret = demuxer.readPacket(video, packet.get())) == 0)
+            {
+                ++videoPackets;
+                av_packet_unref(packet.get());
+            }
+        }
+        demuxer.stop();
+
+        const size_t videoCapacity = demuxer.queueCapacity(video);
+        const size_t audioCapacity = demuxer.queueCapacity(audio);
+        const size_t videoPeak = demuxer.peakQueuedPackets(video);
+        const size_t audioPeak = demuxer.peakQueuedPackets(audio);
+        extra["video_capacity"] = static_cast<qint64>(videoCapacity);
+        extra["video_peak"] = static_cast<qint64>(videoPeak);
+        extra["audio_capacity"] = static_cast<qint64>(audioCapacity);
+        extra["audio_peak"] = static_cast<qint64>(audioPeak);
+        extra["video_read_own"] = demuxer.isReadingOwnPackets(video);
+        extra["video_packets"] = videoPackets;
+        extra["audio_packets"] = audioPackets;
+        frames = videoPackets + audioPackets;
+
+        if (ret != AVERROR_EOF)
+        {
+            error = "读包失败: " + std::to_string(ret);
+            return false;
+        }
+        if (videoPeak > videoCapacity || audioPeak > audioCapacity)
+        {
+            error = "包队列超过上限: 视频 " + std::to_string(videoPeak) + "/" + std::to_string(videoCapacity) + "，音频 " +
+                    std::to_string(audioPeak) + "/" + std::to_string(audioCapacity);
+            return false;
+        }
+        if (videoPackets != expectedVideo || audioPackets != expectedAudio)
+        {
+            error = "读出的包数不符: 视频 " + std::to_string(videoPackets) + "/" + std::to_string(expectedVideo) + "，音频 " +
+                    std::to_string(audioPackets) + "/" + std::to_string(expectedAudio);
+            return false;
+        }
+        return true;
+    }
+
+    bool benchAudioDecode(const SyntheticStory &story, int &frames, std::string &error)
+    {
+        for (const auto &path : story.tonePaths())
+        {
+            AudioDecoder decoder;
+            if (!decoder.open(path) || !decoder.applyVolumeEffect(0.8, nullptr, decoder.getDuration()))
+            {
+                error = decoder.getErrorString();
+                return false;
+            }
+            FFmpegUtils::AvFramePtr frame;
+            int ret = 0;
+            while ((ret = decoder.decodeFrame(frame)) > 0)
+            {
+                ++frames;
+            }
+            if (ret < 0)
+            {
+                error = decoder.getErrorString();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 解码整条旁白为左右声道采样，供混音基准使用（不计时）
+    bool decodeToneSamples(const std::string &path, std::vector<float> &left, std::vector<float> &right, std::string &error)
+    {
+        AudioDecoder decoder;
+        if (!decoder.open(path))
+        {
+            error = decoder.getErrorString();
+            return false;
+        }
+        FFmpegUtils::AvFramePtr frame;
+        int ret = 0;
+        while ((ret = decoder.decodeFrame(frame)) > 0)
+        {
+            const float *l = reinterpret_cast<const float *>(frame->data[0]);
+            const float *r = reinterpret_cast<const float *>(frame->data[frame->ch_layout.nb_channels > 1 ? 1 : 0]);
+            left.insert(left.end(), l, l + frame->nb_samples);
+            right.insert(right.end(), r, r + frame->nb_samples);
+        }
+        if (ret < 0)
+        {
+            error = decoder.getErrorString();
+            return false;
+        }
+        return true;
+    }
+
+    // 与 RenderEngine 中 mixSceneAudio 相同的累加 + 限幅，再写入编码前的 FIFO；帧数按 1024 采样的音频帧计
+    bool benchAudioMix(const SyntheticStory &story, int &frames, std::string &error)
+    {
+        const auto &tones = story.tonePaths();
+        if (tones.empty())
+        {
+            return true;
+        }
+        std::vector<std::vector<float>> layerLeft(std::min<size_t>(tones.size(), 2));
+        std::vector<std::vector<float>> layerRight(layerLeft.size());
+        for (size_t i = 0; i < layerLeft.size(); ++i)
+        {
+            if (!decodeToneSamples(tones[i], layerLeft[i], layerRight[i], error))
+            {
+                return false;
+            }
+        }
+
+        const int frameSize = 1024;
+        AVAudioFifo *fifo = av_audio_fifo_alloc(AV_SAMPLE_FMT_FLTP, 2, frameSize * 4);
+        auto makeStereoFrame = [frameSize]() {
+            auto frame = FFmpegUtils::createAvFrame();
+            if (!frame)
+            {
+                return frame;
+            }
+            frame->nb_samples = frameSize;
+            frame->format = AV_SAMPLE_FMT_FLTP;
+            frame->sample_rate = 44100;
+            av_channel_layout_default(&frame->ch_layout, 2);
+            if (av_frame_get_buffer(frame.get(), 0) < 0)
+            {
+                frame.reset();
+            }
+            return frame;
+        };
+        auto mixed = makeStereoFrame();
+        auto drained = makeStereoFrame();
+        if (!fifo || !mixed || !drained)
+        {
+            av_audio_fifo_free(fifo);
+            error = "分配混音缓冲失败";
+            return false;
+        }
+
+        std::vector<float> mixLeft;
+        std::vector<float> mixRight;
+        size_t length = 0;
+        for (const auto &layer : layerLeft)
+        {
+            length = std::max(length, layer.size());
+        }
+        // 重复几遍让耗时足够稳定
+        const int passes = 8;
+        for (int pass = 0; pass < passes; ++pass)
+        {
+            for (size_t offset = 0; offset + frameSize <= length; offset += frameSize)
+            {
+                mixLeft.assign(frameSize, 0.0f);
+                mixRight.assign(frameSize, 0.0f);
+                for (size_t layer = 0; layer < layerLeft.size(); ++layer)
+                {
+                    const size_t available = layerLeft[layer].size() > offset ? layerLeft[layer].size() - offset : 0;
+                    const size_t take = std::min<size_t>(available, frameSize);
+                    for (size_t i = 0; i < take; ++i)
+                    {
+                        mixLeft[i] += layerLeft[layer][offset + i];
+                        mixRight[i] += layerRight[layer][offset + i];
+                    }
+                }
+                float *dstLeft = reinterpret_cast<float *>(mixed->data[0]);
+                float *dstRight = reinterpret_cast<float *>(mixed->data[1]);
+                for (int i = 0; i < frameSize; ++i)
+                {
+                    dstLeft[i] = std::clamp(mixLeft[i], -1.0f, 1.0f);
+                    dstRight[i] = std::clamp(mixRight[i], -1.0f, 1.0f);
+                }
+                if (av_audio_fifo_write(fifo, reinterpret_cast<void **>(mixed->data), frameSize) < frameSize ||
+                    av_audio_fifo_read(fifo, reinterpret_cast<void **>(drained->data), frameSize) < frameSize)
+                {
+                    av_audio_fifo_free(fifo);
+                    error = "音频 FIFO 读写失败";
+                    return false;
+                }
+                ++frames;
+            }
+        }
+        av_audio_fifo_free(fifo);
+        return true;
+    }
+
+    bool benchKenBurns(const std::string &preset, const BenchOptions &options, int &frames, std::string &error)
+    {
+        auto source = SyntheticStory::makeTestFrame(options.story.width, options.story.height, AV_PIX_FMT_YUV420P, 1, &error);
+        if (!source)
+        {
+            return false;
+        }
+        KenBurnsEffect effect;
+        effect.enabled = true;
+        effect.preset = preset;
+        effect.start_scale = 1.0;
+        effect.end_scale = 1.2;
+
+        EffectProcessor processor;
+        if (!processor.initialize(options.story.width, options.story.height, AV_PIX_FMT_YUV420P, options.story.fps) ||
+            !processor.startKenBurnsSequence(effect, source.get(), options.frames))
+        {
+            error = processor.getErrorString();
+            return false;
+        }
+        FFmpegUtils::AvFramePtr frame;
+        for (int i = 0; i < options.frames; ++i)
+        {
+            if (!processor.fetchKenBurnsFrame(frame))
+            {
+                error = processor.getErrorString();
+                return false;
+            }
+            ++frames;
+        }
+        return true;
+    }
+
+    bool benchTransition(TransitionType type, const BenchOptions &options, int &frames, std::string &error)
+    {
+        auto from = SyntheticStory::makeTestFrame(options.story.width, options.story.height, AV_PIX_FMT_YUV420P, 2, &error);
+        auto to = from ? SyntheticStory::makeTestFrame(options.story.width, options.story.height, AV_PIX_FMT_YUV420P, 3, &error) : nullptr;
+        if (!from || !to)
+        {
+            return false;
+        }
+
+        EffectProcessor processor;
+        if (!processor.initialize(options.story.width, options.story.height, AV_PIX_FMT_YUV420P, options.story.fps) ||
+            !processor.startTransitionSequence(type, from.get(), to.get(), options.frames))
+        {
+            error = processor.getErrorString();
+            return false;
+        }
+        FFmpegUtils::AvFramePtr frame;
+        for (int i = 0; i < options.frames; ++i)
+        {
+            if (!processor.fetchTransitionFrame(frame))
+            {
+                error = processor.getErrorString();
+                return false;
+            }
+            ++frames;
+        }
+        return true;
+    }
+
+    // 直接调用注册表中的转场 kernel，输出帧复用，只测合成本身
+    bool benchTransitionKernel(TransitionType type, bool simd, const BenchOptions &options, int &frames, std::string &error)
+    {
+        TransitionKernel kernel = TransitionKernelRegistry::instance().find(type, AV_PIX_FMT_YUV420P, simd);
+        if (!kernel)
+        {
+            error = "未注册的转场 kernel: " + transitionTypeToString(type);
+            return false;
+        }
+        auto from = SyntheticStory::makeTestFrame(options.story.width, options.story.height, AV_PIX_FMT_YUV420P, 2, &error);
+        auto to = from ? SyntheticStory::makeTestFrame(options.story.width, options.story.height, AV_PIX_FMT_YUV420P, 3, &error) : nullptr;
+        auto out = to ? FFmpegUtils::createAvFrame(options.story.width, options.story.height, AV_PIX_FMT_YUV420P) : nullptr;
+        if (!from || !to || !out)
+        {
+            if (error.empty())
+            {
+                error = "创建转场输出帧失败";
+            }
+            return false;
+        }
+        for (int i = 0; i < options.frames; ++i)
+        {
+            kernel(from.get(), to.get(), out.get(), static_cast<double>(i) / options.frames);
+            ++frames;
+        }
+        return true;
+    }
+
+    // 4:3 视频按 contain 放进项目画面，上方一张旋转的半透明叠加图，逐帧合成；extra 记录逐帧重写的像素比例
+    bool benchCompositor(const BenchOptions &options, int &frames, std::string &error, QJsonObject &extra)
+    {
+        const int width = options.story.width;
+        const int height = options.story.height;
+        const LayerCompositor::Rect rect = LayerCompositor::fitRect(4, 3, width, height, LayerCompositor::Fit::CONTAIN);
+        auto dynamic = SyntheticStory::makeTestFrame(rect.width, rect.height, AV_PIX_FMT_YUV420P, 4, &error);
+        auto overlay = dynamic ? SyntheticStory::makeTestFrame(width / 4, height / 4, AV_PIX_FMT_RGBA, 5, &error) : nullptr;
+        if (!dynamic || !overlay)
+        {
+            return false;
+        }
+        if (av_frame_make_writable(overlay.get()) < 0)
+        {
+            error = "叠加图不可写";
+            return false;
+        }
+        for (int y = 0; y < overlay->height; ++y)
+        {
+            uint8_t *line = overlay->data[0] + static_cast<ptrdiff_t>(y) * overlay->linesize[0];
+            for (int x = 0; x < overlay->width; ++x)
+            {
+                line[x * 4 + 3] = 160;
+            }
+        }
+        LayerCompositor compositor;
+        ImageConfig placement;
+        placement.rotation = 15.0;
+        placement.x = width / 3;
+        placement.y = height / 3;
+        if (!compositor.initialize(width, height, "#202020") || !compositor.setDynamicLayer(rect) ||
+            !compositor.addImageLayer(overlay.get(), placement, LayerCompositor::Fit::NONE))
+        {
+            error = compositor.getErrorString();
+            return false;
+        }
+        for (int i = 0; i < options.frames; ++i)
+        {
+            // 与编码器一样在下一帧前释放输出，缓冲池中的缓冲得以复用
+            auto composed = compositor.compose(dynamic.get());
+            if (!composed)
+            {
+                error = compositor.getErrorString();
+                return false;
+            }
+            ++frames;
+        }
+        const LayerCompositor::Stats &stats = compositor.stats();
+        extra["dirty_ratio"] = stats.totalPixels > 0 ? static_cast<double>(stats.dirtyPixels) / stats.totalPixels : 0.0;
+        return true;
+    }
+
+    // 按给定编码配置与线程预算（经 RenderEngine 同一套 EncoderSettings）编码 options.frames 帧 testsrc 画面，只编码不封装；
+    // two_pass 码控时由调用方指定 pass 与共用的 passLog，bytesOut 接收输出的总字节数
+    bool benchEncode(const BenchOptions &options, const VideoEncodingConfig &encoding, int threadBudget, int &frames,
+                     std::string &error, int pass = 0, TwoPassLog *passLog = nullptr, long long *bytesOut = nullptr)
+    {
+        const SyntheticStoryOptions &story = options.story;
+        // 连续的 testsrc 画面往返播放：互不相关的画面会让编码器每帧都判为场景切换、全部编成 I 帧，
+        // GOP、B 帧、前瞻与码控的差别都测不出来
+        std::vector<FFmpegUtils::AvFramePtr> sources;
+        if (!SyntheticStory::makeTestSequence(story.width, story.height, AV_PIX_FMT_YUV420P, story.fps, 24, sources, error))
+        {
+            return false;
+        }
+        const int period = static_cast<int>(sources.size()) * 2 - 2;
+
+        const AVCodec *codec = avcodec_find_encoder_by_name(story.videoCodec.c_str());
+        FFmpegUtils::AvCodecContextPtr context(codec ? avcodec_alloc_context3(codec) : nullptr);
+        if (!context)
+        {
+            error = "找不到视频编码器: " + story.videoCodec;
+            return false;
+        }
+        context->width = story.width;
+        context->height = story.height;
+        context->time_base = {1, story.fps};
+        context->framerate = {story.fps, 1};
+        context->pix_fmt = AV_PIX_FMT_YUV420P;
+        const ResolvedVideoEncoding resolved = EncoderSettings::resolve(encoding, story.fps, threadBudget);
+        if (!EncoderSettings::apply(context.get(), encoding, resolved, &error, pass, passLog))
+        {
+            return false;
+        }
+        int ret = avcodec_open2(context.get(), codec, nullptr);
+        if (ret < 0)
+        {
+            error = "打开视频编码器失败";
+            return false;
+        }
+
+        auto input = FFmpegUtils::createAvFrame();
+        auto packet = FFmpegUtils::createAvPacket();
+        long long bytes = 0;
+        auto drain = [&]() {
+            while ((ret = avcodec_receive_packet(context.get(), packet.get())) >= 0)
+            {
+                if (pass == 1 && passLog)
+                {
+                    passLog->collect(context.get());
+                }
+                bytes += packet->size;
+                av_packet_unref(packet.get());
+            }
+            return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF;
+        };
+
+        for (int i = 0; i < options.frames; ++i)
+        {
+            const int phase = i % period;
+            av_frame_ref(input.get(), sources[phase < static_cast<int>(sources.size()) ? phase : period - phase].get());
+            input->pts = i;
+            input->pict_type = AV_PICTURE_TYPE_NONE; // testsrc 输出的帧都标为 I 帧，编码器会照此强制关键帧
+            ret = avcodec_send_frame(context.get(), input.get());
+            av_frame_unref(input.get());
+            if (ret < 0 || !drain())
+            {
+                error = "视频编码失败";
+                return false;
+            }
+            ++frames;
+        }
+        if (avcodec_send_frame(context.get(), nullptr) < 0 || !drain())
+        {
+            error = "冲洗视频编码器失败";
+            return false;
+        }
+        if (bytes <= 0)
+        {
+            error = "编码器没有输出数据";
+            return false;
+        }
+        if (bytesOut)
+        {
+            *bytesOut = bytes;
+        }
+        return true;
+    }
+
+    // 码控模式的耗时与输出大小：crf / crf_vbv / abr / two_pass，目标码率取 options.bitrate
+    bool benchRateControl(const BenchOptions &options, const VideoEncodingConfig &base, const std::string &mode,
+                          const std::string &directory, int &frames, std::string &error, QJsonObject &extra)
+    {
+        VideoEncodingConfig encoding = base;
+        encoding.bitrate = options.bitrate;
+        encoding.rate_control = mode == "crf_vbv" ? "crf" : mode;
+        if (mode == "crf_vbv")
+        {
+            encoding.maxrate = options.bitrate;
+        }
+
+        long long bytes = 0;
+        if (mode == "two_pass")
+        {
+            TwoPassLog passLog(directory + "/bench.2pass.log");
+            int analysisFrames = 0;
+            if (!benchEncode(options, encoding, 0, analysisFrames, error, 1, &passLog))
+            {
+                return false;
+            }
+            if (!benchEncode(options, encoding, 0, frames, error, 2, &passLog, &bytes))
+            {
+                return false;
+            }
+        }
+        else if (!benchEncode(options, encoding, 0, frames, error, 0, nullptr, &bytes))
+        {
+            return false;
+        }
+
+        const double seconds = static_cast<double>(options.frames) / options.story.fps;
+        extra["bytes"] = static_cast<double>(bytes);
+        extra["kbps"] = seconds > 0 ? bytes * 8.0 / seconds / 1000.0 : 0.0;
+        extra["target_kbps"] = EncoderSettings::parseBitrate(options.bitrate) / 1000.0;
+        return true;
+    }
+
+    // 同时运行 jobs 个编码任务（各自分得 threadBudget 个线程），frames 为所有任务的总帧数
+    bool benchConcurrentEncode(const BenchOptions &options, const VideoEncodingConfig &encoding, int jobs, int threadBudget,
+                               int &frames, std::string &error)
+    {
+        std::vector<int> jobFrames(jobs, 0);
+        std::vector<std::string> jobErrors(jobs);
+        std::vector<char> jobOk(jobs, 0);
+        std::vector<std::thread> workers;
+        for (int i = 0; i < jobs; ++i)
+        {
+            workers.emplace_back([&, i]() {
+                jobOk[i] = benchEncode(options, encoding, threadBudget, jobFrames[i], jobErrors[i]) ? 1 : 0;
+            });
+        }
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+        for (int i = 0; i < jobs; ++i)
+        {
+            if (!jobOk[i])
+            {
+                error = jobErrors[i];
+                return false;
+            }
+            frames += jobFrames[i];
+        }
+        return true;
+    }
+
+    QJsonObject stageStatsToJson(const RenderStageStats &stats)
+    {
+        QJsonObject stages;
+        stages["setup"] = stats.setup;
+        stages["video_source"] = stats.videoSource;
+        stages["subtitle"] = stats.subtitle;
+        stages["video_encode"] = stats.videoEncode;
+        stages["audio_mix"] = stats.audioMix;
+        stages["audio_encode"] = stats.audioEncode;
+        stages["transition"] = stats.transition;
+        stages["finalize"] = stats.finalize;
+        return stages;
+    }
+
+    // 调度开销：模拟多镜头故事中每个场景 1 路视频 + 若干路音频的解码，每个工作单元是一小段计算，
+    // 对比旧方式（每个场景为每路解码新建线程）与共享执行器（解码以“解到队列满”为一个任务，按需重新调度）
+    struct SchedulingShape
+    {
+        int scenes = 40;
+        int streamsPerScene = 4; // 1 路视频 + 3 路音频
+        int unitsPerStream = 64;
+        int unitsPerTask = 8;    // 对应解码队列容量
+    };
+
+    uint64_t schedulingWorkUnit(uint64_t seed)
+    {
+        // 约几微秒的整数运算，代替一次解码调用
+        for (int i = 0; i < 2000; ++i)
+        {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        }
+        return seed;
+    }
+
+    bool benchSchedulingThreads(const SchedulingShape &shape, int &frames, QJsonObject &extra)
+    {
+        std::atomic<uint64_t> sink{0};
+        int threadsCreated = 0;
+        for (int scene = 0; scene < shape.scenes; ++scene)
+        {
+            std::vector<std::thread> threads;
+            for (int stream = 0; stream < shape.streamsPerScene; ++stream)
+            {
+                threads.emplace_back([&, stream]() {
+                    uint64_t value = static_cast<uint64_t>(stream);
+                    for (int unit = 0; unit < shape.unitsPerStream; ++unit)
+                    {
+                        value = schedulingWorkUnit(value);
+                    }
+                    sink += value;
+                });
+                ++threadsCreated;
+            }
+            for (auto &thread : threads)
+            {
+                thread.join();
+            }
+        }
+        frames = shape.scenes * shape.streamsPerScene * shape.unitsPerStream;
+        extra["threads_created"] = threadsCreated;
+        extra["checksum"] = static_cast<double>(sink.load() & 0xffff);
+        return true;
+    }
+
+    bool benchSchedulingExecutor(const SchedulingShape &shape, int &frames, QJsonObject &extra)
+    {
+        TaskExecutor &executor = TaskExecutor::instance();
+        const TaskExecutor::Stats before = executor.stats();
+        std::atomic<uint64_t> sink{0};
+        for (int scene = 0; scene < shape.scenes; ++scene)
+        {
+            // 每路解码拆成若干个“解满一队列”的任务，后一个依赖前一个，与渲染中按需重新调度的顺序一致
+            std::vector<TaskHandle> last;
+            for (int stream = 0; stream < shape.streamsPerScene; ++stream)
+            {
+                TaskHandle previous;
+                for (int unit = 0; unit < shape.unitsPerStream; unit += shape.unitsPerTask)
+                {
+                    const int count = std::min(shape.unitsPerTask, shape.unitsPerStream - unit);
+                    std::vector<TaskHandle> dependencies;
+                    if (previous.valid())
+                    {
+                        dependencies.push_back(previous);
+                    }
+                    previous = executor.submit([&sink, stream, unit, count]() {
+                        uint64_t value = static_cast<uint64_t>(stream * 131 + unit);
+                        for (int i = 0; i < count; ++i)
+                        {
+                            value = schedulingWorkUnit(value);
+                        }
+                        sink += value;
+                    }, dependencies);
+                }
+                last.push_back(previous);
+            }
+            for (const TaskHandle &handle : last)
+            {
+                handle.wait();
+            }
+        }
+        const TaskExecutor::Stats after = executor.stats();
+        frames = shape.scenes * shape.streamsPerScene * shape.unitsPerStream;
+        const int64_t tasks = after.executed - before.executed;
+        extra["threads_created"] = static_cast<double>(after.threadsCreated - before.threadsCreated);
+        extra["workers"] = executor.workerCount();
+        extra["tasks"] = static_cast<double>(tasks);
+        extra["steals"] = static_cast<double>(after.stolen - before.stolen);
+        extra["mean_queue_wait_us"] = tasks > 0 ? (after.queueWaitSeconds - before.queueWaitSeconds) * 1e6 / tasks : 0.0;
+        extra["checksum"] = static_cast<double>(sink.load() & 0xffff);
+        return true;
+    }
+
+    // writeBufferMb 为输出写缓冲（0 为渲染线程同步写文件）；mux_write_ms 为渲染线程花在写出上的总时间
+    bool benchEndToEnd(const SyntheticStory &story, const BenchOptions &options, int writeBufferMb, bool trace, int &frames,
+                       std::string &error, QJsonObject &extra)
+    {
+        trace = trace && !options.tracePath.isEmpty();
+        if (trace)
+        {
+            StartTrace();
+        }
+        ProjectConfig config = story.config();
+        config.project.write_buffer_mb = writeBufferMb;
+        RenderEngine engine;
+        const bool rendered = engine.initialize(config) && engine.render();
+        if (trace)
+        {
+            std::string traceError;
+            if (!StopTrace(options.tracePath.toUtf8().toStdString(), &traceError))
+            {
+                std::fprintf(stderr, "%s\n", traceError.c_str());
+            }
+        }
+        if (!rendered)
+        {
+            error = engine.errorString();
+            return false;
+        }
+        frames = engine.frameCount();
+        extra["stages"] = stageStatsToJson(engine.stageStats());
+        extra["metrics"] = engine.metrics().toJson();
+        extra["write_buffer_mb"] = writeBufferMb;
+        extra["mux_write_ms"] = engine.metrics().muxWrite.total() * 1000.0;
+        return true;
+    }
+
+    // 断点续渲：按场景分段落盘再拼接。cancelAt 在 (0, 100) 时渲染到该进度即取消，模拟进程被杀，分段与日志留在 checkpointDir；
+    // 之后同一配置再跑一次即从日志续渲。frames 为本次实际编码的帧数，续渲时不含跳过的分段
+    bool benchCheckpoint(const SyntheticStory &story, const std::string &checkpointDir, int cancelAt, int &frames,
+                         std::string &error, QJsonObject &extra)
+    {
+        ProjectConfig config = story.config();
+        config.project.checkpoint_dir = checkpointDir;
+        RenderEngine engine;
+        if (cancelAt > 0)
+        {
+            engine.setProgressCallback([&engine, cancelAt](int percent) {
+                if (percent >= cancelAt)
+                {
+                    engine.requestCancel();
+                }
+            });
+        }
+        const bool rendered = engine.initialize(config) && engine.render();
+        const RenderMetrics &metrics = engine.metrics();
+        if (!rendered && !(cancelAt > 0 && engine.isCancelled()))
+        {
+            error = engine.errorString();
+            return false;
+        }
+        frames = static_cast<int>(metrics.videoFramesSent);
+        extra["cancelled"] = !rendered;
+        extra["checkpoint_parts"] = static_cast<double>(metrics.checkpointParts);
+        extra["checkpoint_parts_resumed"] = static_cast<double>(metrics.checkpointPartsResumed);
+        extra["checkpoint_parts_written"] = static_cast<double>(metrics.checkpointPartsWritten);
+        extra["stages"] = stageStatsToJson(engine.stageStats());
+        return true;
+    }
+
+    // 与基线逐项比较 fps，返回回退的项数
+    int compareWithBaseline(const QJsonObject &baseline, const std::vector<BenchResult> &results, double tolerance)
+    {
+        QJsonObject previous;
+        for (const QJsonValue &value : baseline["results"].toArray())
+        {
+            const QJsonObject entry = value.toObject();
+            previous[entry["name"].toString()] = entry;
+        }
+
+        std::printf("\n%-24s %12s %12s %9s\n", "baseline", "before fps", "now fps", "change");
+        int regressions = 0;
+        for (const BenchResult &result : results)
+        {
+            const QJsonObject entry = previous[QString::fromStdString(result.name)].toObject();
+            const double before = entry["fps"].toDouble();
+            if (before <= 0.0)
+            {
+                std::printf("%-24s %12s %12.2f %9s\n", result.name.c_str(), "-", result.fps(), "new");
+                continue;
+            }
+            const double change = result.fps() / before - 1.0;
+            const bool regressed = change < -tolerance;
+            regressions += regressed ? 1 : 0;
+            std::printf("%-24s %12.2f %12.2f %+8.1f%%%s\n", result.name.c_str(), before, result.fps(), change * 100.0,
+                        regressed ? "  REGRESSION" : "");
+        }
+        return regressions;
+    }
+
+    bool parseArguments(const QStringList &args, BenchOptions &options)
+    {
+        for (int i = 1; i < args.size(); ++i)
+        {
+            const QString &arg = args[i];
+            if (arg == "--verbose")
+            {
+                options.verbose = true;
+                continue;
+            }
+            if (i + 1 >= args.size())
+            {
+                return false;
+            }
+            const QString value = args[++i];
+            if (arg == "--width")
+                options.story.width = value.toInt();
+            else if (arg == "--height")
+                options.story.height = value.toInt();
+            else if (arg == "--fps")
+                options.story.fps = value.toInt();
+            else if (arg == "--images")
+                options.story.imageScenes = value.toInt();
+            else if (arg == "--videos")
+                options.story.videoScenes = value.toInt();
+            else if (arg == "--seconds")
+                options.story.sceneSeconds = value.toDouble();
+            else if (arg == "--frames")
+                options.frames = value.toInt();
+            else if (arg == "--codec")
+                options.story.videoCodec = value.toStdString();
+            else if (arg == "--preset")
+                options.story.videoPreset = value.toStdString();
+            else if (arg == "--bitrate")
+                options.bitrate = value.toStdString();
+            else if (arg == "--json")
+                options.jsonPath = value;
+            else if (arg == "--baseline")
+                options.baselinePath = value;
+            else if (arg == "--tolerance")
+                options.tolerance = value.toDouble();
+            else if (arg == "--keep")
+                options.keepDirectory = value;
+            else if (arg == "--trace")
+                options.tracePath = value;
+            else
+                return false;
+        }
+        // 宽高需为偶数（yuv420p）
+        return options.story.width > 0 && options.story.height > 0 && options.story.width % 2 == 0 &&
+               options.story.height % 2 == 0 && options.story.fps > 0 && options.frames > 0 &&
+               options.story.imageScenes >= 0 && options.story.videoScenes >= 0 &&
+               options.story.imageScenes + options.story.videoScenes > 0 && options.story.sceneSeconds > 0;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    BenchOptions options;
+    if (!parseArguments(app.arguments(), options))
+    {
+        std::fprintf(stderr,
+                     "用法: render_bench [--width W] [--height H] [--fps N] [--images N] [--videos N] [--seconds S]\n"
+                     "                    [--frames N] [--codec NAME] [--preset NAME] [--bitrate R] [--json PATH] [--baseline PATH]\n"
+                     "                    [--tolerance R] [--keep DIR] [--trace PATH] [--verbose]\n");
+        return 2;
+    }
+    if (!options.verbose)
+    {
+        // RenderEngine 逐帧的调试输出会明显影响计时
+        qInstallMessageHandler(quietMessageHandler);
+    }
+
+    std::string error;
+    if (!InitializeFFmpeg(&error))
+    {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    QTemporaryDir tempDir;
+    QString directory = options.keepDirectory;
+    if (directory.isEmpty())
+    {
+        if (!tempDir.isValid())
+        {
+            std::fprintf(stderr, "无法创建临时目录\n");
+            return 1;
+        }
+        directory = tempDir.path();
+    }
+    else if (!QDir().mkpath(directory))
+    {
+        std::fprintf(stderr, "无法创建目录 %s\n", qPrintable(directory));
+        return 1;
+    }
+
+    QElapsedTimer generateTimer;
+    generateTimer.start();
+    SyntheticStory story(options.story);
+    if (!story.generate(directory.toUtf8().toStdString()))
+    {
+        std::fprintf(stderr, "生成合成素材失败: %s\n", story.errorString().c_str());
+        return 1;
+    }
+    std::printf("合成故事: %d 个场景，%dx%d@%d，素材生成 %.2f s，目录 %s\n\n",
+                static_cast<int>(story.config().scenes.size()), options.story.width, options.story.height,
+                options.story.fps, generateTimer.nsecsElapsed() / 1e9, qPrintable(directory));
+
+    std::printf("%-24s %8s %10s %10s %12s\n", "case", "frames", "fps", "ms/frame", "allocs/frame");
+    std::vector<BenchResult> results;
+    bool ok = true;
+    ok = ok && runCase("decode_image", [&](int &frames, std::string &err, QJsonObject &) {
+        return benchImageDecode(story, options, false, frames, err);
+    }, results);
+    ok = ok && runCase("decode_image_memory", [&](int &frames, std::string &err, QJsonObject &) {
+        return benchImageDecode(story, options, true, frames, err);
+    }, results);
+    ok = ok && runCase("decode_video", [&](int &frames, std::string &err, QJsonObject &) {
+        return benchVideoDecode(story, options, frames, err);
+    }, results);
+
+    // 解码线程：1080p 与 4K 素材分别比较单线程、默认预算（4 线程）与占满核心的帧级线程，以及片级线程
+    const int hardwareThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    struct DecodeClip
+    {
+        const char *name;
+        int width;
+        int height;
+    };
+    for (const DecodeClip &clip : {DecodeClip{"1080p", 1920, 1080}, DecodeClip{"4k", 3840, 2160}})
+    {
+        const std::string clipPath = directory.toUtf8().toStdString() + "/decode_" + clip.name + ".mp4";
+        if (!SyntheticStory::writeVideo(clipPath, clip.width, clip.height, options.story.fps, options.story.sceneSeconds, error))
+        {
+            std::fprintf(stderr, "生成解码基准素材失败: %s\n", error.c_str());
+            return 1;
+        }
+        std::vector<int> threadCounts = {1, 4, hardwareThreads};
+        std::sort(threadCounts.begin(), threadCounts.end());
+        threadCounts.erase(std::unique(threadCounts.begin(), threadCounts.end()), threadCounts.end());
+        for (int threads : threadCounts)
+        {
+            ok = ok && runCase(std::string("decode_threads_") + clip.name + "_frame_t" + std::to_string(threads),
+                               [&](int &frames, std::string &err, QJsonObject &extra) {
+                return benchDecodeThreads(clipPath, threads, FF_THREAD_FRAME, frames, err, extra);
+            }, results);
+        }
+        ok = ok && runCase(std::string("decode_threads_") + clip.name + "_slice_t4", [&](int &frames, std::string &err, QJsonObject &extra) {
+            return benchDecodeThreads(clipPath, 4, FF_THREAD_SLICE, frames, err, extra);
+        }, results);
+    }
+    ok = ok && runCase("decode_audio", [&](int &frames, std::string &err, QJsonObject &) {
+        return benchAudioDecode(story, frames, err);
+    }, results);
+
+    // 视频长于队列容量（64 包），停滞的视频队列必然先满
+    const std::string demuxDirectory = directory.toUtf8().toStdString();
+    const std::string demuxPath = demuxDirectory + "/demux_av.mp4";
+    if (!SyntheticStory::writeVideo(demuxDirectory + "/demux_video.mp4", options.story.width, options.story.height,
+                                    options.story.fps, 5.0, error) ||
+        !SyntheticStory::writeTone(demuxDirectory + "/demux_audio.m4a", 5.0, 440.0, error) ||
+        !muxVideoWithAudio(demuxDirectory + "/demux_video.mp4", demuxDirectory + "/demux_audio.m4a", demuxPath, error))
+    {
+        std::fprintf(stderr, "生成共享解复用素材失败: %s\n", error.c_str());
+        return 1;
+    }
+    ok = ok && runCase("shared_demux_stalled_video", [&](int &frames, std::string &err, QJsonObject &extra) {
+        return benchSharedDemuxStall(demuxPath, frames, err, extra);
+    }, results);
+    ok = ok && runCase("audio_mix", [&](int &frames, std::string &err, QJsonObject &) {
+        return benchAudioMix(story, frames, err);
+    }, results);
+    for (const std::string &preset : syntheticKenBurnsPresets())
+    {
+        ok = ok && runCase("ken_burns_" + preset, [&](int &frames, std::string &err, QJsonObject &) {
+            return benchKenBurns(preset, options, frames, err);
+        }, results);
+    }
+    for (TransitionType type : syntheticTransitionTypes())
+    {
+        ok = ok && runCase("transition_" + detail::asciiLower(transitionTypeToString(type)), [&](int &frames, std::string &err, QJsonObject &) {
+            return benchTransition(type, options, frames, err);
+        }, results);
+    }
+    for (TransitionType type : syntheticTransitionTypes())
+    {
+        const std::string name = "kernel_" + detail::asciiLower(transitionTypeToString(type));
+        ok = ok && runCase(name, [&](int &frames, std::string &err, QJsonObject &) {
+            return benchTransitionKernel(type, true, options, frames, err);
+        }, results);
+        if (TransitionKernelRegistry::simdAvailable())
+        {
+            ok = ok && runCase(name + "_scalar", [&](int &frames, std::string &err, QJsonObject &) {
+                return benchTransitionKernel(type, false, options, frames, err);
+            }, results);
+        }
+    }
+    ok = ok && runCase("compositor_letterbox_overlay", [&](int &frames, std::string &err, QJsonObject &extra) {
+        return benchCompositor(options, frames, err, extra);
+    }, results);
+    VideoEncodingConfig encoding;
+    encoding.codec = options.story.videoCodec;
+    encoding.preset = options.story.videoPreset;
+    encoding.crf = options.story.crf;
+    ok = ok && runCase("encode_" + options.story.videoCodec, [&](int &frames, std::string &err, QJsonObject &) {
+        return benchEncode(options, encoding, 0, frames, err);
+    }, results);
+
+    // 编码线程档位：fastest 单任务占满核心；concurrent 按 RenderQueue 的方式把核心均分给多个并行任务
+    const int concurrentJobs = std::max(2, hardwareThreads / 4);
+    const int concurrentBudget = std::max(1, hardwareThreads / concurrentJobs);
+    for (const char *profile : {"fastest", "concurrent"})
+    {
+        VideoEncodingConfig profiled = encoding;
+        profiled.auto_profile = profile;
+        ok = ok && runCase(std::string("encode_profile_") + profile + "_x1", [&](int &frames, std::string &err, QJsonObject &extra) {
+            extra["jobs"] = 1;
+            return benchEncode(options, profiled, 0, frames, err);
+        }, results);
+        ok = ok && runCase(std::string("encode_profile_") + profile + "_x" + std::to_string(concurrentJobs),
+                           [&](int &frames, std::string &err, QJsonObject &extra) {
+            // fastest 档位不分预算，各任务互相抢占核心，用于对照
+            const int budget = profiled.auto_profile == "concurrent" ? concurrentBudget : 0;
+            extra["jobs"] = concurrentJobs;
+            extra["thread_budget"] = budget;
+            return benchConcurrentEncode(options, profiled, concurrentJobs, budget, frames, err);
+        }, results);
+    }
+
+    // 码控模式：同一目标码率下比较耗时（fps）与实际输出大小（kbps）
+    const std::string rateControlDirectory = directory.toUtf8().toStdString();
+    for (const char *mode : {"crf", "crf_vbv", "abr", "two_pass"})
+    {
+        ok = ok && runCase(std::string("rate_control_") + mode, [&](int &frames, std::string &err, QJsonObject &extra) {
+            return benchRateControl(options, encoding, mode, rateControlDirectory, frames, err, extra);
+        }, results);
+    }
+
+    // 调度：40 个镜头、每镜头 4 路解码，比较逐场景建线程与共享执行器的耗时与线程创建数
+    const SchedulingShape schedulingShape;
+    ok = ok && runCase("scheduling_thread_per_stream", [&](int &frames, std::string &, QJsonObject &extra) {
+        return benchSchedulingThreads(schedulingShape, frames, extra);
+    }, results);
+    ok = ok && runCase("scheduling_executor", [&](int &frames, std::string &, QJsonObject &extra) {
+        return benchSchedulingExecutor(schedulingShape, frames, extra);
+    }, results);
+    ok = ok && runCase("render_end_to_end", [&](int &frames, std::string &err, QJsonObject &extra) {
+        return benchEndToEnd(story, options, ProjectInfoConfig().write_buffer_mb, true, frames, err, extra);
+    }, results);
+    // 对照：渲染线程同步写文件（--keep 指向慢盘或网络挂载时差异最明显）
+    ok = ok && runCase("render_end_to_end_sync_write", [&](int &frames, std::string &err, QJsonObject &extra) {
+        return benchEndToEnd(story, options, 0, false, frames, err, extra);
+    }, results);
+    // 断点续渲：完整分段渲染的开销；再在一半处取消并续渲，续渲一项应跳过约一半分段
+    const std::string checkpointDirectory = QDir(directory).filePath("checkpoint").toUtf8().toStdString();
+    ok = ok && runCase("render_checkpoint_full", [&](int &frames, std::string &err, QJsonObject &extra) {
+        return benchCheckpoint(story, checkpointDirectory, 0, frames, err, extra);
+    }, results);
+    ok = ok && runCase("render_checkpoint_killed", [&](int &frames, std::string &err, QJsonObject &extra) {
+        return benchCheckpoint(story, checkpointDirectory, 50, frames, err, extra);
+    }, results);
+    ok = ok && runCase("render_checkpoint_resume", [&](int &frames, std::string &err, QJsonObject &extra) {
+        if (!benchCheckpoint(story, checkpointDirectory, 0, frames, err, extra))
+        {
+            return false;
+        }
+        if (extra["checkpoint_parts_resumed"].toInt() == 0 && extra["checkpoint_parts"].toInt() > 1)
+        {
+            err = "续渲没有复用中断前写完的分段";
+            return false;
+        }
+        return true;
+    }, results);
+    if (!ok)
+    {
+        return 1;
+    }
+
+    QJsonObject environment;
+    environment["width"] = options.story.width;
+    environment["height"] = options.story.height;
+    environment["fps"] = options.story.fps;
+    environment["frames"] = options.frames;
+    environment["image_scenes"] = options.story.imageScenes;
+    environment["video_scenes"] = options.story.videoScenes;
+    environment["scene_seconds"] = options.story.sceneSeconds;
+    environment["codec"] = QString::fromStdString(options.story.videoCodec);
+    environment["preset"] = QString::fromStdString(options.story.videoPreset);
+    environment["hardware_threads"] = static_cast<int>(std::thread::hardware_concurrency());
+    environment["ffmpeg"] = QString::fromUtf8(av_version_info());
+
+    QJsonArray resultArray;
+    for (const BenchResult &result : results)
+    {
+        QJsonObject entry = result.extra;
+        entry["name"] = QString::fromStdString(result.name);
+        entry["frames"] = result.frames;
+        entry["seconds"] = result.seconds;
+        entry["fps"] = result.fps();
+        entry["ms_per_frame"] = result.msPerFrame();
+        entry["allocations"] = static_cast<double>(result.allocations);
+        entry["allocations_per_frame"] = result.allocationsPerFrame();
+        resultArray.append(entry);
+    }
+    QJsonObject report;
+    report["version"] = 1;
+    report["environment"] = environment;
+    report["results"] = resultArray;
+
+    if (!options.jsonPath.isEmpty())
+    {
+        const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+        QFile file(options.jsonPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size())
+        {
+            std::fprintf(stderr, "无法写入 %s\n", qPrintable(options.jsonPath));
+            return 1;
+        }
+    }
+
+    if (!options.baselinePath.isEmpty())
+    {
+        QFile file(options.baselinePath);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            std::fprintf(stderr, "无法读取基线 %s\n", qPrintable(options.baselinePath));
+            return 1;
+        }
+        const QJsonObject baseline = QJsonDocument::fromJson(file.readAll()).object();
+        if (baseline["environment"].toObject()["width"] != environment["width"] ||
+            baseline["environment"].toObject()["height"] != environment["height"] ||
+            baseline["environment"].toObject()["frames"] != environment["frames"])
+        {
+            std::fprintf(stderr, "警告: 基线的分辨率或帧数与本次运行不同，比较结果仅供参考\n");
+        }
+        const int regressions = compareWithBaseline(baseline, results, options.tolerance);
+        if (regressions > 0)
+        {
+            std::printf("\n%d 项相对基线回退超过 %.0f%%\n", regressions, options.tolerance * 100.0);
+            return 3;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,553 @@
+#include "SyntheticStory.h"
+#include "ffmpeg_utils/AvCodecContextWrapper.h"
+#include "ffmpeg_utils/AvFormatContextWrapper.h"
+#include "ffmpeg_utils/AvPacketWrapper.h"
+#include <cstdio>
+
+namespace VideoCreator
+{
+
+    namespace
+    {
+        std::string ffmpegError(int code, const std::string &message)
+        {
+            char buffer[AV_ERROR_MAX_STRING_SIZE] = {0};
+            av_strerror(code, buffer, sizeof(buffer));
+            return message + ": " + buffer;
+        }
+
+        // 只有输出端的 lavfi 滤镜图（testsrc / sine），逐帧拉取
+        class LavfiSource
+        {
+        public:
+            ~LavfiSource()
+            {
+                avfilter_graph_free(&m_graph);
+            }
+
+            bool open(const std::string &description, bool audio, std::string &error)
+            {
+                m_graph = avfilter_graph_alloc();
+                if (!m_graph)
+                {
+                    error = "创建滤镜图失败";
+                    return false;
+                }
+
+                const AVFilter *sink = avfilter_get_by_name(audio ? "abuffersink" : "buffersink");
+                int ret = avfilter_graph_create_filter(&m_sink, sink, "out", nullptr, nullptr, m_graph);
+                if (ret < 0)
+                {
+                    error = ffmpegError(ret, "创建 buffersink 失败");
+                    return false;
+                }
+
+                AVFilterInOut *inputs = avfilter_inout_alloc();
+                AVFilterInOut *outputs = nullptr;
+                if (!inputs)
+                {
+                    error = "分配滤镜端点失败";
+                    return false;
+                }
+                inputs->name = av_strdup("out");
+                inputs->filter_ctx = m_sink;
+                inputs->pad_idx = 0;
+                inputs->next = nullptr;
+
+                ret = avfilter_graph_parse_ptr(m_graph, description.c_str(), &inputs, &outputs, nullptr);
+                avfilter_inout_free(&inputs);
+                avfilter_inout_free(&outputs);
+                if (ret < 0)
+                {
+                    error = ffmpegError(ret, "解析滤镜描述失败: " + description);
+                    return false;
+                }
+
+                ret = avfilter_graph_config(m_graph, nullptr);
+                if (ret < 0)
+                {
+                    error = ffmpegError(ret, "配置滤镜图失败: " + description);
+                    return false;
+                }
+                if (audio)
+                {
+                    // AAC 编码器要求每帧固定 1024 个采样
+                    av_buffersink_set_frame_size(m_sink, 1024);
+                }
+                return true;
+            }
+
+            // 返回 1 表示取到一帧，0 表示结束，<0 表示错误
+            int pull(AVFrame *frame)
+            {
+                int ret = av_buffersink_get_frame(m_sink, frame);
+                if (ret == AVERROR_EOF)
+                {
+                    return 0;
+                }
+                return ret < 0 ? ret : 1;
+            }
+
+        private:
+            AVFilterGraph *m_graph = nullptr;
+            AVFilterContext *m_sink = nullptr;
+        };
+
+        // 单路流的编码 + 封装
+        class MediaWriter
+        {
+        public:
+            // codecContext 已填好参数、尚未打开，所有权转移给 MediaWriter
+            bool open(const std::string &path, AVCodecContext *codecContext, std::string &error)
+            {
+                m_codecContext.reset(codecContext);
+
+                AVFormatContext *context = nullptr;
+                int ret = avformat_alloc_output_context2(&context, nullptr, nullptr, path.c_str());
+                if (ret < 0)
+                {
+                    error = ffmpegError(ret, "创建输出上下文失败: " + path);
+                    return false;
+                }
+                m_formatContext.reset(context);
+
+                if (m_formatContext->oformat->flags & AVFMT_GLOBALHEADER)
+                {
+                    m_codecContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+                }
+                ret = avcodec_open2(m_codecContext.get(), nullptr, nullptr);
+                if (ret < 0)
+                {
+                    error = ffmpegError(ret, "打开编码器失败");
+                    return false;
+                }
+
+                m_stream = avformat_new_stream(m_formatContext.get(), nullptr);
+                if (!m_stream)
+                {
+                    error = "创建输出流失败";
+                    return false;
+                }
+                ret = avcodec_parameters_from_context(m_stream->codecpar, m_codecContext.get());
+                if (ret < 0)
+                {
+                    error = ffmpegError(ret, "复制流参数失败");
+                    return false;
+                }
+                m_stream->time_base = m_codecContext->time_base;
+
+                ret = avio_open(&m_formatContext->pb, path.c_str(), AVIO_FLAG_WRITE);
+                if (ret < 0)
+                {
+                    error = ffmpegError(ret, "无法打开输出文件: " + path);
+                    return false;
+                }
+                ret = avformat_write_header(m_formatContext.get(), nullptr);
+                if (ret < 0)
+                {
+                    error = ffmpegError(ret, "写入文件头失败");
+                    return false;
+                }
+                return true;
+            }
+
+            // frame 为 nullptr 时冲洗编码器
+            bool write(const AVFrame *frame, std::string &error)
+            {
+                int ret = avcodec_send_frame(m_codecContext.get(), frame);
+                if (ret < 0 && ret != AVERROR_EOF)
+                {
+                    error = ffmpegError(ret, "发送帧到编码器失败");
+                    return false;
+                }
+                auto packet = FFmpegUtils::createAvPacket();
+                while (true)
+                {
+                    ret = avcodec_receive_packet(m_codecContext.get(), packet.get());
+                    if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+                    {
+                        break;
+                    }
+                    if (ret < 0)
+                    {
+                        error = ffmpegError(ret, "从编码器接收包失败");
+                        return false;
+                    }
+                    packet->stream_index = m_stream->index;
+                    av_packet_rescale_ts(packet.get(), m_codecContext->time_base, m_stream->time_base);
+                    ret = av_interleaved_write_frame(m_formatContext.get(), packet.get());
+                    if (ret < 0)
+                    {
+                        error = ffmpegError(ret, "写入包失败");
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            bool finish(std::string &error)
+            {
+                if (!write(nullptr, error))
+                {
+                    return false;
+                }
+                int ret = av_write_trailer(m_formatContext.get());
+                if (ret < 0)
+                {
+                    error = ffmpegError(ret, "写入文件尾失败");
+                    return false;
+                }
+                return true;
+            }
+
+        private:
+            FFmpegUtils::AvCodecContextPtr m_codecContext;
+            FFmpegUtils::AvFormatContextPtr m_formatContext;
+            AVStream *m_stream = nullptr;
+        };
+
+        std::string joinPath(const std::string &directory, const std::string &name)
+        {
+            if (directory.empty() || directory.back() == '/' || directory.back() == '\\')
+            {
+                return directory + name;
+            }
+            return directory + "/" + name;
+        }
+    } // namespace
+
+    const std::vector<std::string> &syntheticKenBurnsPresets()
+    {
+        static const std::vector<std::string> presets = {"zoom_in", "zoom_out", "pan_right", "pan_left"};
+        return presets;
+    }
+
+    const std::vector<TransitionType> &syntheticTransitionTypes()
+    {
+        static const std::vector<TransitionType> types = {TransitionType::CROSSFADE,  TransitionType::WIPE,    TransitionType::SLIDE,
+                                                          TransitionType::PUSH_RIGHT, TransitionType::PUSH_UP, TransitionType::PUSH_DOWN,
+                                                          TransitionType::IRIS,       TransitionType::ZOOM_DISSOLVE,
+                                                          TransitionType::LUMA_WIPE};
+        return types;
+    }
+
+    SyntheticStory::SyntheticStory(const SyntheticStoryOptions &options)
+        : m_options(options)
+    {
+    }
+
+    FFmpegUtils::AvFramePtr SyntheticStory::makeTestFrame(int width, int height, AVPixelFormat format, int index, std::string *error)
+    {
+        // hue 旋转让不同 index 的画面内容不同，避免编码器对重复画面走捷径
+        const std::string description = "testsrc=size=" + std::to_string(width) + "x" + std::to_string(height) +
+                                        ":rate=1:duration=1,hue=h=" + std::to_string((index * 47) % 360) +
+                                        ",format=" + av_get_pix_fmt_name(format);
+        std::string localError;
+        LavfiSource source;
+        auto frame = FFmpegUtils::createAvFrame();
+        if (!frame || !source.open(description, false, localError) || source.pull(frame.get()) <= 0)
+        {
+            if (error)
+            {
+                *error = localError.empty() ? std::string("testsrc 未产生画面") : localError;
+            }
+            return nullptr;
+        }
+        return frame;
+    }
+
+    bool SyntheticStory::makeTestSequence(int width, int height, AVPixelFormat format, int fps, int count,
+                                          std::vector<FFmpegUtils::AvFramePtr> &frames, std::string &error)
+    {
+        const std::string description = "testsrc=size=" + std::to_string(width) + "x" + std::to_string(height) +
+                                        ":rate=" + std::to_string(fps) + ",format=" + av_get_pix_fmt_name(format);
+        LavfiSource source;
+        if (!source.open(description, false, error))
+        {
+            return false;
+        }
+        frames.clear();
+        while (static_cast<int>(frames.size()) < count)
+        {
+            auto frame = FFmpegUtils::createAvFrame();
+            if (!frame || source.pull(frame.get()) <= 0)
+            {
+                error = "testsrc 未产生画面";
+                return false;
+            }
+            frames.push_back(std::move(frame));
+        }
+        return true;
+    }
+
+    bool SyntheticStory::writeImage(const std::string &path, int width, int height, int index, std::string &error)
+    {
+        auto frame = makeTestFrame(width, height, AV_PIX_FMT_RGB24, index, &error);
+        if (!frame)
+        {
+            return false;
+        }
+
+        const AVCodec *codec = avcodec_find_encoder(AV_CODEC_ID_PNG);
+        FFmpegUtils::AvCodecContextPtr context(codec ? avcodec_alloc_context3(codec) : nullptr);
+        if (!context)
+        {
+            error = "找不到 PNG 编码器";
+            return false;
+        }
+        context->width = width;
+        context->height = height;
+        context->pix_fmt = AV_PIX_FMT_RGB24;
+        context->time_base = {1, 1};
+        int ret = avcodec_open2(context.get(), codec, nullptr);
+        if (ret < 0)
+        {
+            error = ffmpegError(ret, "打开 PNG 编码器失败");
+            return false;
+        }
+
+        auto packet = FFmpegUtils::createAvPacket();
+        ret = avcodec_send_frame(context.get(), frame.get());
+        if (ret >= 0)
+        {
+            ret = avcodec_receive_packet(context.get(), packet.get());
+        }
+        if (ret < 0)
+        {
+            error = ffmpegError(ret, "PNG 编码失败");
+            return false;
+        }
+
+        // PNG 编码器输出的包就是完整的文件内容
+        std::FILE *file = std::fopen(path.c_str(), "wb");
+        if (!file)
+        {
+            error = "无法写入图片: " + path;
+            return false;
+        }
+        const bool written = std::fwrite(packet->data, 1, static_cast<size_t>(packet->size), file) == static_cast<size_t>(packet->size);
+        std::fclose(file);
+        if (!written)
+        {
+            error = "无法写入图片: " + path;
+        }
+        return written;
+    }
+
+    bool SyntheticStory::writeVideo(const std::string &path, int width, int height, int fps, double seconds, std::string &error)
+    {
+        const AVCodec *codec = avcodec_find_encoder_by_name("libx264");
+        if (!codec)
+        {
+            codec = avcodec_find_encoder(AV_CODEC_ID_MPEG4);
+        }
+        AVCodecContext *context = codec ? avcodec_alloc_context3(codec) : nullptr;
+        if (!context)
+        {
+            error = "找不到可用的视频编码器";
+            return false;
+        }
+        context->width = width;
+        context->height = height;
+        context->pix_fmt = AV_PIX_FMT_YUV420P;
+        context->time_base = {1, fps};
+        context->framerate = {fps, 1};
+        context->gop_size = fps;
+        context->bit_rate = 4000000;
+        if (context->priv_data)
+        {
+            av_opt_set(context->priv_data, "preset", "ultrafast", 0);
+        }
+
+        MediaWriter writer;
+        if (!writer.open(path, context, error))
+        {
+            return false;
+        }
+
+        LavfiSource source;
+        const std::string description = "testsrc=size=" + std::to_string(width) + "x" + std::to_string(height) +
+                                        ":rate=" + std::to_string(fps) + ":duration=" + std::to_string(seconds) +
+                                        ",format=yuv420p";
+        if (!source.open(description, false, error))
+        {
+            return false;
+        }
+
+        auto frame = FFmpegUtils::createAvFrame();
+        int64_t pts = 0;
+        while (true)
+        {
+            int ret = source.pull(frame.get());
+            if (ret == 0)
+            {
+                break;
+            }
+            if (ret < 0)
+            {
+                error = ffmpegError(ret, "testsrc 取帧失败");
+                return false;
+            }
+            frame->pts = pts++;
+            frame->pict_type = AV_PICTURE_TYPE_NONE;
+            const bool ok = writer.write(frame.get(), error);
+            av_frame_unref(frame.get());
+            if (!ok)
+            {
+                return false;
+            }
+        }
+        return writer.finish(error);
+    }
+
+    bool SyntheticStory::writeTone(const std::string &path, double seconds, double frequency, std::string &error)
+    {
+        const AVCodec *codec = avcodec_find_encoder(AV_CODEC_ID_AAC);
+        AVCodecContext *context = codec ? avcodec_alloc_context3(codec) : nullptr;
+        if (!context)
+        {
+            error = "找不到 AAC 编码器";
+            return false;
+        }
+        context->sample_fmt = AV_SAMPLE_FMT_FLTP;
+        context->sample_rate = 44100;
+        context->bit_rate = 128000;
+        context->time_base = {1, 44100};
+        av_channel_layout_from_mask(&context->ch_layout, AV_CH_LAYOUT_STEREO);
+
+        MediaWriter writer;
+        if (!writer.open(path, context, error))
+        {
+            return false;
+        }
+
+        LavfiSource source;
+        const std::string description = "sine=frequency=" + std::to_string(frequency) + ":sample_rate=44100:duration=" +
+                                        std::to_string(seconds) + ",aformat=sample_fmts=fltp:channel_layouts=stereo";
+        if (!source.open(description, true, error))
+        {
+            return false;
+        }
+
+        auto frame = FFmpegUtils::createAvFrame();
+        int64_t samples = 0;
+        while (true)
+        {
+            int ret = source.pull(frame.get());
+            if (ret == 0)
+            {
+                break;
+            }
+            if (ret < 0)
+            {
+                error = ffmpegError(ret, "sine 取帧失败");
+                return false;
+            }
+            frame->pts = samples;
+            samples += frame->nb_samples;
+            const bool ok = writer.write(frame.get(), error);
+            av_frame_unref(frame.get());
+            if (!ok)
+            {
+                return false;
+            }
+        }
+        return writer.finish(error);
+    }
+
+    bool SyntheticStory::generate(const std::string &directory)
+    {
+        m_config = ProjectConfig();
+        m_imagePaths.clear();
+        m_videoPaths.clear();
+        m_tonePaths.clear();
+        m_errorString.clear();
+
+        m_config.project.name = "synthetic";
+        m_config.project.output_path = joinPath(directory, "synthetic.mp4");
+        m_config.project.width = m_options.width;
+        m_config.project.height = m_options.height;
+        m_config.project.fps = m_options.fps;
+        m_config.global_effects.video_encoding.codec = m_options.videoCodec;
+        m_config.global_effects.video_encoding.preset = m_options.videoPreset;
+        m_config.global_effects.video_encoding.crf = m_options.crf;
+
+        const auto &presets = syntheticKenBurnsPresets();
+        const auto &transitions = syntheticTransitionTypes();
+        const int totalScenes = m_options.imageScenes + m_options.videoScenes;
+        int imagesLeft = m_options.imageScenes;
+        int videosLeft = m_options.videoScenes;
+        int sceneId = 1;
+
+        for (int i = 0; i < totalScenes; ++i)
+        {
+            if (i > 0 && m_options.transitionSeconds > 0.0)
+            {
+                SceneConfig transition;
+                transition.id = sceneId++;
+                transition.type = SceneType::TRANSITION;
+                transition.duration = m_options.transitionSeconds;
+                transition.transition_type = transitions[(i - 1) % transitions.size()];
+                transition.from_scene = sceneId - 2;
+                transition.to_scene = sceneId;
+                m_config.scenes.push_back(transition);
+            }
+
+            // 图片与视频场景交替，用完一类后只剩另一类
+            const bool useVideo = videosLeft > 0 && (imagesLeft == 0 || i % 2 == 1);
+            SceneConfig scene;
+            scene.id = sceneId++;
+            scene.duration = m_options.sceneSeconds;
+            if (m_options.subtitles)
+            {
+                scene.effects.subtitle.text = "合成场景 " + std::to_string(i + 1) + " / Synthetic scene";
+            }
+
+            if (useVideo)
+            {
+                const std::string path = joinPath(directory, "video_" + std::to_string(m_videoPaths.size()) + ".mp4");
+                if (!writeVideo(path, m_options.width, m_options.height, m_options.fps, m_options.sceneSeconds, m_errorString))
+                {
+                    return false;
+                }
+                m_videoPaths.push_back(path);
+                scene.type = SceneType::VIDEO_SCENE;
+                scene.resources.video.path = path;
+                scene.resources.video.use_audio = false;
+                --videosLeft;
+            }
+            else
+            {
+                const int imageIndex = static_cast<int>(m_imagePaths.size());
+                const std::string path = joinPath(directory, "image_" + std::to_string(imageIndex) + ".png");
+                if (!writeImage(path, m_options.width, m_options.height, imageIndex, m_errorString))
+                {
+                    return false;
+                }
+                m_imagePaths.push_back(path);
+                scene.type = SceneType::IMAGE_SCENE;
+                scene.resources.image.path = path;
+                scene.effects.ken_burns.enabled = true;
+                scene.effects.ken_burns.preset = presets[imageIndex % presets.size()];
+                scene.effects.ken_burns.start_scale = 1.0;
+                scene.effects.ken_burns.end_scale = 1.2;
+
+                if (m_options.narration)
+                {
+                    const std::string tonePath = joinPath(directory, "narration_" + std::to_string(imageIndex) + ".m4a");
+                    if (!writeTone(tonePath, m_options.sceneSeconds, 220.0 + 110.0 * (imageIndex % 5), m_errorString))
+                    {
+                        return false;
+                    }
+                    m_tonePaths.push_back(tonePath);
+                    scene.resources.audio.path = tonePath;
+                    scene.resources.audio.volume = 0.8;
+                }
+                --imagesLeft;
+            }
+            m_config.scenes.push_back(scene);
+        }
+        return true;
+    }
+
+} // namespace VideoCreator
@@ -0,0 +1,76 @@
+#ifndef SYNTHETIC_STORY_H
+#define SYNTHETIC_STORY_H
+
+#include <string>
+#include <vector>
+#include "model/ProjectConfig.h"
+#include "ffmpeg_utils/FFmpegHeaders.h"
+#include "ffmpeg_utils/AvFrameWrapper.h"
+
+namespace VideoCreator
+{
+
+    // 合成故事的规模参数
+    struct SyntheticStoryOptions
+    {
+        int width = 1920;
+        int height = 1080;
+        int fps = 30;
+        int imageScenes = 4;        // 图片场景数（轮流使用各 Ken Burns 预设）
+        int videoScenes = 2;        // 视频场景数（lavfi testsrc 生成）
+        double sceneSeconds = 3.0;  // 每个场景时长
+        double transitionSeconds = 0.5;
+        bool subtitles = true;
+        bool narration = true;      // 图片场景配正弦波旁白
+        std::string videoCodec = "libx264";
+        std::string videoPreset = "veryfast";
+        int crf = 23;
+    };
+
+    // 合成故事中用到的 Ken Burns 预设与转场类型
+    const std::vector<std::string> &syntheticKenBurnsPresets();
+    const std::vector<TransitionType> &syntheticTransitionTypes();
+
+    /**
+     * SyntheticStory - 在本地生成基准测试用的素材与项目配置
+     *
+     * 图片由 lavfi testsrc 截取一帧编码为 PNG，视频为 testsrc 编码的 MP4，旁白为 sine 编码的 AAC。
+     * 相邻场景之间依次插入每一种 TransitionType 的转场。素材只依赖 FFmpeg 自带的滤镜与编码器。
+     */
+    class SyntheticStory
+    {
+    public:
+        explicit SyntheticStory(const SyntheticStoryOptions &options);
+
+        // 在 directory 中生成素材并构建配置（directory 需已存在）
+        bool generate(const std::string &directory);
+
+        const ProjectConfig &config() const { return m_config; }
+        const std::vector<std::string> &imagePaths() const { return m_imagePaths; }
+        const std::vector<std::string> &videoPaths() const { return m_videoPaths; }
+        const std::vector<std::string> &tonePaths() const { return m_tonePaths; }
+        std::string errorString() const { return m_errorString; }
+
+        // 用 testsrc 生成一帧指定尺寸与像素格式的画面，index 决定画面内容
+        static FFmpegUtils::AvFramePtr makeTestFrame(int width, int height, AVPixelFormat format, int index, std::string *error = nullptr);
+
+        // testsrc 按 fps 连续输出的 count 帧（画面逐帧移动、没有镜头切换），供编码基准使用
+        static bool makeTestSequence(int width, int height, AVPixelFormat format, int fps, int count,
+                                     std::vector<FFmpegUtils::AvFramePtr> &frames, std::string &error);
+
+        static bool writeImage(const std::string &path, int width, int height, int index, std::string &error);
+        static bool writeVideo(const std::string &path, int width, int height, int fps, double seconds, std::string &error);
+        static bool writeTone(const std::string &path, double seconds, double frequency, std::string &error);
+
+    private:
+        SyntheticStoryOptions m_options;
+        ProjectConfig m_config;
+        std::vector<std::string> m_imagePaths;
+        std::vector<std::string> m_videoPaths;
+        std::vector<std::string> m_tonePaths;
+        std::string m_errorString;
+    };
+
+} // namespace VideoCreator
+
+#endif // SYNTHETIC_STORY_H
@@ -1,5 +1,9 @@
 #include "AudioDecoder.h"
+#include "MediaSource.h"
+#include "SharedDemuxer.h"
 #include "ffmpeg_utils/AvPacketWrapper.h"
+#include "model/MediaInfoCache.h"
+#include "trace/TraceRecorder.h"
 #include <QDebug>
 #include <sstream>
 #include <cmath>
@@ -21,30 +25,66 @@ namespace VideoCreator
 
     bool AudioDecoder::open(const std::string &filePath)
     {
+        VC_TRACE_SCOPE("audio_open", "decode");
         // 打开输入文件
-        if (avformat_open_input(&m_formatContext, filePath.c_str(), nullptr, nullptr) < 0)
+        if (MediaSourceRegistry::openInput(&m_formatContext, filePath) < 0)
         {
             m_errorString = "无法打开音频文件: " + filePath;
             return false;
         }
 
-        // 查找流信息
-        if (avformat_find_stream_info(m_formatContext, nullptr) < 0)
+        // 已探测过的文件直接复用流参数，跳过 avformat_find_stream_info
+        MediaInfoCache &mediaInfo = MediaInfoCache::instance();
+        auto streamInfo = mediaInfo.streamInfo(filePath, MediaKind::AUDIO);
+        if (streamInfo && MediaInfoCache::applyStreamInfo(m_formatContext, *streamInfo))
         {
-            m_errorString = "无法获取流信息";
-            cleanup();
-            return false;
+            m_audioStreamIndex = streamInfo->streamIndex;
+        }
+        else
+        {
+            // 查找流信息
+            if (avformat_find_stream_info(m_formatContext, nullptr) < 0)
+            {
+                m_errorString = "无法获取流信息";
+                cleanup();
+                return false;
+            }
+
+            // 查找音频流
+            m_audioStreamIndex = av_find_best_stream(m_formatContext, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+            if (m_audioStreamIndex < 0)
+            {
+                m_errorString = "未找到音频流";
+                cleanup();
+                return false;
+            }
+            mediaInfo.storeStreamInfo(filePath, MediaKind::AUDIO, m_formatContext, m_audioStreamIndex);
         }
 
-        // 查找音频流
-        m_audioStreamIndex = av_find_best_stream(m_formatContext, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
-        if (m_audioStreamIndex < 0)
+        return openCodec();
+    }
+
+    bool AudioDecoder::open(const std::shared_ptr<SharedDemuxer> &demuxer)
+    {
+        VC_TRACE_SCOPE("audio_open", "decode");
+        if (!demuxer || !demuxer->formatContext() || demuxer->audioStreamIndex() < 0)
         {
-            m_errorString = "未找到音频流";
-            cleanup();
+            m_errorString = "共享解复用器未打开音频流";
             return false;
         }
+        m_demuxer = demuxer;
+        m_formatContext = demuxer->formatContext();
+        m_audioStreamIndex = demuxer->audioStreamIndex();
+        if (!openCodec())
+        {
+            return false;
+        }
+        m_demuxer->attach(m_audioStreamIndex);
+        return true;
+    }
 
+    bool AudioDecoder::openCodec()
+    {
         // 获取音频流
         AVStream *audioStream = m_formatContext->streams[m_audioStreamIndex];
 
@@ -237,12 +277,24 @@ namespace VideoCreator
     bool AudioDecoder::seek(double timestamp)
     {
         if (!m_formatContext) return false;
+        if (m_demuxer) {
+            m_errorString = "共享解复用时不支持跳转";
+            return false;
+        }
         int64_t target_ts = static_cast<int64_t>(timestamp / av_q2d(m_formatContext->streams[m_audioStreamIndex]->time_base));
-        return av_seek_frame(m_formatContext, m_audioStreamIndex, target_ts, AVSEEK_FLAG_BACKWARD) >= 0;
+        if (av_seek_frame(m_formatContext, m_audioStreamIndex, target_ts, AVSEEK_FLAG_BACKWARD) < 0) {
+            return false;
+        }
+        // 丢弃解码器里 seek 之前的残留数据
+        if (m_codecContext) {
+            avcodec_flush_buffers(m_codecContext);
+        }
+        return true;
     }
     
     int AudioDecoder::decodeFrame(FFmpegUtils::AvFramePtr &outFrame)
     {
+        VC_TRACE_SCOPE("audio_decode", "decode");
         if (!m_formatContext || !m_codecContext) {
             m_errorString = "Decoder not opened";
             return -1;
@@ -291,7 +343,7 @@ namespace VideoCreator
                 return 0;
             }
             if (ret == AVERROR(EAGAIN)) {
-                ret = av_read_frame(m_formatContext, packet.get());
+                ret = readPacket(packet.get());
                 if (ret >= 0) {
                     if (packet->stream_index == m_audioStreamIndex) {
                         if (avcodec_send_packet(m_codecContext, packet.get()) < 0) {
@@ -365,6 +417,14 @@ namespace VideoCreator
         }
     }
 
+    int AudioDecoder::readPacket(AVPacket *packet)
+    {
+        if (m_demuxer) {
+            return m_demuxer->readPacket(m_audioStreamIndex, packet);
+        }
+        return av_read_frame(m_formatContext, packet);
+    }
+
     double AudioDecoder::getDuration() const
     {
         if (!m_formatContext || m_audioStreamIndex < 0) {
@@ -391,8 +451,13 @@ namespace VideoCreator
             avcodec_free_context(&m_codecContext);
             m_codecContext = nullptr;
         }
-        if (m_formatContext) {
-            avformat_close_input(&m_formatContext);
+        if (m_demuxer) {
+            // 格式上下文归共享解复用器所有
+            m_demuxer->detach(m_audioStreamIndex);
+            m_demuxer.reset();
+            m_formatContext = nullptr;
+        } else if (m_formatContext) {
+            MediaSourceRegistry::closeInput(&m_formatContext);
             m_formatContext = nullptr;
         }
         if (m_swrCtx) {
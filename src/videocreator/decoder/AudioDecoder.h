@@ -11,6 +11,8 @@
 namespace VideoCreator
 {
 
+    class SharedDemuxer;
+
     class AudioDecoder
     {
     public:
@@ -20,6 +22,9 @@ namespace VideoCreator
         // 打开音频文件
         bool open(const std::string &filePath);
 
+        // 从共享解复用器读取视频文件的音轨，此时不支持 seek()
+        bool open(const std::shared_ptr<SharedDemuxer> &demuxer);
+
         // 应用音量效果
         bool applyVolumeEffect(const SceneConfig& sceneConfig);
         bool applyVolumeEffect(double baseVolume, const VolumeMixEffect* effect, double trackDurationSeconds);
@@ -44,6 +49,12 @@ namespace VideoCreator
         std::string getErrorString() const { return m_errorString; }
 
     private:
+        // 按已定位的音频流打开解码器与重采样
+        bool openCodec();
+
+        // 读取下一个包（共享解复用时只会拿到本流的包）
+        int readPacket(AVPacket *packet);
+
         // 初始化Filter Graph
         bool initFilterGraph(double baseVolume, const VolumeMixEffect* effect, double trackDurationSeconds);
 
@@ -52,6 +63,7 @@ namespace VideoCreator
         AVCodecContext *m_codecContext;
         int m_audioStreamIndex;
         struct SwrContext *m_swrCtx;
+        std::shared_ptr<SharedDemuxer> m_demuxer;
         
         // Filter graph 资源
         AVFilterGraph *m_filterGraph;
@@ -1,4 +1,6 @@
 #include "ImageDecoder.h"
+#include "MediaSource.h"
+#include "trace/TraceRecorder.h"
 #include <iostream>
 #include <QDebug>
 
@@ -18,10 +20,11 @@ namespace VideoCreator
 
     bool ImageDecoder::open(const std::string &filePath)
     {
+        VC_TRACE_SCOPE("image_open", "decode");
         qDebug() << "打开图片文件: " << filePath.c_str();
         
         // 打开输入文件
-        if (avformat_open_input(&m_formatContext, filePath.c_str(), nullptr, nullptr) < 0)
+        if (MediaSourceRegistry::openInput(&m_formatContext, filePath) < 0)
         {
             m_errorString = "无法打开图片文件: " + filePath;
             qDebug() << "打开图片文件失败: " << m_errorString.c_str();
@@ -94,6 +97,7 @@ namespace VideoCreator
 
     FFmpegUtils::AvFramePtr ImageDecoder::decode()
     {
+        VC_TRACE_SCOPE("image_decode", "decode");
         if (!m_formatContext || !m_codecContext)
         {
             m_errorString = "解码器未打开";
@@ -189,6 +193,7 @@ namespace VideoCreator
     
     FFmpegUtils::AvFramePtr ImageDecoder::scaleToSize(FFmpegUtils::AvFramePtr& frame, int targetWidth, int targetHeight, AVPixelFormat targetFormat)
     {
+        VC_TRACE_SCOPE("image_scale", "scale");
         if (!frame)
         {
             m_errorString = "输入帧为空";
@@ -269,7 +274,7 @@ namespace VideoCreator
     
         if (m_formatContext)
         {
-            avformat_close_input(&m_formatContext);
+            MediaSourceRegistry::closeInput(&m_formatContext);
             m_formatContext = nullptr;
         }
     
@@ -0,0 +1,319 @@
+#include "MediaSource.h"
+#include "model/MediaInfoCache.h"
+#include "trace/TraceRecorder.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+#include <cstring>
+
+namespace VideoCreator
+{
+
+    namespace
+    {
+        constexpr int kIoBufferSize = 64 * 1024;
+
+        // 自定义 AVIOContext 的读取状态，持有数据的引用直到 closeInput
+        struct MemoryReader
+        {
+            std::shared_ptr<const MediaBuffer> buffer;
+            int64_t position = 0;
+        };
+
+        int readMemory(void *opaque, uint8_t *buf, int bufSize)
+        {
+            MemoryReader *reader = static_cast<MemoryReader *>(opaque);
+            const int64_t remaining = reader->buffer->size() - reader->position;
+            if (remaining <= 0)
+            {
+                return AVERROR_EOF;
+            }
+            const int count = static_cast<int>(std::min<int64_t>(bufSize, remaining));
+            std::memcpy(buf, reader->buffer->data() + reader->position, count);
+            reader->position += count;
+            return count;
+        }
+
+        int64_t seekMemory(void *opaque, int64_t offset, int whence)
+        {
+            MemoryReader *reader = static_cast<MemoryReader *>(opaque);
+            const int64_t size = reader->buffer->size();
+            whence &= ~AVSEEK_FORCE;
+            int64_t target = 0;
+            switch (whence)
+            {
+            case AVSEEK_SIZE:
+                return size;
+            case SEEK_SET:
+                target = offset;
+                break;
+            case SEEK_CUR:
+                target = reader->position + offset;
+                break;
+            case SEEK_END:
+                target = size + offset;
+                break;
+            default:
+                return AVERROR(EINVAL);
+            }
+            if (target < 0 || target > size)
+            {
+                return AVERROR(EINVAL);
+            }
+            reader->position = target;
+            return target;
+        }
+
+        void freeMemoryIo(AVIOContext *io)
+        {
+            if (!io)
+            {
+                return;
+            }
+            delete static_cast<MemoryReader *>(io->opaque);
+            av_freep(&io->buffer);
+            avio_context_free(&io);
+        }
+
+        void fileStamp(const std::string &path, int64_t &size, int64_t &mtime)
+        {
+            QFileInfo info(QString::fromStdString(path));
+            if (info.exists() && info.isFile())
+            {
+                size = info.size();
+                mtime = info.lastModified().toMSecsSinceEpoch();
+            }
+            else
+            {
+                size = -1;
+                mtime = -1;
+            }
+        }
+    } // namespace
+
+    MediaBuffer::~MediaBuffer()
+    {
+        if (m_file)
+        {
+            m_file->unmap(const_cast<uchar *>(m_data));
+        }
+    }
+
+    std::shared_ptr<const MediaBuffer> MediaBuffer::fromBytes(const QByteArray &bytes)
+    {
+        std::shared_ptr<MediaBuffer> buffer(new MediaBuffer());
+        buffer->m_bytes = bytes;
+        buffer->m_data = reinterpret_cast<const uint8_t *>(buffer->m_bytes.constData());
+        buffer->m_size = buffer->m_bytes.size();
+        return buffer;
+    }
+
+    std::shared_ptr<const MediaBuffer> MediaBuffer::mapFile(const std::string &path, std::string *error)
+    {
+        std::unique_ptr<QFile> file(new QFile(QString::fromStdString(path)));
+        if (!file->open(QIODevice::ReadOnly))
+        {
+            if (error)
+            {
+                *error = "无法打开文件: " + path;
+            }
+            return nullptr;
+        }
+        const qint64 size = file->size();
+        uchar *mapped = size > 0 ? file->map(0, size) : nullptr;
+        if (!mapped)
+        {
+            if (error)
+            {
+                *error = "无法映射文件: " + path;
+            }
+            return nullptr;
+        }
+        std::shared_ptr<MediaBuffer> buffer(new MediaBuffer());
+        buffer->m_file = std::move(file);
+        buffer->m_data = mapped;
+        buffer->m_size = size;
+        return buffer;
+    }
+
+    MediaSourceRegistry &MediaSourceRegistry::instance()
+    {
+        static MediaSourceRegistry registry;
+        return registry;
+    }
+
+    bool MediaSourceRegistry::add(const std::string &path, std::shared_ptr<const MediaBuffer> buffer)
+    {
+        const std::string key = MediaInfoCache::normalizedPath(path);
+        if (key.empty() || !buffer || buffer->size() <= 0)
+        {
+            return false;
+        }
+        Entry entry;
+        fileStamp(key, entry.fileSize, entry.fileMtime);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(key);
+        if (it != m_entries.end())
+        {
+            m_bytes -= it->second.buffer->size();
+            m_entries.erase(it);
+        }
+        if (buffer->size() > m_budget)
+        {
+            qDebug() << "媒体数据超过内存预算，不登记:" << key.c_str() << buffer->size();
+            return false;
+        }
+        entry.buffer = std::move(buffer);
+        entry.lastUse = ++m_useCounter;
+        entry.generation = ++m_generation;
+        m_bytes += entry.buffer->size();
+        m_entries[key] = std::move(entry);
+        evictLocked();
+        return true;
+    }
+
+    void MediaSourceRegistry::remove(const std::string &path)
+    {
+        const std::string key = MediaInfoCache::normalizedPath(path);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(key);
+        if (it != m_entries.end())
+        {
+            m_bytes -= it->second.buffer->size();
+            m_entries.erase(it);
+        }
+    }
+
+    void MediaSourceRegistry::clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.clear();
+        m_bytes = 0;
+    }
+
+    std::shared_ptr<const MediaBuffer> MediaSourceRegistry::find(const std::string &path, uint64_t *generation)
+    {
+        {
+            // 没有登记时不必规范化路径与查询文件状态
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_entries.empty())
+            {
+                return nullptr;
+            }
+        }
+        const std::string key = MediaInfoCache::normalizedPath(path);
+        int64_t size = -1;
+        int64_t mtime = -1;
+        fileStamp(key, size, mtime);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(key);
+        if (it == m_entries.end())
+        {
+            return nullptr;
+        }
+        if (it->second.fileSize != size || it->second.fileMtime != mtime)
+        {
+            // 登记之后磁盘文件被改写
+            m_bytes -= it->second.buffer->size();
+            m_entries.erase(it);
+            return nullptr;
+        }
+        it->second.lastUse = ++m_useCounter;
+        if (generation)
+        {
+            *generation = it->second.generation;
+        }
+        return it->second.buffer;
+    }
+
+    void MediaSourceRegistry::setBudget(int64_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_budget = std::max<int64_t>(0, bytes);
+        evictLocked();
+    }
+
+    int64_t MediaSourceRegistry::bytesInUse() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_bytes;
+    }
+
+    void MediaSourceRegistry::evictLocked()
+    {
+        while (m_bytes > m_budget && !m_entries.empty())
+        {
+            auto oldest = std::min_element(m_entries.begin(), m_entries.end(), [](const auto &a, const auto &b) {
+                return a.second.lastUse < b.second.lastUse;
+            });
+            m_bytes -= oldest->second.buffer->size();
+            m_entries.erase(oldest);
+        }
+    }
+
+    int MediaSourceRegistry::openInput(AVFormatContext **formatContext, const std::string &path)
+    {
+        if (auto buffer = instance().find(path))
+        {
+            return openInput(formatContext, buffer, path);
+        }
+        return avformat_open_input(formatContext, path.c_str(), nullptr, nullptr);
+    }
+
+    int MediaSourceRegistry::openInput(AVFormatContext **formatContext, const std::shared_ptr<const MediaBuffer> &buffer,
+                                       const std::string &name)
+    {
+        VC_TRACE_SCOPE("memory_open", "decode");
+        if (!buffer || buffer->size() <= 0)
+        {
+            return AVERROR(EINVAL);
+        }
+        uint8_t *ioBuffer = static_cast<uint8_t *>(av_malloc(kIoBufferSize));
+        if (!ioBuffer)
+        {
+            return AVERROR(ENOMEM);
+        }
+        MemoryReader *reader = new MemoryReader{buffer, 0};
+        AVIOContext *io = avio_alloc_context(ioBuffer, kIoBufferSize, 0, reader, readMemory, nullptr, seekMemory);
+        if (!io)
+        {
+            delete reader;
+            av_free(ioBuffer);
+            return AVERROR(ENOMEM);
+        }
+        AVFormatContext *context = avformat_alloc_context();
+        if (!context)
+        {
+            freeMemoryIo(io);
+            return AVERROR(ENOMEM);
+        }
+        context->pb = io;
+        context->flags |= AVFMT_FLAG_CUSTOM_IO;
+
+        // 失败时 avformat_open_input 释放 context，但不释放自定义的 pb
+        const int ret = avformat_open_input(&context, name.c_str(), nullptr, nullptr);
+        if (ret < 0)
+        {
+            freeMemoryIo(io);
+            return ret;
+        }
+        *formatContext = context;
+        return ret;
+    }
+
+    void MediaSourceRegistry::closeInput(AVFormatContext **formatContext)
+    {
+        if (!formatContext || !*formatContext)
+        {
+            return;
+        }
+        AVIOContext *io = ((*formatContext)->flags & AVFMT_FLAG_CUSTOM_IO) ? (*formatContext)->pb : nullptr;
+        avformat_close_input(formatContext);
+        freeMemoryIo(io);
+    }
+
+} // namespace VideoCreator
@@ -0,0 +1,104 @@
+#ifndef MEDIA_SOURCE_H
+#define MEDIA_SOURCE_H
+
+#include <QByteArray>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "ffmpeg_utils/FFmpegHeaders.h"
+
+class QFile;
+
+namespace VideoCreator
+{
+
+    // 只读的媒体字节：内存数据（QByteArray 隐式共享，不复制）或内存映射的文件，按引用计数共享
+    class MediaBuffer
+    {
+    public:
+        ~MediaBuffer();
+
+        static std::shared_ptr<const MediaBuffer> fromBytes(const QByteArray &bytes);
+
+        // 映射整个文件；失败时返回空
+        static std::shared_ptr<const MediaBuffer> mapFile(const std::string &path, std::string *error = nullptr);
+
+        const uint8_t *data() const { return m_data; }
+        int64_t size() const { return m_size; }
+
+    private:
+        MediaBuffer() = default;
+        MediaBuffer(const MediaBuffer &) = delete;
+        MediaBuffer &operator=(const MediaBuffer &) = delete;
+
+        QByteArray m_bytes;
+        std::unique_ptr<QFile> m_file; // 映射在文件关闭时解除
+        const uint8_t *m_data = nullptr;
+        int64_t m_size = 0;
+    };
+
+    /**
+     * MediaSourceRegistry - 以路径登记内存中的媒体数据（进程内共享）
+     *
+     * 刚下载的素材登记后，解码器与探测通过 openInput() 打开同一路径时，经自定义 AVIOContext 直接读取内存，
+     * 不再从磁盘重新读取；未登记的路径照常按文件打开。
+     * 登记时记下文件大小与修改时间，磁盘上的文件之后被改写时登记自动失效；路径可以不对应磁盘文件。
+     * 总字节数超过预算时淘汰最久未使用的数据，已打开的读取不受影响（数据按引用计数保留到关闭）。
+     */
+    class MediaSourceRegistry
+    {
+    public:
+        static MediaSourceRegistry &instance();
+
+        // 登记或替换 path 的数据；单份数据超过预算时不登记并返回 false
+        bool add(const std::string &path, std::shared_ptr<const MediaBuffer> buffer);
+        void remove(const std::string &path);
+        void clear();
+
+        // 已登记且未失效的数据，没有时返回空；generation（可选）写入该次登记的序号，每次 add 递增，
+        // 同一路径重新登记后序号不同，供 MediaInfoCache 判断内存数据是否变化
+        std::shared_ptr<const MediaBuffer> find(const std::string &path, uint64_t *generation = nullptr);
+
+        // 内存预算（字节），默认 256 MB
+        void setBudget(int64_t bytes);
+        int64_t bytesInUse() const;
+
+        // 打开 path：已登记时从内存读取，否则按文件打开；返回 avformat_open_input 的结果
+        static int openInput(AVFormatContext **formatContext, const std::string &path);
+
+        // 从 buffer 读取，name 只用于格式探测与日志
+        static int openInput(AVFormatContext **formatContext, const std::shared_ptr<const MediaBuffer> &buffer, const std::string &name);
+
+        // 关闭 openInput 打开的上下文（同时释放自定义 AVIOContext）
+        static void closeInput(AVFormatContext **formatContext);
+
+    private:
+        struct Entry
+        {
+            std::shared_ptr<const MediaBuffer> buffer;
+            int64_t fileSize = -1; // 登记时磁盘文件的大小与修改时间（毫秒），文件不存在时为 -1
+            int64_t fileMtime = -1;
+            uint64_t lastUse = 0;
+            uint64_t generation = 0;
+        };
+
+        MediaSourceRegistry() = default;
+        MediaSourceRegistry(const MediaSourceRegistry &) = delete;
+        MediaSourceRegistry &operator=(const MediaSourceRegistry &) = delete;
+
+        // 调用方需持有 m_mutex
+        void evictLocked();
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::string, Entry> m_entries;
+        int64_t m_budget = 256LL * 1024 * 1024;
+        int64_t m_bytes = 0;
+        uint64_t m_useCounter = 0;
+        uint64_t m_generation = 0;
+    };
+
+} // namespace VideoCreator
+
+#endif // MEDIA_SOURCE_H
@@ -0,0 +1,370 @@
+#include "SharedDemuxer.h"
+#include "MediaSource.h"
+#include "model/MediaInfoCache.h"
+#include "trace/TraceRecorder.h"
+#include <QDebug>
+#include <algorithm>
+
+namespace VideoCreator
+{
+
+    namespace
+    {
+        // 队列上限（包数）：视频约 2 秒，AAC 约 6 秒（1024 采样 / 包）
+        constexpr size_t kVideoPacketCapacity = 64;
+        constexpr size_t kAudioPacketCapacity = 256;
+    } // namespace
+
+    SharedDemuxer::~SharedDemuxer()
+    {
+        stop();
+        for (PacketQueue *queue : {&m_video, &m_audio})
+        {
+            if (queue->ownContext)
+            {
+                MediaSourceRegistry::closeInput(&queue->ownContext);
+            }
+        }
+        if (m_formatContext)
+        {
+            MediaSourceRegistry::closeInput(&m_formatContext);
+        }
+    }
+
+    bool SharedDemuxer::open(const std::string &filePath)
+    {
+        VC_TRACE_SCOPE("demux_open", "decode");
+        m_path = filePath;
+        if (MediaSourceRegistry::openInput(&m_formatContext, filePath) < 0)
+        {
+            m_errorString = "无法打开视频文件: " + filePath;
+            return false;
+        }
+
+        // 两个流都已探测过时直接复用流参数，跳过 avformat_find_stream_info
+        MediaInfoCache &mediaInfo = MediaInfoCache::instance();
+        auto videoInfo = mediaInfo.streamInfo(filePath, MediaKind::VIDEO);
+        auto audioInfo = mediaInfo.streamInfo(filePath, MediaKind::AUDIO);
+        if (videoInfo && audioInfo && MediaInfoCache::applyStreamInfo(m_formatContext, *videoInfo) &&
+            MediaInfoCache::applyStreamInfo(m_formatContext, *audioInfo))
+        {
+            m_video.streamIndex = videoInfo->streamIndex;
+            m_audio.streamIndex = audioInfo->streamIndex;
+        }
+        else
+        {
+            if (avformat_find_stream_info(m_formatContext, nullptr) < 0)
+            {
+                m_errorString = "无法获取视频流信息";
+                return false;
+            }
+            m_video.streamIndex = av_find_best_stream(m_formatContext, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+            if (m_video.streamIndex < 0)
+            {
+                m_errorString = "未找到视频流";
+                return false;
+            }
+            mediaInfo.storeStreamInfo(filePath, MediaKind::VIDEO, m_formatContext, m_video.streamIndex);
+            m_audio.streamIndex = av_find_best_stream(m_formatContext, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+            if (m_audio.streamIndex >= 0)
+            {
+                mediaInfo.storeStreamInfo(filePath, MediaKind::AUDIO, m_formatContext, m_audio.streamIndex);
+            }
+            else
+            {
+                m_audio.streamIndex = -1;
+            }
+        }
+        m_video.capacity = kVideoPacketCapacity;
+        m_audio.capacity = kAudioPacketCapacity;
+        return true;
+    }
+
+    SharedDemuxer::PacketQueue *SharedDemuxer::queueFor(int streamIndex)
+    {
+        if (streamIndex < 0)
+        {
+            return nullptr;
+        }
+        if (streamIndex == m_video.streamIndex)
+        {
+            return &m_video;
+        }
+        if (streamIndex == m_audio.streamIndex)
+        {
+            return &m_audio;
+        }
+        return nullptr;
+    }
+
+    void SharedDemuxer::attach(int streamIndex)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (PacketQueue *queue = queueFor(streamIndex))
+        {
+            queue->attached = true;
+        }
+    }
+
+    void SharedDemuxer::detach(int streamIndex)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (PacketQueue *queue = queueFor(streamIndex))
+            {
+                queue->attached = false;
+                queue->packets.clear();
+            }
+        }
+        m_cond.notify_all();
+    }
+
+    void SharedDemuxer::start()
+    {
+        if (!m_formatContext || m_reader.joinable())
+        {
+            return;
+        }
+        m_reader = std::thread([this]() {
+            readLoop();
+        });
+    }
+
+    void SharedDemuxer::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopRequested = true;
+        }
+        m_cond.notify_all();
+        if (m_reader.joinable())
+        {
+            m_reader.join();
+        }
+    }
+
+    bool SharedDemuxer::allQueuesFull() const
+    {
+        // 没有解码器接入或已转为自行读包时视为已满，不必读包
+        for (const PacketQueue *queue : {&m_video, &m_audio})
+        {
+            if (queue->attached && !queue->overflowed && queue->packets.size() < queue->capacity)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool SharedDemuxer::otherQueueStarving(const PacketQueue &full) const
+    {
+        for (const PacketQueue *queue : {&m_video, &m_audio})
+        {
+            if (queue != &full && queue->attached && !queue->overflowed && queue->packets.empty() && queue->waiting > 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void SharedDemuxer::readLoop()
+    {
+        VC_TRACE_THREAD_NAME("demux");
+        auto packet = FFmpegUtils::createAvPacket();
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cond.wait(lock, [&]() {
+                    return m_stopRequested || !allQueuesFull();
+                });
+                if (m_stopRequested)
+                {
+                    return;
+                }
+            }
+
+            int ret = 0;
+            {
+                VC_TRACE_SCOPE("demux_read", "decode");
+                ret = av_read_frame(m_formatContext, packet.get());
+            }
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (ret < 0)
+            {
+                m_readResult = ret;
+                m_finished = true;
+                lock.unlock();
+                m_cond.notify_all();
+                return;
+            }
+            PacketQueue *queue = queueFor(packet->stream_index);
+            if (queue && queue->attached && !queue->overflowed && queue->packets.size() >= queue->capacity)
+            {
+                // 队列满：等它腾出空间；另一方缺包等待时继续等会互相死锁，改由这一方自行读包
+                m_cond.wait(lock, [&]() {
+                    return m_stopRequested || !queue->attached || queue->packets.size() < queue->capacity ||
+                           otherQueueStarving(*queue);
+                });
+                if (m_stopRequested)
+                {
+                    return;
+                }
+                if (queue->attached && queue->packets.size() >= queue->capacity)
+                {
+                    queue->overflowed = true;
+                    qDebug() << "SharedDemuxer: 流" << queue->streamIndex << "队列已满且另一条流缺包，改为自行读包:"
+                             << m_path.c_str();
+                    lock.unlock();
+                    m_cond.notify_all();
+                    av_packet_unref(packet.get());
+                    continue;
+                }
+            }
+            if (queue && queue->attached && !queue->overflowed)
+            {
+                queue->lastPos = packet->pos;
+                queue->lastDts = packet->dts;
+                queue->packets.push_back(std::move(packet));
+                queue->peak = std::max(queue->peak, queue->packets.size());
+                packet = FFmpegUtils::createAvPacket();
+                lock.unlock();
+                m_cond.notify_all();
+            }
+            else
+            {
+                av_packet_unref(packet.get());
+            }
+        }
+    }
+
+    int SharedDemuxer::readPacket(int streamIndex, AVPacket *packet)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        PacketQueue *queue = queueFor(streamIndex);
+        if (!queue)
+        {
+            return AVERROR(EINVAL);
+        }
+        if (queue->packets.empty() && !queue->overflowed)
+        {
+            // 读包线程可能正阻塞在另一条满队列上，需要知道这一方在等包
+            ++queue->waiting;
+            m_cond.notify_all();
+            m_cond.wait(lock, [&]() {
+                return m_stopRequested || m_finished || queue->overflowed || !queue->packets.empty();
+            });
+            --queue->waiting;
+        }
+        if (!queue->packets.empty())
+        {
+            av_packet_move_ref(packet, queue->packets.front().get());
+            queue->packets.pop_front();
+            lock.unlock();
+            // 队列腾出空间，唤醒读包线程
+            m_cond.notify_all();
+            return 0;
+        }
+        if (m_stopRequested)
+        {
+            return AVERROR_EXIT;
+        }
+        if (queue->overflowed)
+        {
+            lock.unlock();
+            return readOwnPacket(*queue, packet);
+        }
+        return m_readResult;
+    }
+
+    int SharedDemuxer::readOwnPacket(PacketQueue &queue, AVPacket *packet)
+    {
+        // overflowed 之后读包线程不再改动 lastPos / lastDts，ownContext 只由本流的解码线程使用
+        if (!queue.ownContext)
+        {
+            VC_TRACE_SCOPE("demux_reopen", "decode");
+            int ret = MediaSourceRegistry::openInput(&queue.ownContext, m_path);
+            if (ret < 0)
+            {
+                return ret;
+            }
+            if (queue.streamIndex >= static_cast<int>(queue.ownContext->nb_streams) &&
+                (ret = avformat_find_stream_info(queue.ownContext, nullptr)) < 0)
+            {
+                return ret;
+            }
+            if (queue.streamIndex >= static_cast<int>(queue.ownContext->nb_streams))
+            {
+                return AVERROR_STREAM_NOT_FOUND;
+            }
+            // 定位到最后入队的包之前的关键帧（失败则从头读），再跳过已经交给解码器的包
+            if (queue.lastDts != AV_NOPTS_VALUE)
+            {
+                av_seek_frame(queue.ownContext, queue.streamIndex, queue.lastDts, AVSEEK_FLAG_BACKWARD);
+            }
+            queue.skipping = queue.lastPos >= 0 || queue.lastDts != AV_NOPTS_VALUE;
+        }
+
+        while (true)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_stopRequested)
+                {
+                    return AVERROR_EXIT;
+                }
+            }
+            int ret = 0;
+            {
+                VC_TRACE_SCOPE("demux_read_own", "decode");
+                ret = av_read_frame(queue.ownContext, packet);
+            }
+            if (ret < 0)
+            {
+                return ret;
+            }
+            if (packet->stream_index != queue.streamIndex)
+            {
+                av_packet_unref(packet);
+                continue;
+            }
+            if (queue.skipping)
+            {
+                const bool delivered = (queue.lastPos >= 0 && packet->pos >= 0)
+                                           ? packet->pos <= queue.lastPos
+                                           : (packet->dts != AV_NOPTS_VALUE && packet->dts <= queue.lastDts);
+                if (delivered)
+                {
+                    av_packet_unref(packet);
+                    continue;
+                }
+                queue.skipping = false;
+            }
+            return 0;
+        }
+    }
+
+    size_t SharedDemuxer::queueCapacity(int streamIndex)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const PacketQueue *queue = queueFor(streamIndex);
+        return queue ? queue->capacity : 0;
+    }
+
+    size_t SharedDemuxer::peakQueuedPackets(int streamIndex)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const PacketQueue *queue = queueFor(streamIndex);
+        return queue ? queue->peak : 0;
+    }
+
+    bool SharedDemuxer::isReadingOwnPackets(int streamIndex)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const PacketQueue *queue = queueFor(streamIndex);
+        return queue && queue->overflowed;
+    }
+
+} // namespace VideoCreator
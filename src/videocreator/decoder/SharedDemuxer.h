@@ -0,0 +1,100 @@
+#ifndef SHARED_DEMUXER_H
+#define SHARED_DEMUXER_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "ffmpeg_utils/FFmpegHeaders.h"
+#include "ffmpeg_utils/AvPacketWrapper.h"
+
+namespace VideoCreator
+{
+
+    /**
+     * SharedDemuxer - 一次解复用，供同一文件的视频与音频解码器共用
+     *
+     * 视频场景使用原视频音轨（use_audio）时，原先 VideoDecoder 与 AudioDecoder 各自打开并解析同一个文件。
+     * 现在由一个读包线程读取一次，按流分发到有界包队列，解码器通过 readPacket() 取包。
+     *
+     * 每个队列都不超过上限：读到的包所属队列已满时，读包线程等待该队列腾出空间。若此时另一条流的解码器
+     * 正因队列为空而等待（交织偏差超过队列容量，或一方解码器停滞），继续等待会互相死锁，于是满的一方改为自行读包：
+     * 共享读包线程丢弃它之后的包，它的解码器取完已入队的包后重新打开文件，定位到最后入队的包之后继续读。
+     * 打开后 formatContext() 的流参数只读；读包线程运行期间不支持跳转。
+     */
+    class SharedDemuxer
+    {
+    public:
+        SharedDemuxer() = default;
+        ~SharedDemuxer();
+
+        // 打开文件并定位视频流与音频流（音频流可缺失）
+        bool open(const std::string &filePath);
+
+        // 解码器接入 / 断开某个流；未接入的流的包直接丢弃，断开时清空该队列
+        void attach(int streamIndex);
+        void detach(int streamIndex);
+
+        // 启动读包线程，须在所有解码器接入之后调用
+        void start();
+
+        // 停止读包线程，唤醒所有等待取包的解码器
+        void stop();
+
+        // 取该流的下一个包：0 成功，AVERROR_EOF 文件结束，AVERROR_EXIT 已停止，其他为读包错误
+        int readPacket(int streamIndex, AVPacket *packet);
+
+        // 该流队列的容量与曾达到的最大包数，以及是否已转为自行读包（基准测试用）
+        size_t queueCapacity(int streamIndex);
+        size_t peakQueuedPackets(int streamIndex);
+        bool isReadingOwnPackets(int streamIndex);
+
+        AVFormatContext *formatContext() const { return m_formatContext; }
+        int videoStreamIndex() const { return m_video.streamIndex; }
+        int audioStreamIndex() const { return m_audio.streamIndex; }
+        const std::string &path() const { return m_path; }
+        std::string getErrorString() const { return m_errorString; }
+
+    private:
+        SharedDemuxer(const SharedDemuxer &) = delete;
+        SharedDemuxer &operator=(const SharedDemuxer &) = delete;
+
+        struct PacketQueue
+        {
+            int streamIndex = -1;
+            size_t capacity = 0;
+            size_t peak = 0;
+            bool attached = false;
+            int waiting = 0;                   // 阻塞在 readPacket 中等包的解码器数
+            bool overflowed = false;           // 已转为自行读包，共享读包线程不再向此队列分发
+            int64_t lastPos = -1;              // 最后入队的包的文件位置与 dts，自行读包时从其后继续
+            int64_t lastDts = AV_NOPTS_VALUE;
+            AVFormatContext *ownContext = nullptr; // 自行读包的上下文，只由该流的解码线程使用
+            bool skipping = false;             // 正在跳过已经入过队的包
+            std::deque<FFmpegUtils::AvPacketPtr> packets;
+        };
+
+        PacketQueue *queueFor(int streamIndex);
+        bool allQueuesFull() const;
+        bool otherQueueStarving(const PacketQueue &full) const;
+        void readLoop();
+        int readOwnPacket(PacketQueue &queue, AVPacket *packet);
+
+        AVFormatContext *m_formatContext = nullptr;
+        std::string m_path;
+        std::string m_errorString;
+
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+        PacketQueue m_video;
+        PacketQueue m_audio;
+        bool m_stopRequested = false;
+        bool m_finished = false;
+        int m_readResult = 0; // 读包线程结束时的 av_read_frame 返回值
+        std::thread m_reader;
+    };
+
+} // namespace VideoCreator
+
+#endif // SHARED_DEMUXER_H
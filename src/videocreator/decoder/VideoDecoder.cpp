@@ -1,13 +1,19 @@
 #include "VideoDecoder.h"
+#include "MediaSource.h"
+#include "SharedDemuxer.h"
 #include <QDebug>
 #include "ffmpeg_utils/AvPacketWrapper.h"
+#include "trace/TraceRecorder.h"
+#include <algorithm>
+#include <thread>
 
 namespace VideoCreator
 {
 
     VideoDecoder::VideoDecoder()
         : m_formatContext(nullptr), m_codecContext(nullptr), m_swsContext(nullptr),
-          m_videoStreamIndex(-1), m_timeBase{1, 1}, m_frameRate(0.0), m_duration(0)
+          m_videoStreamIndex(-1), m_timeBase{1, 1}, m_frameRate(0.0), m_duration(0),
+          m_threadCount(1), m_threadType(FF_THREAD_FRAME | FF_THREAD_SLICE)
     {
     }
 
@@ -16,29 +22,109 @@ namespace VideoCreator
         cleanup();
     }
 
+    bool VideoDecoder::resolveThreading(const VideoDecodingConfig &config, int threadBudget, int &threadCount, int &threadType,
+                                        std::string *error)
+    {
+        if (config.thread_type.empty())
+        {
+            // 帧级吞吐最高；编码格式不支持时 FFmpeg 自动退回片级
+            threadType = FF_THREAD_FRAME | FF_THREAD_SLICE;
+        }
+        else if (config.thread_type == "frame")
+        {
+            threadType = FF_THREAD_FRAME;
+        }
+        else if (config.thread_type == "slice")
+        {
+            // 片级不增加延迟，但只有多 slice 编码的素材才能并行
+            threadType = FF_THREAD_SLICE;
+        }
+        else
+        {
+            if (error)
+            {
+                *error = "未知的解码线程模式: " + config.thread_type;
+            }
+            return false;
+        }
+
+        if (config.threads > 0)
+        {
+            threadCount = config.threads;
+            return true;
+        }
+        int total = threadBudget;
+        if (total <= 0)
+        {
+            const unsigned int hardware = std::thread::hardware_concurrency();
+            total = hardware > 0 ? static_cast<int>(hardware) : 4;
+        }
+        // 解码占预算的四分之一、最多 4 线程：帧级线程每多一个就多缓存一帧，H.264 超过 4 线程收益已很小，其余留给编码器
+        threadCount = std::clamp(total / 4, 1, 4);
+        return true;
+    }
+
     bool VideoDecoder::open(const std::string &filePath)
     {
-        if (avformat_open_input(&m_formatContext, filePath.c_str(), nullptr, nullptr) < 0)
+        VC_TRACE_SCOPE("video_open", "decode");
+        if (MediaSourceRegistry::openInput(&m_formatContext, filePath) < 0)
         {
             m_errorString = "无法打开视频文件: " + filePath;
             return false;
         }
 
-        if (avformat_find_stream_info(m_formatContext, nullptr) < 0)
+        // 已探测过的文件直接复用流参数，跳过 avformat_find_stream_info
+        MediaInfoCache &mediaInfo = MediaInfoCache::instance();
+        m_streamInfo = mediaInfo.streamInfo(filePath, MediaKind::VIDEO);
+        if (m_streamInfo && MediaInfoCache::applyStreamInfo(m_formatContext, *m_streamInfo))
         {
-            m_errorString = "无法获取视频流信息";
-            cleanup();
-            return false;
+            m_videoStreamIndex = m_streamInfo->streamIndex;
         }
+        else
+        {
+            if (avformat_find_stream_info(m_formatContext, nullptr) < 0)
+            {
+                m_errorString = "无法获取视频流信息";
+                cleanup();
+                return false;
+            }
 
-        m_videoStreamIndex = av_find_best_stream(m_formatContext, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
-        if (m_videoStreamIndex < 0)
+            m_videoStreamIndex = av_find_best_stream(m_formatContext, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+            if (m_videoStreamIndex < 0)
+            {
+                m_errorString = "未找到视频流";
+                cleanup();
+                return false;
+            }
+            mediaInfo.storeStreamInfo(filePath, MediaKind::VIDEO, m_formatContext, m_videoStreamIndex);
+            m_streamInfo = mediaInfo.streamInfo(filePath, MediaKind::VIDEO);
+        }
+
+        return openCodec();
+    }
+
+    bool VideoDecoder::open(const std::shared_ptr<SharedDemuxer> &demuxer)
+    {
+        VC_TRACE_SCOPE("video_open", "decode");
+        if (!demuxer || !demuxer->formatContext() || demuxer->videoStreamIndex() < 0)
+        {
+            m_errorString = "共享解复用器未打开视频流";
+            return false;
+        }
+        m_demuxer = demuxer;
+        m_formatContext = demuxer->formatContext();
+        m_videoStreamIndex = demuxer->videoStreamIndex();
+        m_streamInfo = MediaInfoCache::instance().streamInfo(demuxer->path(), MediaKind::VIDEO);
+        if (!openCodec())
         {
-            m_errorString = "未找到视频流";
-            cleanup();
             return false;
         }
+        m_demuxer->attach(m_videoStreamIndex);
+        return true;
+    }
 
+    bool VideoDecoder::openCodec()
+    {
         AVStream *videoStream = m_formatContext->streams[m_videoStreamIndex];
         const AVCodec *codec = avcodec_find_decoder(videoStream->codecpar->codec_id);
         if (!codec)
@@ -63,6 +149,9 @@ namespace VideoCreator
             return false;
         }
 
+        m_codecContext->thread_count = m_threadCount;
+        m_codecContext->thread_type = m_threadType;
+
         if (avcodec_open2(m_codecContext, codec, nullptr) < 0)
         {
             m_errorString = "无法打开视频解码器";
@@ -80,7 +169,7 @@ namespace VideoCreator
             m_duration = m_formatContext->duration;
         }
 
-        AVRational guess = av_guess_frame_rate(m_formatContext, videoStream, nullptr);
+        AVRational guess = m_streamInfo ? m_streamInfo->frameRate : av_guess_frame_rate(m_formatContext, videoStream, nullptr);
         if (guess.num > 0 && guess.den > 0)
         {
             m_frameRate = av_q2d(guess);
@@ -99,6 +188,7 @@ namespace VideoCreator
 
     int VideoDecoder::decodeFrame(FFmpegUtils::AvFramePtr &frame)
     {
+        VC_TRACE_SCOPE("video_decode", "decode");
         if (!m_formatContext || !m_codecContext)
         {
             m_errorString = "视频解码器未初始化";
@@ -129,7 +219,7 @@ namespace VideoCreator
 
             while (true)
             {
-                ret = av_read_frame(m_formatContext, packet.get());
+                ret = readPacket(packet.get());
                 if (ret < 0)
                 {
                     avcodec_send_packet(m_codecContext, nullptr);
@@ -152,8 +242,18 @@ namespace VideoCreator
         }
     }
 
+    int VideoDecoder::readPacket(AVPacket *packet)
+    {
+        if (m_demuxer)
+        {
+            return m_demuxer->readPacket(m_videoStreamIndex, packet);
+        }
+        return av_read_frame(m_formatContext, packet);
+    }
+
     FFmpegUtils::AvFramePtr VideoDecoder::scaleFrame(const AVFrame *frame, int targetWidth, int targetHeight, AVPixelFormat targetFormat)
     {
+        VC_TRACE_SCOPE("video_scale", "scale");
         if (!frame)
         {
             m_errorString = "源视频帧为空";
@@ -206,6 +306,65 @@ namespace VideoCreator
         return scaledFrame;
     }
 
+    bool VideoDecoder::seek(double timestamp)
+    {
+        VC_TRACE_SCOPE("video_seek", "decode");
+        if (!m_formatContext || !m_codecContext || m_videoStreamIndex < 0)
+        {
+            m_errorString = "视频解码器未初始化";
+            return false;
+        }
+        if (m_demuxer)
+        {
+            m_errorString = "共享解复用时不支持跳转";
+            return false;
+        }
+
+        int64_t targetTs = static_cast<int64_t>(std::max(0.0, timestamp) / av_q2d(m_timeBase));
+        AVStream *videoStream = m_formatContext->streams[m_videoStreamIndex];
+        if (videoStream->start_time != AV_NOPTS_VALUE)
+        {
+            targetTs += videoStream->start_time;
+        }
+        if (av_seek_frame(m_formatContext, m_videoStreamIndex, targetTs, AVSEEK_FLAG_BACKWARD) < 0)
+        {
+            m_errorString = "视频跳转失败";
+            return false;
+        }
+        avcodec_flush_buffers(m_codecContext);
+        return true;
+    }
+
+    double VideoDecoder::frameTimestamp(const AVFrame *frame) const
+    {
+        if (!frame || !m_formatContext || m_videoStreamIndex < 0)
+        {
+            return -1.0;
+        }
+        int64_t pts = frame->best_effort_timestamp != AV_NOPTS_VALUE ? frame->best_effort_timestamp : frame->pts;
+        if (pts == AV_NOPTS_VALUE)
+        {
+            return -1.0;
+        }
+        AVStream *videoStream = m_formatContext->streams[m_videoStreamIndex];
+        if (videoStream->start_time != AV_NOPTS_VALUE)
+        {
+            pts -= videoStream->start_time;
+        }
+        return pts * av_q2d(m_timeBase);
+    }
+
+    double VideoDecoder::keyframeBefore(double timestamp) const
+    {
+        if (!m_streamInfo || m_streamInfo->keyframes.empty())
+        {
+            return -1.0;
+        }
+        const auto &keyframes = m_streamInfo->keyframes;
+        auto it = std::upper_bound(keyframes.begin(), keyframes.end(), timestamp);
+        return it == keyframes.begin() ? 0.0 : *(it - 1);
+    }
+
     double VideoDecoder::getDuration() const
     {
         if (!m_formatContext || m_videoStreamIndex < 0)
@@ -238,13 +397,21 @@ namespace VideoCreator
             avcodec_free_context(&m_codecContext);
             m_codecContext = nullptr;
         }
-        if (m_formatContext)
+        if (m_demuxer)
+        {
+            // 格式上下文归共享解复用器所有
+            m_demuxer->detach(m_videoStreamIndex);
+            m_demuxer.reset();
+            m_formatContext = nullptr;
+        }
+        else if (m_formatContext)
         {
-            avformat_close_input(&m_formatContext);
+            MediaSourceRegistry::closeInput(&m_formatContext);
             m_formatContext = nullptr;
         }
         m_videoStreamIndex = -1;
         m_duration = 0;
+        m_streamInfo.reset();
     }
 
 } // namespace VideoCreator
@@ -1,27 +1,55 @@
 #ifndef VIDEO_DECODER_H
 #define VIDEO_DECODER_H
 
+#include <memory>
 #include <string>
 #include "ffmpeg_utils/FFmpegHeaders.h"
 #include "ffmpeg_utils/AvFrameWrapper.h"
+#include "model/MediaInfoCache.h"
+#include "model/ProjectConfig.h"
 
 namespace VideoCreator
 {
 
+    class SharedDemuxer;
+
     class VideoDecoder
     {
     public:
         VideoDecoder();
         ~VideoDecoder();
 
+        // 解码线程数与模式（FF_THREAD_FRAME / FF_THREAD_SLICE 的组合），须在 open() 之前设置；默认单线程
+        void setThreading(int threadCount, int threadType)
+        {
+            m_threadCount = threadCount;
+            m_threadType = threadType;
+        }
+
+        // 按配置与线程预算推导解码线程；threadBudget <= 0 表示未由调用方分配，按硬件线程数
+        static bool resolveThreading(const VideoDecodingConfig &config, int threadBudget, int &threadCount, int &threadType,
+                                     std::string *error = nullptr);
+
         bool open(const std::string &filePath);
 
+        // 从共享解复用器读取视频流（与同文件的 AudioDecoder 共用），此时不支持 seek()
+        bool open(const std::shared_ptr<SharedDemuxer> &demuxer);
+
         // 解码下一帧原始画面
         int decodeFrame(FFmpegUtils::AvFramePtr &frame);
 
         // 将帧缩放/转换成目标尺寸与像素格式
         FFmpegUtils::AvFramePtr scaleFrame(const AVFrame *frame, int targetWidth, int targetHeight, AVPixelFormat targetFormat = AV_PIX_FMT_YUV420P);
 
+        // 跳转到指定时间戳 (秒)，定位到其之前最近的关键帧
+        bool seek(double timestamp);
+
+        // 解码帧的显示时间 (秒)，无时间戳时返回 -1
+        double frameTimestamp(const AVFrame *frame) const;
+
+        // 不晚于 timestamp 的最近关键帧时间 (秒)，容器没有索引时返回 -1
+        double keyframeBefore(double timestamp) const;
+
         double getDuration() const;
         double getFrameRate() const { return m_frameRate; }
         void close();
@@ -31,6 +59,10 @@ namespace VideoCreator
         int sourceHeight() const { return m_codecContext ? m_codecContext->height : 0; }
         AVPixelFormat sourceFormat() const { return m_codecContext ? m_codecContext->pix_fmt : AV_PIX_FMT_NONE; }
 
+        // 解码器实际启用的线程数与模式（open 之后有效；编码格式不支持帧级线程时会退回片级或单线程）
+        int activeThreadCount() const { return m_codecContext ? m_codecContext->thread_count : 0; }
+        int activeThreadType() const { return m_codecContext ? m_codecContext->active_thread_type : 0; }
+
     private:
         AVFormatContext *m_formatContext;
         AVCodecContext *m_codecContext;
@@ -39,9 +71,15 @@ namespace VideoCreator
         AVRational m_timeBase;
         double m_frameRate;
         int64_t m_duration;
+        std::shared_ptr<const MediaStreamInfo> m_streamInfo;
+        int m_threadCount;
+        int m_threadType;
+        std::shared_ptr<SharedDemuxer> m_demuxer;
 
         std::string m_errorString;
 
+        bool openCodec();
+        int readPacket(AVPacket *packet);
         void cleanup();
     };
 
@@ -0,0 +1,328 @@
+#include "AsyncOutputFile.h"
+#include "trace/TraceRecorder.h"
+#include <QDebug>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <fcntl.h>
+#endif
+
+namespace VideoCreator
+{
+
+    namespace
+    {
+        // 封装器与 AVIOContext 之间的小缓冲，满了才回调 writePacket，拷贝进大块
+        constexpr int kIoBufferSize = 256 * 1024;
+        constexpr size_t kMinBlockSize = 1024 * 1024;
+        // 每次预留的块数；O_DIRECT 未采用：封装器回写文件头的偏移与长度任意，对齐读改写的代价大于省下的页缓存拷贝
+        constexpr int64_t kPreallocateBlocks = 4;
+
+        double secondsSince(std::chrono::steady_clock::time_point start)
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+    } // namespace
+
+    AsyncOutputFile::~AsyncOutputFile()
+    {
+        if (m_io && !close(false))
+        {
+            qDebug() << "AsyncOutputFile: 关闭时出错:" << m_errorString.c_str();
+        }
+    }
+
+    bool AsyncOutputFile::open(const std::string &path, size_t blockSize, int maxPendingBlocks, bool flushEachWrite)
+    {
+        m_file.setFileName(QString::fromStdString(path));
+        // 大块直接写入，不经过 QFile 自己的缓冲
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered))
+        {
+            m_errorString = "无法打开输出文件: " + path + " (" + m_file.errorString().toStdString() + ")";
+            return false;
+        }
+        m_blockSize = std::max(blockSize, kMinBlockSize);
+        m_allocated = 0;
+        m_canPreallocate = true;
+        m_maxPending = static_cast<size_t>(std::max(1, maxPendingBlocks));
+        m_flushEachWrite = flushEachWrite;
+
+        uint8_t *ioBuffer = static_cast<uint8_t *>(av_malloc(kIoBufferSize));
+        m_io = ioBuffer ? avio_alloc_context(ioBuffer, kIoBufferSize, 1, this, nullptr, writePacket, seek) : nullptr;
+        if (!m_io)
+        {
+            av_free(ioBuffer);
+            m_file.close();
+            m_errorString = "无法创建输出 AVIOContext";
+            return false;
+        }
+        m_thread = std::thread(&AsyncOutputFile::ioLoop, this);
+        return true;
+    }
+
+    bool AsyncOutputFile::close(bool sync)
+    {
+        if (!m_io)
+        {
+            return !m_failed;
+        }
+        avio_flush(m_io);
+        submit(true);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopRequested = true;
+        }
+        m_cond.notify_all();
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+        av_freep(&m_io->buffer);
+        avio_context_free(&m_io);
+        m_current = Block();
+        m_free.clear();
+
+        if (sync && !m_failed)
+        {
+            VC_TRACE_SCOPE("output_sync", "mux");
+            // 只在结束时落盘一次
+#ifdef _WIN32
+            const int ret = _commit(m_file.handle());
+#else
+            const int ret = ::fsync(m_file.handle());
+#endif
+            if (ret != 0)
+            {
+                m_failed = true;
+                m_errorString = "输出文件落盘失败";
+            }
+        }
+        m_file.close();
+        return !m_failed;
+    }
+
+    int AsyncOutputFile::writePacket(void *opaque, const uint8_t *buf, int size)
+    {
+        return static_cast<AsyncOutputFile *>(opaque)->write(buf, size);
+    }
+
+    int64_t AsyncOutputFile::seek(void *opaque, int64_t offset, int whence)
+    {
+        AsyncOutputFile *self = static_cast<AsyncOutputFile *>(opaque);
+        whence &= ~AVSEEK_FORCE;
+        int64_t target = 0;
+        switch (whence)
+        {
+        case AVSEEK_SIZE:
+            return self->m_size;
+        case SEEK_SET:
+            target = offset;
+            break;
+        case SEEK_CUR:
+            target = self->m_position + offset;
+            break;
+        case SEEK_END:
+            target = self->m_size + offset;
+            break;
+        default:
+            return AVERROR(EINVAL);
+        }
+        if (target < 0)
+        {
+            return AVERROR(EINVAL);
+        }
+        if (target != self->m_position)
+        {
+            // 之后的数据属于新的一块，从 target 开始写
+            if (!self->submit(true))
+            {
+                return AVERROR(EIO);
+            }
+            self->m_position = target;
+        }
+        return target;
+    }
+
+    int AsyncOutputFile::write(const uint8_t *data, int size)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_failed)
+            {
+                return AVERROR(EIO);
+            }
+        }
+        const int written = size;
+        while (size > 0)
+        {
+            if (!m_current.data && !takeFreeBlock())
+            {
+                return AVERROR(ENOMEM);
+            }
+            if (m_current.size == 0)
+            {
+                m_current.offset = m_position;
+            }
+            const size_t chunk = std::min(static_cast<size_t>(size), m_blockSize - m_current.size);
+            std::memcpy(m_current.data.get() + m_current.size, data, chunk);
+            m_current.size += chunk;
+            m_position += static_cast<int64_t>(chunk);
+            data += chunk;
+            size -= static_cast<int>(chunk);
+            if (m_current.size == m_blockSize && !submit(true))
+            {
+                return AVERROR(EIO);
+            }
+        }
+        m_size = std::max(m_size, m_position);
+        if (m_flushEachWrite)
+        {
+            submit(false);
+        }
+        return written;
+    }
+
+    bool AsyncOutputFile::submit(bool wait)
+    {
+        if (!m_current.data || m_current.size == 0)
+        {
+            return true;
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!wait && (m_writing || !m_pending.empty()))
+        {
+            // I/O 线程忙，继续合并到当前块
+            return false;
+        }
+        if (m_pending.size() >= m_maxPending && !m_failed)
+        {
+            VC_TRACE_SCOPE("output_stall", "mux");
+            const auto start = std::chrono::steady_clock::now();
+            m_cond.wait(lock, [this] { return m_pending.size() < m_maxPending || m_failed; });
+            ++m_stats.stalls;
+            m_stats.stallSeconds += secondsSince(start);
+        }
+        if (m_failed)
+        {
+            return false;
+        }
+        m_pending.push_back(std::move(m_current));
+        m_current = Block();
+        lock.unlock();
+        m_cond.notify_all();
+        return true;
+    }
+
+    bool AsyncOutputFile::takeFreeBlock()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_free.empty())
+            {
+                m_current = std::move(m_free.back());
+                m_free.pop_back();
+            }
+        }
+        if (!m_current.data)
+        {
+            m_current.data.reset(static_cast<uint8_t *>(av_malloc(m_blockSize)));
+            if (!m_current.data)
+            {
+                return false;
+            }
+        }
+        m_current.size = 0;
+        m_current.offset = m_position;
+        return true;
+    }
+
+    void AsyncOutputFile::ioLoop()
+    {
+        while (true)
+        {
+            Block block;
+            bool skip = false;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cond.wait(lock, [this] { return !m_pending.empty() || m_stopRequested; });
+                if (m_pending.empty())
+                {
+                    break;
+                }
+                block = std::move(m_pending.front());
+                m_pending.pop_front();
+                m_writing = true;
+                skip = m_failed;
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            bool ok = true;
+            if (!skip)
+            {
+                VC_TRACE_SCOPE("output_write", "mux");
+                preallocate(block.offset + static_cast<int64_t>(block.size));
+                ok = m_file.seek(block.offset) &&
+                     m_file.write(reinterpret_cast<const char *>(block.data.get()), static_cast<qint64>(block.size)) == static_cast<qint64>(block.size);
+                const int64_t end = block.offset + static_cast<int64_t>(block.size);
+                if (ok && end > m_writtenEnd.load(std::memory_order_relaxed))
+                {
+                    m_writtenEnd.store(end, std::memory_order_release);
+                }
+            }
+            const double seconds = secondsSince(start);
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_writing = false;
+                if (!skip)
+                {
+                    m_stats.ioSeconds += seconds;
+                    ++m_stats.blocks;
+                    m_stats.bytes += static_cast<int64_t>(block.size);
+                }
+                if (!ok && !m_failed)
+                {
+                    // 之后的块不再写入，渲染线程下一次写入时返回错误
+                    m_failed = true;
+                    m_errorString = "写入输出文件失败: " + m_file.errorString().toStdString();
+                }
+                block.size = 0;
+                m_free.push_back(std::move(block));
+            }
+            m_cond.notify_all();
+        }
+    }
+
+    void AsyncOutputFile::preallocate(int64_t end)
+    {
+#ifdef __linux__
+        if (!m_canPreallocate || end <= m_allocated)
+        {
+            return;
+        }
+        // KEEP_SIZE：只预留空间不改文件长度，中途失败或估计过多都不会在文件末尾留下零字节
+        const int64_t target = std::max(end, m_allocated + kPreallocateBlocks * static_cast<int64_t>(m_blockSize));
+        VC_TRACE_SCOPE("output_preallocate", "mux");
+        if (::fallocate(m_file.handle(), FALLOC_FL_KEEP_SIZE, m_allocated, target - m_allocated) != 0)
+        {
+            // 文件系统不支持（如部分网络文件系统）或空间不足时不再尝试，由写入本身报告错误
+            m_canPreallocate = false;
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.preallocatedBytes += target - m_allocated;
+        }
+        m_allocated = target;
+#else
+        (void)end;
+#endif
+    }
+
+} // namespace VideoCreator
@@ -0,0 +1,115 @@
+#ifndef ASYNC_OUTPUT_FILE_H
+#define ASYNC_OUTPUT_FILE_H
+
+#include <QFile>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ffmpeg_utils/FFmpegHeaders.h"
+
+namespace VideoCreator
+{
+
+    /**
+     * AsyncOutputFile - 封装器的写后台输出（自定义 AVIOContext）
+     *
+     * 封装器写出的数据先追加到大块缓冲（av_malloc 对齐），写满一块即交给独立的 I/O 线程写盘，渲染线程只做内存拷贝；
+     * 待写块达到上限（磁盘跟不上）时渲染线程才等待，等待计入 Stats。每块记录自己的文件偏移，
+     * 封装器回写文件头（mp4 的 mdat 大小等）时从新偏移开始新的一块，无需等待之前的块写完。
+     * flushEachWrite 时 I/O 线程空闲就立即交出当前块，fMP4 分片尽快落盘供边写边播；磁盘慢时仍会合并成大块。
+     * Linux 上 I/O 线程按块大小提前为文件预留磁盘空间（fallocate KEEP_SIZE，不改变文件长度），减少碎片与写时分配。
+     * 只由一个线程（渲染线程）写入。
+     */
+    class AsyncOutputFile
+    {
+    public:
+        struct Stats
+        {
+            int64_t bytes = 0;
+            int64_t blocks = 0;          // I/O 线程写盘次数
+            int64_t stalls = 0;          // 渲染线程因待写块已满而等待的次数
+            double stallSeconds = 0.0;
+            double ioSeconds = 0.0;      // I/O 线程写盘耗时
+            int64_t preallocatedBytes = 0; // fallocate 预留的字节数，不支持时为 0
+        };
+
+        AsyncOutputFile() = default;
+        ~AsyncOutputFile();
+
+        // 创建（截断）输出文件并启动 I/O 线程；blockSize 为每块字节数，maxPendingBlocks 为待写块上限
+        bool open(const std::string &path, size_t blockSize, int maxPendingBlocks, bool flushEachWrite);
+
+        // 供 AVFormatContext::pb 使用，须同时设置 AVFMT_FLAG_CUSTOM_IO；close 后失效
+        AVIOContext *ioContext() const { return m_io; }
+
+        // 写出剩余数据、等待 I/O 线程结束并关闭文件；sync 时关闭前把文件数据落盘
+        bool close(bool sync);
+
+        bool isOpen() const { return m_io != nullptr; }
+        const Stats &stats() const { return m_stats; }
+        // I/O 线程已写入文件的最大偏移，渲染线程可随时读取
+        int64_t writtenEnd() const { return m_writtenEnd.load(std::memory_order_acquire); }
+        std::string getErrorString() const { return m_errorString; }
+
+    private:
+        AsyncOutputFile(const AsyncOutputFile &) = delete;
+        AsyncOutputFile &operator=(const AsyncOutputFile &) = delete;
+
+        struct BufferDeleter
+        {
+            void operator()(uint8_t *data) const { av_free(data); }
+        };
+
+        struct Block
+        {
+            std::unique_ptr<uint8_t, BufferDeleter> data;
+            size_t size = 0;
+            int64_t offset = 0; // 块在文件中的起始位置
+        };
+
+        static int writePacket(void *opaque, const uint8_t *buf, int size);
+        static int64_t seek(void *opaque, int64_t offset, int whence);
+
+        int write(const uint8_t *data, int size);
+        // 交出当前块；wait 为 false 且待写块已满时不交出，返回 false
+        bool submit(bool wait);
+        bool takeFreeBlock();
+        void ioLoop();
+        void preallocate(int64_t end);
+
+        QFile m_file;
+        AVIOContext *m_io = nullptr;
+        size_t m_blockSize = 0;
+        size_t m_maxPending = 0;
+        bool m_flushEachWrite = false;
+
+        Block m_current;        // 渲染线程正在填充的块
+        int64_t m_position = 0; // 下一次写入的文件偏移
+        int64_t m_size = 0;     // 已写入的最大偏移
+
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+        std::deque<Block> m_pending;
+        std::vector<Block> m_free;
+        bool m_writing = false; // I/O 线程正在写一块
+        bool m_stopRequested = false;
+        bool m_failed = false;
+        std::thread m_thread;
+
+        int64_t m_allocated = 0;      // 已预留到的文件偏移，只由 I/O 线程使用
+        bool m_canPreallocate = true; // 文件系统不支持时关闭
+
+        Stats m_stats;
+        std::atomic<int64_t> m_writtenEnd{0};
+        std::string m_errorString;
+    };
+
+} // namespace VideoCreator
+
+#endif // ASYNC_OUTPUT_FILE_H
@@ -0,0 +1,173 @@
+#include "AudioCrossfade.h"
+#include "decoder/AudioDecoder.h"
+#include "trace/TraceRecorder.h"
+#include <algorithm>
+#include <cmath>
+
+namespace VideoCreator
+{
+
+    void AudioCrossfade::startTail(size_t capacity)
+    {
+        m_capacity = capacity;
+        m_write = 0;
+        m_filled = 0;
+        m_left.assign(capacity, 0.0f);
+        m_right.assign(capacity, 0.0f);
+    }
+
+    void AudioCrossfade::recordTail(const float *left, const float *right, int count)
+    {
+        if (m_capacity == 0 || count <= 0)
+        {
+            return;
+        }
+        // 超出容量的部分只有最后 m_capacity 个采样有用
+        size_t offset = 0;
+        size_t remaining = static_cast<size_t>(count);
+        if (remaining > m_capacity)
+        {
+            offset = remaining - m_capacity;
+            remaining = m_capacity;
+        }
+        while (remaining > 0)
+        {
+            const size_t chunk = std::min(remaining, m_capacity - m_write);
+            if (left)
+            {
+                std::copy(left + offset, left + offset + chunk, m_left.begin() + static_cast<std::ptrdiff_t>(m_write));
+                const float *source = right ? right : left;
+                std::copy(source + offset, source + offset + chunk, m_right.begin() + static_cast<std::ptrdiff_t>(m_write));
+            }
+            else
+            {
+                std::fill_n(m_left.begin() + static_cast<std::ptrdiff_t>(m_write), chunk, 0.0f);
+                std::fill_n(m_right.begin() + static_cast<std::ptrdiff_t>(m_write), chunk, 0.0f);
+            }
+            m_write = (m_write + chunk) % m_capacity;
+            m_filled = std::min(m_capacity, m_filled + chunk);
+            offset += chunk;
+            remaining -= chunk;
+        }
+    }
+
+    AudioClip AudioCrossfade::takeTail()
+    {
+        AudioClip clip;
+        if (m_filled > 0)
+        {
+            // 未写满时从 0 开始，写满后最旧的采样位于 m_write
+            const size_t begin = m_filled < m_capacity ? 0 : m_write;
+            clip.left.reserve(m_filled);
+            clip.right.reserve(m_filled);
+            for (size_t i = 0; i < m_filled; ++i)
+            {
+                const size_t index = (begin + i) % m_capacity;
+                clip.left.push_back(m_left[index]);
+                clip.right.push_back(m_right[index]);
+            }
+        }
+        m_capacity = 0;
+        m_write = 0;
+        m_filled = 0;
+        m_left.clear();
+        m_right.clear();
+        return clip;
+    }
+
+    AudioClip AudioCrossfade::decodeHead(const SceneConfig &scene, size_t samples, int sampleRate, std::string *error)
+    {
+        VC_TRACE_SCOPE("transition_audio_head", "audio");
+        AudioClip clip;
+
+        // 与 renderScene 一致：没有主音轨和附加音轨时，视频原声按主音轨处理
+        std::string path = scene.resources.audio.path;
+        double startOffset = scene.resources.audio.start_offset;
+        if (path.empty() && scene.type == SceneType::VIDEO_SCENE && scene.resources.video.use_audio &&
+            scene.resources.audio_layers.empty())
+        {
+            path = scene.resources.video.path;
+            startOffset = 0.0;
+        }
+        if (path.empty() || samples == 0)
+        {
+            return clip;
+        }
+
+        AudioDecoder decoder;
+        if (!decoder.open(path))
+        {
+            if (error)
+            {
+                *error = "无法打开转场目标音频: " + decoder.getErrorString();
+            }
+            return clip;
+        }
+        if (!decoder.applyVolumeEffect(scene) && error)
+        {
+            // 与旧的转场实现一致，音量特效失败时继续使用原始音频
+            *error = "目标场景音量特效应用失败: " + decoder.getErrorString();
+        }
+
+        const size_t delay = startOffset > 0 ? std::min(samples, static_cast<size_t>(std::lround(startOffset * sampleRate))) : 0;
+        clip.left.reserve(samples);
+        clip.right.reserve(samples);
+        clip.left.assign(delay, 0.0f);
+        clip.right.assign(delay, 0.0f);
+        while (clip.size() < samples)
+        {
+            FFmpegUtils::AvFramePtr frame;
+            const int ret = decoder.decodeFrame(frame);
+            if (ret <= 0 || !frame)
+            {
+                if (ret < 0 && error)
+                {
+                    *error = "转场目标音频解码失败: " + decoder.getErrorString();
+                }
+                break;
+            }
+            const int channelCount = frame->ch_layout.nb_channels > 1 ? 2 : 1;
+            const int count = static_cast<int>(std::min<size_t>(frame->nb_samples, samples - clip.size()));
+            const float *left = reinterpret_cast<const float *>(frame->data[0]);
+            const float *right = channelCount > 1 ? reinterpret_cast<const float *>(frame->data[1]) : left;
+            clip.left.insert(clip.left.end(), left, left + count);
+            clip.right.insert(clip.right.end(), right, right + count);
+        }
+        return clip;
+    }
+
+    void AudioCrossfade::mix(const AudioClip &from, const AudioClip &to, size_t position, size_t total, int count, float *left, float *right)
+    {
+        constexpr double kHalfPi = 1.5707963267948966;
+        for (int i = 0; i < count; ++i)
+        {
+            const size_t index = position + static_cast<size_t>(i);
+            // 等功率：两侧权重平方和为 1，淡化中点响度不下陷
+            const double t = total > 0 ? std::clamp((static_cast<double>(index) + 0.5) / static_cast<double>(total), 0.0, 1.0) : 1.0;
+            const float fromWeight = static_cast<float>(std::cos(t * kHalfPi));
+            const float toWeight = static_cast<float>(std::sin(t * kHalfPi));
+            float l = 0.0f;
+            float r = 0.0f;
+            if (index < from.size())
+            {
+                l += from.left[index] * fromWeight;
+                r += from.right[index] * fromWeight;
+            }
+            if (index < to.size())
+            {
+                l += to.left[index] * toWeight;
+                r += to.right[index] * toWeight;
+            }
+            if (right)
+            {
+                left[i] = std::clamp(l, -1.0f, 1.0f);
+                right[i] = std::clamp(r, -1.0f, 1.0f);
+            }
+            else
+            {
+                left[i] = std::clamp(0.5f * (l + r), -1.0f, 1.0f);
+            }
+        }
+    }
+
+} // namespace VideoCreator
@@ -0,0 +1,57 @@
+#ifndef AUDIO_CROSSFADE_H
+#define AUDIO_CROSSFADE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "model/ProjectConfig.h"
+
+namespace VideoCreator
+{
+
+    // 双声道平面浮点采样，采样率与音频编码器一致
+    struct AudioClip
+    {
+        std::vector<float> left;
+        std::vector<float> right;
+
+        size_t size() const { return left.size(); }
+    };
+
+    /**
+     * AudioCrossfade - 转场音频的等功率交叉淡化
+     *
+     * 前一场景渲染时把写入 FIFO 的混音末尾记入环形缓冲（只保留转场长度），后一场景的开头在前一场景渲染期间
+     * 由后台任务解码；转场时两者按 cos / sin 权重混合，不再重新打开、从头解码两侧音频。
+     */
+    class AudioCrossfade
+    {
+    public:
+        // 开始记录混音末尾，最多保留 capacity 个采样；0 表示不记录
+        void startTail(size_t capacity);
+
+        // 记录一段混音；left / right 为空表示静音，right 为空时复制左声道
+        void recordTail(const float *left, const float *right, int count);
+
+        // 按时间顺序取出记录的末尾并停止记录
+        AudioClip takeTail();
+
+        bool recording() const { return m_capacity > 0; }
+
+        // 解码场景主音轨（无主音轨时为视频原声）开头 samples 个采样，应用场景音量特效与 start_offset
+        static AudioClip decodeHead(const SceneConfig &scene, size_t samples, int sampleRate, std::string *error = nullptr);
+
+        // 写出转场中 [position, position + count) 的混合采样，total 为转场总采样数；right 可为空（单声道输出）
+        static void mix(const AudioClip &from, const AudioClip &to, size_t position, size_t total, int count, float *left, float *right);
+
+    private:
+        std::vector<float> m_left;
+        std::vector<float> m_right;
+        size_t m_capacity = 0;
+        size_t m_write = 0;  // 下一个写入位置
+        size_t m_filled = 0; // 已记录的采样数，不超过 m_capacity
+    };
+
+} // namespace VideoCreator
+
+#endif // AUDIO_CROSSFADE_H
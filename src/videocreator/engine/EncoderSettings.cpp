@@ -0,0 +1,307 @@
+#include "EncoderSettings.h"
+#include <QDebug>
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <thread>
+
+namespace VideoCreator
+{
+
+    namespace
+    {
+        int hardwareThreads()
+        {
+            const unsigned int threads = std::thread::hardware_concurrency();
+            return threads > 0 ? static_cast<int>(threads) : 4;
+        }
+
+        // x264 / x265 通过各自的 *-params 选项接受 "key=value:key=value"
+        const char *codecParamsOption(AVCodecContext *context)
+        {
+            if (!context->priv_data)
+            {
+                return nullptr;
+            }
+            for (const char *option : {"x264-params", "x265-params"})
+            {
+                if (av_opt_find(context->priv_data, option, nullptr, 0, 0))
+                {
+                    return option;
+                }
+            }
+            return nullptr;
+        }
+    } // namespace
+
+    TwoPassLog::TwoPassLog(std::string path)
+        : m_path(std::move(path))
+    {
+    }
+
+    TwoPassLog::~TwoPassLog()
+    {
+        // x264 另外写出 .mbtree 文件
+        std::remove(m_path.c_str());
+        std::remove((m_path + ".mbtree").c_str());
+    }
+
+    void TwoPassLog::collect(const AVCodecContext *context)
+    {
+        if (context && context->stats_out)
+        {
+            m_stats += context->stats_out;
+        }
+    }
+
+    int64_t EncoderSettings::parseBitrate(const std::string &bitrate)
+    {
+        if (bitrate.empty())
+        {
+            return 0;
+        }
+        std::string number = bitrate;
+        int64_t multiplier = 1;
+        const char suffix = number.back();
+        if (suffix == 'k' || suffix == 'K')
+        {
+            multiplier = 1000;
+            number.pop_back();
+        }
+        else if (suffix == 'm' || suffix == 'M')
+        {
+            multiplier = 1000000;
+            number.pop_back();
+        }
+
+        const size_t first = number.find_first_not_of(" \t\n\r");
+        if (first == std::string::npos)
+        {
+            qDebug() << "Invalid bitrate value (only whitespace): " << bitrate.c_str();
+            return 0;
+        }
+        const size_t last = number.find_last_not_of(" \t\n\r");
+        try
+        {
+            return static_cast<int64_t>(std::stoll(number.substr(first, last - first + 1)) * multiplier);
+        }
+        catch (const std::invalid_argument &)
+        {
+            qDebug() << "Invalid bitrate value: " << bitrate.c_str();
+        }
+        catch (const std::out_of_range &)
+        {
+            qDebug() << "Bitrate value out of range: " << bitrate.c_str();
+        }
+        return 0;
+    }
+
+    bool EncoderSettings::isKnownAutoProfile(const std::string &profile)
+    {
+        return profile.empty() || profile == "fastest" || profile == "concurrent";
+    }
+
+    ResolvedVideoEncoding EncoderSettings::resolve(const VideoEncodingConfig &config, int fps, int threadBudget)
+    {
+        ResolvedVideoEncoding resolved;
+        const int hardware = hardwareThreads();
+
+        if (config.auto_profile == "fastest")
+        {
+            // 单任务：帧级线程吞吐最高，前瞻与 B 帧保持编码器默认
+            resolved.threadCount = threadBudget > 0 ? threadBudget : hardware;
+        }
+        else if (config.auto_profile == "concurrent")
+        {
+            // 多任务并行：每个任务少量线程，缩短前瞻减少每个任务缓存的帧
+            resolved.threadCount = threadBudget > 0 ? threadBudget : std::max(2, hardware / 4);
+            resolved.lookahead = 10;
+        }
+        else
+        {
+            resolved.threadCount = threadBudget > 0 ? threadBudget : std::min(8, hardware);
+        }
+        resolved.threadType = FF_THREAD_FRAME;
+
+        if (config.threads > 0)
+        {
+            resolved.threadCount = config.threads;
+        }
+        if (config.thread_type == "slice")
+        {
+            // 片级线程延迟最低，但同等线程数下吞吐不如帧级
+            resolved.threadType = FF_THREAD_SLICE;
+        }
+        else if (config.thread_type == "frame")
+        {
+            resolved.threadType = FF_THREAD_FRAME;
+        }
+
+        // 默认每 2 秒一个关键帧：过短的 GOP 会增大文件并拖慢编码
+        resolved.gopSize = config.gop > 0 ? config.gop : std::max(1, fps * 2);
+        if (config.bframes >= 0)
+        {
+            resolved.maxBFrames = config.bframes;
+        }
+        if (config.lookahead >= 0)
+        {
+            resolved.lookahead = config.lookahead;
+        }
+        resolved.tune = config.tune;
+        resolved.codecParams = config.codec_params;
+
+        resolved.rateControl = config.rate_control.empty() ? "crf" : config.rate_control;
+        resolved.bitRate = parseBitrate(config.bitrate);
+        resolved.maxRate = parseBitrate(config.maxrate);
+        resolved.bufSize = parseBitrate(config.bufsize);
+        if (resolved.maxRate > 0 && resolved.bufSize <= 0)
+        {
+            // 缓冲默认两倍峰值码率：约 2 秒的码率波动空间
+            resolved.bufSize = resolved.maxRate * 2;
+        }
+        resolved.fastFirstPass = config.fast_first_pass;
+        return resolved;
+    }
+
+    bool EncoderSettings::apply(AVCodecContext *context, const VideoEncodingConfig &config, const ResolvedVideoEncoding &resolved,
+                                std::string *error, int pass, TwoPassLog *passLog)
+    {
+        auto fail = [&](const std::string &message) {
+            if (error)
+            {
+                *error = message;
+            }
+            return false;
+        };
+
+        if (!isKnownAutoProfile(config.auto_profile))
+        {
+            return fail("未知的编码自动档位: " + config.auto_profile);
+        }
+        if (!config.thread_type.empty() && config.thread_type != "frame" && config.thread_type != "slice")
+        {
+            return fail("未知的编码线程模式: " + config.thread_type);
+        }
+        const std::string &mode = resolved.rateControl;
+        if (mode != "crf" && mode != "abr" && mode != "two_pass")
+        {
+            return fail("未知的码控模式: " + mode);
+        }
+        if (mode != "crf" && resolved.bitRate <= 0)
+        {
+            return fail(mode + " 码控需要有效的 bitrate");
+        }
+        if (mode == "two_pass" && (pass < 1 || pass > 2 || !passLog))
+        {
+            return fail("two_pass 码控需要指定编码遍数与统计文件");
+        }
+
+        context->thread_count = resolved.threadCount;
+        context->thread_type = resolved.threadType;
+        context->gop_size = resolved.gopSize;
+        if (resolved.maxBFrames >= 0)
+        {
+            context->max_b_frames = resolved.maxBFrames;
+        }
+
+        context->rc_max_rate = resolved.maxRate;
+        context->rc_buffer_size = static_cast<int>(std::min<int64_t>(resolved.bufSize, INT32_MAX));
+
+        const bool hasCrf = context->priv_data && av_opt_find(context->priv_data, "crf", nullptr, 0, 0);
+        if (mode == "crf" && hasCrf)
+        {
+            // crf 与 bit_rate 同时设置时语义冲突，恒定质量模式下只保留 VBV 上限
+            context->bit_rate = 0;
+            av_opt_set_int(context->priv_data, "crf", config.crf, 0);
+        }
+        else
+        {
+            // abr / two_pass，或不支持 crf 的编码器（如 mpeg4）按码率编码
+            context->bit_rate = resolved.bitRate;
+        }
+
+        if (mode == "two_pass")
+        {
+            context->flags |= pass == 1 ? AV_CODEC_FLAG_PASS1 : AV_CODEC_FLAG_PASS2;
+            if (pass == 2)
+            {
+                context->stats_in = passLog->statsIn();
+            }
+        }
+
+        if (!context->priv_data)
+        {
+            return true;
+        }
+        av_opt_set(context->priv_data, "preset", config.preset.c_str(), 0);
+
+        if (!resolved.tune.empty() && av_opt_set(context->priv_data, "tune", resolved.tune.c_str(), 0) < 0)
+        {
+            return fail("编码器不支持 tune: " + resolved.tune);
+        }
+
+        std::string params = resolved.codecParams;
+        const char *paramsOption = codecParamsOption(context);
+        if (resolved.lookahead >= 0 && av_opt_set_int(context->priv_data, "rc-lookahead", resolved.lookahead, 0) < 0)
+        {
+            if (paramsOption)
+            {
+                // libx265 没有独立的 rc-lookahead 选项，并入 x265-params
+                params = "rc-lookahead=" + std::to_string(resolved.lookahead) + (params.empty() ? "" : ":" + params);
+            }
+            else
+            {
+                qDebug() << "EncoderSettings: 编码器不支持 rc-lookahead，已忽略";
+            }
+        }
+
+        if (resolved.fixedKeyframes)
+        {
+            // 闭合 GOP 且不按画面变化插入关键帧，每个分片都能独立解码、各码率档切点一致
+            context->flags |= AV_CODEC_FLAG_CLOSED_GOP;
+            if (av_opt_find(context->priv_data, "sc_threshold", nullptr, 0, 0))
+            {
+                av_opt_set_int(context->priv_data, "sc_threshold", 0, 0);
+            }
+            else if (paramsOption && std::string(paramsOption) == "x265-params")
+            {
+                params = "scenecut=0" + (params.empty() ? std::string() : ":" + params);
+            }
+        }
+
+        if (mode == "two_pass")
+        {
+            if (av_opt_find(context->priv_data, "stats", nullptr, 0, 0))
+            {
+                // libx264：统计文件由编码器自行读写；第一遍快速分析（降低 subme/ref 等）只影响耗时，不影响第二遍结果
+                av_opt_set(context->priv_data, "stats", passLog->path().c_str(), 0);
+                av_opt_set_int(context->priv_data, "fastfirstpass", resolved.fastFirstPass ? 1 : 0, 0);
+            }
+            else if (paramsOption && std::string(paramsOption) == "x265-params")
+            {
+                if (passLog->path().find(':') != std::string::npos)
+                {
+                    return fail("x265 两遍统计文件路径不能包含 ':': " + passLog->path());
+                }
+                std::string passParams = "pass=" + std::to_string(pass) + ":stats=" + passLog->path();
+                if (pass == 1 && resolved.fastFirstPass)
+                {
+                    passParams += ":slow-firstpass=0";
+                }
+                params = passParams + (params.empty() ? "" : ":" + params);
+            }
+        }
+
+        if (!params.empty())
+        {
+            const int ret = paramsOption ? av_opt_set(context->priv_data, paramsOption, params.c_str(), 0)
+                                         : av_opt_set_from_string(context->priv_data, params.c_str(), nullptr, "=", ":");
+            if (ret < 0)
+            {
+                return fail("无法应用编码器参数: " + params);
+            }
+        }
+        return true;
+    }
+
+} // namespace VideoCreator
@@ -0,0 +1,93 @@
+#ifndef ENCODER_SETTINGS_H
+#define ENCODER_SETTINGS_H
+
+#include <cstdint>
+#include <string>
+#include "model/ProjectConfig.h"
+#include "ffmpeg_utils/FFmpegHeaders.h"
+
+namespace VideoCreator
+{
+
+    // 由 VideoEncodingConfig、自动档位与线程预算解析出的最终编码参数（-1 / 空表示沿用编码器默认）
+    struct ResolvedVideoEncoding
+    {
+        int threadCount = 0;
+        int threadType = FF_THREAD_FRAME;
+        int gopSize = 0;
+        int maxBFrames = -1;
+        int lookahead = -1;
+        std::string tune;
+        std::string codecParams;
+
+        std::string rateControl = "crf"; // crf | abr | two_pass
+        int64_t bitRate = 0;             // abr / two_pass 的目标码率
+        int64_t maxRate = 0;             // VBV 峰值码率，0 表示不限制
+        int64_t bufSize = 0;             // VBV 缓冲大小
+        bool fastFirstPass = true;
+
+        bool fixedKeyframes = false;     // 关键帧只出现在 GOP 边界与强制位置（关闭场景切换检测），hls / dash 各码率档分片对齐
+    };
+
+    /**
+     * TwoPassLog - 两遍编码的统计数据
+     *
+     * x264 / x265 自行读写 path() 指向的文件；其他编码器（mpeg4、libvpx 等）通过 stats_out / stats_in 交换，
+     * 由 collect() 在第一遍累积、statsIn() 在第二遍提供。析构时删除统计文件。
+     */
+    class TwoPassLog
+    {
+    public:
+        explicit TwoPassLog(std::string path);
+        ~TwoPassLog();
+
+        const std::string &path() const { return m_path; }
+
+        // 第一遍每取到一个视频包后调用
+        void collect(const AVCodecContext *context);
+
+        // 第二遍传给 AVCodecContext::stats_in，须在编码器释放之后才能销毁本对象
+        char *statsIn() { return m_stats.empty() ? nullptr : &m_stats[0]; }
+
+    private:
+        TwoPassLog(const TwoPassLog &) = delete;
+        TwoPassLog &operator=(const TwoPassLog &) = delete;
+
+        std::string m_path;
+        std::string m_stats;
+    };
+
+    /**
+     * 编码器线程与码控参数
+     *
+     * 自动档位：
+     *  - fastest：单个任务尽快完成，帧级线程占满线程预算（或全部核心）
+     *  - concurrent：多个任务同时渲染，每个任务少量帧线程、缩短前瞻以降低内存与切换开销
+     * 配置中显式给出的字段始终优先于档位。
+     *
+     * 码控模式：
+     *  - crf（默认）：恒定质量，可用 maxrate / bufsize 加 VBV 上限，限制峰值码率而不必重编码
+     *  - abr：按 bitrate 的平均码率，文件大小可预估但同码率下质量不如两遍
+     *  - two_pass：第一遍只收集统计（默认使用快速分析），第二遍按 bitrate 分配，大小最准、耗时约多一遍分析
+     */
+    class EncoderSettings
+    {
+    public:
+        // threadBudget <= 0 表示未由调用方分配，按硬件线程数推导
+        static ResolvedVideoEncoding resolve(const VideoEncodingConfig &config, int fps, int threadBudget);
+
+        // 将参数应用到尚未打开的编码器上下文（须在 avcodec_open2 之前调用）；
+        // two_pass 模式下 pass 取 1 或 2，passLog 为两遍共用的统计数据
+        static bool apply(AVCodecContext *context, const VideoEncodingConfig &config, const ResolvedVideoEncoding &resolved,
+                          std::string *error = nullptr, int pass = 0, TwoPassLog *passLog = nullptr);
+
+        static bool isKnownAutoProfile(const std::string &profile);
+        static bool isTwoPass(const VideoEncodingConfig &config) { return config.rate_control == "two_pass"; }
+
+        // 解析 "5000k"、"5M" 形式的码率，无效时返回 0
+        static int64_t parseBitrate(const std::string &bitrate);
+    };
+
+} // namespace VideoCreator
+
+#endif // ENCODER_SETTINGS_H
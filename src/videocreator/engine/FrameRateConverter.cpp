@@ -0,0 +1,215 @@
+#include "FrameRateConverter.h"
+#include "trace/TraceRecorder.h"
+#include <algorithm>
+#include <cmath>
+
+namespace VideoCreator
+{
+
+    namespace
+    {
+        // 时间戳换算成帧号时的容差，吸收容器时间基带来的舍入误差
+        constexpr double kFrameEpsilon = 1e-6;
+        // 混合权重低于 1/256 时与直接取前一帧没有可见差别
+        constexpr double kMinBlendWeight = 1.0 / 256.0;
+
+        // 按权重混合两帧（YUV420P，8 位定点）
+        void blendFrames(const AVFrame *from, const AVFrame *to, AVFrame *out, double weight)
+        {
+            const int w = static_cast<int>(std::lround(weight * 256.0));
+            const int inv = 256 - w;
+            for (int plane = 0; plane < 3; ++plane)
+            {
+                const int width = plane == 0 ? out->width : (out->width + 1) / 2;
+                const int height = plane == 0 ? out->height : (out->height + 1) / 2;
+                for (int y = 0; y < height; ++y)
+                {
+                    const uint8_t *a = from->data[plane] + y * from->linesize[plane];
+                    const uint8_t *b = to->data[plane] + y * to->linesize[plane];
+                    uint8_t *dst = out->data[plane] + y * out->linesize[plane];
+                    for (int x = 0; x < width; ++x)
+                    {
+                        dst[x] = static_cast<uint8_t>((a[x] * inv + b[x] * w + 128) >> 8);
+                    }
+                }
+            }
+        }
+    } // namespace
+
+    bool FrameRateConverter::parseMode(const std::string &name, Mode &mode, std::string *error)
+    {
+        if (name.empty() || name == "drop")
+        {
+            mode = Mode::DROP;
+            return true;
+        }
+        if (name == "blend")
+        {
+            mode = Mode::BLEND;
+            return true;
+        }
+        if (error)
+        {
+            *error = "未知的帧率转换模式: " + name;
+        }
+        return false;
+    }
+
+    FrameRateConverter::FrameRateConverter(double outputFps, Mode mode, int64_t targetFrames)
+        : m_outputFps(outputFps > 0 ? outputFps : 30.0), m_mode(mode), m_targetFrames(targetFrames)
+    {
+    }
+
+    int64_t FrameRateConverter::outputsBefore(double timestamp) const
+    {
+        // drop 模式取最近的源帧：源帧比输出时间晚不到半帧也算作“已到达”
+        const double offset = m_mode == Mode::DROP ? 0.5 : 0.0;
+        const double position = std::ceil(timestamp * m_outputFps - offset - kFrameEpsilon);
+        return std::max<int64_t>(0, static_cast<int64_t>(position));
+    }
+
+    bool FrameRateConverter::push(FFmpegUtils::AvFramePtr frame, double timestamp, const ScaleFunction &scale, const EmitFunction &emit)
+    {
+        if (!frame)
+        {
+            return true;
+        }
+        if (done())
+        {
+            ++m_dropped;
+            return true;
+        }
+
+        // 无时间戳或时间戳回退时按源帧率顺推
+        const double step = 1.0 / (m_sourceFps > 0 ? m_sourceFps : m_outputFps);
+        if (timestamp < 0)
+        {
+            timestamp = m_pendingTime >= 0 ? m_pendingTime + step : static_cast<double>(m_nextOutput) / m_outputFps;
+        }
+        else if (m_pending && timestamp <= m_pendingTime)
+        {
+            timestamp = m_pendingTime + step;
+        }
+
+        if (!m_pending)
+        {
+            m_pending = std::move(frame);
+            m_pendingTime = timestamp;
+            return true;
+        }
+
+        int64_t end = outputsBefore(timestamp);
+        if (m_targetFrames > 0)
+        {
+            end = std::min(end, m_targetFrames);
+        }
+        FFmpegUtils::AvFramePtr nextScaled;
+        if (end <= m_nextOutput)
+        {
+            // 没有输出帧落在这个源帧上，直接丢弃，不做缩放
+            ++m_dropped;
+        }
+        else if (!emitUntil(end, timestamp, frame.get(), scale, emit, nextScaled))
+        {
+            return false;
+        }
+
+        m_pending = std::move(frame);
+        m_pendingScaled = std::move(nextScaled);
+        m_pendingTime = timestamp;
+        return true;
+    }
+
+    bool FrameRateConverter::finish(const ScaleFunction &scale, const EmitFunction &emit)
+    {
+        if (!m_pending)
+        {
+            return true;
+        }
+        const int64_t end = m_targetFrames > 0 ? m_targetFrames : m_nextOutput + 1;
+        bool ok = true;
+        if (end <= m_nextOutput)
+        {
+            ++m_dropped;
+        }
+        else
+        {
+            FFmpegUtils::AvFramePtr unused;
+            ok = emitUntil(end, -1.0, nullptr, scale, emit, unused);
+        }
+        m_pending.reset();
+        m_pendingScaled.reset();
+        return ok;
+    }
+
+    bool FrameRateConverter::emitUntil(int64_t end, double nextTime, const AVFrame *next, const ScaleFunction &scale,
+                                       const EmitFunction &emit, FFmpegUtils::AvFramePtr &nextScaled)
+    {
+        const int64_t first = m_nextOutput;
+        for (int64_t k = first; k < end; ++k)
+        {
+            if (!m_pendingScaled)
+            {
+                m_pendingScaled = scale(m_pending.get());
+                if (!m_pendingScaled)
+                {
+                    m_errorString = "缩放源帧失败";
+                    return false;
+                }
+            }
+
+            double weight = 0.0;
+            if (m_mode == Mode::BLEND && next && nextTime > m_pendingTime)
+            {
+                const double outputTime = static_cast<double>(k) / m_outputFps;
+                weight = std::clamp((outputTime - m_pendingTime) / (nextTime - m_pendingTime), 0.0, 1.0);
+            }
+
+            FFmpegUtils::AvFramePtr output;
+            if (weight >= kMinBlendWeight)
+            {
+                VC_TRACE_SCOPE("fps_blend", "filter");
+                if (!nextScaled)
+                {
+                    nextScaled = scale(next);
+                    if (!nextScaled)
+                    {
+                        m_errorString = "缩放源帧失败";
+                        return false;
+                    }
+                }
+                output = FFmpegUtils::createAvFrame(m_pendingScaled->width, m_pendingScaled->height, AV_PIX_FMT_YUV420P);
+                if (!output)
+                {
+                    m_errorString = "创建混合帧失败";
+                    return false;
+                }
+                blendFrames(m_pendingScaled.get(), nextScaled.get(), output.get(), weight);
+                av_frame_copy_props(output.get(), m_pendingScaled.get());
+                ++m_blended;
+            }
+            else
+            {
+                // 重复帧只增加引用，不复制像素
+                output = FFmpegUtils::copyAvFrame(m_pendingScaled.get());
+                if (!output)
+                {
+                    m_errorString = "复制源帧失败";
+                    return false;
+                }
+                if (k > first)
+                {
+                    ++m_duplicated;
+                }
+            }
+
+            m_nextOutput = k + 1;
+            if (!emit(std::move(output)))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+} // namespace VideoCreator
@@ -0,0 +1,80 @@
+#ifndef FRAME_RATE_CONVERTER_H
+#define FRAME_RATE_CONVERTER_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include "ffmpeg_utils/FFmpegHeaders.h"
+#include "ffmpeg_utils/AvFrameWrapper.h"
+
+namespace VideoCreator
+{
+
+    /**
+     * FrameRateConverter - 按源帧时间戳把视频片段转换到项目帧率
+     *
+     * 输出第 k 帧的时间为 k / fps（场景内）。drop 模式下每个输出帧取时间不晚于它（容差半个输出帧）的最新源帧，
+     * 源帧率低时重复、高时丢弃；blend 模式按输出时间在相邻两个源帧之间线性混合。
+     * 源帧在确定要输出之前不做缩放，被丢弃的帧不会进入 scaleFrame。
+     */
+    class FrameRateConverter
+    {
+    public:
+        enum class Mode
+        {
+            DROP,
+            BLEND
+        };
+
+        // 缩放源帧到项目尺寸；返回空表示失败
+        using ScaleFunction = std::function<FFmpegUtils::AvFramePtr(const AVFrame *)>;
+        // 交出一个输出帧；返回 false 表示停止（如收到停止请求）
+        using EmitFunction = std::function<bool(FFmpegUtils::AvFramePtr)>;
+
+        // 解析 frame_rate_mode：空或 "drop" / "blend"
+        static bool parseMode(const std::string &name, Mode &mode, std::string *error = nullptr);
+
+        // targetFrames <= 0 表示场景长度未知，此时最后一个源帧只输出一次
+        FrameRateConverter(double outputFps, Mode mode, int64_t targetFrames);
+
+        // 送入一个解码帧及其时间（秒，无时间戳时传负值，按源帧率 sourceFps 顺推）
+        bool push(FFmpegUtils::AvFramePtr frame, double timestamp, const ScaleFunction &scale, const EmitFunction &emit);
+
+        // 源结束：输出最后一个源帧占用的剩余输出帧
+        bool finish(const ScaleFunction &scale, const EmitFunction &emit);
+
+        // 输出帧已达到场景长度，无需再解码
+        bool done() const { return m_targetFrames > 0 && m_nextOutput >= m_targetFrames; }
+
+        void setSourceFps(double sourceFps) { m_sourceFps = sourceFps; }
+        int64_t droppedFrames() const { return m_dropped; }
+        int64_t duplicatedFrames() const { return m_duplicated; }
+        int64_t blendedFrames() const { return m_blended; }
+        std::string getErrorString() const { return m_errorString; }
+
+    private:
+        // 时间 t 之前（不含）的输出帧个数
+        int64_t outputsBefore(double timestamp) const;
+        // 输出 [m_nextOutput, end) 中的帧；next 为下一个源帧（blend 模式用，可为空），其缩放结果写入 nextScaled
+        bool emitUntil(int64_t end, double nextTime, const AVFrame *next, const ScaleFunction &scale, const EmitFunction &emit,
+                       FFmpegUtils::AvFramePtr &nextScaled);
+
+        double m_outputFps;
+        Mode m_mode;
+        int64_t m_targetFrames;
+        double m_sourceFps = 0.0;
+
+        FFmpegUtils::AvFramePtr m_pending;       // 尚未输出完的源帧（未缩放）
+        FFmpegUtils::AvFramePtr m_pendingScaled; // 其缩放结果，按需生成
+        double m_pendingTime = -1.0;
+        int64_t m_nextOutput = 0;
+
+        int64_t m_dropped = 0;
+        int64_t m_duplicated = 0;
+        int64_t m_blended = 0;
+        std::string m_errorString;
+    };
+
+} // namespace VideoCreator
+
+#endif // FRAME_RATE_CONVERTER_H
@@ -0,0 +1,339 @@
+#include "RenderCheckpoint.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+namespace VideoCreator
+{
+
+    namespace
+    {
+        constexpr int kJournalVersion = 1;
+        const char *const kJournalName = "checkpoint.json";
+
+        void addFileStamp(QCryptographicHash &hash, const std::string &path)
+        {
+            if (path.empty())
+            {
+                return;
+            }
+            QFileInfo info(QString::fromStdString(path));
+            const qint64 size = info.exists() ? info.size() : -1;
+            const qint64 mtime = info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1;
+            hash.addData(QByteArray::fromStdString(path));
+            hash.addData(QByteArray::number(size) + ':' + QByteArray::number(mtime) + '\n');
+        }
+
+        // 逐字段写入 "名称=值"，字符串带长度前缀，不同配置不会拼出相同的文本
+        struct CanonicalWriter
+        {
+            QCryptographicHash &hash;
+
+            void add(const char *key, const std::string &value)
+            {
+                hash.addData(QByteArray(key) + '=' + QByteArray::number(static_cast<qulonglong>(value.size())) + ':' +
+                             QByteArray::fromStdString(value) + '\n');
+            }
+            void add(const char *key, long long value)
+            {
+                hash.addData(QByteArray(key) + '=' + QByteArray::number(value) + '\n');
+            }
+            void add(const char *key, double value)
+            {
+                hash.addData(QByteArray(key) + '=' + QByteArray::number(value, 'g', 17) + '\n');
+            }
+            void add(const char *key, int value) { add(key, static_cast<long long>(value)); }
+            void add(const char *key, bool value) { add(key, static_cast<long long>(value)); }
+
+            void image(const ImageConfig &image)
+            {
+                add("image.path", image.path);
+                add("image.x", image.x);
+                add("image.y", image.y);
+                add("image.scale", image.scale);
+                add("image.rotation", image.rotation);
+                add("image.fit", image.fit);
+            }
+            void audio(const AudioConfig &audio)
+            {
+                add("audio.path", audio.path);
+                add("audio.volume", audio.volume);
+                add("audio.start_offset", audio.start_offset);
+            }
+        };
+
+        // 影响输出内容的全部字段；write_buffer_mb / sync_output / checkpoint_dir 只影响写盘方式，不计入
+        void addConfig(CanonicalWriter &writer, const ProjectConfig &config)
+        {
+            const ProjectInfoConfig &project = config.project;
+            writer.add("project.output_path", project.output_path);
+            writer.add("project.width", project.width);
+            writer.add("project.height", project.height);
+            writer.add("project.fps", project.fps);
+            writer.add("project.background_color", project.background_color);
+            writer.add("project.output_format", project.output_format);
+            writer.add("project.segment_duration", project.segment_duration);
+            for (const auto &rendition : project.renditions)
+            {
+                writer.add("rendition.name", rendition.name);
+                writer.add("rendition.width", rendition.width);
+                writer.add("rendition.height", rendition.height);
+                writer.add("rendition.bitrate", rendition.bitrate);
+                writer.add("rendition.maxrate", rendition.maxrate);
+            }
+
+            for (const auto &scene : config.scenes)
+            {
+                writer.add("scene.id", scene.id);
+                writer.add("scene.type", static_cast<int>(scene.type));
+                writer.add("scene.duration", scene.duration);
+                writer.add("scene.transition_type", static_cast<int>(scene.transition_type));
+                writer.add("scene.from_scene", scene.from_scene);
+                writer.add("scene.to_scene", scene.to_scene);
+
+                const ResourcesConfig &resources = scene.resources;
+                writer.image(resources.image);
+                writer.audio(resources.audio);
+                const VideoConfig &video = resources.video;
+                writer.add("video.path", video.path);
+                writer.add("video.trim_start", video.trim_start);
+                writer.add("video.trim_end", video.trim_end);
+                writer.add("video.use_audio", video.use_audio);
+                writer.add("video.frame_rate_mode", video.frame_rate_mode);
+                writer.add("video.fit", video.fit);
+                writer.add("audio_layers", static_cast<int>(resources.audio_layers.size()));
+                for (const auto &layer : resources.audio_layers)
+                {
+                    writer.audio(layer);
+                }
+                writer.add("overlays", static_cast<int>(resources.overlays.size()));
+                for (const auto &overlay : resources.overlays)
+                {
+                    writer.image(overlay);
+                }
+
+                const EffectsConfig &effects = scene.effects;
+                const KenBurnsEffect &kenBurns = effects.ken_burns;
+                writer.add("ken_burns.enabled", kenBurns.enabled);
+                writer.add("ken_burns.preset", kenBurns.preset);
+                writer.add("ken_burns.start_scale", kenBurns.start_scale);
+                writer.add("ken_burns.end_scale", kenBurns.end_scale);
+                writer.add("ken_burns.start_x", kenBurns.start_x);
+                writer.add("ken_burns.start_y", kenBurns.start_y);
+                writer.add("ken_burns.end_x", kenBurns.end_x);
+                writer.add("ken_burns.end_y", kenBurns.end_y);
+                writer.add("volume_mix.enabled", effects.volume_mix.enabled);
+                writer.add("volume_mix.fade_in", effects.volume_mix.fade_in);
+                writer.add("volume_mix.fade_out", effects.volume_mix.fade_out);
+                writer.add("subtitle.text", effects.subtitle.text);
+                writer.add("subtitle.font_size", effects.subtitle.font_size);
+                writer.add("subtitle.font_color", effects.subtitle.font_color);
+                writer.add("subtitle.bg_color", effects.subtitle.bg_color);
+                writer.add("subtitle.margin_bottom", effects.subtitle.margin_bottom);
+            }
+
+            const GlobalEffectsConfig &global = config.global_effects;
+            writer.add("audio_normalization.enabled", global.audio_normalization.enabled);
+            writer.add("audio_normalization.target_level", global.audio_normalization.target_level);
+            const VideoEncodingConfig &encoding = global.video_encoding;
+            writer.add("video_encoding.codec", encoding.codec);
+            writer.add("video_encoding.bitrate", encoding.bitrate);
+            writer.add("video_encoding.preset", encoding.preset);
+            writer.add("video_encoding.crf", encoding.crf);
+            writer.add("video_encoding.auto_profile", encoding.auto_profile);
+            writer.add("video_encoding.thread_type", encoding.thread_type);
+            writer.add("video_encoding.threads", encoding.threads);
+            writer.add("video_encoding.gop", encoding.gop);
+            writer.add("video_encoding.bframes", encoding.bframes);
+            writer.add("video_encoding.lookahead", encoding.lookahead);
+            writer.add("video_encoding.tune", encoding.tune);
+            writer.add("video_encoding.codec_params", encoding.codec_params);
+            writer.add("video_encoding.rate_control", encoding.rate_control);
+            writer.add("video_encoding.maxrate", encoding.maxrate);
+            writer.add("video_encoding.bufsize", encoding.bufsize);
+            writer.add("video_encoding.fast_first_pass", encoding.fast_first_pass);
+            writer.add("video_encoding.pass_log", encoding.pass_log);
+            writer.add("video_decoding.threads", global.video_decoding.threads);
+            writer.add("video_decoding.thread_type", global.video_decoding.thread_type);
+            writer.add("audio_encoding.codec", global.audio_encoding.codec);
+            writer.add("audio_encoding.bitrate", global.audio_encoding.bitrate);
+            writer.add("audio_encoding.channels", global.audio_encoding.channels);
+        }
+    } // namespace
+
+    std::string RenderCheckpoint::fingerprint(const ProjectConfig &config)
+    {
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+        hash.addData(QByteArray::number(kJournalVersion) + '\n');
+        CanonicalWriter writer{hash};
+        addConfig(writer, config);
+        // 素材被替换后（同名文件改写）旧分段不能再用
+        for (const auto &scene : config.scenes)
+        {
+            const ResourcesConfig &resources = scene.resources;
+            addFileStamp(hash, resources.image.path);
+            addFileStamp(hash, resources.audio.path);
+            addFileStamp(hash, resources.video.path);
+            for (const auto &layer : resources.audio_layers)
+            {
+                addFileStamp(hash, layer.path);
+            }
+            for (const auto &overlay : resources.overlays)
+            {
+                addFileStamp(hash, overlay.path);
+            }
+        }
+        return hash.result().toHex().toStdString();
+    }
+
+    std::vector<std::pair<size_t, size_t>> RenderCheckpoint::planParts(const std::vector<SceneConfig> &scenes)
+    {
+        std::vector<std::pair<size_t, size_t>> plan;
+        size_t first = 0;
+        for (size_t i = 1; i < scenes.size(); ++i)
+        {
+            if (scenes[i].type != SceneType::TRANSITION && scenes[i - 1].type != SceneType::TRANSITION)
+            {
+                plan.emplace_back(first, i);
+                first = i;
+            }
+        }
+        if (first < scenes.size())
+        {
+            plan.emplace_back(first, scenes.size());
+        }
+        return plan;
+    }
+
+    bool RenderCheckpoint::open(const std::string &directory, const std::string &fingerprint,
+                                const std::vector<std::pair<size_t, size_t>> &plan)
+    {
+        m_directory = QString::fromStdString(directory);
+        m_fingerprint = fingerprint;
+        m_parts.clear();
+        if (!QDir().mkpath(m_directory))
+        {
+            m_errorString = "无法创建检查点目录: " + directory;
+            return false;
+        }
+
+        QFile file(QDir(m_directory).filePath(kJournalName));
+        QJsonObject root;
+        if (file.open(QIODevice::ReadOnly))
+        {
+            root = QJsonDocument::fromJson(file.readAll()).object();
+            file.close();
+        }
+        if (root["version"].toInt() != kJournalVersion || root["fingerprint"].toString().toStdString() != fingerprint)
+        {
+            if (!root.isEmpty())
+            {
+                qDebug() << "检查点与当前配置或素材不符，重新渲染:" << m_directory;
+            }
+            removePartsFrom(0);
+            return writeJournal();
+        }
+
+        const QJsonArray parts = root["parts"].toArray();
+        for (const QJsonValue &value : parts)
+        {
+            const QJsonObject json = value.toObject();
+            const size_t index = m_parts.size();
+            Part part;
+            part.firstScene = static_cast<size_t>(json["first_scene"].toInteger(-1));
+            part.endScene = static_cast<size_t>(json["end_scene"].toInteger(-1));
+            part.endFrame = json["end_frame"].toInt();
+            part.endAudioSamples = json["end_audio_samples"].toInteger();
+            part.pendingAudio = QByteArray::fromBase64(json["pending_audio"].toString().toLatin1());
+            // 只接受与分段计划一致、文件仍在的连续前缀
+            if (index >= plan.size() || plan[index].first != part.firstScene || plan[index].second != part.endScene ||
+                QFileInfo(QString::fromStdString(partPath(index))).size() <= 0)
+            {
+                break;
+            }
+            m_parts.push_back(std::move(part));
+        }
+        removePartsFrom(m_parts.size());
+        return static_cast<int>(m_parts.size()) == parts.size() || writeJournal();
+    }
+
+    std::string RenderCheckpoint::partPath(size_t index) const
+    {
+        return QDir(m_directory).filePath(QStringLiteral("part_%1.nut").arg(static_cast<qulonglong>(index), 4, 10, QLatin1Char('0'))).toStdString();
+    }
+
+    bool RenderCheckpoint::commit(const Part &part)
+    {
+        m_parts.push_back(part);
+        if (!writeJournal())
+        {
+            m_parts.pop_back();
+            return false;
+        }
+        return true;
+    }
+
+    void RenderCheckpoint::clear()
+    {
+        m_parts.clear();
+        removePartsFrom(0);
+        QFile::remove(QDir(m_directory).filePath(kJournalName));
+    }
+
+    bool RenderCheckpoint::writeJournal()
+    {
+        QJsonArray parts;
+        for (const Part &part : m_parts)
+        {
+            QJsonObject json;
+            json["first_scene"] = static_cast<qint64>(part.firstScene);
+            json["end_scene"] = static_cast<qint64>(part.endScene);
+            json["end_frame"] = part.endFrame;
+            json["end_audio_samples"] = static_cast<qint64>(part.endAudioSamples);
+            json["pending_audio"] = QString::fromLatin1(part.pendingAudio.toBase64());
+            parts.append(json);
+        }
+        QJsonObject root;
+        root["version"] = kJournalVersion;
+        root["fingerprint"] = QString::fromStdString(m_fingerprint);
+        root["parts"] = parts;
+
+        // 先写临时文件再替换，被杀时日志要么是旧的要么是新的
+        QSaveFile file(QDir(m_directory).filePath(kJournalName));
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            m_errorString = "无法写入检查点日志: " + file.fileName().toStdString();
+            return false;
+        }
+        file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+        if (!file.commit())
+        {
+            m_errorString = "无法写入检查点日志: " + file.errorString().toStdString();
+            return false;
+        }
+        return true;
+    }
+
+    void RenderCheckpoint::removePartsFrom(size_t index)
+    {
+        const QDir dir(m_directory);
+        const QStringList files = dir.entryList({QStringLiteral("part_*.nut")}, QDir::Files);
+        for (const QString &name : files)
+        {
+            bool ok = false;
+            const size_t fileIndex = static_cast<size_t>(name.mid(5, name.size() - 9).toULongLong(&ok));
+            if (ok && fileIndex >= index)
+            {
+                dir.remove(name);
+            }
+        }
+    }
+
+} // namespace VideoCreator
@@ -0,0 +1,70 @@
+#ifndef RENDER_CHECKPOINT_H
+#define RENDER_CHECKPOINT_H
+
+#include <QByteArray>
+#include <QString>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "model/ProjectConfig.h"
+
+namespace VideoCreator
+{
+
+    /**
+     * RenderCheckpoint - 断点续渲的分段与日志（project.checkpoint_dir）
+     *
+     * 渲染按场景边界切成若干分段，每段写成独立的 NUT 文件（视频为重新打开编码器后的完整 GOP，音频为混音后的 PCM），
+     * 分段关闭落盘后才记入日志 checkpoint.json（原子替换）。进程被杀后用同一配置重新渲染时，
+     * 指纹相同则跳过日志中已完成的分段，从下一段继续；全部完成后拼接成最终输出并清除检查点。
+     * 日志为每段记下结束时的帧数、音频样本数与 FIFO 中未满一帧的混音，续渲时恢复，音频与不中断的渲染一致。
+     */
+    class RenderCheckpoint
+    {
+    public:
+        struct Part
+        {
+            size_t firstScene = 0;
+            size_t endScene = 0;          // 不含
+            int endFrame = 0;             // 分段结束时的全局帧数
+            int64_t endAudioSamples = 0;  // 分段结束时已送出的音频样本数
+            QByteArray pendingAudio;      // 留在音频 FIFO 中的样本（float 平面格式，各声道依次存放）
+        };
+
+        // 配置（按字段规范化，与来源是 JSON 文件、字符串还是内存无关）与各场景素材（路径、大小、修改时间）的 SHA-256
+        static std::string fingerprint(const ProjectConfig &config);
+
+        // 按可断开的场景边界分段：边界两侧都不是转场（转场需要前后场景的首末帧与音频）
+        static std::vector<std::pair<size_t, size_t>> planParts(const std::vector<SceneConfig> &scenes);
+
+        // 打开检查点目录并读取日志；指纹或分段计划不符的记录连同分段文件一起丢弃
+        bool open(const std::string &directory, const std::string &fingerprint,
+                  const std::vector<std::pair<size_t, size_t>> &plan);
+
+        // 日志中已完成的分段（按顺序，从第 0 段开始连续）
+        const std::vector<Part> &completedParts() const { return m_parts; }
+
+        std::string partPath(size_t index) const;
+
+        // 分段文件已关闭落盘后调用，追加到日志
+        bool commit(const Part &part);
+
+        // 最终输出写完后删除分段与日志
+        void clear();
+
+        std::string getErrorString() const { return m_errorString; }
+
+    private:
+        bool writeJournal();
+        void removePartsFrom(size_t index);
+
+        QString m_directory;
+        std::string m_fingerprint;
+        std::vector<Part> m_parts;
+        std::string m_errorString;
+    };
+
+} // namespace VideoCreator
+
+#endif // RENDER_CHECKPOINT_H
@@ -1,8 +1,18 @@
 #include "RenderEngine.h"
+#include "AsyncOutputFile.h"
+#include "RenderCheckpoint.h"
+#include "EncoderSettings.h"
+#include "SegmentedOutput.h"
+#include "FrameRateConverter.h"
+#include "TaskExecutor.h"
 #include "decoder/ImageDecoder.h"
 #include "decoder/AudioDecoder.h"
+#include "decoder/SharedDemuxer.h"
 #include "decoder/VideoDecoder.h"
 #include "filter/EffectProcessor.h"
+#include "filter/LayerCompositor.h"
+#include "model/MediaInfoCache.h"
+#include "trace/TraceRecorder.h"
 #include "ffmpeg_utils/AvFrameWrapper.h"
 #include "ffmpeg_utils/AvPacketWrapper.h"
 #include <QDebug>
@@ -16,6 +26,8 @@
 #include <condition_variable>
 #include <atomic>
 #include <sstream>
+#include <chrono>
+#include <cstring>
 
 namespace VideoCreator
 {
@@ -27,47 +39,152 @@ namespace VideoCreator
         return message + ": " + errbuf + " (code " + std::to_string(ret) + ")";
     }
 
-    // Helper to parse bitrate strings (e.g., "5000k", "5M")
-    static int64_t parseBitrate(const std::string& bitrateStr) {
-        if (bitrateStr.empty()) {
-            return 0;
-        }
-        char last_char = bitrateStr.back();
-        std::string num_part = bitrateStr;
-        int64_t multiplier = 1;
-
-        if (last_char == 'k' || last_char == 'K') {
-            multiplier = 1000;
-            num_part.pop_back();
-        } else if (last_char == 'm' || last_char == 'M') {
-            multiplier = 1000000;
-            num_part.pop_back();
-        }
-
-        try {
-            // Trim whitespace from num_part before conversion
-            size_t first = num_part.find_first_not_of(" \t\n\r");
-            if (std::string::npos == first) {
-                 qDebug() << "Invalid bitrate value (only whitespace): " << bitrateStr.c_str();
-                 return 0;
-            }
-            size_t last = num_part.find_last_not_of(" \t\n\r");
-            num_part = num_part.substr(first, (last - first + 1));
-
-            return static_cast<int64_t>(std::stoll(num_part) * multiplier);
-        } catch (const std::invalid_argument& e) {
-            qDebug() << "Invalid bitrate value: " << bitrateStr.c_str();
-            return 0;
-        } catch (const std::out_of_range& e) {
-            qDebug() << "Bitrate value out of range: " << bitrateStr.c_str();
-            return 0;
+    // 作用域计时，析构时把耗时累加到指定阶段
+    class StageTimer
+    {
+    public:
+        explicit StageTimer(double &target) : m_target(target), m_start(std::chrono::steady_clock::now()) {}
+        ~StageTimer()
+        {
+            m_target += std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+        }
+
+    private:
+        double &m_target;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    // 解码图片文件（原始尺寸）
+    static FFmpegUtils::AvFramePtr decodeImageFile(const std::string &path, std::string &error)
+    {
+        ImageDecoder decoder;
+        if (path.empty() || !decoder.open(path)) {
+            error = "无法打开图片 " + path + ": " + decoder.getErrorString();
+            return nullptr;
+        }
+        auto frame = decoder.decode();
+        if (!frame) {
+            error = "解码图片失败 " + path + ": " + decoder.getErrorString();
         }
+        return frame;
     }
 
+    // 搭建场景图层：背景色、主图（image 非空时）、动态层（dynamicRect 非空时）与叠加图片（withOverlays 时）
+    static bool buildSceneLayers(const ProjectInfoConfig &project, const SceneConfig &scene, const AVFrame *image,
+                                 const LayerCompositor::Rect *dynamicRect, bool withOverlays, LayerCompositor &compositor, std::string &error)
+    {
+        if (!compositor.initialize(project.width, project.height, project.background_color)) {
+            error = compositor.getErrorString();
+            return false;
+        }
+        LayerCompositor::Fit fit = LayerCompositor::Fit::CONTAIN;
+        if (image) {
+            if (!LayerCompositor::parseFit(scene.resources.image.fit, LayerCompositor::Fit::CONTAIN, fit, &error)) {
+                return false;
+            }
+            if (!compositor.addImageLayer(image, scene.resources.image, fit)) {
+                error = compositor.getErrorString();
+                return false;
+            }
+        }
+        if (dynamicRect && !compositor.setDynamicLayer(*dynamicRect)) {
+            error = compositor.getErrorString();
+            return false;
+        }
+        if (!withOverlays) {
+            return true;
+        }
+        for (const auto &overlay : scene.resources.overlays) {
+            if (!LayerCompositor::parseFit(overlay.fit, LayerCompositor::Fit::NONE, fit, &error)) {
+                return false;
+            }
+            // 与主图打不开时的处理一致：记录日志后跳过该图层
+            std::string overlayError;
+            auto overlayFrame = decodeImageFile(overlay.path, overlayError);
+            if (!overlayFrame) {
+                qDebug() << "跳过叠加图片:" << overlayError.c_str();
+                continue;
+            }
+            if (!compositor.addImageLayer(overlayFrame.get(), overlay, fit)) {
+                error = compositor.getErrorString();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 图片场景的画面：背景色与按配置摆放的主图，withOverlays 时叠加图片一并合成
+    static FFmpegUtils::AvFramePtr composeImageScene(const ProjectInfoConfig &project, const SceneConfig &scene, const AVFrame *image,
+                                                     bool withOverlays, std::string &error)
+    {
+        VC_TRACE_SCOPE("compose_image_scene", "filter");
+        LayerCompositor compositor;
+        if (!buildSceneLayers(project, scene, image, nullptr, withOverlays, compositor, error)) {
+            return nullptr;
+        }
+        auto frame = compositor.composeStatic();
+        if (!frame) {
+            error = compositor.getErrorString();
+        }
+        return frame;
+    }
+
+    // 在铺满画面的帧（Ken Burns 帧）上合成场景的叠加图片；没有叠加图片时直接引用原帧
+    static FFmpegUtils::AvFramePtr composeSceneOverlays(const ProjectInfoConfig &project, const SceneConfig &scene, const AVFrame *frame,
+                                                        std::string &error)
+    {
+        if (scene.resources.overlays.empty()) {
+            return FFmpegUtils::copyAvFrame(frame);
+        }
+        LayerCompositor compositor;
+        const LayerCompositor::Rect fullFrame = LayerCompositor::fitRect(project.width, project.height, project.width, project.height,
+                                                                         LayerCompositor::Fit::STRETCH);
+        if (!buildSceneLayers(project, scene, nullptr, &fullFrame, true, compositor, error)) {
+            return nullptr;
+        }
+        auto composed = compositor.compose(frame);
+        if (!composed) {
+            error = compositor.getErrorString();
+        }
+        return composed;
+    }
+
+    // 视频场景的图层：源画面按 video.fit 适配为动态层，叠加图片在其上
+    static bool buildVideoSceneLayers(const ProjectInfoConfig &project, const SceneConfig &scene, const VideoDecoder &decoder,
+                                      LayerCompositor &compositor, std::string &error)
+    {
+        LayerCompositor::Fit fit = LayerCompositor::Fit::CONTAIN;
+        if (!LayerCompositor::parseFit(scene.resources.video.fit, LayerCompositor::Fit::CONTAIN, fit, &error)) {
+            return false;
+        }
+        const LayerCompositor::Rect rect = LayerCompositor::fitRect(decoder.sourceWidth(), decoder.sourceHeight(),
+                                                                    project.width, project.height, fit);
+        if (rect.empty()) {
+            error = "视频尺寸无效";
+            return false;
+        }
+        return buildSceneLayers(project, scene, nullptr, &rect, true, compositor, error);
+    }
+
+    // 视频帧缩放到动态层矩形后合成
+    static FFmpegUtils::AvFramePtr composeVideoFrame(VideoDecoder &decoder, const AVFrame *frame, LayerCompositor &compositor, std::string &error)
+    {
+        const LayerCompositor::Rect &rect = compositor.dynamicRect();
+        auto scaled = decoder.scaleFrame(frame, rect.width, rect.height, AV_PIX_FMT_YUV420P);
+        if (!scaled) {
+            error = "缩放视频帧失败: " + decoder.getErrorString();
+            return nullptr;
+        }
+        auto composed = compositor.compose(scaled.get());
+        if (!composed) {
+            error = "合成视频帧失败: " + compositor.getErrorString();
+        }
+        return composed;
+    }
 
     RenderEngine::RenderEngine()
         : m_videoStream(nullptr), m_audioStream(nullptr), m_audioFifo(nullptr), m_frameCount(0), m_audioSamplesCount(0), m_progress(0),
-          m_totalProjectFrames(0), m_lastReportedProgress(-1), m_enableAudioTransition(false),
+          m_totalProjectFrames(0), m_lastReportedProgress(-1),
           m_reusableMixFrameCapacity(0)
     {
     }
@@ -81,6 +198,10 @@ namespace VideoCreator
 
     bool RenderEngine::initialize(const ProjectConfig &config)
     {
+        m_stageStats = RenderStageStats();
+        m_metrics = RenderMetrics();
+        StageTimer setupTimer(m_stageStats.setup);
+        VC_TRACE_SCOPE("initialize", "engine");
         m_config = config;
         m_frameCount = 0;
         m_audioSamplesCount = 0;
@@ -92,8 +213,16 @@ namespace VideoCreator
         m_mixBufferRight.clear();
         m_reusableMixFrame.reset();
         m_reusableMixFrameCapacity = 0;
+        m_executorBaseline = TaskExecutor::instance().stats();
         scheduleVideoPrefetchTasks();
 
+        const VideoEncodingConfig &encoding = m_config.global_effects.video_encoding;
+        m_pass = EncoderSettings::isTwoPass(encoding) ? 1 : 0;
+        m_passLog.reset();
+        if (m_pass == 1) {
+            m_passLog = std::make_unique<TwoPassLog>(encoding.pass_log.empty() ? m_config.project.output_path + ".2pass.log" : encoding.pass_log);
+        }
+
 
 
         // 计算总帧数用于进度报告（scene.duration 已在 ConfigLoader 中同步到真实时长）
@@ -106,27 +235,181 @@ namespace VideoCreator
 
         m_totalProjectFrames = totalDuration * m_config.project.fps;
 
+        // 视频场景的解码线程与编码线程同时运行，从同一线程预算中分出
+        if (!VideoDecoder::resolveThreading(m_config.global_effects.video_decoding, m_threadBudget, m_decodeThreads, m_decodeThreadType, &m_errorString)) {
+            return false;
+        }
+        const bool hasVideoScene = std::any_of(m_config.scenes.begin(), m_config.scenes.end(), [](const SceneConfig &scene) {
+            return scene.type == SceneType::VIDEO_SCENE;
+        });
+        if (!hasVideoScene) {
+            m_decodeThreads = 0;
+        }
+        for (const auto &scene : m_config.scenes) {
+            FrameRateConverter::Mode frameRateMode;
+            if (scene.type == SceneType::VIDEO_SCENE &&
+                !FrameRateConverter::parseMode(scene.resources.video.frame_rate_mode, frameRateMode, &m_errorString)) {
+                return false;
+            }
+            LayerCompositor::Fit fit;
+            if (!LayerCompositor::parseFit(scene.resources.image.fit, LayerCompositor::Fit::CONTAIN, fit, &m_errorString) ||
+                !LayerCompositor::parseFit(scene.resources.video.fit, LayerCompositor::Fit::CONTAIN, fit, &m_errorString)) {
+                return false;
+            }
+            for (const auto &overlay : scene.resources.overlays) {
+                if (!LayerCompositor::parseFit(overlay.fit, LayerCompositor::Fit::NONE, fit, &m_errorString)) {
+                    return false;
+                }
+            }
+        }
+        LayerCompositor backgroundCheck;
+        if (!backgroundCheck.initialize(m_config.project.width, m_config.project.height, m_config.project.background_color)) {
+            m_errorString = backgroundCheck.getErrorString();
+            return false;
+        }
+        m_metrics.videoDecoderThreads = m_decodeThreads;
+
+        const std::string &outputFormat = m_config.project.output_format;
+        if (!outputFormat.empty() && outputFormat != "mp4" && outputFormat != "fragmented_mp4" &&
+            !SegmentedOutput::isSegmentedFormat(outputFormat)) {
+            m_errorString = "未知的输出封装: " + outputFormat;
+            return false;
+        }
+        if (!SegmentedOutput::validate(m_config, &m_errorString)) {
+            return false;
+        }
+        if (m_config.project.write_buffer_mb < 0 || m_config.project.write_buffer_mb > 256) {
+            m_errorString = "输出写缓冲大小须在 0 到 256 MB 之间";
+            return false;
+        }
+        m_fragmentedOutput = outputFormat == "fragmented_mp4";
+        m_segmentedOutput = SegmentedOutput::isSegmentedFormat(outputFormat);
+
+        m_checkpointing = false;
+        m_partPath.clear();
+        m_checkpointFingerprint.clear();
+        if (!m_config.project.checkpoint_dir.empty()) {
+            // 分段拼接只支持单遍编码的普通 mp4；设置了目录却不能续渲时报错，不静默按普通方式渲染
+            if (m_pass != 0 || m_fragmentedOutput || m_segmentedOutput) {
+                m_errorString = "checkpoint_dir 不支持两遍编码与 fragmented_mp4 / hls / dash 输出";
+                return false;
+            }
+            m_checkpointFingerprint = RenderCheckpoint::fingerprint(m_config);
+            // 分段输出在 render() 中逐段打开
+            m_checkpointing = true;
+            return true;
+        }
+
+        return openOutput();
+    }
+
+    bool RenderEngine::openOutput()
+    {
+        // 两遍编码的第二遍会重新打开，先释放上一遍的编码器与 FIFO
+        m_videoStream = nullptr;
+        m_audioStream = nullptr;
+        m_renditions.clear();
+        m_videoCodecContext.reset();
+        m_audioCodecContext.reset();
+        m_outputContext.reset();
+        m_outputFile.reset();
+        if (m_audioFifo) {
+            av_audio_fifo_free(m_audioFifo);
+            m_audioFifo = nullptr;
+        }
+        m_reusableMixFrame.reset();
+        m_reusableMixFrameCapacity = 0;
+        m_frameCount = 0;
+        m_audioSamplesCount = 0;
+
         if (!createOutputContext()) return false;
         if (!createVideoStream()) return false;
         if (!createAudioStream()) {
              qDebug() << "音频流创建失败，将生成无声视频";
         }
 
-        int ret = avformat_write_header(m_outputContext.get(), nullptr);
+        AVDictionary *muxerOptions = nullptr;
+        if (m_fragmentedOutput && m_pass != 1) {
+            // fMP4：文件头只写空 moov，之后每个关键帧开始一个 moof 分片并立即刷到磁盘，播放器无需等待文件尾
+            av_dict_set(&muxerOptions, "movflags", "frag_keyframe+empty_moov+default_base_moof", 0);
+            m_outputContext->flags |= AVFMT_FLAG_FLUSH_PACKETS;
+        } else if (m_segmentedOutput && m_pass != 1) {
+            const auto &renditions = m_config.project.renditions;
+            const int threadBudget = videoEncoderThreadBudget();
+            for (const auto &rendition : renditions) {
+                auto encoder = std::make_unique<RenditionEncoder>();
+                if (!encoder->open(m_outputContext.get(), m_config, rendition, threadBudget, &m_errorString)) {
+                    return false;
+                }
+                m_renditions.push_back(std::move(encoder));
+            }
+            SegmentedOutput::muxerOptions(m_config.project, m_audioStream != nullptr, &muxerOptions);
+        }
+        int ret = avformat_write_header(m_outputContext.get(), &muxerOptions);
+        av_dict_free(&muxerOptions);
         if (ret < 0) {
             m_errorString = format_ffmpeg_error(ret, "写入文件头失败");
             return false;
         }
+        m_headerEnd = (m_fragmentedOutput && m_pass != 1) ? avio_tell(m_outputContext->pb) : 0;
+        m_firstFragmentEnd = 0;
 
         return true;
     }
 
     bool RenderEngine::render()
+    {
+        if (m_checkpointing) {
+            return renderCheckpointed();
+        }
+        bool ok = true;
+        if (m_pass == 1) {
+            qDebug() << "两遍编码：第一遍分析";
+            ok = renderPass();
+            if (ok) {
+                // 第二遍写真实输出；场景首/末帧缓存保留复用，运行指标只反映最终这一遍
+                m_pass = 2;
+                m_metrics = RenderMetrics();
+                m_metrics.videoDecoderThreads = m_decodeThreads;
+                m_executorBaseline = TaskExecutor::instance().stats();
+                StageTimer setupTimer(m_stageStats.setup);
+                ok = openOutput();
+            }
+        }
+        if (ok) {
+            ok = renderPass();
+        }
+        if (m_passLog) {
+            if (m_videoCodecContext) {
+                m_videoCodecContext->stats_in = nullptr;
+            }
+            m_passLog.reset();
+        }
+        return ok;
+    }
+
+    bool RenderEngine::renderPass()
     {
         qDebug() << "开始渲染所有场景，总共" << m_config.scenes.size() << "个场景";
-        
-        for (size_t i = 0; i < m_config.scenes.size(); ++i)
+        if (!renderSceneRange(0, m_config.scenes.size())) return false;
+
+        StageTimer finalizeTimer(m_stageStats.finalize);
+        VC_TRACE_SCOPE("finalize", "engine");
+        if (!finishOutput(m_config.project.sync_output)) return false;
+
+        if (m_pass == 1) {
+            m_sceneFirstFramePrefetch.clear();
+            return true;
+        }
+        finishRender();
+        return true;
+    }
+
+    bool RenderEngine::renderSceneRange(size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
         {
+            if (!checkInterrupt()) return false;
             const auto &currentScene = m_config.scenes[i];
             qDebug() << "处理场景" << i << ": ID=" << currentScene.id << ", 类型=" << (currentScene.type == SceneType::TRANSITION ? "转场" : "普通");
 
@@ -138,58 +421,490 @@ namespace VideoCreator
                 }
                 const auto &fromScene = m_config.scenes[i - 1];
                 const auto &toScene = m_config.scenes[i + 1];
+                StageTimer transitionTimer(m_stageStats.transition);
+                VC_TRACE_SCOPE("transition_scene", "engine");
                 if (!renderTransition(currentScene, fromScene, toScene)) return false;
             }
             else
             {
+                VC_TRACE_SCOPE("scene", "engine");
+                if (m_audioStream && i + 2 < m_config.scenes.size() && m_config.scenes[i + 1].type == SceneType::TRANSITION) {
+                    startTransitionAudio(m_config.scenes[i + 1], m_config.scenes[i + 2]);
+                }
                 if (!renderScene(currentScene)) return false;
             }
         }
+        return true;
+    }
 
+    bool RenderEngine::finishOutput(bool sync)
+    {
         if (m_audioStream) {
             if (!flushAudio()) return false;
         }
 
         if (!flushEncoder(m_videoCodecContext.get(), m_videoStream)) return false;
-        if (!flushEncoder(m_audioCodecContext.get(), m_audioStream)) return false;
+        for (auto &rendition : m_renditions) {
+            if (!rendition->flush([this](AVPacket *packet) { return writePacket(packet); }, &m_errorString)) return false;
+        }
+        // 分段里的音频是 PCM，编码器只用来提供参数
+        if (m_partPath.empty() && !flushEncoder(m_audioCodecContext.get(), m_audioStream)) return false;
 
         int ret = av_write_trailer(m_outputContext.get());
         if (ret < 0) {
             m_errorString = format_ffmpeg_error(ret, "写入文件尾失败");
             return false;
         }
+        return closeOutputFile(sync);
+    }
+
+    void RenderEngine::finishRender()
+    {
+        // 执行器在进程内共享，同时进行的其他渲染的任务也会计入
+        const TaskExecutor &executor = TaskExecutor::instance();
+        const TaskExecutor::Stats executorStats = executor.stats();
+        m_metrics.schedulerWorkers = executor.workerCount();
+        m_metrics.schedulerTasks = executorStats.executed - m_executorBaseline.executed;
+        m_metrics.schedulerSteals = executorStats.stolen - m_executorBaseline.stolen;
+        m_metrics.schedulerQueueWaitSeconds = executorStats.queueWaitSeconds - m_executorBaseline.queueWaitSeconds;
+        // 本次渲染创建的系统线程：首次使用时的执行器工作线程，加上共享解复用的读包线程
+        m_metrics.threadsCreated = executorStats.threadsCreated - m_executorBaseline.threadsCreated + m_metrics.sharedDemuxerScenes;
 
         qDebug() << "视频渲染完成！总帧数: " << m_frameCount;
+        qDebug() << "渲染指标:" << m_metrics.summary().c_str();
 
         if (m_lastReportedProgress < 100) {
             m_progress = 100;
             m_lastReportedProgress = m_progress;
+            if (m_progressCallback) {
+                m_progressCallback(m_progress);
+            }
         }
 
         m_sceneFirstFramePrefetch.clear();
+    }
+
+    bool RenderEngine::renderCheckpointed()
+    {
+        const auto plan = RenderCheckpoint::planParts(m_config.scenes);
+        RenderCheckpoint checkpoint;
+        if (!checkpoint.open(m_config.project.checkpoint_dir, m_checkpointFingerprint, plan)) {
+            m_errorString = checkpoint.getErrorString();
+            return false;
+        }
+        const size_t resumed = checkpoint.completedParts().size();
+        m_metrics.checkpointParts = static_cast<int64_t>(plan.size());
+        m_metrics.checkpointPartsResumed = static_cast<int64_t>(resumed);
+        QByteArray pendingAudio;
+        if (resumed > 0) {
+            const RenderCheckpoint::Part &last = checkpoint.completedParts().back();
+            m_frameCount = last.endFrame;
+            m_audioSamplesCount = last.endAudioSamples;
+            pendingAudio = last.pendingAudio;
+            qDebug() << "断点续渲：已完成" << resumed << "/" << plan.size() << "段，从场景" << last.endScene << "继续";
+        }
+        qDebug() << "开始分段渲染，总共" << m_config.scenes.size() << "个场景，" << plan.size() << "段";
+
+        for (size_t p = resumed; p < plan.size(); ++p)
+        {
+            if (!checkInterrupt()) return false;
+            const int frameCount = m_frameCount;
+            const int64_t audioSamples = m_audioSamplesCount;
+            {
+                StageTimer setupTimer(m_stageStats.setup);
+                VC_TRACE_SCOPE("checkpoint_part_open", "engine");
+                m_partPath = checkpoint.partPath(p);
+                if (!openOutput()) return false;
+            }
+            // openOutput 会把计数清零；时间戳沿用全局值（有 B 帧时 NUT 会把首段整体后移，拼接时按段起始帧校正）
+            m_frameCount = frameCount;
+            m_audioSamplesCount = audioSamples;
+            if (m_audioFifo && !pendingAudio.isEmpty()) {
+                const int channels = m_audioCodecContext->ch_layout.nb_channels;
+                const int samples = pendingAudio.size() / (channels * static_cast<int>(sizeof(float)));
+                std::vector<void *> planes(channels);
+                for (int c = 0; c < channels; ++c) {
+                    planes[c] = pendingAudio.data() + static_cast<size_t>(c) * samples * sizeof(float);
+                }
+                if (av_audio_fifo_write(m_audioFifo, planes.data(), samples) < samples) {
+                    m_errorString = "恢复检查点音频失败";
+                    return false;
+                }
+            }
+
+            if (!renderSceneRange(plan[p].first, plan[p].second)) return false;
+
+            StageTimer finalizeTimer(m_stageStats.finalize);
+            VC_TRACE_SCOPE("checkpoint_part_close", "engine");
+            RenderCheckpoint::Part part;
+            part.firstScene = plan[p].first;
+            part.endScene = plan[p].second;
+            if (m_audioFifo && p + 1 < plan.size()) {
+                // 未满一帧的混音留给下一段，与不分段时 FIFO 的内容一致；最后一段由 flushAudio 补齐
+                const int channels = m_audioCodecContext->ch_layout.nb_channels;
+                const int samples = av_audio_fifo_size(m_audioFifo);
+                part.pendingAudio.resize(samples * channels * static_cast<int>(sizeof(float)));
+                std::vector<void *> planes(channels);
+                for (int c = 0; c < channels; ++c) {
+                    planes[c] = part.pendingAudio.data() + static_cast<size_t>(c) * samples * sizeof(float);
+                }
+                if (samples > 0 && av_audio_fifo_read(m_audioFifo, planes.data(), samples) < samples) {
+                    m_errorString = "读取检查点音频失败";
+                    return false;
+                }
+            }
+            // 分段落盘并关闭后才记入日志
+            if (!finishOutput(true)) return false;
+            m_outputContext.reset();
+            part.endFrame = m_frameCount;
+            part.endAudioSamples = m_audioSamplesCount;
+            if (!checkpoint.commit(part)) {
+                m_errorString = checkpoint.getErrorString();
+                return false;
+            }
+            pendingAudio = part.pendingAudio;
+            m_metrics.checkpointPartsWritten++;
+        }
+        m_partPath.clear();
+
+        bool partsMatch = true;
+        if (!checkCheckpointParts(checkpoint, &partsMatch)) return false;
+        if (!partsMatch) {
+            // 视频包原样复制，各段参数不同时拼出的文件只带第一段的 SPS/PPS，后面的段无法正确解码
+            qDebug() << "检查点分段的视频参数不一致，清除分段并整体重新渲染";
+            checkpoint.clear();
+            m_metrics = RenderMetrics();
+            m_metrics.videoDecoderThreads = m_decodeThreads;
+            m_executorBaseline = TaskExecutor::instance().stats();
+            {
+                StageTimer setupTimer(m_stageStats.setup);
+                if (!openOutput()) return false;
+            }
+            return renderPass();
+        }
+
+        StageTimer finalizeTimer(m_stageStats.finalize);
+        VC_TRACE_SCOPE("finalize", "engine");
+        if (!stitchCheckpointParts(checkpoint)) return false;
+        checkpoint.clear();
+        finishRender();
         return true;
     }
 
+    bool RenderEngine::checkCheckpointParts(const RenderCheckpoint &checkpoint, bool *match)
+    {
+        VC_TRACE_SCOPE("checkpoint_check", "mux");
+        *match = true;
+        const auto &parts = checkpoint.completedParts();
+        AVCodecParameters *first = avcodec_parameters_alloc();
+        if (!first) {
+            m_errorString = "分配视频流参数失败";
+            return false;
+        }
+        bool ok = true;
+        for (size_t p = 0; ok && *match && p < parts.size(); ++p)
+        {
+            const std::string path = checkpoint.partPath(p);
+            AVFormatContext *input = nullptr;
+            int ret = avformat_open_input(&input, path.c_str(), nullptr, nullptr);
+            if (ret < 0 || (ret = avformat_find_stream_info(input, nullptr)) < 0) {
+                m_errorString = format_ffmpeg_error(ret, "无法打开检查点分段 " + path);
+                ok = false;
+            } else {
+                const int videoIndex = av_find_best_stream(input, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+                if (videoIndex < 0) {
+                    m_errorString = "检查点分段中没有视频流: " + path;
+                    ok = false;
+                } else if (p == 0) {
+                    ret = avcodec_parameters_copy(first, input->streams[videoIndex]->codecpar);
+                    if (ret < 0) {
+                        m_errorString = format_ffmpeg_error(ret, "复制视频流参数失败");
+                        ok = false;
+                    }
+                } else {
+                    // extradata 里是 SPS/PPS（码流内头时为探测时从首个关键帧提取的那份）
+                    const AVCodecParameters *par = input->streams[videoIndex]->codecpar;
+                    *match = par->codec_id == first->codec_id && par->width == first->width
+                             && par->height == first->height && par->format == first->format
+                             && par->extradata_size == first->extradata_size
+                             && (first->extradata_size == 0
+                                 || std::memcmp(par->extradata, first->extradata, first->extradata_size) == 0);
+                    if (!*match) {
+                        qDebug() << "检查点分段" << p << "的视频参数与第一段不同";
+                    }
+                }
+            }
+            avformat_close_input(&input);
+        }
+        avcodec_parameters_free(&first);
+        return ok;
+    }
+
+    bool RenderEngine::stitchCheckpointParts(const RenderCheckpoint &checkpoint)
+    {
+        VC_TRACE_SCOPE("checkpoint_stitch", "mux");
+        m_videoStream = nullptr;
+        m_audioStream = nullptr;
+        m_videoCodecContext.reset();
+        m_audioCodecContext.reset();
+        m_outputContext.reset();
+        m_outputFile.reset();
+        if (m_audioFifo) {
+            av_audio_fifo_free(m_audioFifo);
+            m_audioFifo = nullptr;
+        }
+        m_audioSamplesCount = 0;
+        if (!createOutputContext()) return false;
+
+        struct InputGuard
+        {
+            AVFormatContext *context = nullptr;
+            ~InputGuard()
+            {
+                avformat_close_input(&context);
+            }
+        };
+        auto packet = FFmpegUtils::createAvPacket();
+        std::vector<float> planar;
+        int64_t frameDuration = 1;
+        const auto &parts = checkpoint.completedParts();
+        if (parts.empty()) {
+            m_errorString = "没有可拼接的检查点分段";
+            return false;
+        }
+        for (size_t p = 0; p < parts.size(); ++p)
+        {
+            const std::string path = checkpoint.partPath(p);
+            InputGuard input;
+            int ret = avformat_open_input(&input.context, path.c_str(), nullptr, nullptr);
+            if (ret < 0 || (ret = avformat_find_stream_info(input.context, nullptr)) < 0) {
+                m_errorString = format_ffmpeg_error(ret, "无法打开检查点分段 " + path);
+                return false;
+            }
+            const int videoIndex = av_find_best_stream(input.context, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+            const int audioIndex = av_find_best_stream(input.context, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+            if (videoIndex < 0) {
+                m_errorString = "检查点分段中没有视频流: " + path;
+                return false;
+            }
+
+            if (p == 0) {
+                // 各段视频参数已在 checkCheckpointParts 中比对一致，取第一段；音频按正常输出重新创建 AAC 编码器
+                const AVStream *inputVideo = input.context->streams[videoIndex];
+                m_videoStream = avformat_new_stream(m_outputContext.get(), nullptr);
+                if (!m_videoStream) {
+                    m_errorString = "创建视频流失败";
+                    return false;
+                }
+                m_videoStream->id = m_outputContext->nb_streams - 1;
+                ret = avcodec_parameters_copy(m_videoStream->codecpar, inputVideo->codecpar);
+                if (ret < 0) {
+                    m_errorString = format_ffmpeg_error(ret, "复制视频流参数失败");
+                    return false;
+                }
+                m_videoStream->codecpar->codec_tag = 0;
+                m_videoStream->time_base = inputVideo->time_base;
+                if (audioIndex >= 0 && !createAudioStream()) {
+                    return false;
+                }
+                ret = avformat_write_header(m_outputContext.get(), nullptr);
+                if (ret < 0) {
+                    m_errorString = format_ffmpeg_error(ret, "写入文件头失败");
+                    return false;
+                }
+                frameDuration = std::max<int64_t>(1, av_rescale_q(1, {1, m_config.project.fps}, m_videoStream->time_base));
+            }
+
+            // 有 B 帧时 NUT 读回的段首若干包没有 dts（编码器延迟），mp4 等封装器拒收；
+            // 先缓存到第一个有 dts 的包，再按帧间隔向前补出编码时原本连续的 dts
+            std::vector<FFmpegUtils::AvPacketPtr> leadingPackets;
+            bool dtsKnown = false;
+            // 段内第一个视频包是起始关键帧，其 pts 应等于段起始帧；首段 dts 为负时 NUT 会整体后移时间戳，这里移回
+            const int64_t startPts = av_rescale_q(p == 0 ? 0 : parts[p - 1].endFrame, {1, m_config.project.fps}, m_videoStream->time_base);
+            int64_t tsOffset = AV_NOPTS_VALUE;
+            auto flushLeadingPackets = [&](int64_t nextDts) {
+                for (size_t i = 0; i < leadingPackets.size(); ++i) {
+                    AVPacket *pending = leadingPackets[i].get();
+                    pending->dts = nextDts == AV_NOPTS_VALUE
+                        ? pending->pts
+                        : nextDts - static_cast<int64_t>(leadingPackets.size() - i) * frameDuration;
+                    const int err = av_interleaved_write_frame(m_outputContext.get(), pending);
+                    if (err < 0) {
+                        m_errorString = format_ffmpeg_error(err, "写入视频包失败 (拼接)");
+                        return false;
+                    }
+                }
+                leadingPackets.clear();
+                return true;
+            };
+
+            while ((ret = av_read_frame(input.context, packet.get())) >= 0) {
+                if (packet->stream_index == videoIndex) {
+                    // 视频包原样复制，不计入编码指标
+                    av_packet_rescale_ts(packet.get(), input.context->streams[videoIndex]->time_base, m_videoStream->time_base);
+                    packet->stream_index = m_videoStream->index;
+                    packet->pos = -1;
+                    if (tsOffset == AV_NOPTS_VALUE) {
+                        tsOffset = packet->pts == AV_NOPTS_VALUE ? 0 : startPts - packet->pts;
+                    }
+                    if (packet->pts != AV_NOPTS_VALUE) packet->pts += tsOffset;
+                    if (packet->dts != AV_NOPTS_VALUE) packet->dts += tsOffset;
+                    if (!dtsKnown && packet->dts == AV_NOPTS_VALUE) {
+                        leadingPackets.emplace_back(av_packet_clone(packet.get()));
+                        if (!leadingPackets.back()) {
+                            m_errorString = "复制视频包失败 (拼接)";
+                            return false;
+                        }
+                        av_packet_unref(packet.get());
+                        continue;
+                    }
+                    dtsKnown = true;
+                    if (!leadingPackets.empty() && !flushLeadingPackets(packet->dts)) return false;
+                    ret = av_interleaved_write_frame(m_outputContext.get(), packet.get());
+                    if (ret < 0) {
+                        m_errorString = format_ffmpeg_error(ret, "写入视频包失败 (拼接)");
+                        return false;
+                    }
+                } else if (packet->stream_index == audioIndex && m_audioStream) {
+                    // PCM_F32LE 拆回平面格式送入 FIFO，按整段音频连续编码
+                    const int channels = m_audioCodecContext->ch_layout.nb_channels;
+                    const int samples = packet->size / (channels * static_cast<int>(sizeof(float)));
+                    const float *in = reinterpret_cast<const float *>(packet->data);
+                    planar.resize(static_cast<size_t>(samples) * channels);
+                    std::vector<void *> planes(channels);
+                    for (int c = 0; c < channels; ++c) {
+                        float *plane = planar.data() + static_cast<size_t>(c) * samples;
+                        for (int i = 0; i < samples; ++i) {
+                            plane[i] = in[i * channels + c];
+                        }
+                        planes[c] = plane;
+                    }
+                    if (av_audio_fifo_write(m_audioFifo, planes.data(), samples) < samples) {
+                        m_errorString = "写入音频FIFO失败 (拼接)";
+                        return false;
+                    }
+                    if (!sendBufferedAudioFrames()) return false;
+                }
+                av_packet_unref(packet.get());
+            }
+            if (ret != AVERROR_EOF) {
+                m_errorString = format_ffmpeg_error(ret, "读取检查点分段失败 " + path);
+                return false;
+            }
+            if (!leadingPackets.empty() && !flushLeadingPackets(AV_NOPTS_VALUE)) return false;
+        }
+
+        if (m_audioStream) {
+            if (!flushAudio()) return false;
+            if (!flushEncoder(m_audioCodecContext.get(), m_audioStream)) return false;
+        }
+        int ret = av_write_trailer(m_outputContext.get());
+        if (ret < 0) {
+            m_errorString = format_ffmpeg_error(ret, "写入文件尾失败");
+            return false;
+        }
+        return closeOutputFile(m_config.project.sync_output);
+    }
+
     bool RenderEngine::createOutputContext()
     {
         AVFormatContext* temp_ctx = nullptr;
-        int ret = avformat_alloc_output_context2(&temp_ctx, nullptr, nullptr, m_config.project.output_path.c_str());
+        // 两遍编码的第一遍只需要编码统计，输出丢给 null 封装器；hls / dash 封装器自行创建分片与播放列表文件；
+        // 断点续渲的分段用 NUT，可直接存放 PCM 音频
+        std::string url = m_segmentedOutput ? SegmentedOutput::muxerUrl(m_config.project) : m_config.project.output_path;
+        const char *formatName = m_pass == 1 ? "null" : (m_segmentedOutput ? m_config.project.output_format.c_str() : nullptr);
+        if (!m_partPath.empty()) {
+            url = m_partPath;
+            formatName = "nut";
+        }
+        const char *fileName = m_pass == 1 ? nullptr : url.c_str();
+        int ret = avformat_alloc_output_context2(&temp_ctx, nullptr, formatName, fileName);
         if (ret < 0) {
             m_errorString = format_ffmpeg_error(ret, "创建输出上下文失败");
             return false;
         }
         m_outputContext.reset(temp_ctx);
+        const bool finalOutput = m_pass != 1 && m_partPath.empty();
+        if (finalOutput && (m_outputContext->oformat->flags & AVFMT_NOFILE)) {
+            m_outputContext->opaque = this;
+            m_defaultIoOpen = m_outputContext->io_open;
+            m_defaultIoClose = m_outputContext->io_close2;
+            m_outputContext->io_open = &RenderEngine::recordingIoOpen;
+            m_outputContext->io_close2 = &RenderEngine::recordingIoClose;
+        }
 
         if (!(m_outputContext->oformat->flags & AVFMT_NOFILE)) {
-            ret = avio_open(&m_outputContext->pb, m_config.project.output_path.c_str(), AVIO_FLAG_WRITE);
-            if (ret < 0) {
-                m_errorString = format_ffmpeg_error(ret, "无法打开输出文件");
-                return false;
+            const int bufferMb = m_config.project.write_buffer_mb;
+            if (bufferMb > 0) {
+                // 双缓冲：I/O 线程写一块时渲染线程填下一块，另留一块排队吸收磁盘抖动
+                m_outputFile = std::make_unique<AsyncOutputFile>();
+                if (!m_outputFile->open(url, static_cast<size_t>(bufferMb) * 1024 * 1024, 2, m_fragmentedOutput)) {
+                    m_errorString = m_outputFile->getErrorString();
+                    m_outputFile.reset();
+                    return false;
+                }
+                m_outputContext->pb = m_outputFile->ioContext();
+                m_outputContext->flags |= AVFMT_FLAG_CUSTOM_IO;
+                m_metrics.outputBufferBytes = static_cast<int64_t>(bufferMb) * 1024 * 1024;
+            } else {
+                ret = avio_open(&m_outputContext->pb, url.c_str(), AVIO_FLAG_WRITE);
+                if (ret < 0) {
+                    m_errorString = format_ffmpeg_error(ret, "无法打开输出文件");
+                    return false;
+                }
+            }
+            if (finalOutput) {
+                m_createdOutputs.insert(url);
             }
         }
         return true;
     }
 
+    int RenderEngine::recordingIoOpen(AVFormatContext *context, AVIOContext **pb, const char *url, int flags, AVDictionary **options)
+    {
+        RenderEngine *engine = static_cast<RenderEngine *>(context->opaque);
+        const int ret = engine->m_defaultIoOpen(context, pb, url, flags, options);
+        if (ret >= 0 && (flags & AVIO_FLAG_WRITE)) {
+            engine->m_createdOutputs.insert(url);
+            engine->m_openOutputs[*pb] = url;
+        }
+        return ret;
+    }
+
+    int RenderEngine::recordingIoClose(AVFormatContext *context, AVIOContext *pb)
+    {
+        RenderEngine *engine = static_cast<RenderEngine *>(context->opaque);
+        auto it = engine->m_openOutputs.find(pb);
+        if (it != engine->m_openOutputs.end()) {
+            static const std::string kTempSuffix = ".tmp";
+            const std::string &url = it->second;
+            if (url.size() > kTempSuffix.size() && url.compare(url.size() - kTempSuffix.size(), kTempSuffix.size(), kTempSuffix) == 0) {
+                engine->m_createdOutputs.insert(url.substr(0, url.size() - kTempSuffix.size()));
+            }
+            engine->m_openOutputs.erase(it);
+        }
+        return engine->m_defaultIoClose(context, pb);
+    }
+
+    bool RenderEngine::closeOutputFile(bool sync)
+    {
+        if (!m_outputFile) return true;
+        VC_TRACE_SCOPE("output_close", "mux");
+        const bool ok = m_outputFile->close(sync);
+        m_outputContext->pb = nullptr;
+        // 断点续渲时每个分段与最终输出各关闭一次，累加
+        const AsyncOutputFile::Stats &stats = m_outputFile->stats();
+        m_metrics.outputWriteStalls += stats.stalls;
+        m_metrics.outputWriteStallSeconds += stats.stallSeconds;
+        m_metrics.outputIoSeconds += stats.ioSeconds;
+        m_metrics.outputPreallocatedBytes += stats.preallocatedBytes;
+        if (!ok) {
+            m_errorString = m_outputFile->getErrorString();
+        }
+        m_outputFile.reset();
+        return ok;
+    }
+
     bool RenderEngine::createVideoStream()
     {
         const AVCodec *videoCodec = avcodec_find_encoder_by_name(m_config.global_effects.video_encoding.codec.c_str());
@@ -216,18 +931,27 @@ namespace VideoCreator
         m_videoCodecContext->time_base = {1, m_config.project.fps};
         m_videoCodecContext->framerate = {m_config.project.fps, 1};
         m_videoCodecContext->pix_fmt = AV_PIX_FMT_YUV420P;
-        std::string bitrateStr = m_config.global_effects.video_encoding.bitrate;
-        m_videoCodecContext->bit_rate = parseBitrate(bitrateStr);
-        m_videoCodecContext->gop_size = 12;
-        unsigned int hardwareThreads = std::thread::hardware_concurrency();
-        if (hardwareThreads == 0) {
-            hardwareThreads = 4;
+        // 由调用方（如 RenderQueue）分配的线程预算，多个任务并行时不再各自抢占全部核心
+        const VideoEncodingConfig &encoding = m_config.global_effects.video_encoding;
+        ResolvedVideoEncoding resolved = EncoderSettings::resolve(encoding, m_config.project.fps, videoEncoderThreadBudget());
+        if (m_segmentedOutput) {
+            resolved.gopSize = SegmentedOutput::keyframeInterval(m_config.project);
+            resolved.fixedKeyframes = true;
+            if (m_outputContext->oformat->flags & AVFMT_GLOBALHEADER) {
+                m_videoCodecContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+            }
+        } else if (!m_partPath.empty()) {
+            // 检查点分段：最终格式需要全局头（mp4 / mkv）时 SPS/PPS 写进各段的流参数，拼接前逐段比对；
+            // 否则（如 ts）仍留在码流内，每段自带
+            const AVOutputFormat *finalFormat = av_guess_format(nullptr, m_config.project.output_path.c_str(), nullptr);
+            if (finalFormat && (finalFormat->flags & AVFMT_GLOBALHEADER)) {
+                m_videoCodecContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+            }
+        }
+        if (!EncoderSettings::apply(m_videoCodecContext.get(), encoding, resolved, &m_errorString, m_pass, m_passLog.get())) {
+            return false;
         }
-        m_videoCodecContext->thread_count = static_cast<int>(std::min(8u, hardwareThreads));
-        m_videoCodecContext->thread_type = FF_THREAD_FRAME;
-
-        av_opt_set(m_videoCodecContext->priv_data, "preset", m_config.global_effects.video_encoding.preset.c_str(), 0);
-        av_opt_set_int(m_videoCodecContext->priv_data, "crf", m_config.global_effects.video_encoding.crf, 0);
+        m_metrics.videoEncoderThreads = m_videoCodecContext->thread_count;
 
         int ret = avcodec_open2(m_videoCodecContext.get(), videoCodec, nullptr);
         if (ret < 0) {
@@ -241,9 +965,27 @@ namespace VideoCreator
             return false;
         }
         m_videoStream->time_base = m_videoCodecContext->time_base;
+        if (m_segmentedOutput) {
+            // crf 模式下编码器不报告码率，播放列表的 BANDWIDTH / 清单的 bandwidth 需要声明值
+            m_videoStream->codecpar->bit_rate = SegmentedOutput::advertisedBitrate(resolved.bitRate, resolved.maxRate);
+        }
         return true;
     }
 
+    int RenderEngine::videoEncoderThreadBudget() const
+    {
+        // 未分配预算时编码器沿用自己的默认值，解码线程另计
+        int budget = m_threadBudget;
+        if (budget > 0 && m_decodeThreads > 0) {
+            budget = std::max(1, budget - m_decodeThreads);
+        }
+        // 码率阶梯的各编码器再平分
+        if (!m_config.project.renditions.empty()) {
+            budget = SegmentedOutput::encoderThreadBudget(budget, static_cast<int>(m_config.project.renditions.size()) + 1);
+        }
+        return budget;
+    }
+
     bool RenderEngine::createAudioStream()
     {
         const AVCodec *audioCodec = avcodec_find_encoder_by_name(m_config.global_effects.audio_encoding.codec.c_str());
@@ -267,7 +1009,7 @@ namespace VideoCreator
 
         m_audioCodecContext->sample_fmt = AV_SAMPLE_FMT_FLTP;
         std::string bitrateStr = m_config.global_effects.audio_encoding.bitrate;
-        m_audioCodecContext->bit_rate = parseBitrate(bitrateStr);
+        m_audioCodecContext->bit_rate = EncoderSettings::parseBitrate(bitrateStr);
         m_audioCodecContext->sample_rate = 44100;
         av_channel_layout_from_mask(&m_audioCodecContext->ch_layout, AV_CH_LAYOUT_STEREO);
         m_audioCodecContext->time_base = {1, m_audioCodecContext->sample_rate};
@@ -275,14 +1017,32 @@ namespace VideoCreator
         if (audioThreads == 0) {
             audioThreads = 2;
         }
+        if (m_threadBudget > 0) {
+            audioThreads = static_cast<unsigned int>(std::max(1, m_threadBudget / 4));
+        }
         m_audioCodecContext->thread_count = static_cast<int>(std::min(4u, audioThreads));
+        m_metrics.audioEncoderThreads = m_audioCodecContext->thread_count;
 
         int ret = avcodec_open2(m_audioCodecContext.get(), audioCodec, nullptr);
         if (ret < 0) {
             m_errorString = format_ffmpeg_error(ret, "打开音频编码器失败");
             return false;
         }
-        ret = avcodec_parameters_from_context(m_audioStream->codecpar, m_audioCodecContext.get());
+        if (!m_partPath.empty()) {
+            // 检查点分段只保存混音后的 PCM，拼接时整体编码一次，避免每段的编码器起始延迟与末尾补齐
+            AVCodecParameters *par = m_audioStream->codecpar;
+            const int channels = m_audioCodecContext->ch_layout.nb_channels;
+            par->codec_type = AVMEDIA_TYPE_AUDIO;
+            par->codec_id = AV_CODEC_ID_PCM_F32LE;
+            par->format = AV_SAMPLE_FMT_FLT;
+            par->sample_rate = m_audioCodecContext->sample_rate;
+            par->bits_per_coded_sample = 32;
+            par->block_align = 4 * channels;
+            par->bit_rate = static_cast<int64_t>(par->sample_rate) * channels * 32;
+            ret = av_channel_layout_copy(&par->ch_layout, &m_audioCodecContext->ch_layout);
+        } else {
+            ret = avcodec_parameters_from_context(m_audioStream->codecpar, m_audioCodecContext.get());
+        }
         if (ret < 0) {
             m_errorString = format_ffmpeg_error(ret, "复制音频流参数失败");
             return false;
@@ -305,11 +1065,17 @@ namespace VideoCreator
             int64_t delaySamples = 0;
             std::mutex mutex;
             std::condition_variable cv;
-            std::thread worker;
+            std::function<void()> pump; // 解码到缓冲满为止，由混音取走采样后重新调度
+            size_t capacity = 0;        // 缓冲上限（采样数）
+            TaskHandle task;            // 最近一次调度的解码任务，受 mutex 保护
+            bool running = false;       // 解码任务已调度或正在执行，受 mutex 保护
+            std::chrono::steady_clock::time_point parkedAt;
             bool finished = false;
             bool error = false;
             std::atomic<bool> stopRequested{false};
             std::string errorMessage;
+            int64_t stalls = 0; // 缓冲满时解码任务的暂停次数与时长，受 mutex 保护
+            double stallSeconds = 0.0;
         };
 
         struct AudioLayerThreadGuard
@@ -331,15 +1097,15 @@ namespace VideoCreator
                         continue;
                     }
                     auto &layer = *layerPtr;
+                    TaskHandle task;
                     {
                         std::lock_guard<std::mutex> lock(layer.mutex);
                         layer.stopRequested.store(true);
+                        task = layer.task;
                     }
                     layer.cv.notify_all();
-                    if (layer.worker.joinable())
-                    {
-                        layer.worker.join();
-                    }
+                    // 停止后不再调度新任务，等最近一次任务返回即可
+                    task.wait();
                 }
             }
         };
@@ -353,28 +1119,35 @@ namespace VideoCreator
             bool error = false;
             std::atomic<bool> stopRequested{false};
             std::string errorMessage;
+            TaskHandle task;      // 最近一次调度的解码任务，受 mutex 保护
+            bool running = false; // 解码任务已调度或正在执行，受 mutex 保护
+            std::chrono::steady_clock::time_point parkedAt;
+            int64_t stalls = 0; // 队列满时解码任务的暂停次数与时长，受 mutex 保护
+            double stallSeconds = 0.0;
+            int64_t droppedFrames = 0; // 帧率转换统计，受 mutex 保护
+            int64_t duplicatedFrames = 0;
+            int64_t blendedFrames = 0;
+            LayerCompositor::Stats compositorStats; // 图层合成统计，受 mutex 保护
         };
 
-        struct FrameThreadGuard
+        struct FrameTaskGuard
         {
             AsyncFrameQueue &queue;
-            std::thread worker;
-            FrameThreadGuard(AsyncFrameQueue &q) : queue(q) {}
-            ~FrameThreadGuard()
+            FrameTaskGuard(AsyncFrameQueue &q) : queue(q) {}
+            ~FrameTaskGuard()
             {
                 stop();
             }
             void stop()
             {
-                if (worker.joinable())
+                TaskHandle task;
                 {
-                    {
-                        std::lock_guard<std::mutex> lock(queue.mutex);
-                        queue.stopRequested.store(true);
-                    }
-                    queue.cv.notify_all();
-                    worker.join();
+                    std::lock_guard<std::mutex> lock(queue.mutex);
+                    queue.stopRequested.store(true);
+                    task = queue.task;
                 }
+                queue.cv.notify_all();
+                task.wait();
             }
         };
 
@@ -388,6 +1161,8 @@ namespace VideoCreator
              qDebug() << "无法打开图片: " << imageDecoder.getErrorString();
         }
 
+        // 使用原视频音轨时音视频共用一次解复用，避免同一文件被打开、解析两遍
+        std::shared_ptr<SharedDemuxer> sharedDemuxer;
         VideoDecoder videoDecoder;
         bool videoSourceAvailable = false;
         if (isVideoScene) {
@@ -395,7 +1170,16 @@ namespace VideoCreator
                 m_errorString = "视频场景缺少视频文件路径";
                 return false;
             }
-            if (!videoDecoder.open(scene.resources.video.path)) {
+            if (scene.resources.video.use_audio && m_audioStream) {
+                sharedDemuxer = std::make_shared<SharedDemuxer>();
+                if (!sharedDemuxer->open(scene.resources.video.path) || sharedDemuxer->audioStreamIndex() < 0) {
+                    // 无音轨或打开失败时退回各自打开文件，由下面的 open 报告错误
+                    sharedDemuxer.reset();
+                }
+            }
+            videoDecoder.setThreading(m_decodeThreads, m_decodeThreadType);
+            const bool videoOpened = sharedDemuxer ? videoDecoder.open(sharedDemuxer) : videoDecoder.open(scene.resources.video.path);
+            if (!videoOpened) {
                 m_errorString = "无法打开视频: " + videoDecoder.getErrorString();
                 return false;
             }
@@ -417,65 +1201,150 @@ namespace VideoCreator
         AudioLayerThreadGuard audioLayerGuard(sceneAudioLayers);
         double longestAudioDuration = -1.0;
 
+        // 解码任务引用的对象须比下面的守卫活得长
+        TaskExecutor &executor = TaskExecutor::instance();
+        std::unique_ptr<FrameRateConverter> frameRateConverter;
+        LayerCompositor videoCompositor;
+        std::function<void()> videoPump;
         AsyncFrameQueue videoFrameQueue;
-        FrameThreadGuard videoThreadGuard(videoFrameQueue);
+        FrameTaskGuard videoTaskGuard(videoFrameQueue);
+
+        // 最先析构：停止读包线程，唤醒阻塞在 readPacket 上的解码任务，之后上面两个守卫才能等到任务返回
+        struct DemuxerStopGuard
+        {
+            std::shared_ptr<SharedDemuxer> &demuxer;
+            ~DemuxerStopGuard()
+            {
+                if (demuxer)
+                {
+                    demuxer->stop();
+                }
+            }
+        } demuxerGuard{sharedDemuxer};
+        // 解码任务一次解到队列满为止，主循环取走帧后再重新调度，不为场景单独创建线程
+        const size_t maxVideoQueueSize = 8;
+        auto scheduleVideoDecodeLocked = [&]() {
+            if (!videoPump || videoFrameQueue.running || videoFrameQueue.finished || videoFrameQueue.error ||
+                videoFrameQueue.stopRequested.load() || videoFrameQueue.frames.size() >= maxVideoQueueSize) {
+                return;
+            }
+            if (videoFrameQueue.parkedAt != std::chrono::steady_clock::time_point{}) {
+                videoFrameQueue.stallSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - videoFrameQueue.parkedAt).count();
+                videoFrameQueue.parkedAt = {};
+            }
+            videoFrameQueue.running = true;
+            videoFrameQueue.task = executor.submit(videoPump);
+        };
         if (isVideoScene && videoSourceAvailable)
         {
-            const size_t maxVideoQueueSize = 8;
-            videoThreadGuard.worker = std::thread([&, maxVideoQueueSize]() {
+            m_metrics.videoQueueCapacity = static_cast<int>(maxVideoQueueSize);
+            // 源画面按 fit 放进动态层矩形，矩形外的背景与叠加图片只合成一次
+            std::string layerError;
+            if (!buildVideoSceneLayers(m_config.project, scene, videoDecoder, videoCompositor, layerError)) {
+                m_errorString = "搭建视频场景图层失败: " + layerError;
+                return false;
+            }
+            FrameRateConverter::Mode frameRateMode = FrameRateConverter::Mode::DROP;
+            FrameRateConverter::parseMode(scene.resources.video.frame_rate_mode, frameRateMode);
+            const int64_t targetSceneFrames = static_cast<int64_t>(std::round(sceneDuration * m_config.project.fps));
+            // 按源帧时间戳对齐项目帧率：先决定每个源帧输出几次，不输出的帧不做缩放
+            frameRateConverter = std::make_unique<FrameRateConverter>(m_config.project.fps, frameRateMode, targetSceneFrames);
+            frameRateConverter->setSourceFps(videoDecoder.getFrameRate());
+            videoPump = [&]() {
+                VC_TRACE_SCOPE("video_decode_task", "decode");
+                FrameRateConverter &converter = *frameRateConverter;
+                std::string composeError;
+                auto scale = [&](const AVFrame *frame) {
+                    return composeVideoFrame(videoDecoder, frame, videoCompositor, composeError);
+                };
+                auto emit = [&](FFmpegUtils::AvFramePtr scaledFrame) {
+                    std::unique_lock<std::mutex> lock(videoFrameQueue.mutex);
+                    if (videoFrameQueue.stopRequested.load())
+                    {
+                        return false;
+                    }
+                    // 一个源帧可能重复输出多次，允许暂时超出上限，下一轮解码前再检查
+                    videoFrameQueue.frames.push_back(std::move(scaledFrame));
+                    videoFrameQueue.droppedFrames = converter.droppedFrames();
+                    videoFrameQueue.duplicatedFrames = converter.duplicatedFrames();
+                    videoFrameQueue.blendedFrames = converter.blendedFrames();
+                    videoFrameQueue.compositorStats = videoCompositor.stats();
+                    lock.unlock();
+                    videoFrameQueue.cv.notify_all();
+                    return true;
+                };
+                auto finish = [&](bool finished, const std::string &message) {
+                    std::lock_guard<std::mutex> lock(videoFrameQueue.mutex);
+                    if (!finished && !videoFrameQueue.stopRequested.load())
+                    {
+                        videoFrameQueue.error = true;
+                        videoFrameQueue.errorMessage = message;
+                    }
+                    videoFrameQueue.finished = finished;
+                    videoFrameQueue.droppedFrames = converter.droppedFrames();
+                    videoFrameQueue.running = false;
+                    videoFrameQueue.cv.notify_all();
+                };
                 while (true)
                 {
-                    if (videoFrameQueue.stopRequested.load())
                     {
-                        break;
+                        std::lock_guard<std::mutex> lock(videoFrameQueue.mutex);
+                        if (videoFrameQueue.stopRequested.load() || videoFrameQueue.frames.size() >= maxVideoQueueSize)
+                        {
+                            if (!videoFrameQueue.stopRequested.load())
+                            {
+                                ++videoFrameQueue.stalls;
+                                videoFrameQueue.parkedAt = std::chrono::steady_clock::now();
+                            }
+                            videoFrameQueue.running = false;
+                            return;
+                        }
                     }
                     FFmpegUtils::AvFramePtr decodedFrame;
-                    int decodeResult = videoDecoder.decodeFrame(decodedFrame);
+                    int decodeResult = converter.done() ? 0 : videoDecoder.decodeFrame(decodedFrame);
                     if (decodeResult > 0 && decodedFrame)
                     {
-                        auto scaledFrame = videoDecoder.scaleFrame(decodedFrame.get(), m_config.project.width, m_config.project.height, AV_PIX_FMT_YUV420P);
-                        if (!scaledFrame)
-                        {
-                            std::lock_guard<std::mutex> lock(videoFrameQueue.mutex);
-                            videoFrameQueue.error = true;
-                            videoFrameQueue.errorMessage = "Failed to scale video frame: " + videoDecoder.getErrorString();
-                            videoFrameQueue.cv.notify_all();
-                            break;
-                        }
-                        std::unique_lock<std::mutex> lock(videoFrameQueue.mutex);
-                        videoFrameQueue.cv.wait(lock, [&]() {
-                            return videoFrameQueue.stopRequested.load() || videoFrameQueue.frames.size() < maxVideoQueueSize;
-                        });
-                        if (videoFrameQueue.stopRequested.load())
+                        const double timestamp = videoDecoder.frameTimestamp(decodedFrame.get());
+                        if (!converter.push(std::move(decodedFrame), timestamp, scale, emit))
                         {
-                            break;
+                            finish(false, composeError.empty() ? converter.getErrorString() : composeError);
+                            return;
                         }
-                        videoFrameQueue.frames.push_back(std::move(scaledFrame));
-                        lock.unlock();
-                        videoFrameQueue.cv.notify_all();
                     }
                     else if (decodeResult == 0)
                     {
-                        std::lock_guard<std::mutex> lock(videoFrameQueue.mutex);
-                        videoFrameQueue.finished = true;
-                        videoFrameQueue.cv.notify_all();
-                        break;
+                        const bool flushed = converter.finish(scale, emit);
+                        finish(flushed, composeError.empty() ? converter.getErrorString() : composeError);
+                        return;
                     }
                     else
                     {
-                        std::lock_guard<std::mutex> lock(videoFrameQueue.mutex);
-                        videoFrameQueue.error = true;
-                        videoFrameQueue.errorMessage = "Failed to decode video frame: " + videoDecoder.getErrorString();
-                        videoFrameQueue.cv.notify_all();
-                        break;
+                        finish(false, "Failed to decode video frame: " + videoDecoder.getErrorString());
+                        return;
                     }
                 }
-            });
+            };
+            std::lock_guard<std::mutex> lock(videoFrameQueue.mutex);
+            scheduleVideoDecodeLocked();
         }
 
+        auto scheduleAudioDecodeLocked = [&](SceneAudioLayer &layer) {
+            if (!layer.pump || layer.running || layer.finished || layer.error || layer.stopRequested.load() ||
+                layer.channels[0].size() >= layer.capacity) {
+                return;
+            }
+            if (layer.parkedAt != std::chrono::steady_clock::time_point{}) {
+                layer.stallSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - layer.parkedAt).count();
+                layer.parkedAt = {};
+            }
+            layer.running = true;
+            layer.task = executor.submit(layer.pump);
+        };
+
         if (m_audioStream) {
             const int targetSampleRate = (m_audioCodecContext && m_audioCodecContext->sample_rate > 0) ? m_audioCodecContext->sample_rate : 44100;
             const size_t maxBufferedSamples = static_cast<size_t>(targetSampleRate) * 5;
+            m_metrics.audioBufferCapacity = static_cast<int64_t>(maxBufferedSamples);
             size_t expectedLayers = 0;
             if (!scene.resources.audio.path.empty()) {
                 expectedLayers++;
@@ -488,28 +1357,29 @@ namespace VideoCreator
                 sceneAudioLayers.reserve(expectedLayers);
             }
             std::vector<AudioConfig> transientAudioConfigs;
-            auto startAudioLayerWorker = [&](SceneAudioLayer &layerRef) {
+            auto startAudioLayerDecode = [&](SceneAudioLayer &layerRef) {
                 SceneAudioLayer *layerPtr = &layerRef;
-                layerRef.worker = std::thread([layerPtr, maxBufferedSamples]() {
+                layerRef.capacity = maxBufferedSamples;
+                layerRef.pump = [layerPtr]() {
+                    VC_TRACE_SCOPE("audio_decode_task", "decode");
                     while (true) {
                         {
                             std::lock_guard<std::mutex> lock(layerPtr->mutex);
-                            if (layerPtr->stopRequested.load()) {
-                                break;
+                            if (layerPtr->stopRequested.load() || layerPtr->channels[0].size() >= layerPtr->capacity) {
+                                if (!layerPtr->stopRequested.load()) {
+                                    ++layerPtr->stalls;
+                                    layerPtr->parkedAt = std::chrono::steady_clock::now();
+                                }
+                                layerPtr->running = false;
+                                return;
                             }
                         }
                         FFmpegUtils::AvFramePtr frame;
                         int decodeResult = layerPtr->decoder->decodeFrame(frame);
+                        std::unique_lock<std::mutex> lock(layerPtr->mutex);
                         if (decodeResult > 0 && frame) {
                             int channelCount = frame->ch_layout.nb_channels > 0 ? frame->ch_layout.nb_channels : 1;
                             channelCount = std::min(channelCount, 2);
-                            std::unique_lock<std::mutex> lock(layerPtr->mutex);
-                            layerPtr->cv.wait(lock, [&]() {
-                                return layerPtr->stopRequested.load() || layerPtr->channels[0].size() < maxBufferedSamples;
-                            });
-                            if (layerPtr->stopRequested.load()) {
-                                break;
-                            }
                             for (int ch = 0; ch < channelCount; ++ch) {
                                 float *data = reinterpret_cast<float *>(frame->data[ch]);
                                 layerPtr->channels[ch].insert(layerPtr->channels[ch].end(), data, data + frame->nb_samples);
@@ -523,29 +1393,32 @@ namespace VideoCreator
                             layerPtr->channels[1].resize(maxSamples, 0.0f);
                             lock.unlock();
                             layerPtr->cv.notify_all();
-                        } else if (decodeResult == 0) {
-                            std::lock_guard<std::mutex> lock(layerPtr->mutex);
+                            continue;
+                        }
+                        if (decodeResult == 0) {
                             layerPtr->finished = true;
-                            layerPtr->cv.notify_all();
-                            break;
-                        } else {
-                            std::lock_guard<std::mutex> lock(layerPtr->mutex);
+                        } else if (!layerPtr->stopRequested.load()) {
                             layerPtr->error = true;
                             layerPtr->errorMessage = layerPtr->decoder ? layerPtr->decoder->getErrorString() : std::string("Audio decode failed");
-                            layerPtr->cv.notify_all();
-                            break;
                         }
+                        layerPtr->running = false;
+                        layerPtr->cv.notify_all();
+                        return;
                     }
-                });
+                };
+                std::lock_guard<std::mutex> lock(layerRef.mutex);
+                scheduleAudioDecodeLocked(layerRef);
             };
 
-            auto addAudioLayer = [&](const AudioConfig &audioConfig, bool applySceneEffect, bool isCritical) {
+            auto addAudioLayer = [&](const AudioConfig &audioConfig, bool applySceneEffect, bool isCritical,
+                                     const std::shared_ptr<SharedDemuxer> &demuxer = nullptr) {
                 if (audioConfig.path.empty()) {
                     return true;
                 }
 
                 auto decoder = std::make_unique<AudioDecoder>();
-                if (!decoder->open(audioConfig.path)) {
+                const bool opened = demuxer ? decoder->open(demuxer) : decoder->open(audioConfig.path);
+                if (!opened) {
                     qDebug() << "Failed to open audio:" << QString::fromStdString(audioConfig.path) << "reason:" << decoder->getErrorString().c_str();
                     return !isCritical;
                 }
@@ -574,7 +1447,7 @@ namespace VideoCreator
                 }
                 SceneAudioLayer &layerRef = *layer;
                 sceneAudioLayers.emplace_back(std::move(layer));
-                startAudioLayerWorker(layerRef);
+                startAudioLayerDecode(layerRef);
                 return true;
             };
 
@@ -596,13 +1469,19 @@ namespace VideoCreator
                 videoAudioConfig.volume = 1.0;
                 videoAudioConfig.start_offset = 0.0;
                 bool treatAsPrimary = scene.resources.audio.path.empty() && scene.resources.audio_layers.empty();
-                if (!addAudioLayer(videoAudioConfig, treatAsPrimary, treatAsPrimary) && treatAsPrimary) {
+                if (!addAudioLayer(videoAudioConfig, treatAsPrimary, treatAsPrimary, sharedDemuxer) && treatAsPrimary) {
                     m_errorString = "Failed to initialize video audio";
                     return false;
                 }
             }
         }
 
+        // 所有解码器接入后才开始读包，接入前读到的包会被丢弃
+        if (sharedDemuxer) {
+            sharedDemuxer->start();
+            ++m_metrics.sharedDemuxerScenes;
+        }
+
         auto enqueueSilenceFrame = [&](int requiredSamples) -> bool {
             if (!m_audioStream || requiredSamples <= 0) {
                 return true;
@@ -616,6 +1495,7 @@ namespace VideoCreator
                 m_errorString = "Failed to enqueue silence frame into FIFO";
                 return false;
             }
+            m_transitionAudio.recordTail(nullptr, nullptr, audioFrame->nb_samples);
             return true;
         };
 
@@ -631,6 +1511,7 @@ namespace VideoCreator
             m_mixBufferRight.assign(samplesNeeded, 0.0f);
             bool hasActiveLayer = false;
             bool hasPendingAudio = false;
+            double decodeWaitSeconds = 0.0;
 
             for (auto &layerPtr : sceneAudioLayers) {
                 if (!layerPtr) {
@@ -655,9 +1536,12 @@ namespace VideoCreator
                 int consumed = 0;
                 while (consumed < requiredSamples) {
                     std::unique_lock<std::mutex> lock(layer.mutex);
+                    const auto waitStart = std::chrono::steady_clock::now();
                     layer.cv.wait(lock, [&]() {
                         return layer.stopRequested.load() || layer.error || !layer.channels[0].empty() || layer.finished;
                     });
+                    decodeWaitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - waitStart).count();
+                    m_metrics.audioLayerBuffered.sample(static_cast<double>(layer.channels[0].size()));
                     if (layer.error) {
                         std::string errorCopy = layer.errorMessage;
                         lock.unlock();
@@ -690,8 +1574,7 @@ namespace VideoCreator
                             hasPendingAudio = true;
                         }
                     }
-                    lock.unlock();
-                    layer.cv.notify_all();
+                    scheduleAudioDecodeLocked(layer);
                 }
 
                 if (!layer.finished) {
@@ -699,6 +1582,8 @@ namespace VideoCreator
                 }
             }
 
+            m_metrics.audioDecodeWait.record(decodeWaitSeconds);
+
             if (!hasActiveLayer && !hasPendingAudio) {
                 return enqueueSilenceFrame(samplesNeeded);
             }
@@ -723,6 +1608,10 @@ namespace VideoCreator
                 m_errorString = "Failed to write mixed audio to FIFO";
                 return false;
             }
+            if (m_transitionAudio.recording()) {
+                const float *right = outputChannels > 1 ? reinterpret_cast<const float *>(mixedFrame->data[1]) : nullptr;
+                m_transitionAudio.recordTail(reinterpret_cast<const float *>(mixedFrame->data[0]), right, mixedFrame->nb_samples);
+            }
             return true;
         };
 
@@ -743,15 +1632,31 @@ namespace VideoCreator
         effectProcessor.initialize(m_config.project.width, m_config.project.height, AV_PIX_FMT_YUV420P, m_config.project.fps);
         
         FFmpegUtils::AvFramePtr sourceImageFrame;
-        if (!isVideoScene && imageDecoder.getWidth() > 0) {
-            sourceImageFrame = imageDecoder.decodeAndCache();
-             if (sourceImageFrame) {
-                auto scaledFrame = imageDecoder.scaleToSize(sourceImageFrame, m_config.project.width, m_config.project.height, AV_PIX_FMT_YUV420P);
-                sourceImageFrame = scaledFrame ? std::move(scaledFrame) : std::move(sourceImageFrame);
+        LayerCompositor overlayCompositor;
+        if (!isVideoScene) {
+            FFmpegUtils::AvFramePtr decodedImage;
+            if (imageDecoder.getWidth() > 0) {
+                decodedImage = imageDecoder.decodeAndCache();
+            }
+            if (!decodedImage) {
+                decodedImage = generateTestFrame(m_frameCount, m_config.project.width, m_config.project.height);
+            }
+            // 主图按 fit、缩放、旋转与位置合成到背景上，只做一次；Ken Burns 作用于这张画面，叠加图片在特效之后逐帧合成
+            const bool kenBurns = scene.effects.ken_burns.enabled;
+            std::string layerError;
+            sourceImageFrame = composeImageScene(m_config.project, scene, decodedImage.get(), !kenBurns, layerError);
+            if (!sourceImageFrame) {
+                m_errorString = "合成场景图层失败: " + layerError;
+                return false;
+            }
+            const LayerCompositor::Rect fullFrame = LayerCompositor::fitRect(m_config.project.width, m_config.project.height,
+                                                                             m_config.project.width, m_config.project.height,
+                                                                             LayerCompositor::Fit::STRETCH);
+            if (kenBurns && !scene.resources.overlays.empty() &&
+                !buildSceneLayers(m_config.project, scene, nullptr, &fullFrame, true, overlayCompositor, layerError)) {
+                m_errorString = "合成场景叠加图片失败: " + layerError;
+                return false;
             }
-        }
-        if (!isVideoScene && !sourceImageFrame) {
-             sourceImageFrame = generateTestFrame(m_frameCount, m_config.project.width, m_config.project.height);
         }
 
         bool kenBurnsActive = false;
@@ -765,6 +1670,7 @@ namespace VideoCreator
     
         int startFrameCount = m_frameCount;
         bool videoEOF = false;
+        m_forceKeyframe = m_fragmentedOutput || m_segmentedOutput;
         FFmpegUtils::AvFramePtr lastFrameCopy;
 
         while (m_frameCount < startFrameCount + totalVideoFramesInScene)
@@ -775,15 +1681,19 @@ namespace VideoCreator
             if (video_time <= audio_time) {
                 // --- VIDEO PART ---
                 FFmpegUtils::AvFramePtr videoFrame;
+                auto sourceStart = std::chrono::steady_clock::now();
 
                 if (isVideoScene) {
                     if (videoEOF) {
                         break;
                     }
+                    VC_TRACE_SCOPE("video_queue_wait", "engine");
                     std::unique_lock<std::mutex> lock(videoFrameQueue.mutex);
                     videoFrameQueue.cv.wait(lock, [&]() {
                         return videoFrameQueue.stopRequested.load() || videoFrameQueue.error || !videoFrameQueue.frames.empty() || videoFrameQueue.finished;
                     });
+                    m_metrics.videoDecodeWait.record(std::chrono::duration<double>(std::chrono::steady_clock::now() - sourceStart).count());
+                    m_metrics.videoQueueDepth.sample(static_cast<double>(videoFrameQueue.frames.size()));
                     if (videoFrameQueue.error) {
                         std::string errorCopy = videoFrameQueue.errorMessage;
                         lock.unlock();
@@ -801,17 +1711,26 @@ namespace VideoCreator
                     }
                     videoFrame = std::move(videoFrameQueue.frames.front());
                     videoFrameQueue.frames.pop_front();
+                    scheduleVideoDecodeLocked();
                     lock.unlock();
-                    videoFrameQueue.cv.notify_all();
                 } else if (kenBurnsActive) {
                     if (!effectProcessor.fetchKenBurnsFrame(videoFrame)) {
                         m_errorString = "获取Ken Burns缓存帧失败: " + effectProcessor.getErrorString();
                         return false;
                     }
+                    if (videoFrame && overlayCompositor.hasDynamicLayer()) {
+                        videoFrame = overlayCompositor.compose(videoFrame.get());
+                        if (!videoFrame) {
+                            m_errorString = "合成场景叠加图片失败: " + overlayCompositor.getErrorString();
+                            return false;
+                        }
+                    }
                 } else {
                     videoFrame = FFmpegUtils::copyAvFrame(sourceImageFrame.get());
+                    m_metrics.compositorStaticFrames++;
                 }
 
+                m_stageStats.videoSource += std::chrono::duration<double>(std::chrono::steady_clock::now() - sourceStart).count();
                 if (!videoFrame) {
                     m_errorString = "生成或处理视频帧失败";
                     return false;
@@ -819,6 +1738,7 @@ namespace VideoCreator
 
                 // 烧录字幕（如果有）
                 if (!scene.effects.subtitle.text.empty()) {
+                    StageTimer subtitleTimer(m_stageStats.subtitle);
                     auto subtitledFrame = burnSubtitle(videoFrame.get(), scene.effects.subtitle);
                     if (subtitledFrame) {
                         videoFrame = std::move(subtitledFrame);
@@ -827,17 +1747,24 @@ namespace VideoCreator
 
                 cacheSceneFirstFrame(scene, videoFrame.get());
                 lastFrameCopy = FFmpegUtils::copyAvFrame(videoFrame.get());
+                markForcedKeyframe(videoFrame.get());
                 videoFrame->pts = m_frameCount;
-                int ret = avcodec_send_frame(m_videoCodecContext.get(), videoFrame.get());
+                auto encodeStart = std::chrono::steady_clock::now();
+                int ret = 0;
+                {
+                    VC_TRACE_SCOPE("encode_video", "encode");
+                    ret = avcodec_send_frame(m_videoCodecContext.get(), videoFrame.get());
+                }
                 if (ret < 0) {
                     m_errorString = format_ffmpeg_error(ret, "发送视频帧到编码器失败");
                     return false;
                 }
+                m_metrics.videoFramesSent++;
                 auto packet = FFmpegUtils::createAvPacket();
                 while ((ret = avcodec_receive_packet(m_videoCodecContext.get(), packet.get())) == 0) {
                     packet->stream_index = m_videoStream->index;
                     av_packet_rescale_ts(packet.get(), m_videoCodecContext->time_base, m_videoStream->time_base);
-                    ret = av_interleaved_write_frame(m_outputContext.get(), packet.get());
+                    ret = writePacket(packet.get());
                     if (ret < 0) {
                         m_errorString = format_ffmpeg_error(ret, "写入视频包失败");
                         return false;
@@ -848,18 +1775,32 @@ namespace VideoCreator
                      m_errorString = format_ffmpeg_error(ret, "从编码器接收视频包失败");
                      return false;
                 }
+                if (!encodeRenditions(videoFrame.get())) {
+                    return false;
+                }
+                const auto encodeEnd = std::chrono::steady_clock::now();
+                m_stageStats.videoEncode += std::chrono::duration<double>(encodeEnd - encodeStart).count();
+                m_metrics.frameLatency.record(std::chrono::duration<double>(encodeEnd - sourceStart).count());
+                m_metrics.encoderQueueDepth.sample(static_cast<double>(m_metrics.videoFramesSent - m_metrics.videoPackets));
                 m_frameCount++;
                 updateAndReportProgress();
+                if (!checkInterrupt()) {
+                    return false;
+                }
 
             } else {
                 // --- AUDIO PART ---
                 if (m_audioStream) {
                     const int frame_size = (m_audioCodecContext && m_audioCodecContext->frame_size > 0) ? m_audioCodecContext->frame_size : 1024;
                     if (av_audio_fifo_size(m_audioFifo) < frame_size) {
+                        StageTimer mixTimer(m_stageStats.audioMix);
+                        VC_TRACE_SCOPE("mix_audio", "audio");
                         if (!mixSceneAudio(frame_size)) {
                             return false;
                         }
+                        m_metrics.audioFifoSamples.sample(static_cast<double>(av_audio_fifo_size(m_audioFifo)));
                     }
+                    StageTimer audioEncodeTimer(m_stageStats.audioEncode);
                     if (!sendBufferedAudioFrames()) {
                         return false;
                     }
@@ -869,6 +1810,27 @@ namespace VideoCreator
         if (lastFrameCopy) {
             storeSceneFrame(m_sceneLastFrames, scene, std::move(lastFrameCopy));
         }
+        m_metrics.compositorFrames += overlayCompositor.stats().frames;
+        m_metrics.compositorDirtyPixels += overlayCompositor.stats().dirtyPixels;
+        m_metrics.compositorTotalPixels += overlayCompositor.stats().totalPixels;
+
+        // 合并解码线程的阻塞统计（线程可能仍在运行，须持锁读取）
+        {
+            std::lock_guard<std::mutex> lock(videoFrameQueue.mutex);
+            m_metrics.videoDecoderStalls += videoFrameQueue.stalls;
+            m_metrics.videoDecoderStallSeconds += videoFrameQueue.stallSeconds;
+            m_metrics.fpsDroppedFrames += videoFrameQueue.droppedFrames;
+            m_metrics.fpsDuplicatedFrames += videoFrameQueue.duplicatedFrames;
+            m_metrics.fpsBlendedFrames += videoFrameQueue.blendedFrames;
+            m_metrics.compositorFrames += videoFrameQueue.compositorStats.frames;
+            m_metrics.compositorDirtyPixels += videoFrameQueue.compositorStats.dirtyPixels;
+            m_metrics.compositorTotalPixels += videoFrameQueue.compositorStats.totalPixels;
+        }
+        for (auto &layerPtr : sceneAudioLayers) {
+            std::lock_guard<std::mutex> lock(layerPtr->mutex);
+            m_metrics.audioDecoderStalls += layerPtr->stalls;
+            m_metrics.audioDecoderStallSeconds += layerPtr->stallSeconds;
+        }
         return true;
     }
 
@@ -877,9 +1839,25 @@ namespace VideoCreator
         int64_t startAudioSampleCount = m_audioSamplesCount;
         int totalFrames = static_cast<int>(std::round(transitionScene.duration * m_config.project.fps));
 
-        if (m_audioStream && m_enableAudioTransition) {
-            if (!renderAudioTransition(fromScene, toScene, transitionScene.duration)) {
-                return false;
+        // 转场音频：前一场景渲染时记下的混音末尾淡出，后台已解码的后一场景开头淡入
+        AudioClip fromTail;
+        AudioClip toHead;
+        size_t crossfadeSamples = 0;
+        size_t crossfadePosition = 0;
+        if (m_audioStream) {
+            fromTail = m_transitionAudio.takeTail();
+            if (m_transitionAudioHead.valid()) {
+                if (m_transitionAudioHead.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                    m_metrics.audioHeadReady++;
+                } else {
+                    m_metrics.audioHeadWaited++;
+                }
+                toHead = m_transitionAudioHead.get();
+            }
+            crossfadeSamples = static_cast<size_t>(std::lround(transitionScene.duration * m_audioCodecContext->sample_rate));
+            if (fromTail.size() > 0 || toHead.size() > 0) {
+                m_metrics.audioCrossfades++;
+                m_metrics.audioCrossfadeSamples += static_cast<int64_t>(crossfadeSamples);
             }
         }
         
@@ -904,13 +1882,12 @@ namespace VideoCreator
             qDebug() << "起点场景包含Ken Burns特效，计算其最后一帧。";
             
             double fromSceneDuration = fromScene.duration;
-            AudioDecoder tempAudioDecoder;
-            if (!fromScene.resources.audio.path.empty() && tempAudioDecoder.open(fromScene.resources.audio.path)) {
-                double audioDuration = tempAudioDecoder.getDuration();
+            if (!fromScene.resources.audio.path.empty()) {
+                // 时长在加载配置时已探测过，无需为此重新打开音频
+                double audioDuration = MediaInfoCache::instance().duration(fromScene.resources.audio.path, MediaKind::AUDIO);
                 if (audioDuration > 0) {
                     fromSceneDuration = audioDuration;
                 }
-                tempAudioDecoder.close();
             }
             int totalFramesInFromScene = static_cast<int>(std::round(fromSceneDuration * m_config.project.fps));
             if (totalFramesInFromScene <= 0) {
@@ -923,9 +1900,10 @@ namespace VideoCreator
                 return false;
             }
 
-            auto scaledFromFrame = fromDecoder.scaleToSize(originalFromFrame, m_config.project.width, m_config.project.height, AV_PIX_FMT_YUV420P);
+            std::string layerError;
+            auto scaledFromFrame = composeImageScene(m_config.project, fromScene, originalFromFrame.get(), false, layerError);
             if (!scaledFromFrame) {
-                m_errorString = "缩放 'from' 场景图片失败，原因: " + fromDecoder.getErrorString();
+                m_errorString = "合成 'from' 场景图片失败，原因: " + layerError;
                 return false;
             }
             scaledFromFrame->pts = 0;
@@ -948,9 +1926,9 @@ namespace VideoCreator
                 m_errorString = "'from' 场景 Ken Burns 特效未生成任何帧";
                 return false;
             }
-            finalFromFrame = FFmpegUtils::copyAvFrame(lastKbFrame.get());
+            finalFromFrame = composeSceneOverlays(m_config.project, fromScene, lastKbFrame.get(), layerError);
             if (!finalFromFrame) {
-                m_errorString = "'from' 场景 Ken Burns 特效最后一帧复制失败";
+                m_errorString = "'from' 场景 Ken Burns 特效最后一帧合成失败: " + layerError;
                 return false;
             }
         } else {
@@ -958,13 +1936,18 @@ namespace VideoCreator
                 m_errorString = "无法打开转场中的起始图片";
                 return false;
             }
-            qDebug() << "起点场景无特效，使用缩放后的静态图片。";
+            qDebug() << "起点场景无特效，使用合成后的静态画面。";
             auto fromFrame = fromDecoder.decode();
             if (!fromFrame) {
                 m_errorString = "解码 'from' 帧失败";
                 return false;
             }
-            finalFromFrame = fromDecoder.scaleToSize(fromFrame, m_config.project.width, m_config.project.height, AV_PIX_FMT_YUV420P);
+            std::string layerError;
+            finalFromFrame = composeImageScene(m_config.project, fromScene, fromFrame.get(), true, layerError);
+            if (!finalFromFrame) {
+                m_errorString = "合成 'from' 场景图片失败，原因: " + layerError;
+                return false;
+            }
         }
         
         if (!fromFrameFromCache && finalFromFrame) {
@@ -989,13 +1972,12 @@ namespace VideoCreator
         } else if (toScene.effects.ken_burns.enabled) {
             // 同步音频时长
             double toSceneDuration = toScene.duration;
-            AudioDecoder tempAudioDecoder;
-            if (!toScene.resources.audio.path.empty() && tempAudioDecoder.open(toScene.resources.audio.path)) {
-                double audioDuration = tempAudioDecoder.getDuration();
+            if (!toScene.resources.audio.path.empty()) {
+                // 时长在加载配置时已探测过，无需为此重新打开音频
+                double audioDuration = MediaInfoCache::instance().duration(toScene.resources.audio.path, MediaKind::AUDIO);
                 if (audioDuration > 0) {
                     toSceneDuration = audioDuration;
                 }
-                tempAudioDecoder.close();
             }
             int totalFramesInToScene = static_cast<int>(std::round(toSceneDuration * m_config.project.fps));
             if (totalFramesInToScene <= 0) {
@@ -1012,9 +1994,10 @@ namespace VideoCreator
                 m_errorString = "解码 'to' 场景的原始图片失败";
                 return false;
             }
-            auto scaledSourceFrame = toDecoder.scaleToSize(originalToFrame, m_config.project.width, m_config.project.height, AV_PIX_FMT_YUV420P);
+            std::string layerError;
+            auto scaledSourceFrame = composeImageScene(m_config.project, toScene, originalToFrame.get(), false, layerError);
             if (!scaledSourceFrame) {
-                m_errorString = "缩放 'to' 场景图片失败，原因: " + toDecoder.getErrorString();
+                m_errorString = "合成 'to' 场景图片失败，原因: " + layerError;
                 return false;
             }
             scaledSourceFrame->pts = 0;
@@ -1031,9 +2014,9 @@ namespace VideoCreator
                 m_errorString = "'to' 场景 Ken Burns 特效处理后未能获取第一帧: " + toSceneProcessor.getErrorString();
                 return false;
             }
-            scaledToFrame = FFmpegUtils::copyAvFrame(firstKbFrame.get());
+            scaledToFrame = composeSceneOverlays(m_config.project, toScene, firstKbFrame.get(), layerError);
             if (!scaledToFrame) {
-                m_errorString = "'to' 场景 Ken Burns 首帧复制失败";
+                m_errorString = "'to' 场景 Ken Burns 首帧合成失败: " + layerError;
                 return false;
             }
         } else {
@@ -1046,9 +2029,10 @@ namespace VideoCreator
                 m_errorString = "解码 'to' 帧失败";
                 return false;
             }
-            scaledToFrame = toDecoder.scaleToSize(toFrame, m_config.project.width, m_config.project.height, AV_PIX_FMT_YUV420P);
+            std::string layerError;
+            scaledToFrame = composeImageScene(m_config.project, toScene, toFrame.get(), true, layerError);
             if (!scaledToFrame) {
-                m_errorString = "缩放 'to' 帧失败";
+                m_errorString = "合成 'to' 帧失败: " + layerError;
                 return false;
             }
         }
@@ -1064,24 +2048,32 @@ namespace VideoCreator
             return false;
         }
 
+        m_forceKeyframe = m_fragmentedOutput || m_segmentedOutput;
         for (int frameIndex = 0; frameIndex < totalFrames; ++frameIndex)
         {
+            const auto frameStart = std::chrono::steady_clock::now();
             FFmpegUtils::AvFramePtr blendedFrame;
             if (!transitionProcessor.fetchTransitionFrame(blendedFrame)) {
                 m_errorString = "应用转场特效失败: " + transitionProcessor.getErrorString();
                 return false;
             }
+            markForcedKeyframe(blendedFrame.get());
             blendedFrame->pts = m_frameCount;
-            int ret = avcodec_send_frame(m_videoCodecContext.get(), blendedFrame.get());
+            int ret = 0;
+            {
+                VC_TRACE_SCOPE("encode_video", "encode");
+                ret = avcodec_send_frame(m_videoCodecContext.get(), blendedFrame.get());
+            }
             if (ret < 0) {
                 m_errorString = format_ffmpeg_error(ret, "发送转场帧到编码器失败");
                 return false;
             }
+            m_metrics.videoFramesSent++;
             auto packet = FFmpegUtils::createAvPacket();
             while ((ret = avcodec_receive_packet(m_videoCodecContext.get(), packet.get())) >= 0) {
                 packet->stream_index = m_videoStream->index;
                 av_packet_rescale_ts(packet.get(), m_videoCodecContext->time_base, m_videoStream->time_base);
-                ret = av_interleaved_write_frame(m_outputContext.get(), packet.get());
+                ret = writePacket(packet.get());
                 if (ret < 0) {
                     m_errorString = format_ffmpeg_error(ret, "写入转场视频包失败");
                     return false;
@@ -1092,6 +2084,11 @@ namespace VideoCreator
                 m_errorString = format_ffmpeg_error(ret, "从编码器接收转场包失败");
                 return false;
             }
+            if (!encodeRenditions(blendedFrame.get())) {
+                return false;
+            }
+            m_metrics.frameLatency.record(std::chrono::duration<double>(std::chrono::steady_clock::now() - frameStart).count());
+            m_metrics.encoderQueueDepth.sample(static_cast<double>(m_metrics.videoFramesSent - m_metrics.videoPackets));
 
             if (m_audioStream) {
                 double video_time_in_scene = (double)(frameIndex + 1) / m_config.project.fps;
@@ -1099,27 +2096,17 @@ namespace VideoCreator
                 while(audio_time_in_scene < video_time_in_scene) {
                     const int frame_size = m_audioCodecContext->frame_size;
                     if (frame_size <= 0) break;
-                    
-                    auto audioFrame = FFmpegUtils::createAvFrame();
-                    audioFrame->nb_samples = frame_size;
-                    audioFrame->ch_layout = m_audioCodecContext->ch_layout;
-                    audioFrame->format = m_audioCodecContext->sample_fmt;
-                    audioFrame->sample_rate = m_audioCodecContext->sample_rate;
-
-                    int ret = av_frame_get_buffer(audioFrame.get(), 0);
-                    if (ret < 0) {
-                         m_errorString = format_ffmpeg_error(ret, "为静音帧分配缓冲区失败 (Transition)");
-                         return false;
-                    }
-                    ret = av_frame_make_writable(audioFrame.get());
-                     if (ret < 0) {
-                        m_errorString = format_ffmpeg_error(ret, "使静音帧可写失败 (Transition)");
-                        return false;
-                    }
-                    av_samples_set_silence(audioFrame->data, 0, audioFrame->nb_samples, audioFrame->ch_layout.nb_channels, (AVSampleFormat)audioFrame->format);
+
+                    // 复用混音帧，不再每个编码帧分配一次缓冲区
+                    if (!ensureReusableAudioFrame(frame_size)) return false;
+                    AVFrame *audioFrame = m_reusableMixFrame.get();
+                    float *left = reinterpret_cast<float *>(audioFrame->data[0]);
+                    float *right = audioFrame->ch_layout.nb_channels > 1 ? reinterpret_cast<float *>(audioFrame->data[1]) : nullptr;
+                    AudioCrossfade::mix(fromTail, toHead, crossfadePosition, crossfadeSamples, frame_size, left, right);
+                    crossfadePosition += static_cast<size_t>(frame_size);
 
                     if(av_audio_fifo_write(m_audioFifo, (void**)audioFrame->data, audioFrame->nb_samples) < audioFrame->nb_samples){
-                        m_errorString = "写入静音数据到FIFO失败 (Transition)";
+                        m_errorString = "写入转场音频到FIFO失败";
                         return false;
                     }
 
@@ -1129,170 +2116,33 @@ namespace VideoCreator
             }
             m_frameCount++;
             updateAndReportProgress();
+            if (!checkInterrupt()) return false;
         }
         return true;
     }
 
-    bool RenderEngine::renderAudioTransition(const SceneConfig &fromScene, const SceneConfig &toScene, double duration_seconds)
+    void RenderEngine::startTransitionAudio(const SceneConfig &transitionScene, const SceneConfig &toScene)
     {
-        if (!m_audioStream || !m_audioCodecContext || duration_seconds <= 0.0) return true;
-
-        const int sample_rate = m_audioCodecContext->sample_rate > 0 ? m_audioCodecContext->sample_rate : 44100;
-        int frame_size = m_audioCodecContext->frame_size;
-        if (frame_size <= 0) frame_size = 1024; // 合理的默认值
-
-        const int total_samples = static_cast<int>(std::ceil(duration_seconds * sample_rate));
-        const double vol_from = fromScene.resources.audio.volume <= 0 ? 0.0 : fromScene.resources.audio.volume;
-        const double vol_to = toScene.resources.audio.volume <= 0 ? 0.0 : toScene.resources.audio.volume;
-
-        AudioDecoder fromDecoder;
-        AudioDecoder toDecoder;
-        bool fromAvailable = !fromScene.resources.audio.path.empty() && fromDecoder.open(fromScene.resources.audio.path);
-        bool toAvailable = !toScene.resources.audio.path.empty() && toDecoder.open(toScene.resources.audio.path);
-
-        if (fromAvailable) {
-            if (!fromDecoder.applyVolumeEffect(fromScene)) {
-                qDebug() << "起始场景音量特效应用失败，继续使用原始音频。原因: " << fromDecoder.getErrorString().c_str();
-            }
-        }
-        if (toAvailable) {
-            if (!toDecoder.applyVolumeEffect(toScene)) {
-                qDebug() << "目标场景音量特效应用失败，继续使用原始音频。原因: " << toDecoder.getErrorString().c_str();
-            }
-        }
-
-        // 如果没有可用音频源，则保持旧逻辑由后续循环填充静音
-        if (!fromAvailable && !toAvailable) {
-            return true;
-        }
-
-        if (fromAvailable) {
-            double fromDuration = fromDecoder.getDuration();
-            if (fromDuration <= 0) {
-                fromDuration = fromScene.duration;
-            }
-            double start_time = std::max(0.0, fromDuration - duration_seconds);
-            fromDecoder.seek(start_time);
-        }
-
-        struct AudioBuffer {
-            std::vector<float> channels[2];
-            size_t readPos = 0;
-            bool exhausted = false;
-        };
-
-        AudioBuffer fromBuf;
-        AudioBuffer toBuf;
-
-        auto compactBuffer = [](AudioBuffer &buf) {
-            const size_t threshold = 8192;
-            if (buf.readPos > threshold) {
-                for (auto &ch : buf.channels) {
-                    if (buf.readPos <= ch.size()) {
-                        ch.erase(ch.begin(), ch.begin() + static_cast<long long>(buf.readPos));
-                    } else {
-                        ch.clear();
-                    }
-                }
-                buf.readPos = 0;
-            }
-        };
-
-        auto ensureSamples = [this](AudioDecoder &decoder, AudioBuffer &buf, int needed, bool &available) -> bool {
-            while (!buf.exhausted && static_cast<int>(buf.channels[0].size() - buf.readPos) < needed) {
-                FFmpegUtils::AvFramePtr frame;
-                int ret = decoder.decodeFrame(frame);
-                if (ret > 0 && frame) {
-                    const int nb = frame->nb_samples;
-                    int ch = frame->ch_layout.nb_channels > 0 ? frame->ch_layout.nb_channels : 1;
-                    ch = std::min(ch, 2); // 仅处理前两个声道
-                    for (int c = 0; c < ch; ++c) {
-                        float *data = reinterpret_cast<float *>(frame->data[c]);
-                        buf.channels[c].insert(buf.channels[c].end(), data, data + nb);
-                    }
-                    // 单声道时复制到右声道，保证双声道输出
-                    if (ch == 1) {
-                        buf.channels[1].insert(buf.channels[1].end(), buf.channels[0].end() - nb, buf.channels[0].end());
-                    }
-                    // 对齐两个声道长度
-                    const size_t max_len = std::max(buf.channels[0].size(), buf.channels[1].size());
-                    buf.channels[0].resize(max_len, 0.0f);
-                    buf.channels[1].resize(max_len, 0.0f);
-                }
-                else if (ret == 0) {
-                    buf.exhausted = true;
-                    break;
-                }
-                else {
-                    buf.exhausted = true;
-                    available = false;
-                    qDebug() << "音频转场解码失败，使用静音代替。";
-                    break;
-                }
-            }
-            return true;
-        };
-
-        int processed = 0;
-        while (processed < total_samples) {
-            int chunk = std::min(frame_size, total_samples - processed);
-
-            if (fromAvailable) {
-                if (!ensureSamples(fromDecoder, fromBuf, chunk, fromAvailable)) return false;
-            }
-            if (toAvailable) {
-                if (!ensureSamples(toDecoder, toBuf, chunk, toAvailable)) return false;
-            }
-
-            auto mixedFrame = FFmpegUtils::createAvFrame();
-            mixedFrame->nb_samples = chunk;
-            mixedFrame->ch_layout = m_audioCodecContext->ch_layout;
-            mixedFrame->format = m_audioCodecContext->sample_fmt;
-            mixedFrame->sample_rate = sample_rate;
-            int ret = av_frame_get_buffer(mixedFrame.get(), 0);
-            if (ret < 0) {
-                m_errorString = format_ffmpeg_error(ret, "为转场混音帧分配缓冲区失败");
-                return false;
-            }
-
-            const int channels = m_audioCodecContext->ch_layout.nb_channels > 0 ? m_audioCodecContext->ch_layout.nb_channels : 2;
-            for (int c = 0; c < channels; ++c) {
-                float *dst = reinterpret_cast<float *>(mixedFrame->data[c]);
-                for (int i = 0; i < chunk; ++i) {
-                    float s_from = 0.0f;
-                    float s_to = 0.0f;
-                    if (fromAvailable && fromBuf.readPos + i < fromBuf.channels[c % 2].size()) {
-                        s_from = fromBuf.channels[c % 2][fromBuf.readPos + i];
-                    }
-                    if (toAvailable && toBuf.readPos + i < toBuf.channels[c % 2].size()) {
-                        s_to = toBuf.channels[c % 2][toBuf.readPos + i];
-                    }
-                    double t = static_cast<double>(processed + i) / static_cast<double>(total_samples);
-                    double w_from = 1.0 - t;
-                    double w_to = t;
-                    dst[i] = static_cast<float>(s_from * w_from * vol_from + s_to * w_to * vol_to);
-                }
-            }
-
-            fromBuf.readPos += chunk;
-            toBuf.readPos += chunk;
-            compactBuffer(fromBuf);
-            compactBuffer(toBuf);
-
-            if (av_audio_fifo_write(m_audioFifo, (void **)mixedFrame->data, mixedFrame->nb_samples) < mixedFrame->nb_samples) {
-                m_errorString = "写入转场混音数据到FIFO失败";
-                return false;
-            }
-
-            if (!sendBufferedAudioFrames()) return false;
-            processed += chunk;
+        if (!m_audioCodecContext || transitionScene.duration <= 0.0) {
+            return;
         }
-
-        return true;
+        const int sampleRate = m_audioCodecContext->sample_rate > 0 ? m_audioCodecContext->sample_rate : 44100;
+        const size_t samples = static_cast<size_t>(std::lround(transitionScene.duration * sampleRate));
+        m_transitionAudio.startTail(samples);
+        // 只解码转场长度的开头，与前一场景的渲染并行
+        m_transitionAudioHead = TaskExecutor::instance().async([toScene, samples, sampleRate]() {
+            std::string error;
+            AudioClip head = AudioCrossfade::decodeHead(toScene, samples, sampleRate, &error);
+            if (!error.empty()) {
+                qDebug() << "转场音频:" << error.c_str();
+            }
+            return head;
+        });
     }
 
     FFmpegUtils::AvFramePtr RenderEngine::extractVideoSceneFrame(const SceneConfig &scene, bool fetchLastFrame)
     {
+        VC_TRACE_SCOPE("extract_scene_frame", "decode");
         if (scene.type != SceneType::VIDEO_SCENE) {
             m_errorString = "场景不是视频类型";
             return nullptr;
@@ -1307,6 +2157,12 @@ namespace VideoCreator
             m_errorString = "无法打开视频: " + decoder.getErrorString();
             return nullptr;
         }
+        LayerCompositor compositor;
+        std::string layerError;
+        if (!buildVideoSceneLayers(m_config.project, scene, decoder, compositor, layerError)) {
+            m_errorString = "搭建视频场景图层失败: " + layerError;
+            return nullptr;
+        }
 
         FFmpegUtils::AvFramePtr selectedFrame;
         bool gotFrame = false;
@@ -1323,12 +2179,12 @@ namespace VideoCreator
             }
             gotFrame = true;
 
-            auto scaledFrame = decoder.scaleFrame(decodedFrame.get(), m_config.project.width, m_config.project.height, AV_PIX_FMT_YUV420P);
-            if (!scaledFrame) {
-                m_errorString = "缩放视频帧失败: " + decoder.getErrorString();
+            auto composedFrame = composeVideoFrame(decoder, decodedFrame.get(), compositor, layerError);
+            if (!composedFrame) {
+                m_errorString = layerError;
                 return nullptr;
             }
-            selectedFrame = std::move(scaledFrame);
+            selectedFrame = std::move(composedFrame);
 
             if (!fetchLastFrame) {
                 break;
@@ -1341,8 +2197,8 @@ namespace VideoCreator
     void RenderEngine::scheduleVideoPrefetchTasks()
     {
         m_sceneFirstFramePrefetch.clear();
-        const int targetWidth = m_config.project.width;
-        const int targetHeight = m_config.project.height;
+        const ProjectInfoConfig project = m_config.project;
+        TaskExecutor &executor = TaskExecutor::instance();
         for (const auto &scene : m_config.scenes) {
             if (scene.type != SceneType::VIDEO_SCENE) {
                 continue;
@@ -1350,27 +2206,44 @@ namespace VideoCreator
             if (scene.resources.video.path.empty()) {
                 continue;
             }
-            m_sceneFirstFramePrefetch.emplace(scene.id, std::async(std::launch::async, [scene, targetWidth, targetHeight]() {
+            TaskHandle firstFrameTask;
+            m_sceneFirstFramePrefetch.emplace(scene.id, executor.async([scene, project]() {
+                VC_TRACE_SCOPE("prefetch_first_frame", "decode");
                 VideoDecoder decoder;
                 if (!decoder.open(scene.resources.video.path)) {
                     qDebug() << "Video prefetch failed:" << QString::fromStdString(scene.resources.video.path)
                              << decoder.getErrorString().c_str();
                     return FFmpegUtils::AvFramePtr{};
                 }
+                LayerCompositor compositor;
+                std::string layerError;
+                if (!buildVideoSceneLayers(project, scene, decoder, compositor, layerError)) {
+                    qDebug() << "Video prefetch layers failed:" << layerError.c_str();
+                    return FFmpegUtils::AvFramePtr{};
+                }
                 while (true) {
                     FFmpegUtils::AvFramePtr decodedFrame;
                     int ret = decoder.decodeFrame(decodedFrame);
                     if (ret <= 0) {
                         return FFmpegUtils::AvFramePtr{};
                     }
-                    auto scaled = decoder.scaleFrame(decodedFrame.get(), targetWidth, targetHeight, AV_PIX_FMT_YUV420P);
-                    if (!scaled) {
-                        qDebug() << "Video frame scale failed:" << decoder.getErrorString().c_str();
+                    auto composed = composeVideoFrame(decoder, decodedFrame.get(), compositor, layerError);
+                    if (!composed) {
+                        qDebug() << "Video frame compose failed:" << layerError.c_str();
                         return FFmpegUtils::AvFramePtr{};
                     }
-                    return scaled;
+                    return composed;
                 }
-            }));
+            }, {}, &firstFrameTask));
+
+            // 共享解复用要求音视频流参数都已缓存；音轨探测排在首帧之后，不推迟场景开头急需的首帧
+            if (scene.resources.video.use_audio) {
+                const std::string path = scene.resources.video.path;
+                executor.submit([path]() {
+                    VC_TRACE_SCOPE("prefetch_audio_probe", "decode");
+                    MediaInfoCache::instance().duration(path, MediaKind::AUDIO);
+                }, {firstFrameTask});
+            }
         }
     }
 
@@ -1380,6 +2253,11 @@ namespace VideoCreator
         if (it == m_sceneFirstFramePrefetch.end()) {
             return;
         }
+        if (it->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            m_metrics.prefetchReady++;
+        } else {
+            m_metrics.prefetchWaited++;
+        }
         FFmpegUtils::AvFramePtr frame = it->second.get();
         m_sceneFirstFramePrefetch.erase(it);
         if (frame) {
@@ -1456,8 +2334,10 @@ namespace VideoCreator
         auto &cache = lastFrame ? m_sceneLastFrames : m_sceneFirstFrames;
         auto it = cache.find(scene.id);
         if (it != cache.end() && it->second) {
+            m_metrics.sceneFrameCacheHits++;
             return FFmpegUtils::copyAvFrame(it->second.get());
         }
+        m_metrics.sceneFrameCacheMisses++;
         return nullptr;
     }
 
@@ -1507,7 +2387,14 @@ namespace VideoCreator
             }
             frame->pts = m_audioSamplesCount;
             m_audioSamplesCount += frame->nb_samples;
-            ret = avcodec_send_frame(m_audioCodecContext.get(), frame.get());
+            if (!m_partPath.empty()) {
+                if (!spoolAudioFrame(frame.get())) return false;
+                continue;
+            }
+            {
+                VC_TRACE_SCOPE("encode_audio", "encode");
+                ret = avcodec_send_frame(m_audioCodecContext.get(), frame.get());
+            }
             if (ret < 0) {
                 m_errorString = format_ffmpeg_error(ret, "发送音频帧到编码器失败 (FIFO)");
                 return false;
@@ -1516,7 +2403,7 @@ namespace VideoCreator
             while ((ret = avcodec_receive_packet(m_audioCodecContext.get(), packet.get())) == 0) {
                 packet->stream_index = m_audioStream->index;
                 av_packet_rescale_ts(packet.get(), m_audioCodecContext->time_base, m_audioStream->time_base);
-                ret = av_interleaved_write_frame(m_outputContext.get(), packet.get());
+                ret = writePacket(packet.get());
                 if (ret < 0) {
                     m_errorString = format_ffmpeg_error(ret, "写入音频包失败 (FIFO)");
                     return false;
@@ -1562,6 +2449,101 @@ namespace VideoCreator
 
 
 
+    bool RenderEngine::spoolAudioFrame(const AVFrame *frame)
+    {
+        const int channels = frame->ch_layout.nb_channels;
+        auto packet = FFmpegUtils::createAvPacket();
+        int ret = av_new_packet(packet.get(), frame->nb_samples * channels * static_cast<int>(sizeof(float)));
+        if (ret < 0) {
+            m_errorString = format_ffmpeg_error(ret, "分配 PCM 包失败");
+            return false;
+        }
+        // 平面 float 交织为 PCM_F32LE
+        float *out = reinterpret_cast<float *>(packet->data);
+        for (int i = 0; i < frame->nb_samples; ++i) {
+            for (int c = 0; c < channels; ++c) {
+                *out++ = reinterpret_cast<const float *>(frame->data[c])[i];
+            }
+        }
+        packet->pts = av_rescale_q(frame->pts, m_audioCodecContext->time_base, m_audioStream->time_base);
+        packet->dts = packet->pts;
+        packet->duration = av_rescale_q(frame->nb_samples, m_audioCodecContext->time_base, m_audioStream->time_base);
+        packet->stream_index = m_audioStream->index;
+        packet->flags |= AV_PKT_FLAG_KEY;
+        // 不经过 writePacket：音频指标只统计拼接时写入的编码包
+        ret = av_interleaved_write_frame(m_outputContext.get(), packet.get());
+        if (ret < 0) {
+            m_errorString = format_ffmpeg_error(ret, "写入 PCM 包失败");
+            return false;
+        }
+        return true;
+    }
+
+    void RenderEngine::markForcedKeyframe(AVFrame *frame)
+    {
+        // 场景起点强制关键帧，分片边界与场景边界对齐，预览 / 点播可从任一场景开始解码；
+        // 其余帧清掉随解码、缩放带来的源帧类型，否则编码器按素材的 I/P/B 编码，配置的 GOP 不起作用
+        if (m_forceKeyframe) {
+            frame->pict_type = AV_PICTURE_TYPE_I;
+            m_forceKeyframe = false;
+        } else {
+            frame->pict_type = AV_PICTURE_TYPE_NONE;
+        }
+    }
+
+    bool RenderEngine::encodeRenditions(const AVFrame *frame)
+    {
+        if (m_renditions.empty()) {
+            return true;
+        }
+        VC_TRACE_SCOPE("encode_renditions", "encode");
+        const PacketWriter writer = [this](AVPacket *packet) { return writePacket(packet); };
+        for (auto &rendition : m_renditions) {
+            if (!rendition->encode(frame, writer, &m_errorString)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int RenderEngine::writePacket(AVPacket *packet)
+    {
+        VC_TRACE_SCOPE("mux", "mux");
+        // 写入后 packet 被复用器取走，须先记下大小
+        if (m_videoStream && packet->stream_index == m_videoStream->index) {
+            if (m_pass == 1 && m_passLog) {
+                m_passLog->collect(m_videoCodecContext.get());
+            }
+            m_metrics.videoPackets++;
+            if (packet->flags & AV_PKT_FLAG_KEY) {
+                m_metrics.videoKeyframes++;
+            }
+            m_metrics.videoBytesWritten += packet->size;
+        } else if (m_audioStream && packet->stream_index == m_audioStream->index) {
+            m_metrics.audioPackets++;
+            m_metrics.audioBytesWritten += packet->size;
+        } else {
+            m_metrics.renditionPackets++;
+            m_metrics.renditionBytesWritten += packet->size;
+        }
+        // 渲染线程花在写出上的时间：同步写文件时含磁盘 I/O，写后台时只有拷贝与等待缓冲
+        const auto writeStart = std::chrono::steady_clock::now();
+        const int ret = av_interleaved_write_frame(m_outputContext.get(), packet);
+        m_metrics.muxWrite.record(std::chrono::duration<double>(std::chrono::steady_clock::now() - writeStart).count());
+        if (m_headerEnd > 0 && m_metrics.playableBytes == 0 && ret >= 0) {
+            // 分片在复用器内缓存，凑齐后整块写出（FLUSH_PACKETS 随即交给输出）：文件头之后的位置第一次前进时，第一个分片已完整写出
+            const int64_t position = avio_tell(m_outputContext->pb);
+            if (m_firstFragmentEnd == 0 && position > m_headerEnd) {
+                m_firstFragmentEnd = position;
+            }
+            // 写后台时还要等 I/O 线程写过这个位置，播放器才能读到整个分片
+            if (m_firstFragmentEnd > 0 && (!m_outputFile || m_outputFile->writtenEnd() >= m_firstFragmentEnd)) {
+                m_metrics.playableBytes = m_firstFragmentEnd;
+            }
+        }
+        return ret;
+    }
+
     bool RenderEngine::flushEncoder(AVCodecContext *codecCtx, AVStream *stream)
     {
         if (!codecCtx || !stream) return true;
@@ -1581,7 +2563,7 @@ namespace VideoCreator
             }
             packet->stream_index = stream->index;
             av_packet_rescale_ts(packet.get(), codecCtx->time_base, stream->time_base);
-            ret = av_interleaved_write_frame(m_outputContext.get(), packet.get());
+            ret = writePacket(packet.get());
             if (ret < 0) {
                 m_errorString = format_ffmpeg_error(ret, "写入包失败 (flush)");
                 return false;
@@ -1594,15 +2576,50 @@ namespace VideoCreator
     void RenderEngine::updateAndReportProgress()
     {
         if (m_totalProjectFrames > 0) {
-            m_progress = static_cast<int>((m_frameCount / m_totalProjectFrames) * 100);
+            double fraction = m_frameCount / m_totalProjectFrames;
+            if (m_pass == 1) {
+                fraction *= 0.5;
+            } else if (m_pass == 2) {
+                fraction = 0.5 + fraction * 0.5;
+            }
+            m_progress = static_cast<int>(fraction * 100);
             if (m_progress > m_lastReportedProgress) {
                 m_lastReportedProgress = m_progress;
+                if (m_progressCallback) {
+                    m_progressCallback(m_progress);
+                }
             }
         }
     }
 
+    void RenderEngine::requestCancel()
+    {
+        m_cancelRequested.store(true);
+        std::lock_guard<std::mutex> lock(m_pauseMutex);
+        m_pauseCond.notify_all();
+    }
+
+    void RenderEngine::setPaused(bool paused)
+    {
+        std::lock_guard<std::mutex> lock(m_pauseMutex);
+        m_paused = paused;
+        m_pauseCond.notify_all();
+    }
+
+    bool RenderEngine::checkInterrupt()
+    {
+        std::unique_lock<std::mutex> lock(m_pauseMutex);
+        m_pauseCond.wait(lock, [this]() { return !m_paused || m_cancelRequested.load(); });
+        if (m_cancelRequested.load()) {
+            m_errorString = "渲染已取消";
+            return false;
+        }
+        return true;
+    }
+
     FFmpegUtils::AvFramePtr RenderEngine::burnSubtitle(AVFrame* inputFrame, const SubtitleConfig& subtitle)
     {
+        VC_TRACE_SCOPE("drawtext", "filter");
         if (!inputFrame || subtitle.text.empty()) {
             return FFmpegUtils::copyAvFrame(inputFrame);
         }
@@ -4,17 +4,43 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <set>
 #include <unordered_map>
 #include <future>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include "model/ProjectConfig.h"
 #include "ffmpeg_utils/FFmpegHeaders.h"
 #include "ffmpeg_utils/AvFrameWrapper.h"
 #include "ffmpeg_utils/AvFormatContextWrapper.h"
 #include "ffmpeg_utils/AvCodecContextWrapper.h"
+#include "engine/RenderMetrics.h"
+#include "engine/TaskExecutor.h"
+#include "engine/AudioCrossfade.h"
 
 namespace VideoCreator
 {
 
+    class TwoPassLog;
+    class RenditionEncoder;
+    class AsyncOutputFile;
+    class RenderCheckpoint;
+
+    // 渲染各阶段累计耗时（秒）
+    struct RenderStageStats
+    {
+        double setup = 0.0;       // initialize：打开输出与编码器、写文件头
+        double videoSource = 0.0; // 取源帧：视频解码 / Ken Burns / 图片拷贝
+        double subtitle = 0.0;    // 字幕烧录
+        double videoEncode = 0.0; // 视频编码与写包
+        double audioMix = 0.0;    // 等待音频解码并混音
+        double audioEncode = 0.0; // 音频编码与写包
+        double transition = 0.0;  // 转场场景（含其音频）
+        double finalize = 0.0;    // 冲洗编码器、写文件尾
+    };
+
     class RenderEngine
     {
     public:
@@ -30,9 +56,31 @@ namespace VideoCreator
         // 获取进度 (0-100)
         int progress() const { return m_progress; }
 
+        // 进度回调 (0-100)，进度增加时在渲染线程中调用；需在 render() 之前设置
+        void setProgressCallback(std::function<void(int)> callback) { m_progressCallback = std::move(callback); }
+
+        // 编码线程预算，需在 initialize() 之前设置；0 表示自动 (min(8, 硬件线程数))
+        void setThreadBudget(int threads) { m_threadBudget = threads; }
+
+        // 以下控制接口可从其他线程调用，渲染在下一帧边界生效
+        void requestCancel();
+        void setPaused(bool paused);
+        bool isCancelled() const { return m_cancelRequested.load(); }
+
         // 获取错误信息
         std::string errorString() const { return m_errorString; }
 
+        // 已编码的视频帧数与各阶段耗时
+        int frameCount() const { return m_frameCount; }
+        const RenderStageStats &stageStats() const { return m_stageStats; }
+
+        // 运行指标（延迟直方图、队列深度、阻塞与缓存命中），可在进度回调中读取
+        const RenderMetrics &metrics() const { return m_metrics; }
+
+        // 本次渲染为最终输出创建的文件（output_path 与 hls / dash 的播放列表、分片），不含检查点分段；
+        // 渲染失败时调用方据此清理，不会误删之前已有的文件
+        const std::set<std::string> &createdOutputs() const { return m_createdOutputs; }
+
     private:
         ProjectConfig m_config;
         int m_progress;
@@ -40,23 +88,53 @@ namespace VideoCreator
         double m_totalProjectFrames;
         int m_lastReportedProgress;
 
+        // 打开输出、创建音视频流并写文件头；两遍编码时每遍调用一次
+        bool openOutput();
+
+        // 依次渲染全部场景并冲洗编码器
+        bool renderPass();
+
+        // 渲染 [begin, end) 范围内的场景
+        bool renderSceneRange(size_t begin, size_t end);
+
+        // 冲洗编码器、写文件尾并关闭输出文件
+        bool finishOutput(bool sync);
+
+        // 渲染结束：汇总执行器指标并报告 100%
+        void finishRender();
+
+        // 断点续渲：逐段渲染未完成的分段，全部完成后拼接
+        bool renderCheckpointed();
+
+        // 比对各分段的视频流参数（含 extradata），不一致时 *match 为 false，不能直接拼接
+        bool checkCheckpointParts(const RenderCheckpoint &checkpoint, bool *match);
+
+        // 把各分段的视频包原样复制到最终输出，PCM 音频整体编码一次
+        bool stitchCheckpointParts(const RenderCheckpoint &checkpoint);
+
         // 创建输出上下文
         bool createOutputContext();
 
+        // 等待写后台输出写完并关闭文件，统计写入指标；sync 时先落盘
+        bool closeOutputFile(bool sync);
+
         // 创建视频流
         bool createVideoStream();
 
         // 创建音频流
         bool createAudioStream();
 
+        // 主视频编码器的线程预算：扣除解码线程、按码率档平分；0 表示由编码器按默认值推导
+        int videoEncoderThreadBudget() const;
+
         // 渲染单个场景
         bool renderScene(const SceneConfig &scene);
 
         // 渲染转场
         bool renderTransition(const SceneConfig &transitionScene, const SceneConfig &fromScene, const SceneConfig &toScene);
 
-        // 为转场生成音频淡入淡出 / 交叉混音
-        bool renderAudioTransition(const SceneConfig &fromScene, const SceneConfig &toScene, double duration_seconds);
+        // 下一个场景是转场时调用：开始记录本场景混音末尾，并在后台解码转场目标场景的音频开头
+        void startTransitionAudio(const SceneConfig &transitionScene, const SceneConfig &toScene);
 
         // 从视频场景提取指定帧（首帧或末帧）并缩放到项目分辨率
         FFmpegUtils::AvFramePtr extractVideoSceneFrame(const SceneConfig &scene, bool fetchLastFrame);
@@ -80,12 +158,54 @@ namespace VideoCreator
         // 冲洗音频缓冲区
         bool flushAudio();
 
+        // 检查点分段：把一帧混音以 PCM 包写入分段，不经过编码器
+        bool spoolAudioFrame(const AVFrame *frame);
+
         // 更新并报告进度
         void updateAndReportProgress();
 
+        // 帧边界检查点：暂停时阻塞，已取消时返回 false
+        bool checkInterrupt();
+
+        // 需要时把该帧标为关键帧（分片输出的场景起点）
+        void markForcedKeyframe(AVFrame *frame);
+
+        // 把主码率档编码前的帧交给其余码率档（hls / dash 码率阶梯）
+        bool encodeRenditions(const AVFrame *frame);
+
+        // 把编码后的包交给封装器
+        int writePacket(AVPacket *packet);
+
         // flush 编码器剩余包
         bool flushEncoder(AVCodecContext *codecCtx, AVStream *stream);
 
+        // 两遍编码：0 为单遍，two_pass 码控时依次为 1、2；统计数据须比编码器上下文活得久
+        int m_pass = 0;
+        std::unique_ptr<TwoPassLog> m_passLog;
+        bool m_fragmentedOutput = false; // fragmented_mp4 输出
+        bool m_segmentedOutput = false;  // hls / dash 输出
+        bool m_forceKeyframe = false;    // 下一帧须编码为关键帧
+        int64_t m_headerEnd = 0;         // fMP4 文件头（空 moov）的结束位置，其他输出为 0
+        int64_t m_firstFragmentEnd = 0;  // fMP4 第一个分片交给输出时的结束位置，尚未写出时为 0
+        std::vector<std::unique_ptr<RenditionEncoder>> m_renditions;
+
+        // 断点续渲：指纹在 initialize() 中由配置与素材计算；m_partPath 非空时输出写入该分段（NUT），音频以 PCM 写入
+        std::string m_checkpointFingerprint;
+        bool m_checkpointing = false;
+        std::string m_partPath;
+
+        // 写后台输出（write_buffer_mb > 0 时），须比 m_outputContext 活得久
+        std::unique_ptr<AsyncOutputFile> m_outputFile;
+
+        // hls / dash 封装器自行打开文件，经 io_open / io_close2 记下写入的文件名；
+        // dash 先写 .tmp 再改名，关闭 .tmp 时把改名后的文件一并记下
+        static int recordingIoOpen(AVFormatContext *context, AVIOContext **pb, const char *url, int flags, AVDictionary **options);
+        static int recordingIoClose(AVFormatContext *context, AVIOContext *pb);
+        int (*m_defaultIoOpen)(AVFormatContext *, AVIOContext **, const char *, int, AVDictionary **) = nullptr;
+        int (*m_defaultIoClose)(AVFormatContext *, AVIOContext *) = nullptr;
+        std::unordered_map<AVIOContext *, std::string> m_openOutputs;
+        std::set<std::string> m_createdOutputs;
+
         // FFmpeg资源
         FFmpegUtils::AvFormatContextPtr m_outputContext;
         FFmpegUtils::AvCodecContextPtr m_videoCodecContext;
@@ -96,8 +216,9 @@ namespace VideoCreator
         int m_frameCount;
         int64_t m_audioSamplesCount;
 
-        // 是否启用音频转场效果（默认关闭，保留实现以便未来开启）
-        bool m_enableAudioTransition;
+        // 转场音频：前一场景混音末尾与后台解码的后一场景开头
+        AudioCrossfade m_transitionAudio;
+        std::future<AudioClip> m_transitionAudioHead;
         std::unordered_map<int, FFmpegUtils::AvFramePtr> m_sceneFirstFrames;
         std::unordered_map<int, FFmpegUtils::AvFramePtr> m_sceneLastFrames;
         std::vector<float> m_mixBufferLeft;
@@ -105,6 +226,18 @@ namespace VideoCreator
         FFmpegUtils::AvFramePtr m_reusableMixFrame;
         int m_reusableMixFrameCapacity;
         std::unordered_map<int, std::future<FFmpegUtils::AvFramePtr>> m_sceneFirstFramePrefetch;
+
+        RenderStageStats m_stageStats;
+        RenderMetrics m_metrics;
+        TaskExecutor::Stats m_executorBaseline; // 本遍开始时的执行器统计，结束时取差值写入指标
+        std::function<void(int)> m_progressCallback;
+        int m_threadBudget = 0;
+        int m_decodeThreads = 0;    // 视频场景的解码线程，无视频场景时为 0
+        int m_decodeThreadType = 0;
+        std::atomic<bool> m_cancelRequested{false};
+        std::mutex m_pauseMutex;
+        std::condition_variable m_pauseCond;
+        bool m_paused = false;
     };
 
 } // namespace VideoCreator
@@ -0,0 +1,183 @@
+#include "RenderMetrics.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace VideoCreator
+{
+
+    void LatencyHistogram::record(double seconds)
+    {
+        if (seconds < 0.0)
+        {
+            seconds = 0.0;
+        }
+        const double micros = seconds * 1e6;
+        int index = 0;
+        if (micros > 1.0)
+        {
+            index = std::min(kBucketCount - 1, static_cast<int>(std::ceil(2.0 * std::log2(micros))));
+        }
+        ++m_buckets[index];
+        ++m_count;
+        m_sum += seconds;
+        m_max = std::max(m_max, seconds);
+    }
+
+    double LatencyHistogram::bucketUpperBound(int index)
+    {
+        return 1e-6 * std::pow(2.0, index / 2.0);
+    }
+
+    double LatencyHistogram::percentile(double p) const
+    {
+        if (m_count == 0)
+        {
+            return 0.0;
+        }
+        const int64_t target = std::max<int64_t>(1, static_cast<int64_t>(std::ceil(std::clamp(p, 0.0, 1.0) * m_count)));
+        int64_t cumulative = 0;
+        for (int i = 0; i < kBucketCount; ++i)
+        {
+            cumulative += m_buckets[i];
+            if (cumulative >= target)
+            {
+                return std::min(bucketUpperBound(i), m_max);
+            }
+        }
+        return m_max;
+    }
+
+    QJsonObject LatencyHistogram::toJson() const
+    {
+        QJsonObject json;
+        json["count"] = static_cast<double>(m_count);
+        json["mean_ms"] = mean() * 1000.0;
+        json["p50_ms"] = percentile(0.50) * 1000.0;
+        json["p90_ms"] = percentile(0.90) * 1000.0;
+        json["p99_ms"] = percentile(0.99) * 1000.0;
+        json["max_ms"] = m_max * 1000.0;
+        json["total_ms"] = m_sum * 1000.0;
+        return json;
+    }
+
+    QJsonObject GaugeStats::toJson() const
+    {
+        QJsonObject json;
+        json["mean"] = mean();
+        json["max"] = max;
+        json["last"] = last;
+        json["samples"] = static_cast<double>(samples);
+        return json;
+    }
+
+    QJsonObject RenderMetrics::toJson() const
+    {
+        QJsonObject latency;
+        latency["frame"] = frameLatency.toJson();
+        latency["video_decode_wait"] = videoDecodeWait.toJson();
+        latency["audio_decode_wait"] = audioDecodeWait.toJson();
+        latency["mux_write"] = muxWrite.toJson();
+
+        QJsonObject queues;
+        queues["video_queue_depth"] = videoQueueDepth.toJson();
+        queues["video_queue_capacity"] = videoQueueCapacity;
+        queues["audio_layer_buffered_samples"] = audioLayerBuffered.toJson();
+        queues["audio_buffer_capacity_samples"] = static_cast<double>(audioBufferCapacity);
+        queues["audio_fifo_samples"] = audioFifoSamples.toJson();
+        queues["encoder_queue_depth"] = encoderQueueDepth.toJson();
+
+        QJsonObject stalls;
+        stalls["video_decoder"] = static_cast<double>(videoDecoderStalls);
+        stalls["video_decoder_seconds"] = videoDecoderStallSeconds;
+        stalls["audio_decoder"] = static_cast<double>(audioDecoderStalls);
+        stalls["audio_decoder_seconds"] = audioDecoderStallSeconds;
+
+        QJsonObject caches;
+        caches["scene_frame_hits"] = static_cast<double>(sceneFrameCacheHits);
+        caches["scene_frame_misses"] = static_cast<double>(sceneFrameCacheMisses);
+        caches["prefetch_ready"] = static_cast<double>(prefetchReady);
+        caches["prefetch_waited"] = static_cast<double>(prefetchWaited);
+        caches["shared_demuxer_scenes"] = static_cast<double>(sharedDemuxerScenes);
+
+        QJsonObject frameRate;
+        frameRate["dropped"] = static_cast<double>(fpsDroppedFrames);
+        frameRate["duplicated"] = static_cast<double>(fpsDuplicatedFrames);
+        frameRate["blended"] = static_cast<double>(fpsBlendedFrames);
+
+        QJsonObject transitionAudio;
+        transitionAudio["crossfades"] = static_cast<double>(audioCrossfades);
+        transitionAudio["samples"] = static_cast<double>(audioCrossfadeSamples);
+        transitionAudio["head_ready"] = static_cast<double>(audioHeadReady);
+        transitionAudio["head_waited"] = static_cast<double>(audioHeadWaited);
+
+        QJsonObject compositor;
+        compositor["frames"] = static_cast<double>(compositorFrames);
+        compositor["static_frames"] = static_cast<double>(compositorStaticFrames);
+        compositor["dirty_ratio"] = compositorTotalPixels > 0 ? static_cast<double>(compositorDirtyPixels) / compositorTotalPixels : 0.0;
+
+        QJsonObject output;
+        output["video_frames_sent"] = static_cast<double>(videoFramesSent);
+        output["video_packets"] = static_cast<double>(videoPackets);
+        output["video_keyframes"] = static_cast<double>(videoKeyframes);
+        output["playable_bytes"] = static_cast<double>(playableBytes);
+        output["audio_packets"] = static_cast<double>(audioPackets);
+        output["video_bytes"] = static_cast<double>(videoBytesWritten);
+        output["audio_bytes"] = static_cast<double>(audioBytesWritten);
+        output["rendition_packets"] = static_cast<double>(renditionPackets);
+        output["rendition_bytes"] = static_cast<double>(renditionBytesWritten);
+        output["write_buffer_bytes"] = static_cast<double>(outputBufferBytes);
+        output["write_stalls"] = static_cast<double>(outputWriteStalls);
+        output["write_stall_ms"] = outputWriteStallSeconds * 1000.0;
+        output["io_thread_ms"] = outputIoSeconds * 1000.0;
+        output["preallocated_bytes"] = static_cast<double>(outputPreallocatedBytes);
+        output["checkpoint_parts"] = static_cast<double>(checkpointParts);
+        output["checkpoint_parts_resumed"] = static_cast<double>(checkpointPartsResumed);
+        output["checkpoint_parts_written"] = static_cast<double>(checkpointPartsWritten);
+
+        QJsonObject threads;
+        threads["video_encoder"] = videoEncoderThreads;
+        threads["video_decoder"] = videoDecoderThreads;
+        threads["audio_encoder"] = audioEncoderThreads;
+        threads["created"] = static_cast<double>(threadsCreated);
+
+        QJsonObject scheduler;
+        scheduler["workers"] = schedulerWorkers;
+        scheduler["tasks"] = static_cast<double>(schedulerTasks);
+        scheduler["steals"] = static_cast<double>(schedulerSteals);
+        scheduler["queue_wait_ms"] = schedulerQueueWaitSeconds * 1000.0;
+        scheduler["mean_queue_wait_us"] = schedulerTasks > 0 ? schedulerQueueWaitSeconds * 1e6 / schedulerTasks : 0.0;
+
+        QJsonObject json;
+        json["latency"] = latency;
+        json["queues"] = queues;
+        json["stalls"] = stalls;
+        json["caches"] = caches;
+        json["frame_rate"] = frameRate;
+        json["transition_audio"] = transitionAudio;
+        json["compositor"] = compositor;
+        json["output"] = output;
+        json["threads"] = threads;
+        json["scheduler"] = scheduler;
+        return json;
+    }
+
+    std::string RenderMetrics::summary() const
+    {
+        char buffer[512];
+        std::snprintf(buffer, sizeof(buffer),
+                      "frame p50 %.2fms p99 %.2fms max %.2fms | video queue %.1f/%d (decoder stalls %lld) | "
+                      "encoder backlog %.1f max %.0f | audio fifo %.0f max %.0f | decode wait video %.0fms audio %.0fms | "
+                      "cache %lld/%lld prefetch %lld/%lld | written %.1f MB (mux %.0fms, stalls %lld)",
+                      frameLatency.percentile(0.50) * 1000.0, frameLatency.percentile(0.99) * 1000.0, frameLatency.max() * 1000.0,
+                      videoQueueDepth.mean(), videoQueueCapacity, static_cast<long long>(videoDecoderStalls),
+                      encoderQueueDepth.mean(), encoderQueueDepth.max, audioFifoSamples.mean(), audioFifoSamples.max,
+                      videoDecodeWait.total() * 1000.0, audioDecodeWait.total() * 1000.0,
+                      static_cast<long long>(sceneFrameCacheHits), static_cast<long long>(sceneFrameCacheHits + sceneFrameCacheMisses),
+                      static_cast<long long>(prefetchReady), static_cast<long long>(prefetchReady + prefetchWaited),
+                      (videoBytesWritten + audioBytesWritten + renditionBytesWritten) / (1024.0 * 1024.0),
+                      muxWrite.total() * 1000.0, static_cast<long long>(outputWriteStalls));
+        return buffer;
+    }
+
+} // namespace VideoCreator
@@ -0,0 +1,141 @@
+#ifndef RENDER_METRICS_H
+#define RENDER_METRICS_H
+
+#include <QJsonObject>
+#include <cstdint>
+#include <string>
+
+namespace VideoCreator
+{
+
+    // 对数分桶的耗时直方图：桶上界为 1µs × 2^(i/2)，最后一个桶约 11.8s，超出的计入最后一个桶
+    class LatencyHistogram
+    {
+    public:
+        static constexpr int kBucketCount = 48;
+
+        void record(double seconds);
+
+        int64_t count() const { return m_count; }
+        double mean() const { return m_count > 0 ? m_sum / m_count : 0.0; }
+        double max() const { return m_max; }
+        double total() const { return m_sum; }
+
+        // 百分位（秒，p 取 0-1），返回所在桶的上界且不超过实际最大值
+        double percentile(double p) const;
+
+        static double bucketUpperBound(int index);
+
+        QJsonObject toJson() const;
+
+    private:
+        int64_t m_buckets[kBucketCount] = {};
+        int64_t m_count = 0;
+        double m_sum = 0.0;
+        double m_max = 0.0;
+    };
+
+    // 采样型指标（队列深度、缓冲量等）
+    struct GaugeStats
+    {
+        double last = 0.0;
+        double max = 0.0;
+        double sum = 0.0;
+        int64_t samples = 0;
+
+        void sample(double value)
+        {
+            last = value;
+            max = samples == 0 || value > max ? value : max;
+            sum += value;
+            ++samples;
+        }
+        double mean() const { return samples > 0 ? sum / samples : 0.0; }
+
+        QJsonObject toJson() const;
+    };
+
+    /**
+     * RenderMetrics - RenderEngine 渲染期间始终开启的运行指标
+     *
+     * 只在渲染线程中更新（解码线程的阻塞统计在场景结束时合并进来），读取方应在进度回调中或渲染结束后访问。
+     * 用于根据数据调整解码队列长度（maxVideoQueueSize）、音频缓冲上限（maxBufferedSamples）与线程数。
+     */
+    struct RenderMetrics
+    {
+        LatencyHistogram frameLatency;    // 单帧生产耗时：取源帧到编码完成（不含暂停）
+        LatencyHistogram videoDecodeWait; // 主循环等待视频解码线程出帧
+        LatencyHistogram audioDecodeWait; // 每次混音等待音频解码线程补充采样的总时间
+        LatencyHistogram muxWrite;        // 渲染线程把一个包交给封装器写出的耗时
+
+        GaugeStats videoQueueDepth;    // 取帧时解码队列中的帧数
+        GaugeStats audioLayerBuffered; // 混音时音频层已缓冲的采样数
+        GaugeStats audioFifoSamples;   // 混音后、编码前 FIFO 中的采样数
+        GaugeStats encoderQueueDepth;  // 已送入视频编码器但尚未产出包的帧数
+
+        int64_t videoDecoderStalls = 0; // 视频解码线程因队列满而阻塞的次数
+        double videoDecoderStallSeconds = 0.0;
+        int64_t audioDecoderStalls = 0; // 音频解码线程因缓冲满而阻塞的次数
+        double audioDecoderStallSeconds = 0.0;
+
+        int64_t sceneFrameCacheHits = 0;   // 转场取首/末帧时命中缓存
+        int64_t sceneFrameCacheMisses = 0; // 需要重新解码
+        int64_t prefetchReady = 0;         // 视频场景首帧预取在使用时已完成
+        int64_t prefetchWaited = 0;        // 使用时仍需等待预取完成
+        int64_t sharedDemuxerScenes = 0;   // 视频与原音轨共用一次解复用的场景数
+
+        int64_t fpsDroppedFrames = 0;    // 帧率转换：未缩放即丢弃的源帧
+        int64_t fpsDuplicatedFrames = 0; // 重复输出的帧
+        int64_t fpsBlendedFrames = 0;    // blend 模式混合生成的帧
+
+        int64_t audioCrossfades = 0;       // 转场音频交叉淡化次数
+        int64_t audioCrossfadeSamples = 0; // 交叉淡化写出的采样数
+        int64_t audioHeadReady = 0;        // 转场目标场景开头在转场开始时已解码完成
+        int64_t audioHeadWaited = 0;       // 仍需等待解码
+
+        int64_t compositorFrames = 0;       // 逐帧合成动态层（视频 / Ken Burns 帧）与叠加图片的帧数
+        int64_t compositorDirtyPixels = 0;  // 其中重新写入的像素数
+        int64_t compositorTotalPixels = 0;  // 其中输出的总像素数
+        int64_t compositorStaticFrames = 0; // 直接复用静态画布的帧数（无 Ken Burns 的图片场景）
+
+        int64_t videoFramesSent = 0;
+        int64_t videoPackets = 0;
+        int64_t videoKeyframes = 0; // fMP4 输出时每个关键帧开始一个分片
+        int64_t playableBytes = 0;  // fMP4：第一个分片写入输出文件后为其结束位置，之前为 0
+        int64_t audioPackets = 0;
+        int64_t videoBytesWritten = 0;
+        int64_t audioBytesWritten = 0;
+        int64_t renditionPackets = 0; // hls / dash 其余码率档
+        int64_t renditionBytesWritten = 0;
+        int64_t outputBufferBytes = 0;       // 写后台每块缓冲大小，0 表示渲染线程同步写文件
+        int64_t outputWriteStalls = 0;       // 渲染线程等待 I/O 线程腾出缓冲的次数
+        double outputWriteStallSeconds = 0.0;
+        double outputIoSeconds = 0.0;        // I/O 线程写盘耗时
+        int64_t outputPreallocatedBytes = 0; // I/O 线程 fallocate 预留的磁盘空间
+        int64_t checkpointParts = 0;         // 断点续渲的分段数，未启用时为 0
+        int64_t checkpointPartsResumed = 0;  // 其中从上次渲染的日志恢复、本次跳过的分段
+        int64_t checkpointPartsWritten = 0;  // 本次渲染写完的分段
+
+        // 本次渲染使用的上限与线程数，便于与上面的采样对照
+        int videoQueueCapacity = 0;
+        int64_t audioBufferCapacity = 0;
+        int videoEncoderThreads = 0;
+        int videoDecoderThreads = 0;
+        int audioEncoderThreads = 0;
+
+        // 解码 / 预取任务的调度开销
+        int schedulerWorkers = 0;
+        int64_t schedulerTasks = 0;
+        int64_t schedulerSteals = 0;             // 被空闲线程窃取执行的任务
+        double schedulerQueueWaitSeconds = 0.0;  // 任务入队到开始执行的总等待
+        int64_t threadsCreated = 0;              // 本次渲染新建的系统线程
+
+        QJsonObject toJson() const;
+
+        // 单行文字摘要，用于日志
+        std::string summary() const;
+    };
+
+} // namespace VideoCreator
+
+#endif // RENDER_METRICS_H
@@ -0,0 +1,481 @@
+#include "RenderQueue.h"
+#include "VideoCreatorAPI.h"
+#include <QDebug>
+#include <QString>
+#include <algorithm>
+#include <chrono>
+
+namespace VideoCreator
+{
+
+    std::string renderJobStateToString(RenderJobState state)
+    {
+        switch (state)
+        {
+        case RenderJobState::QUEUED:
+            return "queued";
+        case RenderJobState::RUNNING:
+            return "running";
+        case RenderJobState::PAUSED:
+            return "paused";
+        case RenderJobState::COMPLETED:
+            return "completed";
+        case RenderJobState::FAILED:
+            return "failed";
+        case RenderJobState::CANCELLED:
+            return "cancelled";
+        default:
+            return "unknown";
+        }
+    }
+
+    RenderQueue::RenderQueue(int cpuBudget, int maxConcurrentJobs)
+    {
+        int budget = cpuBudget;
+        if (budget <= 0) {
+            budget = static_cast<int>(std::thread::hardware_concurrency());
+            if (budget <= 0) {
+                budget = 4;
+            }
+        }
+        int jobs = maxConcurrentJobs > 0 ? maxConcurrentJobs : std::max(1, budget / 4);
+        m_threadsPerJob = std::max(1, budget / jobs);
+        m_maxConcurrent = jobs;
+
+        qDebug() << "RenderQueue: CPU 预算" << budget << "线程，并发任务" << jobs << "，每个任务" << m_threadsPerJob << "个编码线程";
+
+        m_workers.reserve(jobs);
+        for (int i = 0; i < jobs; ++i) {
+            m_workers.emplace_back(&RenderQueue::workerLoop, this);
+        }
+    }
+
+    RenderQueue::~RenderQueue()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+            for (auto &item : m_jobs) {
+                Job &job = *item.second;
+                if (job.active) {
+                    job.cancelRequested = true;
+                    if (job.control) {
+                        job.control->requestCancel();
+                    }
+                }
+            }
+        }
+        m_jobCond.notify_all();
+        // m_stop 之后不会再补工作线程，可以不加锁遍历
+        for (auto &worker : m_workers) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
+
+    void RenderQueue::setEventCallback(std::function<void(const RenderJobEvent &)> callback)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_eventCallback = std::move(callback);
+    }
+
+    int RenderQueue::submit(const ProjectConfig &config, int priority)
+    {
+        auto job = std::make_unique<Job>();
+        job->priority = priority;
+        job->config = config;
+        job->name = !config.project.name.empty() ? config.project.name : config.project.output_path;
+        return enqueue(std::move(job));
+    }
+
+    int RenderQueue::submitFile(const std::string &configPath, int priority)
+    {
+        auto job = std::make_unique<Job>();
+        job->priority = priority;
+        job->configPath = configPath;
+        job->name = configPath;
+        return enqueue(std::move(job));
+    }
+
+    int RenderQueue::enqueue(std::unique_ptr<Job> job)
+    {
+        RenderJobEvent event;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            job->id = m_nextJobId++;
+            event = makeEventLocked(*job);
+            m_jobs.emplace(job->id, std::move(job));
+        }
+        m_jobCond.notify_one();
+        emitEvent(event);
+        return event.jobId;
+    }
+
+    bool RenderQueue::cancel(int jobId)
+    {
+        RenderJobEvent event;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_jobs.find(jobId);
+            if (it == m_jobs.end()) {
+                return false;
+            }
+            Job &job = *it->second;
+            if (job.active) {
+                // 运行中的任务由工作线程在渲染中止后上报 CANCELLED（暂停中的渲染也会被唤醒）
+                job.cancelRequested = true;
+                if (job.control) {
+                    job.control->requestCancel();
+                }
+                return true;
+            }
+            if (job.state != RenderJobState::QUEUED && job.state != RenderJobState::PAUSED) {
+                return false;
+            }
+            job.state = RenderJobState::CANCELLED;
+            event = makeEventLocked(job);
+        }
+        m_idleCond.notify_all();
+        emitEvent(event);
+        return true;
+    }
+
+    void RenderQueue::cancelAll()
+    {
+        std::vector<int> ids;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const auto &item : m_jobs) {
+                ids.push_back(item.first);
+            }
+        }
+        for (int id : ids) {
+            cancel(id);
+        }
+    }
+
+    bool RenderQueue::pause(int jobId)
+    {
+        std::vector<RenderJobEvent> events;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_jobs.find(jobId);
+            if (it == m_jobs.end()) {
+                return false;
+            }
+            Job &job = *it->second;
+            if (job.active) {
+                if (job.cancelRequested) {
+                    return false;
+                }
+                if (job.resumeRequested) {
+                    // 还在等名额的恢复请求直接撤回，渲染本来就处于挂起状态
+                    job.resumeRequested = false;
+                } else if (job.pauseRequested) {
+                    return false;
+                } else {
+                    job.pauseRequested = true;
+                    if (job.control) {
+                        job.control->setPaused(true);
+                    }
+                }
+            } else if (job.state != RenderJobState::QUEUED) {
+                return false;
+            }
+            job.state = RenderJobState::PAUSED;
+            events.push_back(makeEventLocked(job));
+            if (job.active) {
+                // 让出的名额交给等待恢复或排队中的任务
+                std::vector<RenderJobEvent> scheduled = scheduleLocked();
+                events.insert(events.end(), scheduled.begin(), scheduled.end());
+            }
+        }
+        m_idleCond.notify_all();
+        for (const RenderJobEvent &event : events) {
+            emitEvent(event);
+        }
+        return true;
+    }
+
+    bool RenderQueue::resume(int jobId)
+    {
+        RenderJobEvent event;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_jobs.find(jobId);
+            if (it == m_jobs.end()) {
+                return false;
+            }
+            Job &job = *it->second;
+            if (job.active) {
+                if (!job.pauseRequested || job.resumeRequested || job.cancelRequested) {
+                    return false;
+                }
+                if (runningLocked() < m_maxConcurrent) {
+                    job.pauseRequested = false;
+                    if (job.control) {
+                        job.control->setPaused(false);
+                    }
+                    job.state = RenderJobState::RUNNING;
+                } else {
+                    // 名额已满：保持挂起，由 scheduleLocked 在下一个名额空出时继续
+                    job.resumeRequested = true;
+                    job.state = RenderJobState::QUEUED;
+                }
+            } else if (job.state == RenderJobState::PAUSED || job.state == RenderJobState::CANCELLED ||
+                       job.state == RenderJobState::FAILED) {
+                // 取消或失败的任务从头重新渲染
+                if (job.state != RenderJobState::PAUSED) {
+                    job.progress = 0;
+                    job.error.clear();
+                }
+                job.cancelRequested = false;
+                job.state = RenderJobState::QUEUED;
+            } else {
+                return false;
+            }
+            event = makeEventLocked(job);
+        }
+        m_jobCond.notify_one();
+        emitEvent(event);
+        return true;
+    }
+
+    bool RenderQueue::waitForAll(int timeoutMs)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (timeoutMs < 0) {
+            m_idleCond.wait(lock, [this]() { return isIdleLocked(); });
+            return true;
+        }
+        return m_idleCond.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this]() { return isIdleLocked(); });
+    }
+
+    RenderJobState RenderQueue::state(int jobId) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_jobs.find(jobId);
+        return it == m_jobs.end() ? RenderJobState::FAILED : it->second->state;
+    }
+
+    int RenderQueue::progress(int jobId) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_jobs.find(jobId);
+        return it == m_jobs.end() ? 0 : it->second->progress;
+    }
+
+    std::string RenderQueue::errorString(int jobId) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_jobs.find(jobId);
+        return it == m_jobs.end() ? std::string("未知任务") : it->second->error;
+    }
+
+    bool RenderQueue::isIdleLocked() const
+    {
+        for (const auto &item : m_jobs) {
+            const Job &job = *item.second;
+            if (job.state == RenderJobState::QUEUED || job.state == RenderJobState::RUNNING) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    RenderQueue::Job *RenderQueue::nextRunnableLocked()
+    {
+        // 优先级高者先；同优先级按提交顺序（m_jobs 按 ID 有序）
+        Job *best = nullptr;
+        for (auto &item : m_jobs) {
+            Job &job = *item.second;
+            if (job.state != RenderJobState::QUEUED || job.active) {
+                continue;
+            }
+            if (!best || job.priority > best->priority) {
+                best = &job;
+            }
+        }
+        return best;
+    }
+
+    int RenderQueue::runningLocked() const
+    {
+        // 运行中暂停（含等待名额恢复）的任务不占名额
+        int running = 0;
+        for (const auto &item : m_jobs) {
+            const Job &job = *item.second;
+            if (job.active && !job.pauseRequested) {
+                ++running;
+            }
+        }
+        return running;
+    }
+
+    std::vector<RenderJobEvent> RenderQueue::scheduleLocked()
+    {
+        // 名额空出时（任务结束或暂停）先继续等待恢复的任务，按优先级；剩余名额交给排队任务
+        std::vector<RenderJobEvent> events;
+        while (runningLocked() < m_maxConcurrent) {
+            Job *best = nullptr;
+            for (auto &item : m_jobs) {
+                Job &job = *item.second;
+                if (job.active && job.resumeRequested && (!best || job.priority > best->priority)) {
+                    best = &job;
+                }
+            }
+            if (!best) {
+                break;
+            }
+            best->resumeRequested = false;
+            best->pauseRequested = false;
+            if (best->control) {
+                best->control->setPaused(false);
+            }
+            best->state = RenderJobState::RUNNING;
+            events.push_back(makeEventLocked(*best));
+        }
+
+        if (!m_stop && m_idleWorkers == 0 && runningLocked() < m_maxConcurrent && nextRunnableLocked()) {
+            // 工作线程都被暂停的任务占住，补一个线程接手排队任务
+            m_workers.emplace_back(&RenderQueue::workerLoop, this);
+        }
+        m_jobCond.notify_all();
+        return events;
+    }
+
+    RenderJobEvent RenderQueue::makeEventLocked(const Job &job) const
+    {
+        RenderJobEvent event;
+        event.jobId = job.id;
+        event.state = job.state;
+        event.progress = job.progress;
+        event.name = job.name;
+        event.error = job.error;
+        return event;
+    }
+
+    void RenderQueue::emitEvent(const RenderJobEvent &event)
+    {
+        std::function<void(const RenderJobEvent &)> callback;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            callback = m_eventCallback;
+        }
+        if (callback) {
+            callback(event);
+        }
+    }
+
+    void RenderQueue::workerLoop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            Job *job = nullptr;
+            ++m_idleWorkers;
+            m_jobCond.wait(lock, [&]() {
+                if (m_stop) {
+                    return true;
+                }
+                job = runningLocked() < m_maxConcurrent ? nextRunnableLocked() : nullptr;
+                return job != nullptr;
+            });
+            --m_idleWorkers;
+            if (m_stop) {
+                break;
+            }
+
+            job->active = true;
+            job->state = RenderJobState::RUNNING;
+            job->progress = 0;
+            job->error.clear();
+            job->cancelRequested = false;
+            job->pauseRequested = false;
+            job->resumeRequested = false;
+            RenderJobEvent event = makeEventLocked(*job);
+            lock.unlock();
+            emitEvent(event);
+
+            runJob(*job);
+
+            lock.lock();
+            job->active = false;
+            std::vector<RenderJobEvent> events = scheduleLocked();
+            m_idleCond.notify_all();
+            if (!events.empty()) {
+                lock.unlock();
+                for (const RenderJobEvent &resumed : events) {
+                    emitEvent(resumed);
+                }
+                lock.lock();
+            }
+        }
+    }
+
+    void RenderQueue::runJob(Job &job)
+    {
+        RenderControl control;
+        control.setThreadBudget(m_threadsPerJob);
+        control.setRemoveIncompleteOutput(true);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            job.control = &control;
+            if (job.cancelRequested) {
+                control.requestCancel();
+            }
+            if (job.pauseRequested) {
+                control.setPaused(true);
+            }
+        }
+
+        const RenderProgressCallback progress = [this, &job](int percent, const RenderMetrics &) {
+            RenderJobEvent event;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                job.progress = percent;
+                event = makeEventLocked(job);
+            }
+            emitEvent(event);
+        };
+
+        // Job 的配置字段只在提交时写入，运行期间可以不加锁读取；配置文件此时才加载
+        std::string error;
+        const bool success = job.configPath.empty()
+                                 ? RenderFromConfig(job.config, &error, progress, nullptr, &control)
+                                 : RenderFromJson(job.configPath, &error, progress, nullptr, &control);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            job.control = nullptr;
+        }
+        finishJob(job, success, error);
+    }
+
+    void RenderQueue::finishJob(Job &job, bool success, const std::string &error)
+    {
+        RenderJobEvent event;
+        bool cancelled = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            cancelled = job.cancelRequested;
+            if (success) {
+                job.state = RenderJobState::COMPLETED;
+                job.progress = 100;
+            } else if (cancelled) {
+                job.state = RenderJobState::CANCELLED;
+            } else {
+                job.state = RenderJobState::FAILED;
+                job.error = error;
+            }
+            job.pauseRequested = false;
+            job.resumeRequested = false;
+            event = makeEventLocked(job);
+        }
+        if (!success && !cancelled) {
+            qDebug() << "RenderQueue: 任务" << event.jobId << "失败:" << QString::fromStdString(error);
+        }
+        emitEvent(event);
+    }
+
+} // namespace VideoCreator
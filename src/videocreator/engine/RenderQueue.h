@@ -0,0 +1,131 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "model/ProjectConfig.h"
+
+namespace VideoCreator
+{
+
+    class RenderControl;
+
+    enum class RenderJobState
+    {
+        QUEUED,
+        RUNNING,
+        PAUSED,
+        COMPLETED,
+        FAILED,
+        CANCELLED
+    };
+
+    std::string renderJobStateToString(RenderJobState state);
+
+    // 任务事件：状态变化与进度变化都会触发
+    struct RenderJobEvent
+    {
+        int jobId = 0;
+        RenderJobState state = RenderJobState::QUEUED;
+        int progress = 0;  // 0-100
+        std::string name;  // 配置文件路径或项目名
+        std::string error; // FAILED 时的错误信息
+    };
+
+    /**
+     * RenderQueue - 批量渲染队列
+     *
+     * 按优先级（高者先，同级先提交者先）调度任务，同时运行的任务数由 CPU 预算决定，
+     * 每个任务分到 预算/并发数 个编码线程，而不是各自占用 min(8, 硬件线程数)。
+     * 任务通过 VideoCreatorAPI 的 RenderFromJson / RenderFromConfig 渲染，取消与暂停经由 RenderControl。
+     * 事件回调在工作线程中调用，回调内不要再调用本队列的阻塞接口。
+     */
+    class RenderQueue
+    {
+    public:
+        // cpuBudget 为 0 时取硬件线程数；maxConcurrentJobs 为 0 时按每个任务约 4 个线程推算
+        explicit RenderQueue(int cpuBudget = 0, int maxConcurrentJobs = 0);
+        ~RenderQueue();
+
+        RenderQueue(const RenderQueue &) = delete;
+        RenderQueue &operator=(const RenderQueue &) = delete;
+
+        void setEventCallback(std::function<void(const RenderJobEvent &)> callback);
+
+        // 提交任务，返回任务 ID；配置文件在开始渲染时才加载
+        int submit(const ProjectConfig &config, int priority = 0);
+        int submitFile(const std::string &configPath, int priority = 0);
+
+        // 取消：排队中的任务直接出队，运行中的任务在下一帧中止并删除本次渲染已写出的未完成输出（含 hls / dash 的播放列表与分片）
+        bool cancel(int jobId);
+        void cancelAll();
+
+        // 暂停：排队中的任务不再被调度；运行中的任务在帧边界挂起并让出并发名额，
+        // 工作线程都被暂停的任务占住时补一个线程接手排队任务
+        bool pause(int jobId);
+
+        // 恢复暂停的任务：运行中暂停的任务有空闲名额时立即继续，否则排队（QUEUED）等下一个空出的名额，先于未开始的任务；
+        // 已取消或失败的任务重新排队从头渲染
+        bool resume(int jobId);
+
+        // 等待所有任务结束（暂停的任务不计），timeoutMs < 0 表示一直等待；超时返回 false
+        bool waitForAll(int timeoutMs = -1);
+
+        RenderJobState state(int jobId) const;
+        int progress(int jobId) const;
+        std::string errorString(int jobId) const;
+
+        int concurrentJobs() const { return m_maxConcurrent; }
+        int threadsPerJob() const { return m_threadsPerJob; }
+
+    private:
+        struct Job
+        {
+            int id = 0;
+            int priority = 0;
+            ProjectConfig config;
+            std::string configPath; // 非空时从文件加载
+            std::string name;
+            RenderJobState state = RenderJobState::QUEUED;
+            int progress = 0;
+            std::string error;
+            RenderControl *control = nullptr; // 仅在渲染期间有效，受 m_mutex 保护
+            bool active = false;              // 已被工作线程取走（含运行中暂停）
+            bool cancelRequested = false;
+            bool pauseRequested = false;
+            bool resumeRequested = false;     // 运行中暂停的任务等待空闲名额继续
+        };
+
+        int enqueue(std::unique_ptr<Job> job);
+        void workerLoop();
+        void runJob(Job &job);
+        void finishJob(Job &job, bool success, const std::string &error);
+        Job *nextRunnableLocked();
+        int runningLocked() const;
+        std::vector<RenderJobEvent> scheduleLocked();
+        RenderJobEvent makeEventLocked(const Job &job) const;
+        void emitEvent(const RenderJobEvent &event);
+        bool isIdleLocked() const;
+
+        int m_threadsPerJob = 1;
+        int m_maxConcurrent = 1;
+        int m_idleWorkers = 0;
+        std::vector<std::thread> m_workers; // 只在 m_mutex 下增长
+        mutable std::mutex m_mutex;
+        std::condition_variable m_jobCond;  // 有新任务可调度
+        std::condition_variable m_idleCond; // 任务结束
+        std::map<int, std::unique_ptr<Job>> m_jobs;
+        int m_nextJobId = 1;
+        bool m_stop = false;
+        std::function<void(const RenderJobEvent &)> m_eventCallback;
+    };
+
+} // namespace VideoCreator
+
+#endif // RENDER_QUEUE_H
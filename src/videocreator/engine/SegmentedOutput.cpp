@@ -0,0 +1,326 @@
+#include "SegmentedOutput.h"
+#include "EncoderSettings.h"
+#include "ffmpeg_utils/AvPacketWrapper.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace VideoCreator
+{
+
+    namespace
+    {
+        // 封装器在累计时长达到 n × 目标后的第一个关键帧处切片；目标取极小值即每个关键帧切一次
+        const char *kSplitTarget = "0.1";
+
+        std::string ffmpegError(int ret, const std::string &message)
+        {
+            char errbuf[AV_ERROR_MAX_STRING_SIZE] = {0};
+            av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
+            return message + ": " + errbuf;
+        }
+
+        bool fail(std::string *error, const std::string &message)
+        {
+            if (error)
+            {
+                *error = message;
+            }
+            return false;
+        }
+
+        // 去掉扩展名的完整路径，分片文件与播放列表放在同一目录并以此为前缀
+        std::string pathWithoutExtension(const std::string &path)
+        {
+            const size_t slash = path.find_last_of("/\\");
+            const size_t dot = path.find_last_of('.');
+            if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+            {
+                return path;
+            }
+            return path.substr(0, dot);
+        }
+
+        std::string fileName(const std::string &path)
+        {
+            const size_t slash = path.find_last_of("/\\");
+            return slash == std::string::npos ? path : path.substr(slash + 1);
+        }
+    } // namespace
+
+    bool SegmentedOutput::validate(const ProjectConfig &config, std::string *error)
+    {
+        const ProjectInfoConfig &project = config.project;
+        if (!isSegmentedFormat(project.output_format))
+        {
+            if (!project.renditions.empty())
+            {
+                return fail(error, "renditions 只适用于 hls / dash 输出");
+            }
+            return true;
+        }
+        if (project.segment_duration <= 0.0)
+        {
+            return fail(error, "segment_duration 必须大于 0");
+        }
+        if (!project.renditions.empty() && EncoderSettings::isTwoPass(config.global_effects.video_encoding))
+        {
+            return fail(error, "多码率档暂不支持 two_pass 码控");
+        }
+
+        std::vector<std::string> names{primaryName(project)};
+        for (const RenditionConfig &rendition : project.renditions)
+        {
+            const std::string name = renditionName(rendition);
+            if (rendition.height <= 0 || rendition.height % 2 != 0 || rendition.width < 0 || rendition.width % 2 != 0)
+            {
+                return fail(error, "码率档宽高须为正偶数: " + name);
+            }
+            if (EncoderSettings::parseBitrate(rendition.bitrate) <= 0)
+            {
+                return fail(error, "码率档需要有效的 bitrate: " + name);
+            }
+            // 名称写入 var_stream_map 与分片文件名
+            if (name.find_first_of(" ,:/\\") != std::string::npos)
+            {
+                return fail(error, "码率档名称不能包含空格、逗号、冒号或路径分隔符: " + name);
+            }
+            if (std::find(names.begin(), names.end(), name) != names.end())
+            {
+                return fail(error, "码率档名称重复: " + name);
+            }
+            names.push_back(name);
+        }
+        return true;
+    }
+
+    int SegmentedOutput::keyframeInterval(const ProjectInfoConfig &project)
+    {
+        // 分片输出时取代 video_encoding.gop
+        return std::max(1, static_cast<int>(std::lround(project.segment_duration * project.fps)));
+    }
+
+    std::string SegmentedOutput::primaryName(const ProjectInfoConfig &project)
+    {
+        return std::to_string(project.height) + "p";
+    }
+
+    std::string SegmentedOutput::renditionName(const RenditionConfig &rendition)
+    {
+        return rendition.name.empty() ? std::to_string(rendition.height) + "p" : rendition.name;
+    }
+
+    int SegmentedOutput::renditionWidth(const ProjectInfoConfig &project, const RenditionConfig &rendition)
+    {
+        if (rendition.width > 0 || project.height <= 0)
+        {
+            return rendition.width;
+        }
+        const int width = static_cast<int>(std::lround(static_cast<double>(rendition.height) * project.width / project.height));
+        return std::max(2, width & ~1);
+    }
+
+    std::string SegmentedOutput::muxerUrl(const ProjectInfoConfig &project)
+    {
+        if (project.output_format == "hls" && !project.renditions.empty())
+        {
+            return pathWithoutExtension(project.output_path) + "_%v.m3u8";
+        }
+        return project.output_path;
+    }
+
+    void SegmentedOutput::muxerOptions(const ProjectInfoConfig &project, bool hasAudio, AVDictionary **options)
+    {
+        const std::string base = pathWithoutExtension(project.output_path);
+        const bool ladder = !project.renditions.empty();
+
+        if (project.output_format == "hls")
+        {
+            av_dict_set(options, "hls_time", kSplitTarget, 0);
+            av_dict_set(options, "hls_playlist_type", "vod", 0);
+            av_dict_set(options, "hls_flags", "independent_segments", 0);
+            av_dict_set(options, "hls_segment_filename", (base + (ladder ? "_%v" : "") + "_%05d.ts").c_str(), 0);
+            if (ladder)
+            {
+                // 每个视频档一个子播放列表，共用同一路音频
+                const std::string group = hasAudio ? ",agroup:audio" : "";
+                std::string streamMap = "v:0" + group + ",name:" + primaryName(project);
+                for (size_t i = 0; i < project.renditions.size(); ++i)
+                {
+                    streamMap += " v:" + std::to_string(i + 1) + group + ",name:" + renditionName(project.renditions[i]);
+                }
+                if (hasAudio)
+                {
+                    streamMap += " a:0,agroup:audio,name:audio";
+                }
+                av_dict_set(options, "var_stream_map", streamMap.c_str(), 0);
+                av_dict_set(options, "master_pl_name", fileName(project.output_path).c_str(), 0);
+            }
+            return;
+        }
+
+        // dash：全部视频档在同一个 AdaptationSet 中作为不同 Representation
+        const std::string stem = fileName(base);
+        av_dict_set(options, "seg_duration", kSplitTarget, 0);
+        av_dict_set(options, "use_template", "1", 0);
+        av_dict_set(options, "use_timeline", "1", 0);
+        av_dict_set(options, "adaptation_sets", hasAudio ? "id=0,streams=v id=1,streams=a" : "id=0,streams=v", 0);
+        av_dict_set(options, "init_seg_name", (stem + "-init-$RepresentationID$.$ext$").c_str(), 0);
+        av_dict_set(options, "media_seg_name", (stem + "-$RepresentationID$-$Number%05d$.$ext$").c_str(), 0);
+    }
+
+    int SegmentedOutput::encoderThreadBudget(int threadBudget, int encoderCount)
+    {
+        int total = threadBudget;
+        if (total <= 0)
+        {
+            const unsigned int hardware = std::thread::hardware_concurrency();
+            total = hardware > 0 ? static_cast<int>(hardware) : 4;
+        }
+        return std::max(1, total / std::max(1, encoderCount));
+    }
+
+    RenditionEncoder::~RenditionEncoder()
+    {
+        if (m_scaler)
+        {
+            sws_freeContext(m_scaler);
+        }
+    }
+
+    bool RenditionEncoder::open(AVFormatContext *outputContext, const ProjectConfig &config, const RenditionConfig &rendition,
+                                int threadBudget, std::string *error)
+    {
+        const ProjectInfoConfig &project = config.project;
+        const VideoEncodingConfig &primary = config.global_effects.video_encoding;
+        m_name = SegmentedOutput::renditionName(rendition);
+
+        const AVCodec *codec = avcodec_find_encoder_by_name(primary.codec.c_str());
+        if (!codec)
+        {
+            return fail(error, "找不到视频编码器: " + primary.codec);
+        }
+        m_stream = avformat_new_stream(outputContext, codec);
+        if (!m_stream)
+        {
+            return fail(error, "创建码率档视频流失败: " + m_name);
+        }
+        m_stream->id = outputContext->nb_streams - 1;
+
+        AVCodecContext *context = avcodec_alloc_context3(codec);
+        if (!context)
+        {
+            return fail(error, "创建码率档编码器上下文失败: " + m_name);
+        }
+        m_codecContext.reset(context);
+
+        context->width = SegmentedOutput::renditionWidth(project, rendition);
+        context->height = rendition.height;
+        context->time_base = {1, project.fps};
+        context->framerate = {project.fps, 1};
+        context->pix_fmt = AV_PIX_FMT_YUV420P;
+        if (outputContext->oformat->flags & AVFMT_GLOBALHEADER)
+        {
+            context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+        }
+
+        // 沿用主码率档的编码器、预设与码控模式，只替换码率；峰值默认等于目标码率（带 VBV 上限的 crf / abr）
+        VideoEncodingConfig encoding = primary;
+        encoding.bitrate = rendition.bitrate;
+        encoding.maxrate = rendition.maxrate.empty() ? rendition.bitrate : rendition.maxrate;
+        encoding.bufsize.clear();
+        ResolvedVideoEncoding resolved = EncoderSettings::resolve(encoding, project.fps, threadBudget);
+        resolved.gopSize = SegmentedOutput::keyframeInterval(project);
+        resolved.fixedKeyframes = true;
+        if (!EncoderSettings::apply(context, encoding, resolved, error))
+        {
+            return false;
+        }
+
+        int ret = avcodec_open2(context, codec, nullptr);
+        if (ret < 0)
+        {
+            return fail(error, ffmpegError(ret, "打开码率档编码器失败: " + m_name));
+        }
+        ret = avcodec_parameters_from_context(m_stream->codecpar, context);
+        if (ret < 0)
+        {
+            return fail(error, ffmpegError(ret, "复制码率档视频流参数失败: " + m_name));
+        }
+        m_stream->time_base = context->time_base;
+        m_stream->codecpar->bit_rate = SegmentedOutput::advertisedBitrate(resolved.bitRate, resolved.maxRate);
+
+        m_frame = FFmpegUtils::createAvFrame(context->width, context->height, AV_PIX_FMT_YUV420P);
+        if (!m_frame)
+        {
+            return fail(error, "创建码率档缩放帧失败: " + m_name);
+        }
+        return true;
+    }
+
+    bool RenditionEncoder::encode(const AVFrame *frame, const PacketWriter &writer, std::string *error)
+    {
+        // 编码器可能仍持有上一帧缓冲的引用，写入前确保可写
+        int ret = av_frame_make_writable(m_frame.get());
+        if (ret < 0)
+        {
+            return fail(error, ffmpegError(ret, "码率档帧不可写: " + m_name));
+        }
+
+        // 阶梯多为缩小，双三次比双线性更清晰
+        m_scaler = sws_getCachedContext(m_scaler,
+                                        frame->width, frame->height, (AVPixelFormat)frame->format,
+                                        m_frame->width, m_frame->height, AV_PIX_FMT_YUV420P,
+                                        SWS_BICUBIC, nullptr, nullptr, nullptr);
+        if (!m_scaler)
+        {
+            return fail(error, "创建码率档缩放上下文失败: " + m_name);
+        }
+        if (sws_scale(m_scaler, frame->data, frame->linesize, 0, frame->height, m_frame->data, m_frame->linesize) <= 0)
+        {
+            return fail(error, "码率档缩放失败: " + m_name);
+        }
+        m_frame->pts = frame->pts;
+        m_frame->pict_type = frame->pict_type;
+
+        ret = avcodec_send_frame(m_codecContext.get(), m_frame.get());
+        if (ret < 0)
+        {
+            return fail(error, ffmpegError(ret, "发送码率档视频帧失败: " + m_name));
+        }
+        return drain(writer, error);
+    }
+
+    bool RenditionEncoder::flush(const PacketWriter &writer, std::string *error)
+    {
+        const int ret = avcodec_send_frame(m_codecContext.get(), nullptr);
+        if (ret < 0 && ret != AVERROR_EOF)
+        {
+            return fail(error, ffmpegError(ret, "冲洗码率档编码器失败: " + m_name));
+        }
+        return drain(writer, error);
+    }
+
+    bool RenditionEncoder::drain(const PacketWriter &writer, std::string *error)
+    {
+        auto packet = FFmpegUtils::createAvPacket();
+        int ret = 0;
+        while ((ret = avcodec_receive_packet(m_codecContext.get(), packet.get())) == 0)
+        {
+            packet->stream_index = m_stream->index;
+            av_packet_rescale_ts(packet.get(), m_codecContext->time_base, m_stream->time_base);
+            ret = writer(packet.get());
+            if (ret < 0)
+            {
+                return fail(error, ffmpegError(ret, "写入码率档视频包失败: " + m_name));
+            }
+            av_packet_unref(packet.get());
+        }
+        if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF)
+        {
+            return fail(error, ffmpegError(ret, "从码率档编码器接收包失败: " + m_name));
+        }
+        return true;
+    }
+
+} // namespace VideoCreator
@@ -0,0 +1,97 @@
+#ifndef SEGMENTED_OUTPUT_H
+#define SEGMENTED_OUTPUT_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "model/ProjectConfig.h"
+#include "ffmpeg_utils/FFmpegHeaders.h"
+#include "ffmpeg_utils/AvFrameWrapper.h"
+#include "ffmpeg_utils/AvCodecContextWrapper.h"
+
+namespace VideoCreator
+{
+
+    // 把编码后的包交给封装器（RenderEngine::writePacket）
+    using PacketWriter = std::function<int(AVPacket *)>;
+
+    /**
+     * SegmentedOutput - HLS / DASH 分片输出
+     *
+     * 由 FFmpeg 的 hls / dash 封装器直接写出分片与播放列表，省去渲染后再用 ffmpeg 重新封装一遍。
+     * 分片边界完全由关键帧决定：场景（及转场）起点强制关键帧，场景内每 segment_duration 秒一个关键帧，
+     * 并关闭编码器的场景切换检测；封装器的切片目标取极小值，即每个关键帧开始一个新分片。
+     * 因此分片不会跨越场景边界，多码率档之间的切点也完全一致。
+     */
+    class SegmentedOutput
+    {
+    public:
+        static bool isSegmentedFormat(const std::string &format) { return format == "hls" || format == "dash"; }
+
+        // 检查分片时长与码率档配置
+        static bool validate(const ProjectConfig &config, std::string *error);
+
+        // 关键帧间隔（帧），即场景内的最长分片
+        static int keyframeInterval(const ProjectInfoConfig &project);
+
+        // 码率档名称，对应 HLS 的 %v 与 master 播放列表
+        static std::string primaryName(const ProjectInfoConfig &project);
+        static std::string renditionName(const RenditionConfig &rendition);
+
+        // 码率档宽度：未指定时按项目宽高比推导，取偶数
+        static int renditionWidth(const ProjectInfoConfig &project, const RenditionConfig &rendition);
+
+        // 写入 AVFormatContext::url 的路径：HLS 多码率档时为带 %v 的子播放列表，output_path 为 master 播放列表
+        static std::string muxerUrl(const ProjectInfoConfig &project);
+
+        // 封装器选项；hasAudio 为 false 时不生成音频分组
+        static void muxerOptions(const ProjectInfoConfig &project, bool hasAudio, AVDictionary **options);
+
+        // 多个编码器分摊线程预算，threadBudget <= 0 时按硬件线程数
+        static int encoderThreadBudget(int threadBudget, int encoderCount);
+
+        // 播放列表 / 清单中声明的带宽：有峰值码率时取峰值，否则取目标码率
+        static int64_t advertisedBitrate(int64_t bitRate, int64_t maxRate) { return maxRate > 0 ? maxRate : bitRate; }
+    };
+
+    /**
+     * RenditionEncoder - 码率阶梯中的一档
+     *
+     * 与主编码器共用解码、合成与字幕烧录后的帧，只做缩放与编码，各档无需重新解码合成。
+     * 强制关键帧（pict_type）与 pts 随源帧传递，分片与主码率档对齐。
+     */
+    class RenditionEncoder
+    {
+    public:
+        RenditionEncoder() = default;
+        ~RenditionEncoder();
+
+        // 在 outputContext 中创建视频流并打开编码器，须在写文件头之前调用
+        bool open(AVFormatContext *outputContext, const ProjectConfig &config, const RenditionConfig &rendition,
+                  int threadBudget, std::string *error);
+
+        // 缩放并编码一帧
+        bool encode(const AVFrame *frame, const PacketWriter &writer, std::string *error);
+
+        // 冲洗编码器剩余包
+        bool flush(const PacketWriter &writer, std::string *error);
+
+        const std::string &name() const { return m_name; }
+        AVStream *stream() const { return m_stream; }
+
+    private:
+        RenditionEncoder(const RenditionEncoder &) = delete;
+        RenditionEncoder &operator=(const RenditionEncoder &) = delete;
+
+        bool drain(const PacketWriter &writer, std::string *error);
+
+        std::string m_name;
+        FFmpegUtils::AvCodecContextPtr m_codecContext;
+        AVStream *m_stream = nullptr;
+        SwsContext *m_scaler = nullptr;
+        FFmpegUtils::AvFramePtr m_frame;
+    };
+
+} // namespace VideoCreator
+
+#endif // SEGMENTED_OUTPUT_H
@@ -0,0 +1,226 @@
+#include "TaskExecutor.h"
+#include "trace/TraceRecorder.h"
+#include <algorithm>
+#include <chrono>
+
+namespace VideoCreator
+{
+
+    struct TaskState
+    {
+        TaskExecutor::Task task;
+        std::atomic<int> pendingDependencies{1}; // 额外的 1 在提交时登记完依赖后释放
+        std::chrono::steady_clock::time_point queuedAt;
+
+        std::mutex mutex;
+        std::condition_variable cond;
+        bool done = false;
+        std::vector<std::shared_ptr<TaskState>> dependents; // 受 mutex 保护
+    };
+
+    namespace
+    {
+        // 当前线程所属的执行器与工作线程序号，用于把子任务压入本线程队列
+        thread_local const TaskExecutor *t_executor = nullptr;
+        thread_local size_t t_workerIndex = 0;
+    } // namespace
+
+    bool TaskHandle::isDone() const
+    {
+        if (!m_state)
+        {
+            return true;
+        }
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        return m_state->done;
+    }
+
+    void TaskHandle::wait() const
+    {
+        if (!m_state)
+        {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(m_state->mutex);
+        m_state->cond.wait(lock, [this]() { return m_state->done; });
+    }
+
+    TaskExecutor &TaskExecutor::instance()
+    {
+        static TaskExecutor executor([]() {
+            const unsigned int hardware = std::thread::hardware_concurrency();
+            return std::clamp(static_cast<int>(hardware > 0 ? hardware : 4) / 2, 2, 8);
+        }());
+        return executor;
+    }
+
+    TaskExecutor::TaskExecutor(int workerCount)
+    {
+        const size_t count = static_cast<size_t>(std::max(1, workerCount));
+        m_workers.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            m_workers.push_back(std::make_unique<Worker>());
+        }
+        // 所有队列就绪后再启动线程，窃取时可以安全遍历 m_workers
+        for (size_t i = 0; i < count; ++i)
+        {
+            m_workers[i]->thread = std::thread([this, i]() { workerLoop(i); });
+            ++m_threadsCreated;
+        }
+    }
+
+    TaskExecutor::~TaskExecutor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_stopping = true;
+        }
+        m_sleepCond.notify_all();
+        for (auto &worker : m_workers)
+        {
+            if (worker->thread.joinable())
+            {
+                worker->thread.join();
+            }
+        }
+    }
+
+    TaskHandle TaskExecutor::submit(Task task, const std::vector<TaskHandle> &dependencies)
+    {
+        auto state = std::make_shared<TaskState>();
+        state->task = std::move(task);
+        ++m_submitted;
+
+        for (const TaskHandle &dependency : dependencies)
+        {
+            if (!dependency.m_state)
+            {
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(dependency.m_state->mutex);
+            if (!dependency.m_state->done)
+            {
+                ++state->pendingDependencies;
+                dependency.m_state->dependents.push_back(state);
+            }
+        }
+        if (--state->pendingDependencies == 0)
+        {
+            enqueue(state);
+        }
+        return TaskHandle(state);
+    }
+
+    TaskExecutor::Stats TaskExecutor::stats() const
+    {
+        Stats stats;
+        stats.threadsCreated = m_threadsCreated.load();
+        stats.submitted = m_submitted.load();
+        stats.executed = m_executed.load();
+        stats.stolen = m_stolen.load();
+        stats.queueWaitSeconds = static_cast<double>(m_queueWaitNanos.load()) * 1e-9;
+        return stats;
+    }
+
+    void TaskExecutor::enqueue(const std::shared_ptr<TaskState> &state)
+    {
+        // 工作线程内提交（包括依赖完成后放行的任务）留在本线程，数据更可能还在缓存中
+        const size_t index = t_executor == this ? t_workerIndex : m_nextWorker++ % m_workers.size();
+        state->queuedAt = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(m_workers[index]->mutex);
+            m_workers[index]->tasks.push_back(state);
+        }
+        ++m_queued;
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+        }
+        m_sleepCond.notify_one();
+    }
+
+    std::shared_ptr<TaskState> TaskExecutor::takeTask(size_t workerIndex, bool &stolen)
+    {
+        {
+            Worker &own = *m_workers[workerIndex];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty())
+            {
+                auto state = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                --m_queued;
+                stolen = false;
+                return state;
+            }
+        }
+        for (size_t offset = 1; offset < m_workers.size(); ++offset)
+        {
+            Worker &victim = *m_workers[(workerIndex + offset) % m_workers.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty())
+            {
+                auto state = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                --m_queued;
+                stolen = true;
+                return state;
+            }
+        }
+        return nullptr;
+    }
+
+    void TaskExecutor::run(const std::shared_ptr<TaskState> &state)
+    {
+        const auto waited = std::chrono::steady_clock::now() - state->queuedAt;
+        m_queueWaitNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(waited).count();
+
+        if (state->task)
+        {
+            state->task();
+            state->task = nullptr; // 尽早释放捕获的资源
+        }
+        ++m_executed;
+
+        std::vector<std::shared_ptr<TaskState>> dependents;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->done = true;
+            dependents.swap(state->dependents);
+        }
+        state->cond.notify_all();
+        for (auto &dependent : dependents)
+        {
+            if (--dependent->pendingDependencies == 0)
+            {
+                enqueue(dependent);
+            }
+        }
+    }
+
+    void TaskExecutor::workerLoop(size_t workerIndex)
+    {
+        t_executor = this;
+        t_workerIndex = workerIndex;
+        VC_TRACE_THREAD_NAME("task");
+        while (true)
+        {
+            bool stolen = false;
+            if (auto state = takeTask(workerIndex, stolen))
+            {
+                if (stolen)
+                {
+                    ++m_stolen;
+                }
+                run(state);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_sleepCond.wait(lock, [this]() { return m_stopping || m_queued.load() > 0; });
+            if (m_stopping)
+            {
+                return;
+            }
+        }
+    }
+
+} // namespace VideoCreator
@@ -0,0 +1,120 @@
+#ifndef TASK_EXECUTOR_H
+#define TASK_EXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace VideoCreator
+{
+
+    struct TaskState;
+
+    // 已提交任务的句柄，可等待完成或作为其他任务的依赖
+    class TaskHandle
+    {
+    public:
+        TaskHandle() = default;
+
+        bool valid() const { return static_cast<bool>(m_state); }
+        bool isDone() const;
+        void wait() const;
+
+    private:
+        friend class TaskExecutor;
+        explicit TaskHandle(std::shared_ptr<TaskState> state) : m_state(std::move(state)) {}
+
+        std::shared_ptr<TaskState> m_state;
+    };
+
+    /**
+     * TaskExecutor - 进程内共享的工作窃取任务执行器
+     *
+     * 固定数量的工作线程，各自持有一个双端队列：工作线程提交的任务压入自己队列尾部并优先后进先出执行，
+     * 空闲时从其他线程队列头部窃取。渲染中的解码、混音前的音频解码、首帧预取都以短任务运行，
+     * 不再为每个场景、每个音频层创建和销毁线程。
+     * 任务可声明依赖，全部依赖完成后才入队。任务不应无限期阻塞等待其他任务，否则会占住工作线程。
+     */
+    class TaskExecutor
+    {
+    public:
+        using Task = std::function<void()>;
+
+        // 累计统计（自进程启动），调用方取差值
+        struct Stats
+        {
+            int64_t threadsCreated = 0;
+            int64_t submitted = 0;
+            int64_t executed = 0;
+            int64_t stolen = 0;           // 由非所属线程窃取执行的任务数
+            double queueWaitSeconds = 0.0; // 入队到开始执行的总等待时间
+        };
+
+        // 工作线程数：硬件线程数的一半，2 ~ 8
+        static TaskExecutor &instance();
+
+        explicit TaskExecutor(int workerCount);
+        ~TaskExecutor();
+
+        // 提交任务；dependencies 中的任务全部完成后才开始执行
+        TaskHandle submit(Task task, const std::vector<TaskHandle> &dependencies = {});
+
+        // 提交有返回值的任务，以 std::future 取结果；handle 非空时同时返回任务句柄，供后续任务依赖
+        template <typename Function>
+        auto async(Function function, const std::vector<TaskHandle> &dependencies = {}, TaskHandle *handle = nullptr)
+            -> std::future<decltype(function())>
+        {
+            using Result = decltype(function());
+            auto packaged = std::make_shared<std::packaged_task<Result()>>(std::move(function));
+            std::future<Result> future = packaged->get_future();
+            TaskHandle submitted = submit([packaged]() { (*packaged)(); }, dependencies);
+            if (handle)
+            {
+                *handle = submitted;
+            }
+            return future;
+        }
+
+        int workerCount() const { return static_cast<int>(m_workers.size()); }
+        Stats stats() const;
+
+    private:
+        TaskExecutor(const TaskExecutor &) = delete;
+        TaskExecutor &operator=(const TaskExecutor &) = delete;
+
+        struct Worker
+        {
+            std::mutex mutex;
+            std::deque<std::shared_ptr<TaskState>> tasks;
+            std::thread thread;
+        };
+
+        void enqueue(const std::shared_ptr<TaskState> &state);
+        std::shared_ptr<TaskState> takeTask(size_t workerIndex, bool &stolen);
+        void run(const std::shared_ptr<TaskState> &state);
+        void workerLoop(size_t workerIndex);
+
+        std::vector<std::unique_ptr<Worker>> m_workers;
+        std::atomic<size_t> m_nextWorker{0};
+        std::atomic<int64_t> m_queued{0};
+        std::mutex m_sleepMutex;
+        std::condition_variable m_sleepCond;
+        bool m_stopping = false;
+
+        std::atomic<int64_t> m_threadsCreated{0};
+        std::atomic<int64_t> m_submitted{0};
+        std::atomic<int64_t> m_executed{0};
+        std::atomic<int64_t> m_stolen{0};
+        std::atomic<int64_t> m_queueWaitNanos{0};
+    };
+
+} // namespace VideoCreator
+
+#endif // TASK_EXECUTOR_H
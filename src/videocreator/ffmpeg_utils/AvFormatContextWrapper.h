@@ -10,7 +10,8 @@ namespace FFmpegUtils {
 struct AvFormatContextDeleter {
     void operator()(AVFormatContext* context) const {
         if (context) {
-            if (context->pb) {
+            // 自定义 AVIOContext 由设置它的一方释放
+            if (context->pb && !(context->flags & AVFMT_FLAG_CUSTOM_IO)) {
                 avio_closep(&context->pb);
             }
             avformat_free_context(context);
@@ -1,4 +1,5 @@
 ﻿#include "EffectProcessor.h"
+#include "trace/TraceRecorder.h"
 #include <sstream>
 #include <cmath>
 #include <locale>
@@ -33,6 +34,7 @@ namespace VideoCreator
 
     bool EffectProcessor::startKenBurnsSequence(const KenBurnsEffect& effect, const AVFrame* inputImage, int total_frames)
     {
+        VC_TRACE_SCOPE("kenburns_setup", "filter");
         resetSequenceState();
         if (!effect.enabled) {
             m_errorString = "Ken Burns effect is not enabled.";
@@ -124,6 +126,7 @@ namespace VideoCreator
 
     bool EffectProcessor::fetchKenBurnsFrame(FFmpegUtils::AvFramePtr &outFrame)
     {
+        VC_TRACE_SCOPE("zoompan", "filter");
         if (m_sequenceType != SequenceType::KenBurns) {
             m_errorString = "Ken Burns sequence has not been initialized.";
             return false;
@@ -144,6 +147,7 @@ namespace VideoCreator
 
     bool EffectProcessor::startTransitionSequence(TransitionType type, const AVFrame* fromFrame, const AVFrame* toFrame, int duration_frames)
     {
+        VC_TRACE_SCOPE("transition_setup", "filter");
         resetSequenceState();
         if (!fromFrame || !toFrame) {
             m_errorString = "Input frames for transition are null.";
@@ -153,6 +157,17 @@ namespace VideoCreator
             m_errorString = "Transition frame count must be positive.";
             return false;
         }
+        if (fromFrame->format != toFrame->format || fromFrame->width != toFrame->width || fromFrame->height != toFrame->height) {
+            m_errorString = "Transition frames differ in size or pixel format.";
+            return false;
+        }
+        const AVPixelFormat format = static_cast<AVPixelFormat>(fromFrame->format);
+        TransitionKernel kernel = TransitionKernelRegistry::instance().find(type, format);
+        if (!kernel) {
+            m_errorString = "No transition kernel for " + transitionTypeToString(type) + " / " +
+                            (av_get_pix_fmt_name(format) ? av_get_pix_fmt_name(format) : "unknown");
+            return false;
+        }
 
         // 保存输入帧用于手动混合
         m_transitionFromFrame = FFmpegUtils::copyAvFrame(fromFrame);
@@ -162,7 +177,7 @@ namespace VideoCreator
             return false;
         }
 
-        m_transitionType = type;
+        m_transitionKernel = kernel;
         m_sequenceType = SequenceType::Transition;
         m_expectedFrames = duration_frames;
         m_generatedFrames = 0;
@@ -171,6 +186,7 @@ namespace VideoCreator
 
     bool EffectProcessor::fetchTransitionFrame(FFmpegUtils::AvFramePtr &outFrame)
     {
+        VC_TRACE_SCOPE("transition_blend", "filter");
         if (m_sequenceType != SequenceType::Transition) {
             m_errorString = "Transition sequence has not been initialized.";
             return false;
@@ -187,31 +203,15 @@ namespace VideoCreator
         // 计算混合比例 (0.0 = 全部 from, 1.0 = 全部 to)
         double progress = static_cast<double>(m_generatedFrames) / static_cast<double>(m_expectedFrames);
 
-        // 创建输出帧
-        outFrame = FFmpegUtils::createAvFrame(m_width, m_height, AV_PIX_FMT_YUV420P);
+        // 创建输出帧，尺寸与格式跟随输入帧
+        const AVFrame* from = m_transitionFromFrame.get();
+        const AVFrame* to = m_transitionToFrame.get();
+        outFrame = FFmpegUtils::createAvFrame(from->width, from->height, static_cast<AVPixelFormat>(from->format));
         if (!outFrame) {
             m_errorString = "Failed to allocate transition output frame.";
             return false;
         }
-
-        const AVFrame* from = m_transitionFromFrame.get();
-        const AVFrame* to = m_transitionToFrame.get();
-
-        // 根据转场类型进行混合
-        switch (m_transitionType) {
-        case TransitionType::CROSSFADE:
-            blendFramesCrossfade(from, to, outFrame.get(), progress);
-            break;
-        case TransitionType::WIPE:
-            blendFramesWipe(from, to, outFrame.get(), progress);
-            break;
-        case TransitionType::SLIDE:
-            blendFramesSlide(from, to, outFrame.get(), progress);
-            break;
-        default:
-            blendFramesCrossfade(from, to, outFrame.get(), progress);
-            break;
-        }
+        m_transitionKernel(from, to, outFrame.get(), progress);
 
         stampFrameColorInfo(outFrame.get());
         m_generatedFrames++;
@@ -224,105 +224,6 @@ namespace VideoCreator
         return true;
     }
 
-    void EffectProcessor::blendFramesCrossfade(const AVFrame* from, const AVFrame* to, AVFrame* out, double progress)
-    {
-        // Y 平面
-        for (int y = 0; y < m_height; ++y) {
-            for (int x = 0; x < m_width; ++x) {
-                int fromY = from->data[0][y * from->linesize[0] + x];
-                int toY = to->data[0][y * to->linesize[0] + x];
-                out->data[0][y * out->linesize[0] + x] = static_cast<uint8_t>(fromY * (1.0 - progress) + toY * progress);
-            }
-        }
-        // U 和 V 平面 (半分辨率)
-        int uvHeight = m_height / 2;
-        int uvWidth = m_width / 2;
-        for (int y = 0; y < uvHeight; ++y) {
-            for (int x = 0; x < uvWidth; ++x) {
-                int fromU = from->data[1][y * from->linesize[1] + x];
-                int toU = to->data[1][y * to->linesize[1] + x];
-                out->data[1][y * out->linesize[1] + x] = static_cast<uint8_t>(fromU * (1.0 - progress) + toU * progress);
-
-                int fromV = from->data[2][y * from->linesize[2] + x];
-                int toV = to->data[2][y * to->linesize[2] + x];
-                out->data[2][y * out->linesize[2] + x] = static_cast<uint8_t>(fromV * (1.0 - progress) + toV * progress);
-            }
-        }
-    }
-
-    void EffectProcessor::blendFramesWipe(const AVFrame* from, const AVFrame* to, AVFrame* out, double progress)
-    {
-        int wipeX = static_cast<int>(m_width * progress);
-
-        // Y 平面
-        for (int y = 0; y < m_height; ++y) {
-            for (int x = 0; x < m_width; ++x) {
-                if (x < wipeX) {
-                    out->data[0][y * out->linesize[0] + x] = to->data[0][y * to->linesize[0] + x];
-                } else {
-                    out->data[0][y * out->linesize[0] + x] = from->data[0][y * from->linesize[0] + x];
-                }
-            }
-        }
-        // U 和 V 平面
-        int uvHeight = m_height / 2;
-        int uvWidth = m_width / 2;
-        int wipeUvX = wipeX / 2;
-        for (int y = 0; y < uvHeight; ++y) {
-            for (int x = 0; x < uvWidth; ++x) {
-                if (x < wipeUvX) {
-                    out->data[1][y * out->linesize[1] + x] = to->data[1][y * to->linesize[1] + x];
-                    out->data[2][y * out->linesize[2] + x] = to->data[2][y * to->linesize[2] + x];
-                } else {
-                    out->data[1][y * out->linesize[1] + x] = from->data[1][y * from->linesize[1] + x];
-                    out->data[2][y * out->linesize[2] + x] = from->data[2][y * from->linesize[2] + x];
-                }
-            }
-        }
-    }
-
-    void EffectProcessor::blendFramesSlide(const AVFrame* from, const AVFrame* to, AVFrame* out, double progress)
-    {
-        int slideOffset = static_cast<int>(m_width * progress);
-
-        // Y 平面
-        for (int y = 0; y < m_height; ++y) {
-            for (int x = 0; x < m_width; ++x) {
-                int fromX = x + slideOffset;
-                int toX = x - (m_width - slideOffset);
-
-                if (fromX < m_width) {
-                    out->data[0][y * out->linesize[0] + x] = from->data[0][y * from->linesize[0] + fromX];
-                } else if (toX >= 0) {
-                    out->data[0][y * out->linesize[0] + x] = to->data[0][y * to->linesize[0] + toX];
-                } else {
-                    out->data[0][y * out->linesize[0] + x] = 0;
-                }
-            }
-        }
-        // U 和 V 平面
-        int uvHeight = m_height / 2;
-        int uvWidth = m_width / 2;
-        int slideUvOffset = slideOffset / 2;
-        for (int y = 0; y < uvHeight; ++y) {
-            for (int x = 0; x < uvWidth; ++x) {
-                int fromX = x + slideUvOffset;
-                int toX = x - (uvWidth - slideUvOffset);
-
-                if (fromX < uvWidth) {
-                    out->data[1][y * out->linesize[1] + x] = from->data[1][y * from->linesize[1] + fromX];
-                    out->data[2][y * out->linesize[2] + x] = from->data[2][y * from->linesize[2] + fromX];
-                } else if (toX >= 0) {
-                    out->data[1][y * out->linesize[1] + x] = to->data[1][y * to->linesize[1] + toX];
-                    out->data[2][y * out->linesize[2] + x] = to->data[2][y * to->linesize[2] + toX];
-                } else {
-                    out->data[1][y * out->linesize[1] + x] = 128;
-                    out->data[2][y * out->linesize[2] + x] = 128;
-                }
-            }
-        }
-    }
-
     bool EffectProcessor::retrieveFrame(FFmpegUtils::AvFramePtr &outFrame)
     {
         if (!m_buffersinkContext) {
@@ -6,6 +6,7 @@
 #include "ffmpeg_utils/FFmpegHeaders.h"
 #include "ffmpeg_utils/AvFrameWrapper.h"
 #include "model/ProjectConfig.h"
+#include "filter/TransitionKernels.h"
 
 namespace VideoCreator
 {
@@ -51,8 +52,8 @@ namespace VideoCreator
         int m_expectedFrames;
         int m_generatedFrames;
 
-        // 手动转场混合所需的成员变量
-        TransitionType m_transitionType;
+        // 转场 kernel 在开始序列时查找一次，逐帧直接调用
+        TransitionKernel m_transitionKernel = nullptr;
         FFmpegUtils::AvFramePtr m_transitionFromFrame;
         FFmpegUtils::AvFramePtr m_transitionToFrame;
 
@@ -62,11 +63,6 @@ namespace VideoCreator
         void stampFrameColorInfo(AVFrame *frame) const;
         void resetSequenceState();
         void cleanup();
-
-        // 手动转场混合函数
-        void blendFramesCrossfade(const AVFrame* from, const AVFrame* to, AVFrame* out, double progress);
-        void blendFramesWipe(const AVFrame* from, const AVFrame* to, AVFrame* out, double progress);
-        void blendFramesSlide(const AVFrame* from, const AVFrame* to, AVFrame* out, double progress);
     };
 
 } // namespace VideoCreator
@@ -0,0 +1,583 @@
+#include "LayerCompositor.h"
+#include "filter/PixelBlend.h"
+#include "trace/TraceRecorder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+extern "C" {
+#include <libavutil/parseutils.h>
+}
+
+namespace VideoCreator
+{
+
+    namespace
+    {
+        // 同时被引用的输出帧超过缓冲池大小时，新帧临时分配
+        constexpr size_t kOutputPoolSize = 4;
+        // 预变换后的图层最大边长，避免超大缩放比例耗尽内存
+        constexpr int kMaxLayerSize = 16384;
+        constexpr double kPi = 3.14159265358979323846;
+
+        inline int floorEven(int value) { return value & ~1; }
+        inline int ceilEven(int value) { return (value + 1) & ~1; }
+        inline int roundEven(double value) { return std::max(2, 2 * static_cast<int>(std::lround(value / 2.0))); }
+
+        inline uint8_t *row(AVFrame *frame, int plane, int y)
+        {
+            return frame->data[plane] + static_cast<ptrdiff_t>(y) * frame->linesize[plane];
+        }
+
+        inline const uint8_t *row(const AVFrame *frame, int plane, int y)
+        {
+            return frame->data[plane] + static_cast<ptrdiff_t>(y) * frame->linesize[plane];
+        }
+
+        // 0 ~ 255 的不透明度转为混合权重 0 ~ 256
+        inline uint16_t alphaWeight(int alpha) { return static_cast<uint16_t>(alpha + (alpha >> 7)); }
+
+        // 非线性 RGB（0 ~ 1）转 limited range YCbCr，矩阵与 EffectProcessor 一致：720p 及以上 BT.709，否则 BT.601
+        struct YuvMatrix
+        {
+            double kr;
+            double kb;
+
+            explicit YuvMatrix(bool bt709) : kr(bt709 ? 0.2126 : 0.299), kb(bt709 ? 0.0722 : 0.114) {}
+
+            void convert(double r, double g, double b, double &y, double &cb, double &cr) const
+            {
+                const double luma = kr * r + (1.0 - kr - kb) * g + kb * b;
+                y = 16.0 + 219.0 * luma;
+                cb = 128.0 + 224.0 * (b - luma) / (2.0 * (1.0 - kb));
+                cr = 128.0 + 224.0 * (r - luma) / (2.0 * (1.0 - kr));
+            }
+        };
+
+        inline uint8_t clampByte(double value)
+        {
+            return static_cast<uint8_t>(std::clamp(static_cast<int>(std::lround(value)), 0, 255));
+        }
+
+        // 相交矩形（不要求偶数）
+        LayerCompositor::Rect intersect(const LayerCompositor::Rect &a, const LayerCompositor::Rect &b)
+        {
+            LayerCompositor::Rect result;
+            result.x = std::max(a.x, b.x);
+            result.y = std::max(a.y, b.y);
+            result.width = std::min(a.x + a.width, b.x + b.width) - result.x;
+            result.height = std::min(a.y + a.height, b.y + b.height) - result.y;
+            return result;
+        }
+
+        // 双线性取样 RGBA，按不透明度加权颜色，避免透明像素的颜色渗入边缘；取样点在图片外时视为透明
+        void sampleRgba(const AVFrame *rgba, double sx, double sy, double out[4])
+        {
+            const int x0 = static_cast<int>(std::floor(sx));
+            const int y0 = static_cast<int>(std::floor(sy));
+            const double fx = sx - x0;
+            const double fy = sy - y0;
+            double sum[4] = {0.0, 0.0, 0.0, 0.0};
+            for (int j = 0; j < 2; ++j)
+            {
+                const int y = y0 + j;
+                if (y < 0 || y >= rgba->height)
+                {
+                    continue;
+                }
+                const double wy = j == 0 ? 1.0 - fy : fy;
+                const uint8_t *line = row(rgba, 0, y);
+                for (int i = 0; i < 2; ++i)
+                {
+                    const int x = x0 + i;
+                    if (x < 0 || x >= rgba->width)
+                    {
+                        continue;
+                    }
+                    const double w = wy * (i == 0 ? 1.0 - fx : fx) * line[x * 4 + 3];
+                    sum[0] += w * line[x * 4];
+                    sum[1] += w * line[x * 4 + 1];
+                    sum[2] += w * line[x * 4 + 2];
+                    sum[3] += w;
+                }
+            }
+            if (sum[3] > 0.0)
+            {
+                out[0] = sum[0] / sum[3];
+                out[1] = sum[1] / sum[3];
+                out[2] = sum[2] / sum[3];
+            }
+            else
+            {
+                out[0] = out[1] = out[2] = 0.0;
+            }
+            out[3] = sum[3];
+        }
+    } // namespace
+
+    bool LayerCompositor::parseFit(const std::string &name, Fit defaultFit, Fit &fit, std::string *error)
+    {
+        if (name.empty())
+        {
+            fit = defaultFit;
+            return true;
+        }
+        if (name == "stretch")
+        {
+            fit = Fit::STRETCH;
+            return true;
+        }
+        if (name == "contain")
+        {
+            fit = Fit::CONTAIN;
+            return true;
+        }
+        if (name == "cover")
+        {
+            fit = Fit::COVER;
+            return true;
+        }
+        if (name == "none")
+        {
+            fit = Fit::NONE;
+            return true;
+        }
+        if (error)
+        {
+            *error = "未知的图片适配方式: " + name;
+        }
+        return false;
+    }
+
+    LayerCompositor::Rect LayerCompositor::fitRect(int sourceWidth, int sourceHeight, int width, int height, Fit fit)
+    {
+        Rect rect;
+        if (sourceWidth <= 0 || sourceHeight <= 0 || width <= 0 || height <= 0)
+        {
+            return rect;
+        }
+        if (fit == Fit::STRETCH)
+        {
+            rect.width = ceilEven(width);
+            rect.height = ceilEven(height);
+            return rect;
+        }
+        if (fit == Fit::NONE)
+        {
+            rect.width = ceilEven(sourceWidth);
+            rect.height = ceilEven(sourceHeight);
+            return rect;
+        }
+        const double scaleX = static_cast<double>(width) / sourceWidth;
+        const double scaleY = static_cast<double>(height) / sourceHeight;
+        const double scale = fit == Fit::CONTAIN ? std::min(scaleX, scaleY) : std::max(scaleX, scaleY);
+        rect.width = roundEven(sourceWidth * scale);
+        rect.height = roundEven(sourceHeight * scale);
+        if (fit == Fit::CONTAIN)
+        {
+            rect.width = std::min(rect.width, ceilEven(width));
+            rect.height = std::min(rect.height, ceilEven(height));
+        }
+        rect.x = floorEven((width - rect.width) / 2);
+        rect.y = floorEven((height - rect.height) / 2);
+        return rect;
+    }
+
+    bool LayerCompositor::initialize(int width, int height, const std::string &backgroundColor)
+    {
+        if (width <= 0 || height <= 0)
+        {
+            m_errorString = "合成画面尺寸无效";
+            return false;
+        }
+        m_width = width;
+        m_height = height;
+        m_bt709 = height >= 720;
+        m_sprites.clear();
+        m_dynamicIndex = -1;
+        m_dynamicRect = Rect();
+        m_canvas.reset();
+        m_pool.clear();
+        m_stats = Stats();
+
+        uint8_t rgba[4] = {0, 0, 0, 255};
+        if (!backgroundColor.empty() && av_parse_color(rgba, backgroundColor.c_str(), -1, nullptr) < 0)
+        {
+            m_errorString = "无法解析背景颜色: " + backgroundColor;
+            return false;
+        }
+        double y = 0.0, cb = 0.0, cr = 0.0;
+        YuvMatrix(m_bt709).convert(rgba[0] / 255.0, rgba[1] / 255.0, rgba[2] / 255.0, y, cb, cr);
+        m_background[0] = clampByte(y);
+        m_background[1] = clampByte(cb);
+        m_background[2] = clampByte(cr);
+        return true;
+    }
+
+    bool LayerCompositor::addImageLayer(const AVFrame *image, const ImageConfig &config, Fit fit)
+    {
+        VC_TRACE_SCOPE("compositor_prepare_layer", "filter");
+        if (m_canvas)
+        {
+            m_errorString = "静态画布已合成，不能再添加图层";
+            return false;
+        }
+        if (!image || image->width <= 0 || image->height <= 0)
+        {
+            m_errorString = "图层图片为空";
+            return false;
+        }
+        if (!(config.scale > 0.0))
+        {
+            m_errorString = "图片缩放比例须大于 0";
+            return false;
+        }
+
+        // 适配与缩放一次完成，再按需旋转
+        const Rect fitted = fitRect(image->width, image->height, m_width, m_height, fit);
+        const int scaledWidth = roundEven(fitted.width * config.scale);
+        const int scaledHeight = roundEven(fitted.height * config.scale);
+        if (scaledWidth > kMaxLayerSize || scaledHeight > kMaxLayerSize)
+        {
+            m_errorString = "图片缩放后尺寸过大";
+            return false;
+        }
+        const double centerX = fitted.x + fitted.width / 2.0 + config.x;
+        const double centerY = fitted.y + fitted.height / 2.0 + config.y;
+
+        auto rgba = FFmpegUtils::createAvFrame(scaledWidth, scaledHeight, AV_PIX_FMT_RGBA);
+        SwsContext *swsContext = sws_getContext(image->width, image->height, static_cast<AVPixelFormat>(image->format),
+                                                scaledWidth, scaledHeight, AV_PIX_FMT_RGBA,
+                                                SWS_BILINEAR, nullptr, nullptr, nullptr);
+        if (!rgba || !swsContext)
+        {
+            sws_freeContext(swsContext);
+            m_errorString = "无法创建图层缩放上下文";
+            return false;
+        }
+        // 与 ImageDecoder::scaleToSize 相同的源色彩判断
+        int colorspace = image->colorspace;
+        if (colorspace == AVCOL_SPC_UNSPECIFIED)
+        {
+            colorspace = image->height >= 720 ? AVCOL_SPC_BT709 : AVCOL_SPC_SMPTE170M;
+        }
+        const int srcRange = image->color_range == AVCOL_RANGE_MPEG ? 0 : 1;
+        sws_setColorspaceDetails(swsContext, sws_getCoefficients(colorspace), srcRange,
+                                 sws_getCoefficients(SWS_CS_DEFAULT), 1, 0, 1 << 16, 1 << 16);
+        const int scaled = sws_scale(swsContext, image->data, image->linesize, 0, image->height, rgba->data, rgba->linesize);
+        sws_freeContext(swsContext);
+        if (scaled <= 0)
+        {
+            m_errorString = "图层缩放失败";
+            return false;
+        }
+
+        Sprite sprite;
+        const double radians = std::fmod(config.rotation, 360.0) * kPi / 180.0;
+        const bool rotated = std::abs(std::sin(radians)) > 1e-9 || std::cos(radians) < 0.0;
+        if (rotated)
+        {
+            const double cosA = std::cos(radians);
+            const double sinA = std::sin(radians);
+            const double halfWidth = (std::abs(scaledWidth * cosA) + std::abs(scaledHeight * sinA)) / 2.0;
+            const double halfHeight = (std::abs(scaledWidth * sinA) + std::abs(scaledHeight * cosA)) / 2.0;
+            sprite.x = floorEven(static_cast<int>(std::floor(centerX - halfWidth)));
+            sprite.y = floorEven(static_cast<int>(std::floor(centerY - halfHeight)));
+            sprite.width = ceilEven(static_cast<int>(std::ceil(centerX + halfWidth)) - sprite.x);
+            sprite.height = ceilEven(static_cast<int>(std::ceil(centerY + halfHeight)) - sprite.y);
+        }
+        else
+        {
+            sprite.x = floorEven(static_cast<int>(std::lround(centerX - scaledWidth / 2.0)));
+            sprite.y = floorEven(static_cast<int>(std::lround(centerY - scaledHeight / 2.0)));
+            sprite.width = scaledWidth;
+            sprite.height = scaledHeight;
+        }
+
+        // 逐像素求 RGBA（旋转时反向映射到缩放后的图片），同时转为 YUV 与权重
+        const YuvMatrix matrix(m_bt709);
+        const int chromaWidth = sprite.width / 2;
+        const int chromaHeight = sprite.height / 2;
+        const size_t lumaSize = static_cast<size_t>(sprite.width) * sprite.height;
+        const size_t chromaSize = static_cast<size_t>(chromaWidth) * chromaHeight;
+        std::vector<uint8_t> alpha(lumaSize);
+        std::vector<double> cbPlane(lumaSize);
+        std::vector<double> crPlane(lumaSize);
+        sprite.planes[0].resize(lumaSize);
+        const double cosA = std::cos(radians);
+        const double sinA = std::sin(radians);
+        bool opaque = true;
+        for (int y = 0; y < sprite.height; ++y)
+        {
+            for (int x = 0; x < sprite.width; ++x)
+            {
+                double pixel[4];
+                if (rotated)
+                {
+                    // 像素中心相对图层中心的偏移，逆时针转回图片坐标
+                    const double dx = sprite.x + x + 0.5 - centerX;
+                    const double dy = sprite.y + y + 0.5 - centerY;
+                    const double u = dx * cosA + dy * sinA;
+                    const double v = -dx * sinA + dy * cosA;
+                    sampleRgba(rgba.get(), u + scaledWidth / 2.0 - 0.5, v + scaledHeight / 2.0 - 0.5, pixel);
+                }
+                else
+                {
+                    const uint8_t *source = row(rgba.get(), 0, y) + x * 4;
+                    pixel[0] = source[0];
+                    pixel[1] = source[1];
+                    pixel[2] = source[2];
+                    pixel[3] = source[3];
+                }
+                const size_t index = static_cast<size_t>(y) * sprite.width + x;
+                double luma = 0.0, cb = 0.0, cr = 0.0;
+                matrix.convert(pixel[0] / 255.0, pixel[1] / 255.0, pixel[2] / 255.0, luma, cb, cr);
+                sprite.planes[0][index] = clampByte(luma);
+                cbPlane[index] = cb;
+                crPlane[index] = cr;
+                alpha[index] = clampByte(pixel[3]);
+                opaque = opaque && alpha[index] == 255;
+            }
+        }
+
+        // 色度取 2x2 的不透明度加权平均，透明像素不影响颜色
+        sprite.opaque = opaque;
+        sprite.planes[1].resize(chromaSize);
+        sprite.planes[2].resize(chromaSize);
+        if (!opaque)
+        {
+            sprite.weights[0].resize(lumaSize);
+            sprite.weights[1].resize(chromaSize);
+            for (size_t i = 0; i < lumaSize; ++i)
+            {
+                sprite.weights[0][i] = alphaWeight(alpha[i]);
+            }
+        }
+        for (int y = 0; y < chromaHeight; ++y)
+        {
+            for (int x = 0; x < chromaWidth; ++x)
+            {
+                double sumAlpha = 0.0, sumCb = 0.0, sumCr = 0.0;
+                for (int j = 0; j < 2; ++j)
+                {
+                    for (int i = 0; i < 2; ++i)
+                    {
+                        const size_t index = static_cast<size_t>(y * 2 + j) * sprite.width + x * 2 + i;
+                        sumAlpha += alpha[index];
+                        sumCb += alpha[index] * cbPlane[index];
+                        sumCr += alpha[index] * crPlane[index];
+                    }
+                }
+                const size_t index = static_cast<size_t>(y) * chromaWidth + x;
+                sprite.planes[1][index] = sumAlpha > 0.0 ? clampByte(sumCb / sumAlpha) : 128;
+                sprite.planes[2][index] = sumAlpha > 0.0 ? clampByte(sumCr / sumAlpha) : 128;
+                if (!opaque)
+                {
+                    sprite.weights[1][index] = alphaWeight(clampByte(sumAlpha / 4.0));
+                }
+            }
+        }
+
+        m_sprites.push_back(std::move(sprite));
+        return true;
+    }
+
+    bool LayerCompositor::setDynamicLayer(const Rect &rect)
+    {
+        if (m_canvas || m_dynamicIndex >= 0)
+        {
+            m_errorString = "动态层只能设置一次，且须在合成前设置";
+            return false;
+        }
+        if (rect.empty() || (rect.x & 1) || (rect.y & 1) || (rect.width & 1) || (rect.height & 1))
+        {
+            m_errorString = "动态层矩形须为非空且坐标尺寸为偶数";
+            return false;
+        }
+        m_dynamicIndex = static_cast<int>(m_sprites.size());
+        m_dynamicRect = rect;
+        return true;
+    }
+
+    bool LayerCompositor::hasLayersAbove() const
+    {
+        if (m_dynamicIndex < 0)
+        {
+            return false;
+        }
+        for (size_t i = static_cast<size_t>(m_dynamicIndex); i < m_sprites.size(); ++i)
+        {
+            const Sprite &sprite = m_sprites[i];
+            if (!intersect(m_dynamicRect, Rect{sprite.x, sprite.y, sprite.width, sprite.height}).empty())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void LayerCompositor::blendSprite(const Sprite &sprite, const Rect &clip, AVFrame *frame)
+    {
+        const Rect area = intersect(intersect(clip, Rect{sprite.x, sprite.y, sprite.width, sprite.height}),
+                                    Rect{0, 0, frame->width, frame->height});
+        if (area.empty())
+        {
+            return;
+        }
+        for (int plane = 0; plane < 3; ++plane)
+        {
+            const int shift = plane == 0 ? 0 : 1;
+            // 区域起点为偶数（画面与 sprite 原点均为偶数），终点向上取整覆盖奇数宽度画面的最后一列
+            const int x0 = area.x >> shift;
+            const int x1 = AV_CEIL_RSHIFT(area.x + area.width, shift);
+            const int y0 = area.y >> shift;
+            const int y1 = AV_CEIL_RSHIFT(area.y + area.height, shift);
+            const int spriteX = sprite.x >> shift;
+            const int spriteY = sprite.y >> shift;
+            const int stride = sprite.width >> shift;
+            const int count = x1 - x0;
+            for (int y = y0; y < y1; ++y)
+            {
+                const size_t offset = static_cast<size_t>(y - spriteY) * stride + (x0 - spriteX);
+                uint8_t *dst = row(frame, plane, y) + x0;
+                if (sprite.opaque)
+                {
+                    std::memcpy(dst, sprite.planes[plane].data() + offset, static_cast<size_t>(count));
+                }
+                else
+                {
+                    PixelBlend::blendRowWeighted<true>(dst, sprite.planes[plane].data() + offset,
+                                                       sprite.weights[shift].data() + offset, dst, count);
+                }
+            }
+        }
+    }
+
+    FFmpegUtils::AvFramePtr LayerCompositor::composeStatic()
+    {
+        if (!m_canvas)
+        {
+            VC_TRACE_SCOPE("compositor_static", "filter");
+            auto canvas = FFmpegUtils::createAvFrame(m_width, m_height, AV_PIX_FMT_YUV420P);
+            if (!canvas)
+            {
+                m_errorString = "无法分配合成画布";
+                return nullptr;
+            }
+            canvas->color_range = AVCOL_RANGE_MPEG;
+            canvas->colorspace = m_bt709 ? AVCOL_SPC_BT709 : AVCOL_SPC_SMPTE170M;
+            canvas->color_primaries = m_bt709 ? AVCOL_PRI_BT709 : AVCOL_PRI_SMPTE170M;
+            for (int plane = 0; plane < 3; ++plane)
+            {
+                const int planeWidth = plane == 0 ? m_width : AV_CEIL_RSHIFT(m_width, 1);
+                const int planeHeight = plane == 0 ? m_height : AV_CEIL_RSHIFT(m_height, 1);
+                for (int y = 0; y < planeHeight; ++y)
+                {
+                    std::memset(row(canvas.get(), plane, y), m_background[plane], static_cast<size_t>(planeWidth));
+                }
+            }
+            const Rect full{0, 0, m_width, m_height};
+            for (const Sprite &sprite : m_sprites)
+            {
+                blendSprite(sprite, full, canvas.get());
+            }
+            m_canvas = std::move(canvas);
+        }
+        return FFmpegUtils::copyAvFrame(m_canvas.get());
+    }
+
+    FFmpegUtils::AvFramePtr LayerCompositor::acquireOutput(bool &restored)
+    {
+        // 编码器与队列释放引用后缓冲重新可写，其中矩形外仍是画布内容
+        for (PooledFrame &pooled : m_pool)
+        {
+            if (av_frame_is_writable(pooled.frame.get()))
+            {
+                restored = pooled.filled;
+                pooled.filled = true;
+                return FFmpegUtils::copyAvFrame(pooled.frame.get());
+            }
+        }
+        restored = false;
+        auto frame = FFmpegUtils::createAvFrame(m_width, m_height, AV_PIX_FMT_YUV420P);
+        if (!frame || m_pool.size() >= kOutputPoolSize)
+        {
+            // 池中缓冲都被占用时用一次性的帧
+            return frame;
+        }
+        m_pool.push_back(PooledFrame{std::move(frame), true});
+        return FFmpegUtils::copyAvFrame(m_pool.back().frame.get());
+    }
+
+    FFmpegUtils::AvFramePtr LayerCompositor::compose(const AVFrame *dynamic)
+    {
+        if (m_dynamicIndex < 0 || !dynamic)
+        {
+            m_errorString = "没有动态层或输入帧为空";
+            return nullptr;
+        }
+        if (dynamic->width != m_dynamicRect.width || dynamic->height != m_dynamicRect.height ||
+            dynamic->format != AV_PIX_FMT_YUV420P)
+        {
+            m_errorString = "动态层输入帧尺寸或格式与图层不符";
+            return nullptr;
+        }
+        const Rect full{0, 0, m_width, m_height};
+        const Rect area = intersect(m_dynamicRect, full);
+        m_stats.frames++;
+        m_stats.totalPixels += static_cast<int64_t>(m_width) * m_height;
+        m_stats.dirtyPixels += area.empty() ? 0 : static_cast<int64_t>(area.width) * area.height;
+
+        const bool coversFrame = m_dynamicRect.x == 0 && m_dynamicRect.y == 0 &&
+                                 m_dynamicRect.width == m_width && m_dynamicRect.height == m_height;
+        if (coversFrame && !hasLayersAbove())
+        {
+            return FFmpegUtils::copyAvFrame(dynamic);
+        }
+        if (!composeStatic())
+        {
+            return nullptr;
+        }
+
+        VC_TRACE_SCOPE("compositor_frame", "filter");
+        bool restored = false;
+        FFmpegUtils::AvFramePtr output = acquireOutput(restored);
+        if (!output)
+        {
+            m_errorString = "无法分配合成输出帧";
+            return nullptr;
+        }
+        if (!restored)
+        {
+            av_frame_copy(output.get(), m_canvas.get());
+            m_stats.dirtyPixels += static_cast<int64_t>(m_width) * m_height - (area.empty() ? 0 : static_cast<int64_t>(area.width) * area.height);
+        }
+
+        if (!area.empty())
+        {
+            for (int plane = 0; plane < 3; ++plane)
+            {
+                const int shift = plane == 0 ? 0 : 1;
+                const int x0 = area.x >> shift;
+                const int x1 = AV_CEIL_RSHIFT(area.x + area.width, shift);
+                const int y0 = area.y >> shift;
+                const int y1 = AV_CEIL_RSHIFT(area.y + area.height, shift);
+                const int sourceX = x0 - (m_dynamicRect.x >> shift);
+                const int sourceY = y0 - (m_dynamicRect.y >> shift);
+                for (int y = y0; y < y1; ++y)
+                {
+                    std::memcpy(row(output.get(), plane, y) + x0, row(dynamic, plane, sourceY + y - y0) + sourceX, static_cast<size_t>(x1 - x0));
+                }
+            }
+            for (size_t i = static_cast<size_t>(m_dynamicIndex); i < m_sprites.size(); ++i)
+            {
+                blendSprite(m_sprites[i], area, output.get());
+            }
+        }
+
+        av_frame_copy_props(output.get(), m_canvas.get());
+        output->pts = dynamic->pts;
+        return output;
+    }
+
+} // namespace VideoCreator
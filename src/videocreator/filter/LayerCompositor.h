@@ -0,0 +1,130 @@
+#ifndef LAYER_COMPOSITOR_H
+#define LAYER_COMPOSITOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ffmpeg_utils/FFmpegHeaders.h"
+#include "ffmpeg_utils/AvFrameWrapper.h"
+#include "model/ProjectConfig.h"
+
+namespace VideoCreator
+{
+
+    /**
+     * LayerCompositor - 场景图层合成（输出 YUV420P）
+     *
+     * 图层自下而上为：背景色、按 ImageConfig 摆放的图片（适配方式、缩放、旋转、平移）、至多一个动态层
+     * （视频帧或 Ken Burns 帧）、动态层之上的叠加图片。静态图层在 addImageLayer 时一次性完成缩放、旋转
+     * 与颜色转换，预先合成为静态画布；每帧只把动态层写入它的矩形，并在矩形内重新混合上方图层，
+     * 矩形外直接沿用画布。输出帧取自内部缓冲池，缓冲被重新使用时矩形外的像素已是画布内容，无需再复制。
+     * 同一实例不能在多个线程中同时调用。
+     */
+    class LayerCompositor
+    {
+    public:
+        // 图片适配到画面的方式
+        enum class Fit
+        {
+            STRETCH, // 拉伸铺满（旧行为）
+            CONTAIN, // 保持宽高比完整显示，居中，空白处为背景色
+            COVER,   // 保持宽高比铺满，居中裁切
+            NONE     // 原始尺寸，从左上角开始
+        };
+
+        // 像素矩形，坐标与尺寸均为偶数（与 4:2:0 色度对齐），可以超出画面
+        struct Rect
+        {
+            int x = 0;
+            int y = 0;
+            int width = 0;
+            int height = 0;
+
+            bool empty() const { return width <= 0 || height <= 0; }
+        };
+
+        // 累计统计：dirtyPixels 为逐帧重新写入的像素数，totalPixels 为输出帧总像素数
+        struct Stats
+        {
+            int64_t frames = 0;
+            int64_t dirtyPixels = 0;
+            int64_t totalPixels = 0;
+        };
+
+        // 解析 fit：空时取 defaultFit，其余为 "stretch" / "contain" / "cover" / "none"
+        static bool parseFit(const std::string &name, Fit defaultFit, Fit &fit, std::string *error = nullptr);
+
+        // 源尺寸按 fit 适配到 width x height 画面后的矩形
+        static Rect fitRect(int sourceWidth, int sourceHeight, int width, int height, Fit fit);
+
+        // backgroundColor 为 FFmpeg 颜色语法（"#RRGGBB"、"black" 等），空时为黑色
+        bool initialize(int width, int height, const std::string &backgroundColor);
+
+        // 在当前最上层添加图片图层：按 fit 适配后以图层中心缩放 config.scale、顺时针旋转 config.rotation 度，
+        // 再平移 (config.x, config.y)；config.path 不使用
+        bool addImageLayer(const AVFrame *image, const ImageConfig &config, Fit fit);
+
+        // 在当前最上层放置动态层，之后添加的图片位于其上方；compose 的输入须为 rect 大小
+        bool setDynamicLayer(const Rect &rect);
+
+        bool hasDynamicLayer() const { return m_dynamicIndex >= 0; }
+        // 动态层上方是否有与其矩形相交的图层
+        bool hasLayersAbove() const;
+        const Rect &dynamicRect() const { return m_dynamicRect; }
+
+        // 全部静态图层合成的画面（只在首次调用时合成），动态层位置为其下方图层的内容
+        FFmpegUtils::AvFramePtr composeStatic();
+
+        // 合成一帧：dynamic 写入动态层矩形（超出画面部分裁掉），再混合上方图层；
+        // 动态层铺满画面且上方无图层时直接引用输入帧
+        FFmpegUtils::AvFramePtr compose(const AVFrame *dynamic);
+
+        int width() const { return m_width; }
+        int height() const { return m_height; }
+        const Stats &stats() const { return m_stats; }
+        std::string getErrorString() const { return m_errorString; }
+
+    private:
+        // 预变换后的图层，位于画面坐标 (x, y)，权重为 0 ~ 256 的不透明度
+        struct Sprite
+        {
+            int x = 0;
+            int y = 0;
+            int width = 0;
+            int height = 0;
+            bool opaque = false; // 完全不透明时直接复制，不保存权重
+            std::vector<uint8_t> planes[3];
+            std::vector<uint16_t> weights[2]; // [0] 亮度，[1] 色度（2x2 平均）
+        };
+
+        // 把 sprite 与 clip 相交的部分混合到 frame
+        static void blendSprite(const Sprite &sprite, const Rect &clip, AVFrame *frame);
+
+        // 取一个可写的输出帧（缓冲池中缓冲的引用，或池满时新分配的帧）；restored 为 false 时须先复制整幅画布
+        FFmpegUtils::AvFramePtr acquireOutput(bool &restored);
+
+        int m_width = 0;
+        int m_height = 0;
+        bool m_bt709 = true;
+        uint8_t m_background[3] = {16, 128, 128};
+
+        std::vector<Sprite> m_sprites;
+        int m_dynamicIndex = -1; // 动态层位于 m_sprites[m_dynamicIndex] 之前，-1 表示没有
+        Rect m_dynamicRect;
+
+        FFmpegUtils::AvFramePtr m_canvas;
+        // 输出缓冲池：filled 表示矩形外已是画布内容
+        struct PooledFrame
+        {
+            FFmpegUtils::AvFramePtr frame;
+            bool filled = false;
+        };
+        std::vector<PooledFrame> m_pool;
+
+        Stats m_stats;
+        std::string m_errorString;
+    };
+
+} // namespace VideoCreator
+
+#endif // LAYER_COMPOSITOR_H
@@ -0,0 +1,93 @@
+#ifndef PIXEL_BLEND_H
+#define PIXEL_BLEND_H
+
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VC_PIXEL_BLEND_SSE2 1
+#include <emmintrin.h>
+#else
+#define VC_PIXEL_BLEND_SSE2 0
+#endif
+
+namespace VideoCreator
+{
+
+    // 8 位平面的逐行混合，供转场 kernel 与图层合成共用；Simd 为 false 时为标量实现（基准对照用）
+    namespace PixelBlend
+    {
+        // 当前编译目标带有 SSE2 实现
+        constexpr bool kSimdAvailable = VC_PIXEL_BLEND_SSE2 != 0;
+
+        // 常量权重混合一行：dst = (a * (256 - w) + b * w + 128) >> 8
+        template <bool Simd>
+        void blendRow(const uint8_t *a, const uint8_t *b, uint8_t *dst, int count, int weight)
+        {
+            int x = 0;
+#if VC_PIXEL_BLEND_SSE2
+            if constexpr (Simd)
+            {
+                // 16 位无符号乘加不会溢出：255 * 256 + 128 < 65536
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i weightB = _mm_set1_epi16(static_cast<short>(weight));
+                const __m128i weightA = _mm_set1_epi16(static_cast<short>(256 - weight));
+                const __m128i rounding = _mm_set1_epi16(128);
+                for (; x + 16 <= count; x += 16)
+                {
+                    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + x));
+                    const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + x));
+                    __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(va, zero), weightA),
+                                               _mm_mullo_epi16(_mm_unpacklo_epi8(vb, zero), weightB));
+                    __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(va, zero), weightA),
+                                               _mm_mullo_epi16(_mm_unpackhi_epi8(vb, zero), weightB));
+                    lo = _mm_srli_epi16(_mm_add_epi16(lo, rounding), 8);
+                    hi = _mm_srli_epi16(_mm_add_epi16(hi, rounding), 8);
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), _mm_packus_epi16(lo, hi));
+                }
+            }
+#endif
+            const int inverse = 256 - weight;
+            for (; x < count; ++x)
+            {
+                dst[x] = static_cast<uint8_t>((a[x] * inverse + b[x] * weight + 128) >> 8);
+            }
+        }
+
+        // 逐像素权重混合一行，weights 取值 0 ~ 256；a 与 dst 可以是同一行（原地叠加）
+        template <bool Simd>
+        void blendRowWeighted(const uint8_t *a, const uint8_t *b, const uint16_t *weights, uint8_t *dst, int count)
+        {
+            int x = 0;
+#if VC_PIXEL_BLEND_SSE2
+            if constexpr (Simd)
+            {
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i full = _mm_set1_epi16(256);
+                const __m128i rounding = _mm_set1_epi16(128);
+                for (; x + 16 <= count; x += 16)
+                {
+                    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + x));
+                    const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + x));
+                    const __m128i wLo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + x));
+                    const __m128i wHi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + x + 8));
+                    __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(va, zero), _mm_sub_epi16(full, wLo)),
+                                               _mm_mullo_epi16(_mm_unpacklo_epi8(vb, zero), wLo));
+                    __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(va, zero), _mm_sub_epi16(full, wHi)),
+                                               _mm_mullo_epi16(_mm_unpackhi_epi8(vb, zero), wHi));
+                    lo = _mm_srli_epi16(_mm_add_epi16(lo, rounding), 8);
+                    hi = _mm_srli_epi16(_mm_add_epi16(hi, rounding), 8);
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), _mm_packus_epi16(lo, hi));
+                }
+            }
+#endif
+            for (; x < count; ++x)
+            {
+                dst[x] = static_cast<uint8_t>((a[x] * (256 - weights[x]) + b[x] * weights[x] + 128) >> 8);
+            }
+        }
+
+    } // namespace PixelBlend
+
+} // namespace VideoCreator
+
+#endif // PIXEL_BLEND_H
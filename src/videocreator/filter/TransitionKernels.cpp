@@ -0,0 +1,321 @@
+#include "TransitionKernels.h"
+#include "filter/PixelBlend.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace VideoCreator
+{
+
+    namespace
+    {
+        // 平面 YUV 布局：亮度平面全分辨率，两个色度平面按 ChromaShiftX / ChromaShiftY 降采样
+        template <AVPixelFormat Format, int ChromaShiftX, int ChromaShiftY>
+        struct PlanarYuvLayout
+        {
+            static constexpr AVPixelFormat kFormat = Format;
+            static constexpr int kPlanes = 3;
+
+            static constexpr int shiftX(int plane) { return plane == 0 ? 0 : ChromaShiftX; }
+            static constexpr int shiftY(int plane) { return plane == 0 ? 0 : ChromaShiftY; }
+            static int width(int plane, int lumaWidth) { return AV_CEIL_RSHIFT(lumaWidth, shiftX(plane)); }
+            static int height(int plane, int lumaHeight) { return AV_CEIL_RSHIFT(lumaHeight, shiftY(plane)); }
+        };
+
+        using Yuv420pLayout = PlanarYuvLayout<AV_PIX_FMT_YUV420P, 1, 1>;
+        using Yuv444pLayout = PlanarYuvLayout<AV_PIX_FMT_YUV444P, 0, 0>;
+
+        inline const uint8_t *row(const AVFrame *frame, int plane, int y)
+        {
+            return frame->data[plane] + static_cast<ptrdiff_t>(y) * frame->linesize[plane];
+        }
+
+        inline uint8_t *row(AVFrame *frame, int plane, int y)
+        {
+            return frame->data[plane] + static_cast<ptrdiff_t>(y) * frame->linesize[plane];
+        }
+
+        // 8 位定点权重（0 ~ 256）
+        inline int fixedWeight(double progress)
+        {
+            return std::clamp(static_cast<int>(std::lround(progress * 256.0)), 0, 256);
+        }
+
+        // 按行拼接：[0, split) 取 left 从 leftStart 开始的像素，[split, count) 取 right 从 rightStart 开始的像素
+        inline void spliceRow(const uint8_t *left, int leftStart, const uint8_t *right, int rightStart, uint8_t *dst, int split, int count)
+        {
+            std::memcpy(dst, left + leftStart, static_cast<size_t>(split));
+            std::memcpy(dst + split, right + rightStart, static_cast<size_t>(count - split));
+        }
+
+        template <typename Layout, bool Simd>
+        struct CrossfadeKernel
+        {
+            static void apply(const AVFrame *from, const AVFrame *to, AVFrame *out, double progress)
+            {
+                const int weight = fixedWeight(progress);
+                for (int plane = 0; plane < Layout::kPlanes; ++plane)
+                {
+                    const int width = Layout::width(plane, out->width);
+                    const int height = Layout::height(plane, out->height);
+                    for (int y = 0; y < height; ++y)
+                    {
+                        PixelBlend::blendRow<Simd>(row(from, plane, y), row(to, plane, y), row(out, plane, y), width, weight);
+                    }
+                }
+            }
+        };
+
+        // 从左向右擦除：分界左侧为 to
+        template <typename Layout, bool Simd>
+        struct WipeKernel
+        {
+            static void apply(const AVFrame *from, const AVFrame *to, AVFrame *out, double progress)
+            {
+                const int edge = static_cast<int>(out->width * progress);
+                for (int plane = 0; plane < Layout::kPlanes; ++plane)
+                {
+                    const int width = Layout::width(plane, out->width);
+                    const int height = Layout::height(plane, out->height);
+                    const int split = std::clamp(AV_CEIL_RSHIFT(edge, Layout::shiftX(plane)), 0, width);
+                    for (int y = 0; y < height; ++y)
+                    {
+                        spliceRow(row(to, plane, y), 0, row(from, plane, y), split, row(out, plane, y), split, width);
+                    }
+                }
+            }
+        };
+
+        enum class PushDirection
+        {
+            Left,  // to 从右侧推入
+            Right, // to 从左侧推入
+            Up,    // to 从下方推入
+            Down   // to 从上方推入
+        };
+
+        // 推入：from 与 to 一起移动，to 推走 from；整行或整段内存拷贝
+        template <typename Layout, bool Simd, PushDirection Direction>
+        struct PushKernel
+        {
+            static void apply(const AVFrame *from, const AVFrame *to, AVFrame *out, double progress)
+            {
+                constexpr bool horizontal = Direction == PushDirection::Left || Direction == PushDirection::Right;
+                const int offset = static_cast<int>((horizontal ? out->width : out->height) * progress);
+                for (int plane = 0; plane < Layout::kPlanes; ++plane)
+                {
+                    const int width = Layout::width(plane, out->width);
+                    const int height = Layout::height(plane, out->height);
+                    if constexpr (horizontal)
+                    {
+                        const int shift = std::clamp(AV_CEIL_RSHIFT(offset, Layout::shiftX(plane)), 0, width);
+                        for (int y = 0; y < height; ++y)
+                        {
+                            if constexpr (Direction == PushDirection::Left)
+                            {
+                                spliceRow(row(from, plane, y), shift, row(to, plane, y), 0, row(out, plane, y), width - shift, width);
+                            }
+                            else
+                            {
+                                spliceRow(row(to, plane, y), width - shift, row(from, plane, y), 0, row(out, plane, y), shift, width);
+                            }
+                        }
+                    }
+                    else
+                    {
+                        const int shift = std::clamp(AV_CEIL_RSHIFT(offset, Layout::shiftY(plane)), 0, height);
+                        for (int y = 0; y < height; ++y)
+                        {
+                            const uint8_t *source = nullptr;
+                            if constexpr (Direction == PushDirection::Up)
+                            {
+                                source = y < height - shift ? row(from, plane, y + shift) : row(to, plane, y - (height - shift));
+                            }
+                            else
+                            {
+                                source = y < shift ? row(to, plane, height - shift + y) : row(from, plane, y - shift);
+                            }
+                            std::memcpy(row(out, plane, y), source, static_cast<size_t>(width));
+                        }
+                    }
+                }
+            }
+        };
+
+        template <typename Layout, bool Simd>
+        using PushLeftKernel = PushKernel<Layout, Simd, PushDirection::Left>;
+        template <typename Layout, bool Simd>
+        using PushRightKernel = PushKernel<Layout, Simd, PushDirection::Right>;
+        template <typename Layout, bool Simd>
+        using PushUpKernel = PushKernel<Layout, Simd, PushDirection::Up>;
+        template <typename Layout, bool Simd>
+        using PushDownKernel = PushKernel<Layout, Simd, PushDirection::Down>;
+
+        // 光圈：以画面中心为圆心的圆逐渐扩大到覆盖四角，圆内为 to；每行只算一次圆的水平跨度
+        template <typename Layout, bool Simd>
+        struct IrisKernel
+        {
+            static void apply(const AVFrame *from, const AVFrame *to, AVFrame *out, double progress)
+            {
+                const double centerX = out->width * 0.5;
+                const double centerY = out->height * 0.5;
+                const double radius = progress * std::sqrt(centerX * centerX + centerY * centerY);
+                for (int plane = 0; plane < Layout::kPlanes; ++plane)
+                {
+                    const int width = Layout::width(plane, out->width);
+                    const int height = Layout::height(plane, out->height);
+                    const double scaleX = static_cast<double>(1 << Layout::shiftX(plane));
+                    const double scaleY = static_cast<double>(1 << Layout::shiftY(plane));
+                    for (int y = 0; y < height; ++y)
+                    {
+                        // 在亮度坐标系中计算，色度平面按采样位置换算
+                        const double dy = (y + 0.5) * scaleY - centerY;
+                        int begin = 0;
+                        int end = 0;
+                        if (std::abs(dy) < radius)
+                        {
+                            const double half = std::sqrt(radius * radius - dy * dy);
+                            begin = std::clamp(static_cast<int>(std::lround((centerX - half) / scaleX)), 0, width);
+                            end = std::clamp(static_cast<int>(std::lround((centerX + half) / scaleX)), begin, width);
+                        }
+                        const uint8_t *fromRow = row(from, plane, y);
+                        uint8_t *outRow = row(out, plane, y);
+                        std::memcpy(outRow, fromRow, static_cast<size_t>(begin));
+                        std::memcpy(outRow + begin, row(to, plane, y) + begin, static_cast<size_t>(end - begin));
+                        std::memcpy(outRow + end, fromRow + end, static_cast<size_t>(width - end));
+                    }
+                }
+            }
+        };
+
+        // 缩放溶解：from 以画面中心放大（最多 kZoom）的同时淡出到 to；最近邻取样，坐标表每个平面只算一次
+        template <typename Layout, bool Simd>
+        struct ZoomDissolveKernel
+        {
+            static constexpr double kZoom = 0.25;
+
+            static void apply(const AVFrame *from, const AVFrame *to, AVFrame *out, double progress)
+            {
+                const int weight = fixedWeight(progress);
+                const double scale = 1.0 / (1.0 + kZoom * progress);
+                std::vector<int> sourceX;
+                std::vector<uint8_t> zoomed;
+                for (int plane = 0; plane < Layout::kPlanes; ++plane)
+                {
+                    const int width = Layout::width(plane, out->width);
+                    const int height = Layout::height(plane, out->height);
+                    sourceX.resize(static_cast<size_t>(width));
+                    zoomed.resize(static_cast<size_t>(width));
+                    for (int x = 0; x < width; ++x)
+                    {
+                        const double position = (x + 0.5 - width * 0.5) * scale + width * 0.5;
+                        sourceX[x] = std::clamp(static_cast<int>(position), 0, width - 1);
+                    }
+                    for (int y = 0; y < height; ++y)
+                    {
+                        const double position = (y + 0.5 - height * 0.5) * scale + height * 0.5;
+                        const uint8_t *fromRow = row(from, plane, std::clamp(static_cast<int>(position), 0, height - 1));
+                        for (int x = 0; x < width; ++x)
+                        {
+                            zoomed[x] = fromRow[sourceX[x]];
+                        }
+                        PixelBlend::blendRow<Simd>(zoomed.data(), row(to, plane, y), row(out, plane, y), width, weight);
+                    }
+                }
+            }
+        };
+
+        // 亮度遮罩擦除：以 from 的亮度为遮罩，暗处先过渡到 to，过渡边缘宽 kSoftness 个亮度级
+        template <typename Layout, bool Simd>
+        struct LumaWipeKernel
+        {
+            static constexpr int kSoftness = 32;
+
+            static void apply(const AVFrame *from, const AVFrame *to, AVFrame *out, double progress)
+            {
+                // 每帧只算一次 256 项权重表，行内只查表不分支
+                uint16_t table[256];
+                const double threshold = progress * (255 + kSoftness);
+                for (int level = 0; level < 256; ++level)
+                {
+                    const double t = std::clamp((threshold - level) / kSoftness, 0.0, 1.0);
+                    table[level] = static_cast<uint16_t>(std::lround(t * 256.0));
+                }
+                std::vector<uint16_t> weights(static_cast<size_t>(out->width));
+                for (int plane = 0; plane < Layout::kPlanes; ++plane)
+                {
+                    const int width = Layout::width(plane, out->width);
+                    const int height = Layout::height(plane, out->height);
+                    const int shiftX = Layout::shiftX(plane);
+                    const int shiftY = Layout::shiftY(plane);
+                    for (int y = 0; y < height; ++y)
+                    {
+                        // 色度平面取对应位置左上角的亮度作为遮罩
+                        const uint8_t *matte = row(from, 0, y << shiftY);
+                        for (int x = 0; x < width; ++x)
+                        {
+                            weights[x] = table[matte[x << shiftX]];
+                        }
+                        PixelBlend::blendRowWeighted<Simd>(row(from, plane, y), row(to, plane, y), weights.data(), row(out, plane, y), width);
+                    }
+                }
+            }
+        };
+
+        template <template <typename, bool> class Kernel, typename Layout>
+        void addKernel(TransitionKernelRegistry &registry, TransitionType type)
+        {
+            registry.add(type, Layout::kFormat, &Kernel<Layout, true>::apply, &Kernel<Layout, false>::apply);
+        }
+
+        template <typename Layout>
+        void addLayoutKernels(TransitionKernelRegistry &registry)
+        {
+            addKernel<CrossfadeKernel, Layout>(registry, TransitionType::CROSSFADE);
+            addKernel<WipeKernel, Layout>(registry, TransitionType::WIPE);
+            addKernel<PushLeftKernel, Layout>(registry, TransitionType::SLIDE);
+            addKernel<PushRightKernel, Layout>(registry, TransitionType::PUSH_RIGHT);
+            addKernel<PushUpKernel, Layout>(registry, TransitionType::PUSH_UP);
+            addKernel<PushDownKernel, Layout>(registry, TransitionType::PUSH_DOWN);
+            addKernel<IrisKernel, Layout>(registry, TransitionType::IRIS);
+            addKernel<ZoomDissolveKernel, Layout>(registry, TransitionType::ZOOM_DISSOLVE);
+            addKernel<LumaWipeKernel, Layout>(registry, TransitionType::LUMA_WIPE);
+        }
+    } // namespace
+
+    TransitionKernelRegistry &TransitionKernelRegistry::instance()
+    {
+        static TransitionKernelRegistry registry = []() {
+            TransitionKernelRegistry builtin;
+            addLayoutKernels<Yuv420pLayout>(builtin);
+            addLayoutKernels<Yuv444pLayout>(builtin);
+            return builtin;
+        }();
+        return registry;
+    }
+
+    void TransitionKernelRegistry::add(TransitionType type, AVPixelFormat format, TransitionKernel kernel, TransitionKernel scalarKernel)
+    {
+        Entry &entry = m_kernels[{static_cast<int>(type), static_cast<int>(format)}];
+        entry.simd = kernel;
+        entry.scalar = scalarKernel ? scalarKernel : kernel;
+    }
+
+    TransitionKernel TransitionKernelRegistry::find(TransitionType type, AVPixelFormat format, bool simd) const
+    {
+        auto it = m_kernels.find({static_cast<int>(type), static_cast<int>(format)});
+        if (it == m_kernels.end())
+        {
+            return nullptr;
+        }
+        return simd ? it->second.simd : it->second.scalar;
+    }
+
+    bool TransitionKernelRegistry::simdAvailable()
+    {
+        return PixelBlend::kSimdAvailable;
+    }
+
+} // namespace VideoCreator
@@ -0,0 +1,49 @@
+#ifndef TRANSITION_KERNELS_H
+#define TRANSITION_KERNELS_H
+
+#include <map>
+#include <utility>
+#include "ffmpeg_utils/FFmpegHeaders.h"
+#include "model/ProjectConfig.h"
+
+namespace VideoCreator
+{
+
+    // 转场 kernel：按进度 progress（0 = 全部 from，1 = 全部 to）把两帧合成到 out，三帧尺寸与像素格式相同
+    using TransitionKernel = void (*)(const AVFrame *from, const AVFrame *to, AVFrame *out, double progress);
+
+    /**
+     * TransitionKernelRegistry - 按转场类型与像素格式查找转场 kernel
+     *
+     * 每个 kernel 是按平面布局（像素格式）与是否启用 SIMD 在编译期特化的函数，逐行处理，行内不按转场类型分支；
+     * 新增转场只需实现 kernel 并注册，不改动 EffectProcessor。
+     * instance() 首次调用时注册全部内置 kernel；自定义注册应在渲染开始前完成，查找可在多个线程中并发进行。
+     */
+    class TransitionKernelRegistry
+    {
+    public:
+        static TransitionKernelRegistry &instance();
+
+        // 注册或替换 kernel；scalarKernel 为不使用 SIMD 的版本，供基准对照，为空时与 kernel 相同
+        void add(TransitionType type, AVPixelFormat format, TransitionKernel kernel, TransitionKernel scalarKernel = nullptr);
+
+        // 未注册时返回空
+        TransitionKernel find(TransitionType type, AVPixelFormat format, bool simd = true) const;
+
+        // 当前编译目标是否带有 SIMD 实现（SSE2）
+        static bool simdAvailable();
+
+    private:
+        TransitionKernelRegistry() = default;
+
+        struct Entry
+        {
+            TransitionKernel simd = nullptr;
+            TransitionKernel scalar = nullptr;
+        };
+        std::map<std::pair<int, int>, Entry> m_kernels;
+    };
+
+} // namespace VideoCreator
+
+#endif // TRANSITION_KERNELS_H
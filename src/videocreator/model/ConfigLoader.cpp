@@ -1,13 +1,9 @@
 #include "ConfigLoader.h"
+#include "MediaInfoCache.h"
+#include "ConfigStreamParser.h"
 #include <QDebug>
 #include <QProcess>
 
-extern "C"
-{
-#include <libavformat/avformat.h>
-#include <libavcodec/avcodec.h>
-}
-
 namespace VideoCreator
 {
 
@@ -20,17 +16,25 @@ namespace VideoCreator
             return false;
         }
 
-        QByteArray jsonData = file.readAll();
-        file.close();
+        // 文件按块流式解析，不构建 QJsonDocument，场景很多时内存和耗时都更低
+        ConfigStreamParser parser;
+        std::vector<size_t> derivedScenes;
+        bool hasScenes = false;
+        if (!parser.parse(&file, config, derivedScenes, hasScenes))
+        {
+            m_errorString = parser.errorString();
+            return false;
+        }
 
-        return loadFromString(QString::fromUtf8(jsonData), config);
+        if (hasScenes)
+        {
+            resolveSceneDurations(config, derivedScenes);
+        }
+        return true;
     }
 
     bool ConfigLoader::loadFromString(const QString &jsonString, ProjectConfig &config)
     {
-        m_audioDurationCache.clear();
-        m_videoDurationCache.clear();
-
         QJsonParseError parseError;
         QJsonDocument doc = QJsonDocument::fromJson(jsonString.toUtf8(), &parseError);
 
@@ -46,8 +50,11 @@ namespace VideoCreator
             return false;
         }
 
-        QJsonObject root = doc.object();
+        return loadFromJsonObject(doc.object(), config);
+    }
 
+    bool ConfigLoader::loadFromJsonObject(const QJsonObject &root, ProjectConfig &config)
+    {
         // 解析项目配置
         if (root.contains("project") && root["project"].isObject())
         {
@@ -64,14 +71,20 @@ namespace VideoCreator
             config.scenes.clear();
 
             int sceneId = 1; // 从1开始分配场景ID
+            std::vector<size_t> derivedScenes; // JSON 未给出时长、需按素材推导的场景
             for (const QJsonValue &sceneValue : scenesArray)
             {
                 if (sceneValue.isObject())
                 {
+                    const QJsonObject sceneObject = sceneValue.toObject();
                     SceneConfig scene;
                     scene.id = sceneId; // 自动分配场景ID
-                    if (parseSceneConfig(sceneValue.toObject(), scene))
+                    if (parseSceneConfig(sceneObject, scene))
                     {
+                        if (!(sceneObject.contains("duration") && sceneObject["duration"].isDouble()))
+                        {
+                            derivedScenes.push_back(config.scenes.size());
+                        }
                         config.scenes.push_back(scene);
                         sceneId++;
                     }
@@ -81,6 +94,8 @@ namespace VideoCreator
                     }
                 }
             }
+
+            resolveSceneDurations(config, derivedScenes);
         }
 
         // 解析全局效果配置
@@ -127,6 +142,52 @@ namespace VideoCreator
             project.background_color = json["background_color"].toString().toUtf8().toStdString();
         }
 
+        if (json.contains("output_format") && json["output_format"].isString())
+        {
+            project.output_format = json["output_format"].toString().toUtf8().toStdString();
+        }
+
+        if (json.contains("segment_duration") && json["segment_duration"].isDouble())
+        {
+            project.segment_duration = json["segment_duration"].toDouble();
+        }
+
+        if (json.contains("write_buffer_mb") && json["write_buffer_mb"].isDouble())
+        {
+            project.write_buffer_mb = json["write_buffer_mb"].toInt();
+        }
+
+        if (json.contains("sync_output") && json["sync_output"].isBool())
+        {
+            project.sync_output = json["sync_output"].toBool();
+        }
+
+        if (json.contains("checkpoint_dir") && json["checkpoint_dir"].isString())
+        {
+            project.checkpoint_dir = json["checkpoint_dir"].toString().toUtf8().toStdString();
+        }
+
+        if (json.contains("renditions") && json["renditions"].isArray())
+        {
+            project.renditions.clear();
+            const QJsonArray renditionArray = json["renditions"].toArray();
+            for (const QJsonValue &renditionValue : renditionArray)
+            {
+                if (!renditionValue.isObject())
+                {
+                    continue;
+                }
+                const QJsonObject renditionObject = renditionValue.toObject();
+                RenditionConfig rendition;
+                rendition.name = renditionObject["name"].toString().toUtf8().toStdString();
+                rendition.width = renditionObject["width"].toInt();
+                rendition.height = renditionObject["height"].toInt();
+                rendition.bitrate = renditionObject["bitrate"].toString().toUtf8().toStdString();
+                rendition.maxrate = renditionObject["maxrate"].toString().toUtf8().toStdString();
+                project.renditions.push_back(rendition);
+            }
+        }
+
         return true;
     }
 
@@ -176,93 +237,147 @@ namespace VideoCreator
             scene.to_scene = json["to_scene"].toInt();
         }
 
-        // Auto derive duration from audio/video resources when JSON omits it
+        // JSON 未给出时长时，由 deriveSceneDuration 按音视频素材推导
         if (json.contains("duration") && json["duration"].isDouble())
         {
             scene.duration = json["duration"].toDouble();
         }
-        else
+        return true;
+    }
+
+    void ConfigLoader::deriveMissingDurations(ProjectConfig &config)
+    {
+        std::vector<size_t> derivedScenes;
+        for (size_t i = 0; i < config.scenes.size(); ++i)
         {
-            double audioDrivenDuration = -1.0;
-            bool hasAudioResource = false;
-            auto updateAudioDuration = [&](const std::string &path) {
-                if (path.empty())
-                {
-                    return;
-                }
-                hasAudioResource = true;
-                double audioDuration = getAudioDuration(path);
-                if (audioDuration > audioDrivenDuration)
+            if (config.scenes[i].duration <= 0.0)
+            {
+                derivedScenes.push_back(i);
+            }
+        }
+        if (!derivedScenes.empty())
+        {
+            resolveSceneDurations(config, derivedScenes);
+        }
+    }
+
+    void ConfigLoader::resolveSceneDurations(ProjectConfig &config, const std::vector<size_t> &sceneIndices)
+    {
+        // 先并行探测所有场景的素材时长，再逐个推导
+        prefetchMediaDurations(config, sceneIndices);
+        for (size_t index : sceneIndices)
+        {
+            deriveSceneDuration(config.scenes[index]);
+        }
+        MediaInfoCache::instance().save();
+    }
+
+    void ConfigLoader::prefetchMediaDurations(const ProjectConfig &config, const std::vector<size_t> &sceneIndices)
+    {
+        std::vector<std::pair<std::string, MediaKind>> requests;
+        for (size_t index : sceneIndices)
+        {
+            const SceneConfig &scene = config.scenes[index];
+            auto addAudio = [&](const std::string &path) {
+                if (!path.empty())
                 {
-                    audioDrivenDuration = audioDuration;
+                    requests.emplace_back(normalizedPath(path), MediaKind::AUDIO);
                 }
             };
-
-            updateAudioDuration(scene.resources.audio.path);
+            addAudio(scene.resources.audio.path);
             for (const auto &layerConfig : scene.resources.audio_layers)
             {
-                updateAudioDuration(layerConfig.path);
+                addAudio(layerConfig.path);
+            }
+            if (scene.type == SceneType::VIDEO_SCENE && !scene.resources.video.path.empty())
+            {
+                requests.emplace_back(normalizedPath(scene.resources.video.path), MediaKind::VIDEO);
+            }
+        }
+        MediaInfoCache::instance().prefetch(requests);
+    }
+
+    // Auto derive duration from audio/video resources when JSON omits it
+    void ConfigLoader::deriveSceneDuration(SceneConfig &scene)
+    {
+        double audioDrivenDuration = -1.0;
+        bool hasAudioResource = false;
+        auto updateAudioDuration = [&](const std::string &path) {
+            if (path.empty())
+            {
+                return;
+            }
+            hasAudioResource = true;
+            double audioDuration = getAudioDuration(path);
+            if (audioDuration > audioDrivenDuration)
+            {
+                audioDrivenDuration = audioDuration;
             }
+        };
 
-            if (scene.type == SceneType::IMAGE_SCENE && audioDrivenDuration > 0)
+        updateAudioDuration(scene.resources.audio.path);
+        for (const auto &layerConfig : scene.resources.audio_layers)
+        {
+            updateAudioDuration(layerConfig.path);
+        }
+
+        if (scene.type == SceneType::IMAGE_SCENE && audioDrivenDuration > 0)
+        {
+            scene.duration = audioDrivenDuration;
+            qDebug() << "Scene duration synced to audio length:"
+                     << audioDrivenDuration
+                     << "seconds";
+        }
+        else if (scene.type == SceneType::VIDEO_SCENE && !scene.resources.video.path.empty())
+        {
+            double videoDuration = getVideoDuration(scene.resources.video.path);
+            if (videoDuration > 0)
+            {
+                scene.duration = videoDuration;
+                qDebug() << "Scene duration synced to video length:"
+                         << videoDuration
+                         << "seconds";
+            }
+            else if (audioDrivenDuration > 0)
             {
                 scene.duration = audioDrivenDuration;
-                qDebug() << "Scene duration synced to audio length:"
+                qDebug() << "Scene duration uses audio length for video scene:"
                          << audioDrivenDuration
                          << "seconds";
             }
-            else if (scene.type == SceneType::VIDEO_SCENE && !scene.resources.video.path.empty())
+            else
             {
-                double videoDuration = getVideoDuration(scene.resources.video.path);
-                if (videoDuration > 0)
-                {
-                    scene.duration = videoDuration;
-                    qDebug() << "Scene duration synced to video length:"
-                             << videoDuration
-                             << "seconds";
-                }
-                else if (audioDrivenDuration > 0)
-                {
-                    scene.duration = audioDrivenDuration;
-                    qDebug() << "Scene duration uses audio length for video scene:"
-                             << audioDrivenDuration
-                             << "seconds";
-                }
-                else
-                {
-                    scene.duration = 5.0;
-                    qDebug() << "Failed to get video duration, fallback to 5 seconds.";
-                }
+                scene.duration = 5.0;
+                qDebug() << "Failed to get video duration, fallback to 5 seconds.";
             }
-            else if (scene.type == SceneType::IMAGE_SCENE)
+        }
+        else if (scene.type == SceneType::IMAGE_SCENE)
+        {
+            scene.duration = 5.0;
+            if (hasAudioResource)
             {
-                scene.duration = 5.0;
-                if (hasAudioResource)
-                {
-                    qDebug() << "Failed to get audio duration, fallback to 5 seconds.";
-                }
-                else
-                {
-                    qDebug() << "Scene has no audio, fallback to 5 seconds.";
-                }
+                qDebug() << "Failed to get audio duration, fallback to 5 seconds.";
             }
-            else if (scene.type == SceneType::VIDEO_SCENE)
+            else
             {
-                if (audioDrivenDuration > 0)
-                {
-                    scene.duration = audioDrivenDuration;
-                    qDebug() << "Scene duration uses audio length for video scene:"
-                             << audioDrivenDuration
-                             << "seconds";
-                }
-                else
-                {
-                    scene.duration = 5.0;
-                    qDebug() << "Video scene missing resources, fallback to 5 seconds.";
-                }
+                qDebug() << "Scene has no audio, fallback to 5 seconds.";
+            }
+        }
+        else if (scene.type == SceneType::VIDEO_SCENE)
+        {
+            if (audioDrivenDuration > 0)
+            {
+                scene.duration = audioDrivenDuration;
+                qDebug() << "Scene duration uses audio length for video scene:"
+                         << audioDrivenDuration
+                         << "seconds";
+            }
+            else
+            {
+                scene.duration = 5.0;
+                qDebug() << "Video scene missing resources, fallback to 5 seconds.";
             }
         }
-        return true;
     }
 
     bool ConfigLoader::parseResourcesConfig(const QJsonObject &json, ResourcesConfig &resources)
@@ -313,6 +428,25 @@ namespace VideoCreator
             }
         }
 
+        // 叠加图片
+        if (json.contains("overlays") && json["overlays"].isArray())
+        {
+            resources.overlays.clear();
+            QJsonArray overlayArray = json["overlays"].toArray();
+            for (const QJsonValue &overlayValue : overlayArray)
+            {
+                if (!overlayValue.isObject())
+                {
+                    continue;
+                }
+                ImageConfig overlayConfig;
+                if (parseImageConfig(overlayValue.toObject(), overlayConfig) && !overlayConfig.path.empty())
+                {
+                    resources.overlays.push_back(overlayConfig);
+                }
+            }
+        }
+
         return true;
     }
 
@@ -346,6 +480,11 @@ namespace VideoCreator
             image.rotation = json["rotation"].toDouble();
         }
 
+        if (json.contains("fit") && json["fit"].isString())
+        {
+            image.fit = json["fit"].toString().toUtf8().toStdString();
+        }
+
         return true;
     }
 
@@ -391,6 +530,16 @@ namespace VideoCreator
             video.use_audio = json["use_audio"].toBool();
         }
 
+        if (json.contains("frame_rate_mode") && json["frame_rate_mode"].isString())
+        {
+            video.frame_rate_mode = json["frame_rate_mode"].toString().toUtf8().toStdString();
+        }
+
+        if (json.contains("fit") && json["fit"].isString())
+        {
+            video.fit = json["fit"].toString().toUtf8().toStdString();
+        }
+
         return true;
     }
 
@@ -541,6 +690,15 @@ namespace VideoCreator
             }
         }
 
+        // 解析视频解码配置
+        if (json.contains("video_decoding") && json["video_decoding"].isObject())
+        {
+            if (!parseVideoDecodingConfig(json["video_decoding"].toObject(), global_effects.video_decoding))
+            {
+                return false;
+            }
+        }
+
         // 解析音频编码配置
         if (json.contains("audio_encoding") && json["audio_encoding"].isObject())
         {
@@ -568,32 +726,22 @@ namespace VideoCreator
         return true;
     }
 
-    bool ConfigLoader::parseVideoEncodingConfig(const QJsonObject &json, VideoEncodingConfig &config)
+    bool ConfigLoader::parseVideoDecodingConfig(const QJsonObject &json, VideoDecodingConfig &config)
     {
-        if (json.contains("codec") && json["codec"].isString())
-        {
-            config.codec = json["codec"].toString().toUtf8().toStdString();
-        }
-
-        if (json.contains("bitrate") && json["bitrate"].isString())
+        if (json.contains("threads") && json["threads"].isDouble())
         {
-            config.bitrate = json["bitrate"].toString().toUtf8().toStdString();
+            config.threads = json["threads"].toInt();
         }
 
-        if (json.contains("preset") && json["preset"].isString())
+        if (json.contains("thread_type") && json["thread_type"].isString())
         {
-            config.preset = json["preset"].toString().toUtf8().toStdString();
-        }
-
-        if (json.contains("crf") && json["crf"].isDouble())
-        {
-            config.crf = json["crf"].toInt();
+            config.thread_type = json["thread_type"].toString().toUtf8().toStdString();
         }
 
         return true;
     }
 
-    bool ConfigLoader::parseAudioEncodingConfig(const QJsonObject &json, AudioEncodingConfig &config)
+    bool ConfigLoader::parseVideoEncodingConfig(const QJsonObject &json, VideoEncodingConfig &config)
     {
         if (json.contains("codec") && json["codec"].isString())
         {
@@ -605,226 +753,139 @@ namespace VideoCreator
             config.bitrate = json["bitrate"].toString().toUtf8().toStdString();
         }
 
-        if (json.contains("channels") && json["channels"].isDouble())
+        if (json.contains("preset") && json["preset"].isString())
         {
-            config.channels = json["channels"].toInt();
+            config.preset = json["preset"].toString().toUtf8().toStdString();
         }
 
-        return true;
-    }
-
-    SceneType ConfigLoader::stringToSceneType(const QString &typeStr)
-    {
-        QString lower = typeStr.toLower();
-        if (lower == "image_scene")
-            return SceneType::IMAGE_SCENE;
-        if (lower == "video_scene")
-            return SceneType::VIDEO_SCENE;
-        if (lower == "transition")
-            return SceneType::TRANSITION;
-        return SceneType::IMAGE_SCENE; // 默认值
-    }
-
-    TransitionType ConfigLoader::stringToTransitionType(const QString &typeStr)
-    {
-        QString lower = typeStr.toLower();
-        if (lower == "crossfade")
-            return TransitionType::CROSSFADE;
-        if (lower == "wipe")
-            return TransitionType::WIPE;
-        if (lower == "slide")
-            return TransitionType::SLIDE;
-        return TransitionType::CROSSFADE; // 默认值
-    }
-
-    double ConfigLoader::getAudioDuration(const std::string &audioPath)
-    {
-        const std::string key = normalizedPath(audioPath);
-        if (key.empty())
+        if (json.contains("crf") && json["crf"].isDouble())
         {
-            qDebug() << "Audio path is empty";
-            return -1.0;
+            config.crf = json["crf"].toInt();
         }
 
-        auto cachedIt = m_audioDurationCache.find(key);
-        if (cachedIt != m_audioDurationCache.end())
+        if (json.contains("auto_profile") && json["auto_profile"].isString())
         {
-            return cachedIt->second;
+            config.auto_profile = json["auto_profile"].toString().toUtf8().toStdString();
         }
 
-        double duration = probeAudioDuration(key);
-        m_audioDurationCache[key] = duration;
-        return duration;
-    }
+        if (json.contains("thread_type") && json["thread_type"].isString())
+        {
+            config.thread_type = json["thread_type"].toString().toUtf8().toStdString();
+        }
 
-    double ConfigLoader::getVideoDuration(const std::string &videoPath)
-    {
-        const std::string key = normalizedPath(videoPath);
-        if (key.empty())
+        if (json.contains("threads") && json["threads"].isDouble())
         {
-            qDebug() << "Video path is empty";
-            return -1.0;
+            config.threads = json["threads"].toInt();
         }
 
-        auto cachedIt = m_videoDurationCache.find(key);
-        if (cachedIt != m_videoDurationCache.end())
+        if (json.contains("gop") && json["gop"].isDouble())
         {
-            return cachedIt->second;
+            config.gop = json["gop"].toInt();
         }
 
-        double duration = probeVideoDuration(key);
-        m_videoDurationCache[key] = duration;
-        return duration;
-    }
+        if (json.contains("bframes") && json["bframes"].isDouble())
+        {
+            config.bframes = json["bframes"].toInt();
+        }
 
-    double ConfigLoader::probeAudioDuration(const std::string &audioPath)
-    {
-        if (audioPath.empty())
+        if (json.contains("lookahead") && json["lookahead"].isDouble())
         {
-            return -1.0;
+            config.lookahead = json["lookahead"].toInt();
         }
 
-        QFileInfo info(QString::fromStdString(audioPath));
-        QFile file(info.absoluteFilePath());
-        if (!file.exists())
+        if (json.contains("tune") && json["tune"].isString())
         {
-            qDebug() << "Audio file not found:" << info.absoluteFilePath();
-            return -1.0;
+            config.tune = json["tune"].toString().toUtf8().toStdString();
         }
 
-        AVFormatContext *formatCtx = nullptr;
-        int ret = avformat_open_input(&formatCtx, audioPath.c_str(), nullptr, nullptr);
-        if (ret < 0)
+        if (json.contains("codec_params") && json["codec_params"].isString())
         {
-            char errbuf[256];
-            av_strerror(ret, errbuf, sizeof(errbuf));
-            qDebug() << "Failed to open audio file:" << info.absoluteFilePath();
-            qDebug() << "FFmpeg error:" << errbuf;
-            return -1.0;
+            config.codec_params = json["codec_params"].toString().toUtf8().toStdString();
         }
 
-        ret = avformat_find_stream_info(formatCtx, nullptr);
-        if (ret < 0)
+        if (json.contains("rate_control") && json["rate_control"].isString())
         {
-            char errbuf[256];
-            av_strerror(ret, errbuf, sizeof(errbuf));
-            qDebug() << "Failed to read audio stream info:" << info.absoluteFilePath();
-            qDebug() << "FFmpeg error:" << errbuf;
-            avformat_close_input(&formatCtx);
-            return -1.0;
+            config.rate_control = json["rate_control"].toString().toUtf8().toStdString();
         }
 
-        int audioStreamIndex = -1;
-        for (unsigned int i = 0; i < formatCtx->nb_streams; i++)
+        if (json.contains("maxrate") && json["maxrate"].isString())
         {
-            if (formatCtx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO)
-            {
-                audioStreamIndex = i;
-                break;
-            }
+            config.maxrate = json["maxrate"].toString().toUtf8().toStdString();
         }
 
-        if (audioStreamIndex == -1)
+        if (json.contains("bufsize") && json["bufsize"].isString())
         {
-            qDebug() << "No audio stream in file:" << info.absoluteFilePath();
-            avformat_close_input(&formatCtx);
-            return -1.0;
+            config.bufsize = json["bufsize"].toString().toUtf8().toStdString();
         }
 
-        double duration = 0.0;
-        if (formatCtx->duration != AV_NOPTS_VALUE)
+        if (json.contains("fast_first_pass") && json["fast_first_pass"].isBool())
         {
-            duration = formatCtx->duration / (double)AV_TIME_BASE;
+            config.fast_first_pass = json["fast_first_pass"].toBool();
         }
-        else if (formatCtx->streams[audioStreamIndex]->duration != AV_NOPTS_VALUE)
+
+        if (json.contains("pass_log") && json["pass_log"].isString())
         {
-            AVStream *stream = formatCtx->streams[audioStreamIndex];
-            duration = stream->duration * av_q2d(stream->time_base);
+            config.pass_log = json["pass_log"].toString().toUtf8().toStdString();
         }
 
-        avformat_close_input(&formatCtx);
-        return duration > 0 ? duration : -1.0;
+        return true;
     }
 
-    double ConfigLoader::probeVideoDuration(const std::string &videoPath)
+    bool ConfigLoader::parseAudioEncodingConfig(const QJsonObject &json, AudioEncodingConfig &config)
     {
-        if (videoPath.empty())
+        if (json.contains("codec") && json["codec"].isString())
         {
-            return -1.0;
+            config.codec = json["codec"].toString().toUtf8().toStdString();
         }
 
-        QFileInfo info(QString::fromStdString(videoPath));
-        QFile file(info.absoluteFilePath());
-        if (!file.exists())
+        if (json.contains("bitrate") && json["bitrate"].isString())
         {
-            qDebug() << "Video file not found:" << info.absoluteFilePath();
-            return -1.0;
+            config.bitrate = json["bitrate"].toString().toUtf8().toStdString();
         }
 
-        AVFormatContext *formatCtx = nullptr;
-        int ret = avformat_open_input(&formatCtx, videoPath.c_str(), nullptr, nullptr);
-        if (ret < 0)
+        if (json.contains("channels") && json["channels"].isDouble())
         {
-            char errbuf[256];
-            av_strerror(ret, errbuf, sizeof(errbuf));
-            qDebug() << "Failed to open video file:" << info.absoluteFilePath();
-            qDebug() << "FFmpeg error:" << errbuf;
-            return -1.0;
+            config.channels = json["channels"].toInt();
         }
 
-        ret = avformat_find_stream_info(formatCtx, nullptr);
-        if (ret < 0)
-        {
-            char errbuf[256];
-            av_strerror(ret, errbuf, sizeof(errbuf));
-            qDebug() << "Failed to read video stream info:" << info.absoluteFilePath();
-            qDebug() << "FFmpeg error:" << errbuf;
-            avformat_close_input(&formatCtx);
-            return -1.0;
-        }
+        return true;
+    }
 
-        int videoStreamIndex = -1;
-        for (unsigned int i = 0; i < formatCtx->nb_streams; i++)
-        {
-            if (formatCtx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
-            {
-                videoStreamIndex = i;
-                break;
-            }
-        }
+    SceneType ConfigLoader::stringToSceneType(const QString &typeStr)
+    {
+        return sceneTypeFromString(typeStr.toStdString());
+    }
 
-        if (videoStreamIndex == -1)
+    TransitionType ConfigLoader::stringToTransitionType(const QString &typeStr)
+    {
+        return transitionTypeFromString(typeStr.toStdString());
+    }
+
+    double ConfigLoader::getAudioDuration(const std::string &audioPath)
+    {
+        const std::string key = normalizedPath(audioPath);
+        if (key.empty())
         {
-            qDebug() << "No video stream in file:" << info.absoluteFilePath();
-            avformat_close_input(&formatCtx);
+            qDebug() << "Audio path is empty";
             return -1.0;
         }
+        return MediaInfoCache::instance().duration(key, MediaKind::AUDIO);
+    }
 
-        double duration = 0.0;
-        if (formatCtx->duration != AV_NOPTS_VALUE)
-        {
-            duration = formatCtx->duration / (double)AV_TIME_BASE;
-        }
-        else if (formatCtx->streams[videoStreamIndex]->duration != AV_NOPTS_VALUE)
+    double ConfigLoader::getVideoDuration(const std::string &videoPath)
+    {
+        const std::string key = normalizedPath(videoPath);
+        if (key.empty())
         {
-            AVStream *stream = formatCtx->streams[videoStreamIndex];
-            duration = stream->duration * av_q2d(stream->time_base);
+            qDebug() << "Video path is empty";
+            return -1.0;
         }
-
-        avformat_close_input(&formatCtx);
-        return duration > 0 ? duration : -1.0;
+        return MediaInfoCache::instance().duration(key, MediaKind::VIDEO);
     }
 
     std::string ConfigLoader::normalizedPath(const std::string &path) const
     {
-        if (path.empty())
-        {
-            return std::string();
-        }
-
-        QFileInfo info(QString::fromStdString(path));
-        QString normalized = QDir::fromNativeSeparators(QDir::cleanPath(info.absoluteFilePath()));
-        return normalized.toStdString();
+        return MediaInfoCache::normalizedPath(path);
     }
 
 } // namespace VideoCreator
@@ -8,7 +8,7 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
-#include <unordered_map>
+#include <vector>
 #include "ProjectConfig.h"
 
 namespace VideoCreator
@@ -25,13 +25,17 @@ namespace VideoCreator
         // 从JSON字符串加载配置
         bool loadFromString(const QString &jsonString, ProjectConfig &config);
 
+        // 从已解析的JSON对象加载配置
+        bool loadFromJsonObject(const QJsonObject &root, ProjectConfig &config);
+
+        // 直接构建的配置（不经过 JSON）：为时长 <= 0 的场景按素材推导时长
+        void deriveMissingDurations(ProjectConfig &config);
+
         // 获取错误信息
         QString errorString() const { return m_errorString; }
 
     private:
         QString m_errorString;
-        std::unordered_map<std::string, double> m_audioDurationCache;
-        std::unordered_map<std::string, double> m_videoDurationCache;
 
         // 解析项目配置
         bool parseProjectConfig(const QJsonObject &json, ProjectInfoConfig &project);
@@ -70,15 +74,23 @@ namespace VideoCreator
 
         // 解析视频编码配置
         bool parseVideoEncodingConfig(const QJsonObject &json, VideoEncodingConfig &config);
+        bool parseVideoDecodingConfig(const QJsonObject &json, VideoDecodingConfig &config);
 
         // 解析音频编码配置
         bool parseAudioEncodingConfig(const QJsonObject &json, AudioEncodingConfig &config);
 
-        // 获取音频文件时长（秒）
+        // 为指定场景推导时长（并行探测素材后逐个推导，并保存探测缓存）
+        void resolveSceneDurations(ProjectConfig &config, const std::vector<size_t> &sceneIndices);
+
+        // 并行探测需要推导时长的场景素材
+        void prefetchMediaDurations(const ProjectConfig &config, const std::vector<size_t> &sceneIndices);
+
+        // JSON 未给出时长时，按音频/视频素材推导场景时长
+        void deriveSceneDuration(SceneConfig &scene);
+
+        // 获取音频文件时长（秒），结果由 MediaInfoCache 跨实例共享
         double getAudioDuration(const std::string &audioPath);
         double getVideoDuration(const std::string &videoPath);
-        double probeAudioDuration(const std::string &normalizedPath);
-        double probeVideoDuration(const std::string &normalizedPath);
         std::string normalizedPath(const std::string &path) const;
 
         // 字符串到枚举转换
@@ -0,0 +1,908 @@
+#include "ConfigStreamParser.h"
+#include <QByteArray>
+#include <cmath>
+#include <limits>
+
+namespace VideoCreator
+{
+
+    namespace
+    {
+        bool isJsonSpace(int c)
+        {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        }
+
+        void appendUtf8(std::string &out, uint32_t codePoint)
+        {
+            if (codePoint < 0x80)
+            {
+                out.push_back(static_cast<char>(codePoint));
+            }
+            else if (codePoint < 0x800)
+            {
+                out.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+                out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+            else if (codePoint < 0x10000)
+            {
+                out.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+                out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+            else
+            {
+                out.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+                out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+        }
+
+        int hexValue(int c)
+        {
+            if (c >= '0' && c <= '9')
+                return c - '0';
+            if (c >= 'a' && c <= 'f')
+                return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F')
+                return c - 'A' + 10;
+            return -1;
+        }
+    } // namespace
+
+    bool ConfigStreamParser::parse(QIODevice *device, ProjectConfig &config, std::vector<size_t> &derivedScenes, bool &hasScenes)
+    {
+        m_device = device;
+        m_buffer.resize(kChunkSize);
+        m_pos = 0;
+        m_size = 0;
+        m_consumed = 0;
+        m_errorString.clear();
+        derivedScenes.clear();
+        hasScenes = false;
+
+        // 跳过 UTF-8 BOM
+        if (fill() && static_cast<unsigned char>(m_buffer[0]) == 0xEF)
+        {
+            if (next() != 0xEF || next() != 0xBB || next() != 0xBF)
+            {
+                return fail("无效的 UTF-8 BOM");
+            }
+        }
+
+        if (peek() != '{')
+        {
+            return fail(peek() < 0 ? "文件为空" : "JSON根元素不是对象");
+        }
+        if (!parseRoot(config, derivedScenes, hasScenes))
+        {
+            return false;
+        }
+        if (peek() >= 0)
+        {
+            return fail("根对象之后存在多余内容");
+        }
+        return true;
+    }
+
+    // ---------------- 词法层 ----------------
+
+    bool ConfigStreamParser::fill()
+    {
+        if (m_pos < m_size)
+        {
+            return true;
+        }
+        m_consumed += static_cast<qint64>(m_size);
+        m_pos = 0;
+        m_size = 0;
+        const qint64 bytesRead = m_device->read(m_buffer.data(), kChunkSize);
+        if (bytesRead <= 0)
+        {
+            return false;
+        }
+        m_size = static_cast<size_t>(bytesRead);
+        return true;
+    }
+
+    int ConfigStreamParser::peek()
+    {
+        while (true)
+        {
+            if (m_pos >= m_size && !fill())
+            {
+                return -1;
+            }
+            const int c = static_cast<unsigned char>(m_buffer[m_pos]);
+            if (!isJsonSpace(c))
+            {
+                return c;
+            }
+            ++m_pos;
+        }
+    }
+
+    int ConfigStreamParser::next()
+    {
+        if (m_pos >= m_size && !fill())
+        {
+            return -1;
+        }
+        return static_cast<unsigned char>(m_buffer[m_pos++]);
+    }
+
+    bool ConfigStreamParser::expect(char c)
+    {
+        if (peek() != static_cast<unsigned char>(c))
+        {
+            return fail(QString("缺少 '%1'").arg(QChar::fromLatin1(c)));
+        }
+        ++m_pos;
+        return true;
+    }
+
+    bool ConfigStreamParser::readString(std::string &out)
+    {
+        out.clear();
+        if (!expect('"'))
+        {
+            return false;
+        }
+        while (true)
+        {
+            // 整段拷贝不含转义的内容
+            size_t start = m_pos;
+            while (m_pos < m_size && m_buffer[m_pos] != '"' && m_buffer[m_pos] != '\\' &&
+                   static_cast<unsigned char>(m_buffer[m_pos]) >= 0x20)
+            {
+                ++m_pos;
+            }
+            out.append(m_buffer.data() + start, m_pos - start);
+
+            const int c = next();
+            if (c < 0)
+            {
+                return fail("字符串未结束");
+            }
+            if (c == '"')
+            {
+                return true;
+            }
+            if (c < 0x20)
+            {
+                return fail("字符串中包含未转义的控制字符");
+            }
+            if (c != '\\')
+            {
+                // 缓冲区边界上的普通字符
+                out.push_back(static_cast<char>(c));
+                continue;
+            }
+
+            const int escape = next();
+            switch (escape)
+            {
+            case '"':
+            case '\\':
+            case '/':
+                out.push_back(static_cast<char>(escape));
+                break;
+            case 'b':
+                out.push_back('\b');
+                break;
+            case 'f':
+                out.push_back('\f');
+                break;
+            case 'n':
+                out.push_back('\n');
+                break;
+            case 'r':
+                out.push_back('\r');
+                break;
+            case 't':
+                out.push_back('\t');
+                break;
+            case 'u':
+            {
+                auto readHex4 = [this](uint32_t &value) {
+                    value = 0;
+                    for (int i = 0; i < 4; ++i)
+                    {
+                        const int digit = hexValue(next());
+                        if (digit < 0)
+                        {
+                            return false;
+                        }
+                        value = (value << 4) | static_cast<uint32_t>(digit);
+                    }
+                    return true;
+                };
+                uint32_t codePoint = 0;
+                if (!readHex4(codePoint))
+                {
+                    return fail("无效的 \\u 转义");
+                }
+                // UTF-16 代理对
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF)
+                {
+                    uint32_t low = 0;
+                    if (next() != '\\' || next() != 'u' || !readHex4(low) || low < 0xDC00 || low > 0xDFFF)
+                    {
+                        return fail("无效的 UTF-16 代理对");
+                    }
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF)
+                {
+                    return fail("无效的 UTF-16 代理对");
+                }
+                appendUtf8(out, codePoint);
+                break;
+            }
+            default:
+                return fail("无效的转义字符");
+            }
+        }
+    }
+
+    bool ConfigStreamParser::readNumber(double &out)
+    {
+        char text[64];
+        int length = 0;
+        while (true)
+        {
+            if (m_pos >= m_size && !fill())
+            {
+                break;
+            }
+            const char c = m_buffer[m_pos];
+            if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E'))
+            {
+                break;
+            }
+            if (length >= static_cast<int>(sizeof(text)) - 1)
+            {
+                return fail("数字过长");
+            }
+            text[length++] = c;
+            ++m_pos;
+        }
+
+        // JSON 数字语法: -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+        int i = 0;
+        auto digits = [&]() {
+            const int begin = i;
+            while (i < length && text[i] >= '0' && text[i] <= '9')
+                ++i;
+            return i > begin;
+        };
+        if (i < length && text[i] == '-')
+            ++i;
+        bool valid = false;
+        if (i < length && text[i] == '0')
+        {
+            ++i;
+            valid = true;
+        }
+        else
+        {
+            valid = digits();
+        }
+        if (valid && i < length && text[i] == '.')
+        {
+            ++i;
+            valid = digits();
+        }
+        if (valid && i < length && (text[i] == 'e' || text[i] == 'E'))
+        {
+            ++i;
+            if (i < length && (text[i] == '+' || text[i] == '-'))
+                ++i;
+            valid = digits();
+        }
+        if (!valid || i != length)
+        {
+            return fail("无效的数字");
+        }
+
+        // QByteArray::toDouble 与系统区域设置无关
+        bool ok = false;
+        out = QByteArray::fromRawData(text, length).toDouble(&ok);
+        if (!ok)
+        {
+            return fail("无效的数字");
+        }
+        return true;
+    }
+
+    bool ConfigStreamParser::readLiteral(const char *literal)
+    {
+        for (const char *p = literal; *p; ++p)
+        {
+            if (next() != static_cast<unsigned char>(*p))
+            {
+                return fail("无效的字面量");
+            }
+        }
+        return true;
+    }
+
+    bool ConfigStreamParser::readBool(bool &out)
+    {
+        if (peek() == 't')
+        {
+            out = true;
+            return readLiteral("true");
+        }
+        out = false;
+        return readLiteral("false");
+    }
+
+    bool ConfigStreamParser::skipValue(int depth)
+    {
+        if (depth > kMaxDepth)
+        {
+            return fail("嵌套层级过深");
+        }
+        const int c = peek();
+        switch (c)
+        {
+        case '{':
+            return readObject([this, depth](const std::string &) { return skipValue(depth + 1); });
+        case '[':
+            return readArray([this, depth]() { return skipValue(depth + 1); });
+        case '"':
+            return readString(m_scratch);
+        case 't':
+            return readLiteral("true");
+        case 'f':
+            return readLiteral("false");
+        case 'n':
+            return readLiteral("null");
+        default:
+        {
+            if (c == '-' || (c >= '0' && c <= '9'))
+            {
+                double ignored = 0.0;
+                return readNumber(ignored);
+            }
+            return fail(c < 0 ? "文件意外结束" : "无效的值");
+        }
+        }
+    }
+
+    bool ConfigStreamParser::fail(const QString &message)
+    {
+        if (m_errorString.isEmpty())
+        {
+            const qint64 offset = m_consumed + static_cast<qint64>(m_pos);
+            m_errorString = QString("JSON解析错误: %1 (偏移 %2)").arg(message).arg(offset);
+        }
+        return false;
+    }
+
+    template <typename Callback>
+    bool ConfigStreamParser::readObject(Callback onMember)
+    {
+        if (!expect('{'))
+        {
+            return false;
+        }
+        if (peek() == '}')
+        {
+            ++m_pos;
+            return true;
+        }
+        std::string key;
+        while (true)
+        {
+            if (!readString(key) || !expect(':'))
+            {
+                return false;
+            }
+            if (!onMember(key))
+            {
+                return false;
+            }
+            const int c = peek();
+            ++m_pos;
+            if (c == '}')
+            {
+                return true;
+            }
+            if (c != ',')
+            {
+                --m_pos;
+                return fail(c < 0 ? "对象未结束" : "对象成员之间缺少 ','");
+            }
+        }
+    }
+
+    template <typename Callback>
+    bool ConfigStreamParser::readArray(Callback onElement)
+    {
+        if (!expect('['))
+        {
+            return false;
+        }
+        if (peek() == ']')
+        {
+            ++m_pos;
+            return true;
+        }
+        while (true)
+        {
+            if (!onElement())
+            {
+                return false;
+            }
+            const int c = peek();
+            ++m_pos;
+            if (c == ']')
+            {
+                return true;
+            }
+            if (c != ',')
+            {
+                --m_pos;
+                return fail(c < 0 ? "数组未结束" : "数组元素之间缺少 ','");
+            }
+        }
+    }
+
+    // ---------------- 字段层 ----------------
+
+    bool ConfigStreamParser::readStringField(std::string &target)
+    {
+        if (peek() != '"')
+        {
+            return skipValue();
+        }
+        return readString(target);
+    }
+
+    bool ConfigStreamParser::readDoubleField(double &target, bool *present)
+    {
+        const int c = peek();
+        if (!(c == '-' || (c >= '0' && c <= '9')))
+        {
+            return skipValue();
+        }
+        if (present)
+        {
+            *present = true;
+        }
+        return readNumber(target);
+    }
+
+    bool ConfigStreamParser::readIntField(int &target)
+    {
+        double value = 0.0;
+        bool present = false;
+        if (!readDoubleField(value, &present))
+        {
+            return false;
+        }
+        if (present)
+        {
+            // 与 QJsonValue::toInt() 一致：非整数或超出范围时取 0
+            const bool integral = std::floor(value) == value &&
+                                  value >= std::numeric_limits<int>::min() &&
+                                  value <= std::numeric_limits<int>::max();
+            target = integral ? static_cast<int>(value) : 0;
+        }
+        return true;
+    }
+
+    bool ConfigStreamParser::readBoolField(bool &target)
+    {
+        const int c = peek();
+        if (c != 't' && c != 'f')
+        {
+            return skipValue();
+        }
+        return readBool(target);
+    }
+
+    // ---------------- 结构层 ----------------
+
+    bool ConfigStreamParser::parseRoot(ProjectConfig &config, std::vector<size_t> &derivedScenes, bool &hasScenes)
+    {
+        return readObject([&](const std::string &key) {
+            if (key == "project" && peek() == '{')
+            {
+                return parseProject(config.project);
+            }
+            if (key == "scenes" && peek() == '[')
+            {
+                hasScenes = true;
+                config.scenes.clear();
+                derivedScenes.clear();
+                int sceneId = 1; // 从1开始分配场景ID
+                return readArray([&]() {
+                    if (peek() != '{')
+                    {
+                        return skipValue(); // 非对象元素忽略
+                    }
+                    SceneConfig scene;
+                    scene.id = sceneId; // 自动分配场景ID
+                    bool hasDuration = false;
+                    if (!parseScene(scene, hasDuration))
+                    {
+                        return false;
+                    }
+                    if (!hasDuration)
+                    {
+                        derivedScenes.push_back(config.scenes.size());
+                    }
+                    config.scenes.push_back(std::move(scene));
+                    sceneId++;
+                    return true;
+                });
+            }
+            if (key == "global_effects" && peek() == '{')
+            {
+                return parseGlobalEffects(config.global_effects);
+            }
+            return skipValue();
+        });
+    }
+
+    bool ConfigStreamParser::parseProject(ProjectInfoConfig &project)
+    {
+        return readObject([&](const std::string &key) {
+            if (key == "name")
+                return readStringField(project.name);
+            if (key == "output_path")
+                return readStringField(project.output_path);
+            if (key == "width")
+                return readIntField(project.width);
+            if (key == "height")
+                return readIntField(project.height);
+            if (key == "fps")
+                return readIntField(project.fps);
+            if (key == "background_color")
+                return readStringField(project.background_color);
+            if (key == "output_format")
+                return readStringField(project.output_format);
+            if (key == "segment_duration")
+                return readDoubleField(project.segment_duration);
+            if (key == "write_buffer_mb")
+                return readIntField(project.write_buffer_mb);
+            if (key == "sync_output")
+                return readBoolField(project.sync_output);
+            if (key == "checkpoint_dir")
+                return readStringField(project.checkpoint_dir);
+            if (key == "renditions" && peek() == '[')
+            {
+                project.renditions.clear();
+                return readArray([&]() {
+                    if (peek() != '{')
+                    {
+                        return skipValue();
+                    }
+                    RenditionConfig rendition;
+                    if (!parseRendition(rendition))
+                    {
+                        return false;
+                    }
+                    project.renditions.push_back(std::move(rendition));
+                    return true;
+                });
+            }
+            return skipValue();
+        });
+    }
+
+    bool ConfigStreamParser::parseRendition(RenditionConfig &rendition)
+    {
+        return readObject([&](const std::string &key) {
+            if (key == "name")
+                return readStringField(rendition.name);
+            if (key == "width")
+                return readIntField(rendition.width);
+            if (key == "height")
+                return readIntField(rendition.height);
+            if (key == "bitrate")
+                return readStringField(rendition.bitrate);
+            if (key == "maxrate")
+                return readStringField(rendition.maxrate);
+            return skipValue();
+        });
+    }
+
+    bool ConfigStreamParser::parseScene(SceneConfig &scene, bool &hasDuration)
+    {
+        return readObject([&](const std::string &key) {
+            if (key == "id")
+                return readIntField(scene.id);
+            if (key == "type")
+            {
+                if (peek() != '"')
+                    return skipValue();
+                if (!readString(m_scratch))
+                    return false;
+                scene.type = sceneTypeFromString(m_scratch);
+                return true;
+            }
+            if (key == "resources" && peek() == '{')
+                return parseResources(scene.resources);
+            if (key == "effects" && peek() == '{')
+                return parseEffects(scene.effects);
+            if (key == "transition_type")
+            {
+                if (peek() != '"')
+                    return skipValue();
+                if (!readString(m_scratch))
+                    return false;
+                scene.transition_type = transitionTypeFromString(m_scratch);
+                return true;
+            }
+            if (key == "from_scene")
+                return readIntField(scene.from_scene);
+            if (key == "to_scene")
+                return readIntField(scene.to_scene);
+            if (key == "duration")
+                return readDoubleField(scene.duration, &hasDuration);
+            return skipValue();
+        });
+    }
+
+    bool ConfigStreamParser::parseResources(ResourcesConfig &resources)
+    {
+        return readObject([&](const std::string &key) {
+            if (key == "image" && peek() == '{')
+                return parseImage(resources.image);
+            if (key == "video" && peek() == '{')
+                return parseVideo(resources.video);
+            if (key == "audio" && peek() == '{')
+                return parseAudio(resources.audio);
+            if (key == "audio_layers" && peek() == '[')
+            {
+                resources.audio_layers.clear();
+                return readArray([&]() {
+                    if (peek() != '{')
+                    {
+                        return skipValue();
+                    }
+                    AudioConfig layerConfig;
+                    if (!parseAudio(layerConfig))
+                    {
+                        return false;
+                    }
+                    resources.audio_layers.push_back(std::move(layerConfig));
+                    return true;
+                });
+            }
+            if (key == "overlays" && peek() == '[')
+            {
+                resources.overlays.clear();
+                return readArray([&]() {
+                    if (peek() != '{')
+                    {
+                        return skipValue();
+                    }
+                    ImageConfig overlayConfig;
+                    if (!parseImage(overlayConfig))
+                    {
+                        return false;
+                    }
+                    if (!overlayConfig.path.empty())
+                    {
+                        resources.overlays.push_back(std::move(overlayConfig));
+                    }
+                    return true;
+                });
+            }
+            return skipValue();
+        });
+    }
+
+    bool ConfigStreamParser::parseImage(ImageConfig &image)
+    {
+        return readObject([&](const std::string &key) {
+            if (key == "path")
+                return readStringField(image.path);
+            if (key == "position" && peek() == '{')
+            {
+                return readObject([&](const std::string &axis) {
+                    if (axis == "x")
+                        return readIntField(image.x);
+                    if (axis == "y")
+                        return readIntField(image.y);
+                    return skipValue();
+                });
+            }
+            if (key == "scale")
+                return readDoubleField(image.scale);
+            if (key == "rotation")
+                return readDoubleField(image.rotation);
+            if (key == "fit")
+                return readStringField(image.fit);
+            return skipValue();
+        });
+    }
+
+    bool ConfigStreamParser::parseVideo(VideoConfig &video)
+    {
+        return readObject([&](const std::string &key) {
+            if (key == "path")
+                return readStringField(video.path);
+            if (key == "trim_start")
+                return readDoubleField(video.trim_start);
+            if (key == "trim_end")
+                return readDoubleField(video.trim_end);
+            if (key == "use_audio")
+                return readBoolField(video.use_audio);
+            if (key == "frame_rate_mode")
+                return readStringField(video.frame_rate_mode);
+            if (key == "fit")
+                return readStringField(video.fit);
+            return skipValue();
+        });
+    }
+
+    bool ConfigStreamParser::parseAudio(AudioConfig &audio)
+    {
+        return readObject([&](const std::string &key) {
+            if (key == "path")
+                return readStringField(audio.path);
+            if (key == "volume")
+                return readDoubleField(audio.volume);
+            if (key == "start_offset")
+                return readDoubleField(audio.start_offset);
+            return skipValue();
+        });
+    }
+
+    bool ConfigStreamParser::parseEffects(EffectsConfig &effects)
+    {
+        return readObject([&](const std::string &key) {
+            if (key == "ken_burns" && peek() == '{')
+                return parseKenBurns(effects.ken_burns);
+            if (key == "volume_mix" && peek() == '{')
+                return parseVolumeMix(effects.volume_mix);
+            if (key == "subtitle" && peek() == '{')
+                return parseSubtitle(effects.subtitle);
+            return skipValue();
+        });
+    }
+
+    bool ConfigStreamParser::parseKenBurns(KenBurnsEffect &effect)
+    {
+        return readObject([&](const std::string &key) {
+            if (key == "enabled")
+                return readBoolField(effect.enabled);
+            if (key == "preset")
+                return readStringField(effect.preset);
+            if (key == "start_scale")
+                return readDoubleField(effect.start_scale);
+            if (key == "end_scale")
+                return readDoubleField(effect.end_scale);
+            if (key == "start_x")
+                return readIntField(effect.start_x);
+            if (key == "start_y")
+                return readIntField(effect.start_y);
+            if (key == "end_x")
+                return readIntField(effect.end_x);
+            if (key == "end_y")
+                return readIntField(effect.end_y);
+            return skipValue();
+        });
+    }
+
+    bool ConfigStreamParser::parseVolumeMix(VolumeMixEffect &effect)
+    {
+        return readObject([&](const std::string &key) {
+            if (key == "enabled")
+                return readBoolField(effect.enabled);
+            if (key == "fade_in")
+                return readDoubleField(effect.fade_in);
+            if (key == "fade_out")
+                return readDoubleField(effect.fade_out);
+            return skipValue();
+        });
+    }
+
+    bool ConfigStreamParser::parseSubtitle(SubtitleConfig &subtitle)
+    {
+        return readObject([&](const std::string &key) {
+            if (key == "text")
+                return readStringField(subtitle.text);
+            if (key == "font_size")
+                return readIntField(subtitle.font_size);
+            if (key == "font_color")
+                return readStringField(subtitle.font_color);
+            if (key == "bg_color")
+                return readStringField(subtitle.bg_color);
+            if (key == "margin_bottom")
+                return readIntField(subtitle.margin_bottom);
+            return skipValue();
+        });
+    }
+
+    bool ConfigStreamParser::parseGlobalEffects(GlobalEffectsConfig &globalEffects)
+    {
+        return readObject([&](const std::string &key) {
+            if (key == "audio_normalization" && peek() == '{')
+            {
+                AudioNormalizationConfig &config = globalEffects.audio_normalization;
+                return readObject([&](const std::string &field) {
+                    if (field == "enabled")
+                        return readBoolField(config.enabled);
+                    if (field == "target_level")
+                        return readDoubleField(config.target_level);
+                    return skipValue();
+                });
+            }
+            if (key == "video_encoding" && peek() == '{')
+            {
+                VideoEncodingConfig &config = globalEffects.video_encoding;
+                return readObject([&](const std::string &field) {
+                    if (field == "codec")
+                        return readStringField(config.codec);
+                    if (field == "bitrate")
+                        return readStringField(config.bitrate);
+                    if (field == "preset")
+                        return readStringField(config.preset);
+                    if (field == "crf")
+                        return readIntField(config.crf);
+                    if (field == "auto_profile")
+                        return readStringField(config.auto_profile);
+                    if (field == "thread_type")
+                        return readStringField(config.thread_type);
+                    if (field == "threads")
+                        return readIntField(config.threads);
+                    if (field == "gop")
+                        return readIntField(config.gop);
+                    if (field == "bframes")
+                        return readIntField(config.bframes);
+                    if (field == "lookahead")
+                        return readIntField(config.lookahead);
+                    if (field == "tune")
+                        return readStringField(config.tune);
+                    if (field == "codec_params")
+                        return readStringField(config.codec_params);
+                    if (field == "rate_control")
+                        return readStringField(config.rate_control);
+                    if (field == "maxrate")
+                        return readStringField(config.maxrate);
+                    if (field == "bufsize")
+                        return readStringField(config.bufsize);
+                    if (field == "fast_first_pass")
+                        return readBoolField(config.fast_first_pass);
+                    if (field == "pass_log")
+                        return readStringField(config.pass_log);
+                    return skipValue();
+                });
+            }
+            if (key == "video_decoding" && peek() == '{')
+            {
+                VideoDecodingConfig &config = globalEffects.video_decoding;
+                return readObject([&](const std::string &field) {
+                    if (field == "threads")
+                        return readIntField(config.threads);
+                    if (field == "thread_type")
+                        return readStringField(config.thread_type);
+                    return skipValue();
+                });
+            }
+            if (key == "audio_encoding" && peek() == '{')
+            {
+                AudioEncodingConfig &config = globalEffects.audio_encoding;
+                return readObject([&](const std::string &field) {
+                    if (field == "codec")
+                        return readStringField(config.codec);
+                    if (field == "bitrate")
+                        return readStringField(config.bitrate);
+                    if (field == "channels")
+                        return readIntField(config.channels);
+                    return skipValue();
+                });
+            }
+            return skipValue();
+        });
+    }
+
+} // namespace VideoCreator
@@ -0,0 +1,85 @@
+#ifndef CONFIG_STREAM_PARSER_H
+#define CONFIG_STREAM_PARSER_H
+
+#include <QIODevice>
+#include <QString>
+#include <string>
+#include <vector>
+#include "ProjectConfig.h"
+
+namespace VideoCreator
+{
+
+    /**
+     * ConfigStreamParser - 流式 JSON 配置解析器
+     *
+     * 按块从 QIODevice 读取，边扫描词法边填充 ProjectConfig，不构建 QJsonDocument。
+     * 字段语义与 ConfigLoader::loadFromJsonObject 一致：类型不符的字段忽略，
+     * 未知字段跳过。场景时长推导仍由 ConfigLoader 负责。
+     */
+    class ConfigStreamParser
+    {
+    public:
+        ConfigStreamParser() = default;
+
+        // 解析整个配置；derivedScenes 返回 JSON 未给出时长、需按素材推导的场景下标，
+        // hasScenes 表示配置中是否有 scenes 数组
+        bool parse(QIODevice *device, ProjectConfig &config, std::vector<size_t> &derivedScenes, bool &hasScenes);
+
+        QString errorString() const { return m_errorString; }
+
+    private:
+        // 词法层
+        bool fill();
+        int peek();
+        int next();
+        bool expect(char c);
+        bool readString(std::string &out);
+        bool readNumber(double &out);
+        bool readLiteral(const char *literal);
+        bool readBool(bool &out);
+        bool skipValue(int depth = 0);
+        bool fail(const QString &message);
+
+        // 逐个读取对象成员，onMember(key) 必须消费掉对应的值
+        template <typename Callback>
+        bool readObject(Callback onMember);
+        template <typename Callback>
+        bool readArray(Callback onElement);
+
+        // 字段层：类型匹配时赋值，否则跳过该值
+        bool readStringField(std::string &target);
+        bool readDoubleField(double &target, bool *present = nullptr);
+        bool readIntField(int &target);
+        bool readBoolField(bool &target);
+
+        // 结构层，对应 ConfigLoader 的 parse* 函数
+        bool parseRoot(ProjectConfig &config, std::vector<size_t> &derivedScenes, bool &hasScenes);
+        bool parseProject(ProjectInfoConfig &project);
+        bool parseRendition(RenditionConfig &rendition);
+        bool parseScene(SceneConfig &scene, bool &hasDuration);
+        bool parseResources(ResourcesConfig &resources);
+        bool parseImage(ImageConfig &image);
+        bool parseVideo(VideoConfig &video);
+        bool parseAudio(AudioConfig &audio);
+        bool parseEffects(EffectsConfig &effects);
+        bool parseKenBurns(KenBurnsEffect &effect);
+        bool parseVolumeMix(VolumeMixEffect &effect);
+        bool parseSubtitle(SubtitleConfig &subtitle);
+        bool parseGlobalEffects(GlobalEffectsConfig &globalEffects);
+
+        static constexpr int kChunkSize = 64 * 1024;
+        static constexpr int kMaxDepth = 256;
+
+        QIODevice *m_device = nullptr;
+        std::vector<char> m_buffer;
+        size_t m_pos = 0;
+        size_t m_size = 0;
+        qint64 m_consumed = 0; // 已移出缓冲区的字节数，用于报错位置
+        std::string m_scratch; // 读取字段名/字符串值时复用
+        QString m_errorString;
+    };
+
+} // namespace VideoCreator
+
+#endif // CONFIG_STREAM_PARSER_H
@@ -0,0 +1,443 @@
+#include "MediaInfoCache.h"
+#include "decoder/MediaSource.h"
+#include "engine/TaskExecutor.h"
+#include <QDebug>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <atomic>
+
+namespace VideoCreator
+{
+
+    namespace
+    {
+        // 缓存格式变化时递增，旧文件直接丢弃
+        constexpr int kCacheVersion = 1;
+    }
+
+    MediaInfoCache &MediaInfoCache::instance()
+    {
+        static MediaInfoCache cache;
+        return cache;
+    }
+
+    QString MediaInfoCache::cacheFilePath() const
+    {
+        QString dir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+        if (dir.isEmpty())
+        {
+            dir = QDir::tempPath();
+        }
+        return QDir(dir).filePath("StoryFlow/media_info_cache.json");
+    }
+
+    double MediaInfoCache::duration(const std::string &rawPath, MediaKind kind)
+    {
+        const std::string path = normalizedPath(rawPath);
+        if (path.empty())
+        {
+            return -1.0;
+        }
+
+        const std::string key = cacheKey(path, kind);
+        const Entry stamp = fileStamp(path);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ensureLoadedLocked();
+            if (const Entry *cached = lookupLocked(key, stamp))
+            {
+                return cached->duration;
+            }
+        }
+
+        Entry entry = stamp;
+        probe(path, kind, entry);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // 文件不存在（且未登记到内存）时不写入缓存，下次重新检查
+        if (stamp.size >= 0)
+        {
+            m_entries[key] = entry;
+            m_dirty = true;
+        }
+        return entry.duration;
+    }
+
+    void MediaInfoCache::prefetch(const std::vector<std::pair<std::string, MediaKind>> &requests)
+    {
+        // 去重；文件状态在加锁前取好，stat 不占用缓存锁
+        std::vector<std::pair<std::string, MediaKind>> items;
+        std::vector<Entry> stamps;
+        for (const auto &request : requests)
+        {
+            if (request.first.empty())
+            {
+                continue;
+            }
+            const std::pair<std::string, MediaKind> item(normalizedPath(request.first), request.second);
+            if (std::find(items.begin(), items.end(), item) == items.end())
+            {
+                items.push_back(item);
+                stamps.push_back(fileStamp(item.first));
+            }
+        }
+
+        // 过滤已命中的文件
+        std::vector<std::pair<std::string, MediaKind>> pending;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ensureLoadedLocked();
+            for (size_t i = 0; i < items.size(); ++i)
+            {
+                if (!lookupLocked(cacheKey(items[i].first, items[i].second), stamps[i]))
+                {
+                    pending.push_back(items[i]);
+                }
+            }
+        }
+        if (pending.empty())
+        {
+            return;
+        }
+
+        // 探测在共享执行器上进行，不再临时创建线程；调用线程同样领取文件，执行器忙时也能完成
+        TaskExecutor &executor = TaskExecutor::instance();
+        const size_t taskCount = std::min(static_cast<size_t>(executor.workerCount()), pending.size() - 1);
+
+        std::atomic<size_t> nextIndex{0};
+        auto worker = [&]() {
+            for (size_t i = nextIndex++; i < pending.size(); i = nextIndex++)
+            {
+                duration(pending[i].first, pending[i].second);
+            }
+        };
+
+        std::vector<TaskHandle> tasks;
+        tasks.reserve(taskCount);
+        for (size_t i = 0; i < taskCount; ++i)
+        {
+            tasks.push_back(executor.submit(worker));
+        }
+        worker();
+        for (const auto &task : tasks)
+        {
+            task.wait();
+        }
+        qDebug() << "MediaInfoCache: probed" << pending.size() << "files with" << taskCount << "executor tasks";
+    }
+
+    std::shared_ptr<const MediaStreamInfo> MediaInfoCache::streamInfo(const std::string &rawPath, MediaKind kind)
+    {
+        const std::string path = normalizedPath(rawPath);
+        if (path.empty())
+        {
+            return nullptr;
+        }
+        const Entry stamp = fileStamp(path);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ensureLoadedLocked();
+        const Entry *cached = lookupLocked(cacheKey(path, kind), stamp);
+        return cached ? cached->stream : nullptr;
+    }
+
+    void MediaInfoCache::storeStreamInfo(const std::string &rawPath, MediaKind kind, const AVFormatContext *formatCtx, int streamIndex)
+    {
+        const std::string path = normalizedPath(rawPath);
+        if (path.empty() || !formatCtx || streamIndex < 0)
+        {
+            return;
+        }
+        const Entry stamp = fileStamp(path);
+        if (stamp.size < 0)
+        {
+            return;
+        }
+        auto info = captureStreamInfo(formatCtx, streamIndex);
+        const double duration = containerDuration(formatCtx, streamIndex);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ensureLoadedLocked();
+        Entry &entry = m_entries[cacheKey(path, kind)];
+        if (entry.size != stamp.size || entry.mtime != stamp.mtime || entry.generation != stamp.generation)
+        {
+            entry = stamp;
+            entry.duration = duration;
+            m_dirty = true;
+        }
+        entry.stream = std::move(info);
+    }
+
+    bool MediaInfoCache::applyStreamInfo(AVFormatContext *formatCtx, const MediaStreamInfo &info)
+    {
+        // 无文件头的格式（如 MPEG-TS）要读包才能建流，不能跳过探测
+        if (!formatCtx || !info.codecpar || (formatCtx->ctx_flags & AVFMTCTX_NOHEADER))
+        {
+            return false;
+        }
+        if (info.streamIndex < 0 || formatCtx->nb_streams != info.streamCount)
+        {
+            return false;
+        }
+
+        AVStream *stream = formatCtx->streams[info.streamIndex];
+        if (stream->codecpar->codec_type != info.codecpar->codec_type || stream->codecpar->codec_id != info.codecpar->codec_id)
+        {
+            return false;
+        }
+        if (avcodec_parameters_copy(stream->codecpar, info.codecpar.get()) < 0)
+        {
+            return false;
+        }
+
+        // 这些时间信息原本由 avformat_find_stream_info 估算
+        if (stream->start_time == AV_NOPTS_VALUE)
+        {
+            stream->start_time = info.startTime;
+        }
+        if (stream->duration == AV_NOPTS_VALUE)
+        {
+            stream->duration = info.streamDuration;
+        }
+        if (formatCtx->duration == AV_NOPTS_VALUE)
+        {
+            formatCtx->duration = info.formatDuration;
+        }
+        return true;
+    }
+
+    void MediaInfoCache::save()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_dirty)
+        {
+            return;
+        }
+
+        QJsonObject entries;
+        for (const auto &item : m_entries)
+        {
+            // 登记序号只在本进程内有效
+            if (item.second.generation != 0)
+            {
+                continue;
+            }
+            QJsonObject entry;
+            entry["size"] = static_cast<qint64>(item.second.size);
+            entry["mtime"] = static_cast<qint64>(item.second.mtime);
+            entry["duration"] = item.second.duration;
+            entries[QString::fromStdString(item.first)] = entry;
+        }
+        QJsonObject root;
+        root["version"] = kCacheVersion;
+        root["entries"] = entries;
+
+        const QString filePath = cacheFilePath();
+        QDir().mkpath(QFileInfo(filePath).absolutePath());
+        QSaveFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            qDebug() << "MediaInfoCache: cannot write cache file:" << filePath;
+            return;
+        }
+        file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+        if (file.commit())
+        {
+            m_dirty = false;
+        }
+    }
+
+    void MediaInfoCache::ensureLoadedLocked()
+    {
+        if (m_loaded)
+        {
+            return;
+        }
+        m_loaded = true;
+
+        QFile file(cacheFilePath());
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            return;
+        }
+        const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+        if (root["version"].toInt() != kCacheVersion)
+        {
+            return;
+        }
+
+        const QJsonObject entries = root["entries"].toObject();
+        for (auto it = entries.begin(); it != entries.end(); ++it)
+        {
+            const QJsonObject json = it.value().toObject();
+            Entry entry;
+            entry.size = json["size"].toInteger(-1);
+            entry.mtime = json["mtime"].toInteger(-1);
+            entry.duration = json["duration"].toDouble(-1.0);
+            m_entries.emplace(it.key().toStdString(), entry);
+        }
+    }
+
+    const MediaInfoCache::Entry *MediaInfoCache::lookupLocked(const std::string &key, const Entry &fileStamp) const
+    {
+        auto it = m_entries.find(key);
+        if (it == m_entries.end() || fileStamp.size < 0)
+        {
+            return nullptr;
+        }
+        if (it->second.size != fileStamp.size || it->second.mtime != fileStamp.mtime ||
+            it->second.generation != fileStamp.generation)
+        {
+            return nullptr;
+        }
+        return &it->second;
+    }
+
+    std::string MediaInfoCache::normalizedPath(const std::string &path)
+    {
+        if (path.empty())
+        {
+            return std::string();
+        }
+
+        QFileInfo info(QString::fromStdString(path));
+        QString normalized = QDir::fromNativeSeparators(QDir::cleanPath(info.absoluteFilePath()));
+        return normalized.toStdString();
+    }
+
+    std::string MediaInfoCache::cacheKey(const std::string &path, MediaKind kind)
+    {
+        return (kind == MediaKind::AUDIO ? "audio|" : "video|") + path;
+    }
+
+    MediaInfoCache::Entry MediaInfoCache::fileStamp(const std::string &path)
+    {
+        Entry stamp;
+        QFileInfo info(QString::fromStdString(path));
+        if (info.exists() && info.isFile())
+        {
+            stamp.size = info.size();
+            stamp.mtime = info.lastModified().toMSecsSinceEpoch();
+        }
+        else if (auto buffer = MediaSourceRegistry::instance().find(path, &stamp.generation))
+        {
+            stamp.size = buffer->size();
+        }
+        return stamp;
+    }
+
+    void MediaInfoCache::probe(const std::string &path, MediaKind kind, Entry &entry)
+    {
+        const bool isAudio = (kind == MediaKind::AUDIO);
+        const char *label = isAudio ? "audio" : "video";
+        entry.duration = -1.0;
+
+        QFileInfo info(QString::fromStdString(path));
+        QFile file(info.absoluteFilePath());
+        if (!file.exists() && !MediaSourceRegistry::instance().find(path))
+        {
+            qDebug() << "Media file not found:" << label << info.absoluteFilePath();
+            return;
+        }
+
+        AVFormatContext *formatCtx = nullptr;
+        int ret = MediaSourceRegistry::openInput(&formatCtx, path);
+        if (ret < 0)
+        {
+            char errbuf[256];
+            av_strerror(ret, errbuf, sizeof(errbuf));
+            qDebug() << "Failed to open" << label << "file:" << info.absoluteFilePath();
+            qDebug() << "FFmpeg error:" << errbuf;
+            return;
+        }
+
+        ret = avformat_find_stream_info(formatCtx, nullptr);
+        if (ret < 0)
+        {
+            char errbuf[256];
+            av_strerror(ret, errbuf, sizeof(errbuf));
+            qDebug() << "Failed to read" << label << "stream info:" << info.absoluteFilePath();
+            qDebug() << "FFmpeg error:" << errbuf;
+            MediaSourceRegistry::closeInput(&formatCtx);
+            return;
+        }
+
+        // 与解码器选择同一条流，登记的参数才能直接复用
+        const AVMediaType mediaType = isAudio ? AVMEDIA_TYPE_AUDIO : AVMEDIA_TYPE_VIDEO;
+        const int streamIndex = av_find_best_stream(formatCtx, mediaType, -1, -1, nullptr, 0);
+        if (streamIndex < 0)
+        {
+            qDebug() << "No" << label << "stream in file:" << info.absoluteFilePath();
+            MediaSourceRegistry::closeInput(&formatCtx);
+            return;
+        }
+
+        entry.duration = containerDuration(formatCtx, streamIndex);
+        entry.stream = captureStreamInfo(formatCtx, streamIndex);
+        MediaSourceRegistry::closeInput(&formatCtx);
+    }
+
+    double MediaInfoCache::containerDuration(const AVFormatContext *formatCtx, int streamIndex)
+    {
+        double duration = 0.0;
+        if (formatCtx->duration != AV_NOPTS_VALUE)
+        {
+            duration = formatCtx->duration / (double)AV_TIME_BASE;
+        }
+        else if (formatCtx->streams[streamIndex]->duration != AV_NOPTS_VALUE)
+        {
+            const AVStream *stream = formatCtx->streams[streamIndex];
+            duration = stream->duration * av_q2d(stream->time_base);
+        }
+        return duration > 0 ? duration : -1.0;
+    }
+
+    std::shared_ptr<const MediaStreamInfo> MediaInfoCache::captureStreamInfo(const AVFormatContext *formatCtx, int streamIndex)
+    {
+        const AVStream *stream = formatCtx->streams[streamIndex];
+        AVCodecParameters *codecpar = avcodec_parameters_alloc();
+        if (!codecpar || avcodec_parameters_copy(codecpar, stream->codecpar) < 0)
+        {
+            avcodec_parameters_free(&codecpar);
+            return nullptr;
+        }
+
+        auto info = std::make_shared<MediaStreamInfo>();
+        info->codecpar = std::shared_ptr<const AVCodecParameters>(codecpar, [](const AVCodecParameters *params) {
+            AVCodecParameters *owned = const_cast<AVCodecParameters *>(params);
+            avcodec_parameters_free(&owned);
+        });
+        info->streamIndex = streamIndex;
+        info->streamCount = formatCtx->nb_streams;
+        info->timeBase = stream->time_base;
+        info->startTime = stream->start_time;
+        info->streamDuration = stream->duration;
+        info->formatDuration = formatCtx->duration;
+        if (stream->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
+        {
+            info->frameRate = av_guess_frame_rate(const_cast<AVFormatContext *>(formatCtx), const_cast<AVStream *>(stream), nullptr);
+
+            // 容器自带的索引（如 MP4 的 stss）在打开时就已读入，可直接得到关键帧表
+            const int64_t startTime = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+            const int entryCount = avformat_index_get_entries_count(stream);
+            for (int i = 0; i < entryCount; ++i)
+            {
+                const AVIndexEntry *indexEntry = avformat_index_get_entry(const_cast<AVStream *>(stream), i);
+                if (indexEntry && (indexEntry->flags & AVINDEX_KEYFRAME))
+                {
+                    info->keyframes.push_back((indexEntry->timestamp - startTime) * av_q2d(stream->time_base));
+                }
+            }
+            std::sort(info->keyframes.begin(), info->keyframes.end());
+        }
+        return info;
+    }
+
+} // namespace VideoCreator
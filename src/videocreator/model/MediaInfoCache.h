@@ -0,0 +1,104 @@
+#ifndef MEDIA_INFO_CACHE_H
+#define MEDIA_INFO_CACHE_H
+
+#include <QString>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "ffmpeg_utils/FFmpegHeaders.h"
+
+namespace VideoCreator
+{
+
+    // 探测的媒体类型（同一文件按音频/视频分别缓存）
+    enum class MediaKind
+    {
+        AUDIO,
+        VIDEO
+    };
+
+    // 已探测的流参数（仅保存在进程内），解码器据此跳过 avformat_find_stream_info
+    struct MediaStreamInfo
+    {
+        int streamIndex = -1;
+        unsigned int streamCount = 0;
+        AVRational timeBase{0, 1};
+        AVRational frameRate{0, 1};      // av_guess_frame_rate 的结果（仅视频）
+        int64_t startTime = AV_NOPTS_VALUE; // 流时间基
+        int64_t streamDuration = AV_NOPTS_VALUE; // 流时间基
+        int64_t formatDuration = AV_NOPTS_VALUE; // AV_TIME_BASE
+        std::shared_ptr<const AVCodecParameters> codecpar;
+        std::vector<double> keyframes;   // 容器索引中的关键帧时间（秒，已减去 start_time），升序
+    };
+
+    // 媒体信息注册表（进程内共享，时长持久化到磁盘）
+    // 以 (路径, 文件大小, 修改时间) 为键，文件变化后自动重新探测；
+    // 只在 MediaSourceRegistry 中登记、磁盘上没有的素材以 (路径, 数据大小, 登记序号) 为键，只缓存在进程内
+    // ConfigLoader 加载时填充，RenderEngine / 解码器 / 预览直接复用，避免重复解析容器
+    class MediaInfoCache
+    {
+    public:
+        static MediaInfoCache &instance();
+
+        // 获取媒体时长（秒），未命中时同步探测；失败返回 -1
+        double duration(const std::string &path, MediaKind kind);
+
+        // 并行探测一批文件，已命中缓存的直接跳过
+        void prefetch(const std::vector<std::pair<std::string, MediaKind>> &requests);
+
+        // 获取已知的流参数，没有（或文件已变化）时返回空
+        std::shared_ptr<const MediaStreamInfo> streamInfo(const std::string &path, MediaKind kind);
+
+        // 解码器完整探测后登记流参数，供后续打开同一文件时复用
+        void storeStreamInfo(const std::string &path, MediaKind kind, const AVFormatContext *formatCtx, int streamIndex);
+
+        // 把已知流参数填入刚 avformat_open_input 的上下文；参数与文件不符时返回 false，
+        // 调用方应回退到 avformat_find_stream_info
+        static bool applyStreamInfo(AVFormatContext *formatCtx, const MediaStreamInfo &info);
+
+        // 有新结果时写回磁盘缓存
+        void save();
+
+        // 磁盘缓存文件路径
+        QString cacheFilePath() const;
+
+        // 规范化为绝对路径（统一分隔符），作为缓存键的一部分
+        static std::string normalizedPath(const std::string &path);
+
+    private:
+        struct Entry
+        {
+            int64_t size = -1;
+            int64_t mtime = -1; // 修改时间（毫秒）
+            uint64_t generation = 0; // 内存素材的登记序号，磁盘文件为 0
+            double duration = -1.0;
+            std::shared_ptr<const MediaStreamInfo> stream; // 不写入磁盘
+        };
+
+        MediaInfoCache() = default;
+        MediaInfoCache(const MediaInfoCache &) = delete;
+        MediaInfoCache &operator=(const MediaInfoCache &) = delete;
+
+        // 调用方需持有 m_mutex
+        void ensureLoadedLocked();
+        const Entry *lookupLocked(const std::string &key, const Entry &fileStamp) const;
+
+        static std::string cacheKey(const std::string &path, MediaKind kind);
+        static Entry fileStamp(const std::string &path);
+        static void probe(const std::string &path, MediaKind kind, Entry &entry);
+        static double containerDuration(const AVFormatContext *formatCtx, int streamIndex);
+        static std::shared_ptr<const MediaStreamInfo> captureStreamInfo(const AVFormatContext *formatCtx, int streamIndex);
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::string, Entry> m_entries;
+        bool m_loaded = false;
+        bool m_dirty = false;
+    };
+
+} // namespace VideoCreator
+
+#endif // MEDIA_INFO_CACHE_H
@@ -20,7 +20,13 @@ namespace VideoCreator
     {
         CROSSFADE,
         WIPE,
-        SLIDE
+        SLIDE, // 向左推入（push_left）
+        PUSH_RIGHT,
+        PUSH_UP,
+        PUSH_DOWN,
+        IRIS,          // 圆形光圈展开
+        ZOOM_DISSOLVE, // 放大并溶解
+        LUMA_WIPE      // 按起始画面亮度擦除
     };
 
     // 辅助函数：将 TransitionType 转换为字符串
@@ -34,19 +40,81 @@ namespace VideoCreator
             return "WIPE";
         case TransitionType::SLIDE:
             return "SLIDE";
+        case TransitionType::PUSH_RIGHT:
+            return "PUSH_RIGHT";
+        case TransitionType::PUSH_UP:
+            return "PUSH_UP";
+        case TransitionType::PUSH_DOWN:
+            return "PUSH_DOWN";
+        case TransitionType::IRIS:
+            return "IRIS";
+        case TransitionType::ZOOM_DISSOLVE:
+            return "ZOOM_DISSOLVE";
+        case TransitionType::LUMA_WIPE:
+            return "LUMA_WIPE";
         default:
             return "UNKNOWN";
         }
     }
 
+    namespace detail
+    {
+        inline std::string asciiLower(std::string value)
+        {
+            for (char &c : value)
+            {
+                if (c >= 'A' && c <= 'Z')
+                {
+                    c = static_cast<char>(c - 'A' + 'a');
+                }
+            }
+            return value;
+        }
+    } // namespace detail
+
+    // 辅助函数：字符串转场景类型（不区分大小写，未知值按图片场景处理）
+    inline SceneType sceneTypeFromString(const std::string &typeStr)
+    {
+        const std::string lower = detail::asciiLower(typeStr);
+        if (lower == "video_scene")
+            return SceneType::VIDEO_SCENE;
+        if (lower == "transition")
+            return SceneType::TRANSITION;
+        return SceneType::IMAGE_SCENE;
+    }
+
+    // 辅助函数：字符串转转场类型（不区分大小写，未知值按淡入淡出处理）
+    inline TransitionType transitionTypeFromString(const std::string &typeStr)
+    {
+        const std::string lower = detail::asciiLower(typeStr);
+        if (lower == "wipe")
+            return TransitionType::WIPE;
+        if (lower == "slide" || lower == "push_left")
+            return TransitionType::SLIDE;
+        if (lower == "push_right")
+            return TransitionType::PUSH_RIGHT;
+        if (lower == "push_up")
+            return TransitionType::PUSH_UP;
+        if (lower == "push_down")
+            return TransitionType::PUSH_DOWN;
+        if (lower == "iris")
+            return TransitionType::IRIS;
+        if (lower == "zoom_dissolve")
+            return TransitionType::ZOOM_DISSOLVE;
+        if (lower == "luma_wipe")
+            return TransitionType::LUMA_WIPE;
+        return TransitionType::CROSSFADE;
+    }
+
     // 图片配置
     struct ImageConfig
     {
         std::string path;      // 图片文件路径
-        int x = 0;             // X坐标
-        int y = 0;             // Y坐标
-        double scale = 1.0;    // 缩放比例
-        double rotation = 0.0; // 旋转角度
+        int x = 0;             // X坐标（相对适配后位置的水平平移）
+        int y = 0;             // Y坐标（相对适配后位置的垂直平移）
+        double scale = 1.0;    // 缩放比例（以图片中心缩放）
+        double rotation = 0.0; // 旋转角度（度，顺时针，以图片中心旋转）
+        std::string fit;       // 适配方式: stretch | contain | cover | none，空时主图为 contain、叠加图为 none
     };
 
     // 音频配置
@@ -64,6 +132,8 @@ namespace VideoCreator
         double trim_start = 0.0; // 起始偏移
         double trim_end = -1.0;  // 结束时间（-1 表示使用全长）
         bool use_audio = true;   // 是否使用原视频音频
+        std::string frame_rate_mode = "drop"; // 帧率转换："drop" 按时间戳丢帧/重复帧，"blend" 相邻帧混合
+        std::string fit = "contain";          // 适配方式: stretch | contain(保持宽高比，空白处为背景色) | cover | none
     };
 
     // 资源配置
@@ -73,6 +143,7 @@ namespace VideoCreator
         AudioConfig audio; // 音频配置
         VideoConfig video; // 视频配置
         std::vector<AudioConfig> audio_layers; // Additional audio layers for mixing
+        std::vector<ImageConfig> overlays;     // 叠加图片，按顺序绘制在主图 / 视频之上
     };
 
     // Ken Burns特效配置
@@ -143,6 +214,28 @@ namespace VideoCreator
         std::string bitrate = "5000k"; // 比特率
         std::string preset = "medium"; // 预设
         int crf = 23;                  // 质量因子
+
+        std::string auto_profile;      // 自动档位: 空 | fastest(单任务最快) | concurrent(多任务并行)
+        std::string thread_type;       // 线程模式: 空(帧级) | frame | slice
+        int threads = 0;               // 编码线程数，0 按档位与线程预算推导
+        int gop = 0;                   // 关键帧间隔(帧)，0 为 2 秒
+        int bframes = -1;              // B 帧数，-1 使用编码器默认
+        int lookahead = -1;            // 码控前瞻帧数，-1 使用编码器默认
+        std::string tune;              // 如 film / animation / zerolatency
+        std::string codec_params;      // 透传给编码器的 "key=value:key=value"（x264-params / x265-params）
+
+        std::string rate_control;      // 码控模式: 空/crf(恒定质量) | abr(平均码率 bitrate) | two_pass(两遍，按 bitrate)
+        std::string maxrate;           // VBV 峰值码率，如 "8000k"，空表示不限制
+        std::string bufsize;           // VBV 缓冲大小，空时为 maxrate 的两倍
+        bool fast_first_pass = true;   // two_pass 第一遍使用快速分析
+        std::string pass_log;          // two_pass 统计文件路径，空时为输出路径加 ".2pass.log"
+    };
+
+    // 视频素材解码配置
+    struct VideoDecodingConfig
+    {
+        int threads = 0;         // 解码线程数，0 按线程预算推导（与编码线程分摊）
+        std::string thread_type; // 线程模式: 空(帧级优先，不支持时片级) | frame | slice
     };
 
     // 音频编码配置
@@ -158,9 +251,20 @@ namespace VideoCreator
     {
         AudioNormalizationConfig audio_normalization; // 音频标准化
         VideoEncodingConfig video_encoding;           // 视频编码
+        VideoDecodingConfig video_decoding;           // 视频素材解码
         AudioEncodingConfig audio_encoding;           // 音频编码
     };
 
+    // hls / dash 码率阶梯中的一档（主码率档即项目分辨率与 video_encoding）
+    struct RenditionConfig
+    {
+        std::string name;    // 播放列表中的名称，空时为 "<height>p"
+        int width = 0;       // 宽度，0 按项目宽高比由 height 推导
+        int height = 0;      // 高度
+        std::string bitrate; // 目标码率，如 "2500k"
+        std::string maxrate; // 峰值码率，空时等于 bitrate
+    };
+
     // 项目基本信息配置
     struct ProjectInfoConfig
     {
@@ -170,6 +274,12 @@ namespace VideoCreator
         int height = 1080;                        // 视频高度
         int fps = 30;                             // 帧率
         std::string background_color = "#000000"; // 背景颜色
+        std::string output_format;                // 封装: 空/mp4(moov 在文件尾) | fragmented_mp4(fMP4，渲染中即可边写边播) | hls(.m3u8) | dash(.mpd)
+        double segment_duration = 4.0;            // hls / dash 分片最长时长(秒)，场景起点总是开始新分片
+        std::vector<RenditionConfig> renditions;  // hls / dash 额外码率档，与主码率档共用合成后的帧
+        int write_buffer_mb = 8;                  // 输出写缓冲每块大小(MB)，由独立 I/O 线程写盘；0 为渲染线程同步写文件
+        bool sync_output = false;                 // 渲染结束时把输出文件落盘（fsync）
+        std::string checkpoint_dir;               // 断点续渲目录：按场景分段落盘并记录日志，重新渲染同一配置时从最后完成的分段继续；空为不启用
     };
 
     // 项目全局配置
@@ -0,0 +1,143 @@
+// storyflow-batch：用 RenderQueue 批量渲染目录中的 JSON 配置
+// 用法: storyflow-batch [--budget N] [--jobs N] [--priority 文件名=优先级]... <目录或配置文件>...
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QStringList>
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include "engine/RenderQueue.h"
+
+using namespace VideoCreator;
+
+namespace
+{
+    std::atomic<bool> g_interrupted{false};
+
+    void onSignal(int)
+    {
+        g_interrupted.store(true);
+    }
+
+    void printUsage()
+    {
+        std::fprintf(stderr,
+                     "用法: storyflow-batch [选项] <目录或配置文件>...\n"
+                     "  --budget N             CPU 线程预算（默认硬件线程数）\n"
+                     "  --jobs N               同时渲染的任务数（默认 预算/4）\n"
+                     "  --priority NAME=P      文件名为 NAME 的配置使用优先级 P（越大越先渲染）\n"
+                     "按 Ctrl+C 取消所有未完成的任务。\n");
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    int budget = 0;
+    int jobs = 0;
+    std::map<QString, int> priorities;
+    QStringList inputs;
+
+    const QStringList args = app.arguments();
+    for (int i = 1; i < args.size(); ++i) {
+        const QString &arg = args[i];
+        if ((arg == "--budget" || arg == "--jobs" || arg == "--priority") && i + 1 < args.size()) {
+            const QString value = args[++i];
+            if (arg == "--budget") {
+                budget = value.toInt();
+            } else if (arg == "--jobs") {
+                jobs = value.toInt();
+            } else {
+                const int split = value.lastIndexOf('=');
+                if (split <= 0) {
+                    printUsage();
+                    return 2;
+                }
+                priorities[value.left(split)] = value.mid(split + 1).toInt();
+            }
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        } else if (arg.startsWith("--")) {
+            std::fprintf(stderr, "未知选项: %s\n", qPrintable(arg));
+            printUsage();
+            return 2;
+        } else {
+            inputs << arg;
+        }
+    }
+
+    // 目录展开为其中的 *.json（按文件名排序）
+    QStringList configFiles;
+    for (const QString &input : inputs) {
+        QFileInfo info(input);
+        if (info.isDir()) {
+            const QFileInfoList entries = QDir(input).entryInfoList({"*.json"}, QDir::Files, QDir::Name);
+            for (const QFileInfo &entry : entries) {
+                configFiles << entry.absoluteFilePath();
+            }
+        } else if (info.isFile()) {
+            configFiles << info.absoluteFilePath();
+        } else {
+            std::fprintf(stderr, "找不到: %s\n", qPrintable(input));
+        }
+    }
+    if (configFiles.isEmpty()) {
+        printUsage();
+        return 2;
+    }
+
+    RenderQueue queue(budget, jobs);
+    std::printf("%d 个配置，%d 个并发任务，每个任务 %d 个编码线程\n",
+                static_cast<int>(configFiles.size()), queue.concurrentJobs(), queue.threadsPerJob());
+
+    std::mutex printMutex;
+    std::map<int, RenderJobState> finalStates;
+    queue.setEventCallback([&](const RenderJobEvent &event) {
+        std::lock_guard<std::mutex> lock(printMutex);
+        // 进度只在 10% 整数倍时打印，避免刷屏
+        if (event.state == RenderJobState::RUNNING && event.progress % 10 != 0) {
+            return;
+        }
+        std::printf("[job %d] %-9s %3d%%  %s%s%s\n", event.jobId, renderJobStateToString(event.state).c_str(),
+                    event.progress, event.name.c_str(), event.error.empty() ? "" : "  ", event.error.c_str());
+        std::fflush(stdout);
+        finalStates[event.jobId] = event.state;
+    });
+
+    for (const QString &file : configFiles) {
+        const auto it = priorities.find(QFileInfo(file).fileName());
+        queue.submitFile(file.toUtf8().toStdString(), it != priorities.end() ? it->second : 0);
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    bool cancelled = false;
+    while (!queue.waitForAll(200)) {
+        if (g_interrupted.load() && !cancelled) {
+            std::printf("收到中断信号，正在取消剩余任务...\n");
+            queue.cancelAll();
+            cancelled = true;
+        }
+    }
+
+    int completed = 0;
+    int failed = 0;
+    {
+        std::lock_guard<std::mutex> lock(printMutex);
+        for (const auto &item : finalStates) {
+            if (item.second == RenderJobState::COMPLETED) {
+                ++completed;
+            } else if (item.second == RenderJobState::FAILED) {
+                ++failed;
+            }
+        }
+    }
+    std::printf("完成 %d，失败 %d，取消 %d\n", completed, failed,
+                static_cast<int>(configFiles.size()) - completed - failed);
+    return failed > 0 || cancelled ? 1 : 0;
+}
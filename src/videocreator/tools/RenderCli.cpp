@@ -0,0 +1,404 @@
+// storyflow-render：无界面渲染一个或多个 JSON 配置，可输出机器可读的统计信息
+// 用法: storyflow-render [选项] <配置文件>...
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <algorithm>
+#include <cstdio>
+#include "VideoCreatorAPI.h"
+#include "model/ConfigLoader.h"
+#include "engine/EncoderSettings.h"
+#include "engine/RenderEngine.h"
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace VideoCreator;
+
+namespace
+{
+    struct CliOptions
+    {
+        int threads = 0;
+        QString profile;
+        QString encoderProfile;
+        QString rateControl;
+        QString bitrate;
+        QString maxrate;
+        QString preset;
+        int crf = -1;
+        QString output;
+        QString format;
+        double segmentDuration = 0.0;
+        QString statsFormat; // 空 / "json" / "text"
+        QString statsFile;
+        QString traceFile;
+        bool quiet = false;
+        QStringList configs;
+    };
+
+    // 编码档位：draft 追求速度，quality 追求画质，balanced 与默认配置一致
+    bool applyProfile(const QString &profile, VideoEncodingConfig &encoding)
+    {
+        if (profile == "draft") {
+            encoding.preset = "ultrafast";
+            encoding.crf = 30;
+        } else if (profile == "balanced") {
+            encoding.preset = "medium";
+            encoding.crf = 23;
+        } else if (profile == "quality") {
+            encoding.preset = "slow";
+            encoding.crf = 18;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // 进程峰值常驻内存（字节），取不到时返回 -1
+    qint64 peakRssBytes()
+    {
+#if defined(Q_OS_WIN)
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            return static_cast<qint64>(counters.PeakWorkingSetSize);
+        }
+        return -1;
+#else
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0) {
+            return -1;
+        }
+#if defined(Q_OS_MACOS)
+        return static_cast<qint64>(usage.ru_maxrss); // macOS 单位为字节
+#else
+        return static_cast<qint64>(usage.ru_maxrss) * 1024; // Linux 单位为 KB
+#endif
+#endif
+    }
+
+    QJsonObject stageStatsToJson(const RenderStageStats &stats)
+    {
+        QJsonObject stages;
+        stages["setup"] = stats.setup;
+        stages["video_source"] = stats.videoSource;
+        stages["subtitle"] = stats.subtitle;
+        stages["video_encode"] = stats.videoEncode;
+        stages["audio_mix"] = stats.audioMix;
+        stages["audio_encode"] = stats.audioEncode;
+        stages["transition"] = stats.transition;
+        stages["finalize"] = stats.finalize;
+        return stages;
+    }
+
+    void quietMessageHandler(QtMsgType type, const QMessageLogContext &, const QString &message)
+    {
+        if (type == QtDebugMsg || type == QtInfoMsg) {
+            return;
+        }
+        std::fprintf(stderr, "%s\n", qPrintable(message));
+    }
+
+    void printUsage()
+    {
+        std::fprintf(stderr,
+                     "用法: storyflow-render [选项] <配置文件>...\n"
+                     "  --threads N           编码线程数（默认 min(8, 硬件线程数)）\n"
+                     "  --profile NAME        编码档位: draft | balanced | quality\n"
+                     "  --encoder-profile NAME  编码线程档位: fastest（单任务最快）| concurrent（多任务并行）\n"
+                     "  --preset NAME         覆盖 x264 preset\n"
+                     "  --crf N               覆盖 CRF\n"
+                     "  --rate-control MODE   码控模式: crf | abr | two_pass\n"
+                     "  --bitrate R           abr / two_pass 目标码率，如 4000k\n"
+                     "  --maxrate R           VBV 峰值码率（缓冲默认两倍）\n"
+                     "  --output PATH         覆盖输出路径（只能用于单个配置）\n"
+                     "  --format NAME         输出封装: mp4 | fragmented_mp4 | hls | dash（hls/dash 时输出路径为 .m3u8/.mpd）\n"
+                     "  --segment-duration S  hls / dash 最长分片时长（秒）\n"
+                     "  --stats json|text     渲染结束后输出统计：总耗时、分阶段耗时、fps、峰值内存\n"
+                     "  --stats-file PATH     统计写入文件而不是标准输出\n"
+                     "  --trace PATH          记录各阶段追踪区间，导出 Chrome trace JSON\n"
+                     "  --quiet               不输出调试日志\n");
+    }
+
+    bool parseArguments(const QStringList &args, CliOptions &options)
+    {
+        for (int i = 1; i < args.size(); ++i) {
+            const QString &arg = args[i];
+            auto takeValue = [&](QString &value) {
+                if (i + 1 >= args.size()) {
+                    std::fprintf(stderr, "%s 缺少参数\n", qPrintable(arg));
+                    return false;
+                }
+                value = args[++i];
+                return true;
+            };
+
+            QString value;
+            if (arg == "--threads") {
+                if (!takeValue(value)) return false;
+                options.threads = value.toInt();
+            } else if (arg == "--profile") {
+                if (!takeValue(options.profile)) return false;
+            } else if (arg == "--encoder-profile") {
+                if (!takeValue(options.encoderProfile)) return false;
+                if (!EncoderSettings::isKnownAutoProfile(options.encoderProfile.toStdString())) {
+                    std::fprintf(stderr, "未知的编码线程档位: %s\n", qPrintable(options.encoderProfile));
+                    return false;
+                }
+            } else if (arg == "--preset") {
+                if (!takeValue(options.preset)) return false;
+            } else if (arg == "--crf") {
+                if (!takeValue(value)) return false;
+                bool ok = false;
+                options.crf = value.toInt(&ok);
+                if (!ok || options.crf < 0) {
+                    std::fprintf(stderr, "无效的 CRF: %s\n", qPrintable(value));
+                    return false;
+                }
+            } else if (arg == "--rate-control") {
+                if (!takeValue(options.rateControl)) return false;
+                if (options.rateControl != "crf" && options.rateControl != "abr" && options.rateControl != "two_pass") {
+                    std::fprintf(stderr, "未知的码控模式: %s\n", qPrintable(options.rateControl));
+                    return false;
+                }
+            } else if (arg == "--bitrate") {
+                if (!takeValue(options.bitrate)) return false;
+            } else if (arg == "--maxrate") {
+                if (!takeValue(options.maxrate)) return false;
+            } else if (arg == "--output") {
+                if (!takeValue(options.output)) return false;
+            } else if (arg == "--format") {
+                if (!takeValue(options.format)) return false;
+            } else if (arg == "--segment-duration") {
+                if (!takeValue(value)) return false;
+                bool ok = false;
+                options.segmentDuration = value.toDouble(&ok);
+                if (!ok || options.segmentDuration <= 0.0) {
+                    std::fprintf(stderr, "无效的分片时长: %s\n", qPrintable(value));
+                    return false;
+                }
+            } else if (arg == "--stats") {
+                if (!takeValue(options.statsFormat)) return false;
+                if (options.statsFormat != "json" && options.statsFormat != "text") {
+                    std::fprintf(stderr, "--stats 只支持 json 或 text\n");
+                    return false;
+                }
+            } else if (arg == "--stats-file") {
+                if (!takeValue(options.statsFile)) return false;
+            } else if (arg == "--trace") {
+                if (!takeValue(options.traceFile)) return false;
+            } else if (arg == "--quiet") {
+                options.quiet = true;
+            } else if (arg == "-h" || arg == "--help") {
+                return false;
+            } else if (arg.startsWith("--")) {
+                std::fprintf(stderr, "未知选项: %s\n", qPrintable(arg));
+                return false;
+            } else {
+                options.configs << arg;
+            }
+        }
+
+        if (options.configs.isEmpty()) {
+            return false;
+        }
+        if (!options.output.isEmpty() && options.configs.size() > 1) {
+            std::fprintf(stderr, "--output 只能用于单个配置\n");
+            return false;
+        }
+        if (!options.profile.isEmpty()) {
+            VideoEncodingConfig probe;
+            if (!applyProfile(options.profile, probe)) {
+                std::fprintf(stderr, "未知的编码档位: %s\n", qPrintable(options.profile));
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 渲染单个配置，返回该任务的统计
+    QJsonObject renderOne(const QString &configPath, const CliOptions &options, bool &success)
+    {
+        QJsonObject job;
+        job["config"] = configPath;
+
+        QElapsedTimer totalTimer;
+        totalTimer.start();
+
+        ConfigLoader loader;
+        ProjectConfig config;
+        success = loader.loadFromFile(configPath, config);
+        const double loadSeconds = totalTimer.nsecsElapsed() / 1e9;
+        job["load_seconds"] = loadSeconds;
+        if (!success) {
+            job["success"] = false;
+            job["error"] = loader.errorString();
+            return job;
+        }
+
+        if (!options.profile.isEmpty()) {
+            applyProfile(options.profile, config.global_effects.video_encoding);
+        }
+        if (!options.encoderProfile.isEmpty()) {
+            config.global_effects.video_encoding.auto_profile = options.encoderProfile.toStdString();
+        }
+        if (!options.preset.isEmpty()) {
+            config.global_effects.video_encoding.preset = options.preset.toStdString();
+        }
+        if (options.crf >= 0) {
+            config.global_effects.video_encoding.crf = options.crf;
+        }
+        if (!options.rateControl.isEmpty()) {
+            config.global_effects.video_encoding.rate_control = options.rateControl.toStdString();
+        }
+        if (!options.bitrate.isEmpty()) {
+            config.global_effects.video_encoding.bitrate = options.bitrate.toStdString();
+        }
+        if (!options.maxrate.isEmpty()) {
+            config.global_effects.video_encoding.maxrate = options.maxrate.toStdString();
+        }
+        if (!options.output.isEmpty()) {
+            config.project.output_path = options.output.toUtf8().toStdString();
+        }
+        if (!options.format.isEmpty()) {
+            config.project.output_format = options.format.toStdString();
+        }
+        if (options.segmentDuration > 0.0) {
+            config.project.segment_duration = options.segmentDuration;
+        }
+        job["output"] = QString::fromUtf8(config.project.output_path.c_str());
+
+        double videoSeconds = 0.0;
+        for (const auto &scene : config.scenes) {
+            videoSeconds += std::max(0.0, scene.duration);
+        }
+
+        RenderEngine engine;
+        engine.setThreadBudget(options.threads);
+        success = engine.initialize(config) && engine.render();
+
+        const double totalSeconds = totalTimer.nsecsElapsed() / 1e9;
+        const double renderSeconds = totalSeconds - loadSeconds;
+        job["success"] = success;
+        if (!success) {
+            job["error"] = QString::fromStdString(engine.errorString());
+        }
+        job["frames"] = engine.frameCount();
+        job["video_seconds"] = videoSeconds;
+        job["total_seconds"] = totalSeconds;
+        job["render_seconds"] = renderSeconds;
+        job["fps"] = renderSeconds > 0 ? engine.frameCount() / renderSeconds : 0.0;
+        job["realtime_factor"] = renderSeconds > 0 ? videoSeconds / renderSeconds : 0.0;
+        job["stages"] = stageStatsToJson(engine.stageStats());
+        job["metrics"] = engine.metrics().toJson();
+        job["metrics_summary"] = QString::fromStdString(engine.metrics().summary());
+        return job;
+    }
+
+    QByteArray formatText(const QJsonObject &report)
+    {
+        QByteArray text;
+        const QJsonArray jobs = report["jobs"].toArray();
+        for (const QJsonValue &value : jobs) {
+            const QJsonObject job = value.toObject();
+            text += QString("%1: %2\n").arg(job["config"].toString(), QString(job["success"].toBool() ? "ok" : "FAILED")).toUtf8();
+            if (!job["error"].toString().isEmpty()) {
+                text += QString("  error: %1\n").arg(job["error"].toString()).toUtf8();
+            }
+            text += QString("  frames %1  total %2 s  fps %3  realtime x%4\n")
+                        .arg(job["frames"].toInt())
+                        .arg(job["total_seconds"].toDouble(), 0, 'f', 3)
+                        .arg(job["fps"].toDouble(), 0, 'f', 1)
+                        .arg(job["realtime_factor"].toDouble(), 0, 'f', 2)
+                        .toUtf8();
+            const QJsonObject stages = job["stages"].toObject();
+            for (auto it = stages.begin(); it != stages.end(); ++it) {
+                text += QString("  %1 %2 s\n").arg(it.key(), -14).arg(it.value().toDouble(), 0, 'f', 3).toUtf8();
+            }
+            if (!job["metrics_summary"].toString().isEmpty()) {
+                text += QString("  %1\n").arg(job["metrics_summary"].toString()).toUtf8();
+            }
+        }
+        text += QString("total %1 s  peak rss %2 MB\n")
+                    .arg(report["total_seconds"].toDouble(), 0, 'f', 3)
+                    .arg(report["peak_rss_bytes"].toDouble() / (1024.0 * 1024.0), 0, 'f', 1)
+                    .toUtf8();
+        return text;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    CliOptions options;
+    if (!parseArguments(app.arguments(), options)) {
+        printUsage();
+        return 2;
+    }
+    if (options.quiet) {
+        qInstallMessageHandler(quietMessageHandler);
+    }
+
+    std::string error;
+    if (!InitializeFFmpeg(&error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    if (!options.traceFile.isEmpty()) {
+        StartTrace();
+    }
+
+    QElapsedTimer totalTimer;
+    totalTimer.start();
+    QJsonArray jobs;
+    int failures = 0;
+    for (const QString &configPath : options.configs) {
+        bool success = false;
+        jobs.append(renderOne(configPath, options, success));
+        if (!success) {
+            ++failures;
+            std::fprintf(stderr, "渲染失败: %s\n", qPrintable(configPath));
+        }
+    }
+
+    if (!options.traceFile.isEmpty() && !StopTrace(options.traceFile.toUtf8().toStdString(), &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        ++failures;
+    }
+
+    if (!options.statsFormat.isEmpty()) {
+        QJsonObject report;
+        report["version"] = 1;
+        report["jobs"] = jobs;
+        report["total_seconds"] = totalTimer.nsecsElapsed() / 1e9;
+        report["peak_rss_bytes"] = peakRssBytes();
+        report["threads"] = options.threads;
+        report["profile"] = options.profile;
+        report["encoder_profile"] = options.encoderProfile;
+
+        const QByteArray output = options.statsFormat == "json"
+                                      ? QJsonDocument(report).toJson(QJsonDocument::Indented)
+                                      : formatText(report);
+        if (options.statsFile.isEmpty()) {
+            std::fwrite(output.constData(), 1, static_cast<size_t>(output.size()), stdout);
+        } else {
+            QFile file(options.statsFile);
+            if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(output) != output.size()) {
+                std::fprintf(stderr, "无法写入统计文件: %s\n", qPrintable(options.statsFile));
+                return 1;
+            }
+        }
+    }
+
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,257 @@
+#include "TraceRecorder.h"
+#include <QDebug>
+#include <QString>
+#include <algorithm>
+#include <cstdio>
+#include <new>
+
+namespace VideoCreator
+{
+
+    std::atomic<bool> TraceRecorder::s_enabled{false};
+
+    // 只有所属线程写入；导出方在 m_mutex 下按 count 读取已发布的事件
+    struct TraceRecorder::ThreadBuffer
+    {
+        int tid = 0;
+        std::atomic<const char *> threadName{nullptr};
+        std::atomic<uint64_t> generation{0};
+        std::atomic<size_t> count{0}; // 已完整写入的事件数（release 发布）
+        std::atomic<size_t> dropped{0};
+        std::atomic<bool> alive{true}; // 所属线程退出后置为 false，缓冲区随后被回收
+        std::atomic<TraceEvent *> chunks[kMaxChunks];
+
+        ThreadBuffer()
+        {
+            for (auto &chunk : chunks)
+            {
+                chunk.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        ~ThreadBuffer()
+        {
+            for (auto &chunk : chunks)
+            {
+                delete[] chunk.load(std::memory_order_relaxed);
+            }
+        }
+    };
+
+    namespace
+    {
+        thread_local const char *t_threadName = nullptr;
+
+        int64_t steadyNanoseconds(std::chrono::steady_clock::time_point time)
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+        }
+
+        std::string jsonEscape(const char *text)
+        {
+            std::string escaped;
+            for (const char *p = text; p && *p; ++p)
+            {
+                const unsigned char c = static_cast<unsigned char>(*p);
+                if (c == '"' || c == '\\')
+                {
+                    escaped += '\\';
+                    escaped += static_cast<char>(c);
+                }
+                else if (c < 0x20)
+                {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    escaped += buffer;
+                }
+                else
+                {
+                    escaped += static_cast<char>(c);
+                }
+            }
+            return escaped;
+        }
+    } // namespace
+
+    TraceRecorder &TraceRecorder::instance()
+    {
+        static TraceRecorder recorder;
+        return recorder;
+    }
+
+    TraceRecorder::~TraceRecorder() = default;
+
+    void TraceRecorder::setThreadName(const char *name)
+    {
+        // 只记在线程局部变量里，未启用追踪时不注册缓冲区
+        t_threadName = name;
+    }
+
+    TraceRecorder::ThreadBuffer *TraceRecorder::currentThreadBuffer()
+    {
+        struct Slot
+        {
+            ThreadBuffer *buffer = nullptr;
+            ~Slot()
+            {
+                if (buffer)
+                {
+                    buffer->alive.store(false, std::memory_order_release);
+                }
+            }
+        };
+        thread_local Slot slot;
+
+        if (!slot.buffer)
+        {
+            auto buffer = std::make_unique<ThreadBuffer>();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            buffer->tid = m_nextTid++;
+            slot.buffer = buffer.get();
+            m_buffers.push_back(std::move(buffer));
+        }
+        return slot.buffer;
+    }
+
+    void TraceRecorder::start()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // 回收已退出线程的缓冲区；仍在运行的线程在下次记录时按代号自行清空
+        m_buffers.erase(std::remove_if(m_buffers.begin(), m_buffers.end(),
+                                       [](const std::unique_ptr<ThreadBuffer> &buffer) {
+                                           return !buffer->alive.load(std::memory_order_acquire);
+                                       }),
+                        m_buffers.end());
+        m_originNs.store(steadyNanoseconds(std::chrono::steady_clock::now()), std::memory_order_relaxed);
+        m_generation.fetch_add(1, std::memory_order_release);
+        s_enabled.store(true, std::memory_order_release);
+        qDebug() << "TraceRecorder: 开始记录";
+    }
+
+    bool TraceRecorder::stop(const std::string &outputPath, std::string *error)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!s_enabled.exchange(false))
+        {
+            if (error)
+            {
+                *error = "追踪尚未开始";
+            }
+            return false;
+        }
+        return writeChromeTrace(outputPath, error);
+    }
+
+    void TraceRecorder::record(const char *name, const char *category, std::chrono::steady_clock::time_point begin,
+                               std::chrono::steady_clock::time_point end)
+    {
+        ThreadBuffer *buffer = currentThreadBuffer();
+        const uint64_t generation = m_generation.load(std::memory_order_acquire);
+        if (buffer->generation.load(std::memory_order_relaxed) != generation)
+        {
+            // 新一轮记录：上一轮的事件作废，已分配的块留着复用
+            buffer->count.store(0, std::memory_order_relaxed);
+            buffer->dropped.store(0, std::memory_order_relaxed);
+            buffer->generation.store(generation, std::memory_order_release);
+        }
+        if (buffer->threadName.load(std::memory_order_relaxed) != t_threadName)
+        {
+            buffer->threadName.store(t_threadName, std::memory_order_relaxed);
+        }
+
+        const size_t index = buffer->count.load(std::memory_order_relaxed);
+        const size_t chunkIndex = index / kChunkSize;
+        if (chunkIndex >= kMaxChunks)
+        {
+            buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        TraceEvent *chunk = buffer->chunks[chunkIndex].load(std::memory_order_relaxed);
+        if (!chunk)
+        {
+            chunk = new (std::nothrow) TraceEvent[kChunkSize];
+            if (!chunk)
+            {
+                buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            buffer->chunks[chunkIndex].store(chunk, std::memory_order_release);
+        }
+
+        TraceEvent &event = chunk[index % kChunkSize];
+        event.name = name;
+        event.category = category;
+        event.startNs = steadyNanoseconds(begin) - m_originNs.load(std::memory_order_relaxed);
+        event.durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+        buffer->count.store(index + 1, std::memory_order_release);
+    }
+
+    bool TraceRecorder::writeChromeTrace(const std::string &outputPath, std::string *error)
+    {
+        std::FILE *file = std::fopen(outputPath.c_str(), "wb");
+        if (!file)
+        {
+            if (error)
+            {
+                *error = "无法写入追踪文件: " + outputPath;
+            }
+            return false;
+        }
+
+        const uint64_t generation = m_generation.load(std::memory_order_acquire);
+        size_t eventCount = 0;
+        size_t droppedCount = 0;
+        std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+        std::fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"StoryFlow render\"}}", file);
+        for (const auto &buffer : m_buffers)
+        {
+            if (buffer->generation.load(std::memory_order_acquire) != generation)
+            {
+                continue;
+            }
+            const size_t count = buffer->count.load(std::memory_order_acquire);
+            droppedCount += buffer->dropped.load(std::memory_order_relaxed);
+            if (count == 0)
+            {
+                continue;
+            }
+
+            const char *threadName = buffer->threadName.load(std::memory_order_relaxed);
+            const std::string label = threadName ? jsonEscape(threadName) : "thread " + std::to_string(buffer->tid);
+            std::fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                         buffer->tid, label.c_str());
+            for (size_t i = 0; i < count; ++i)
+            {
+                const TraceEvent *chunk = buffer->chunks[i / kChunkSize].load(std::memory_order_acquire);
+                const TraceEvent &event = chunk[i % kChunkSize];
+                if (event.startNs < 0)
+                {
+                    continue; // 跨越两轮记录的区间
+                }
+                std::fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                             jsonEscape(event.name).c_str(), jsonEscape(event.category).c_str(), buffer->tid,
+                             event.startNs / 1000.0, event.durationNs / 1000.0);
+                ++eventCount;
+            }
+        }
+        std::fputs("\n]}\n", file);
+
+        const bool writeFailed = std::ferror(file) != 0;
+        if (std::fclose(file) != 0 || writeFailed)
+        {
+            if (error)
+            {
+                *error = "写入追踪文件失败: " + outputPath;
+            }
+            return false;
+        }
+
+        qDebug() << "TraceRecorder: 已写出" << eventCount << "个事件到" << QString::fromStdString(outputPath);
+        if (droppedCount > 0)
+        {
+            qWarning() << "TraceRecorder: 缓冲区已满，丢弃了" << droppedCount << "个事件";
+        }
+        return true;
+    }
+
+} // namespace VideoCreator
@@ -0,0 +1,116 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace VideoCreator
+{
+
+    // 一个已结束的区间（Chrome trace 的 "X" 事件）
+    struct TraceEvent
+    {
+        const char *name = nullptr;     // 静态字符串，记录时不复制
+        const char *category = nullptr; // 静态字符串
+        int64_t startNs = 0;            // 相对 start() 的纳秒
+        int64_t durationNs = 0;
+    };
+
+    /**
+     * TraceRecorder - 渲染热路径的区间追踪
+     *
+     * 每个线程只写自己的缓冲区（按块分配，写入无锁），stop() 时导出为 Chrome trace JSON，
+     * 可在 chrome://tracing 或 ui.perfetto.dev 中打开。未启用时 TraceSpan 只读一次原子标志，不取时间。
+     */
+    class TraceRecorder
+    {
+    public:
+        static TraceRecorder &instance();
+
+        static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+        // 开始新一轮记录，丢弃上一轮的事件
+        void start();
+
+        // 停止记录并写出 Chrome trace JSON；未在记录时返回 false
+        bool stop(const std::string &outputPath, std::string *error = nullptr);
+
+        // 为当前线程命名，显示在 trace 的线程轨道上；name 须为静态字符串
+        static void setThreadName(const char *name);
+
+        void record(const char *name, const char *category, std::chrono::steady_clock::time_point begin,
+                    std::chrono::steady_clock::time_point end);
+
+        // 每个线程的事件上限 = 块大小 × 块数，超出的事件丢弃并计数
+        static constexpr size_t kChunkSize = 4096;
+        static constexpr size_t kMaxChunks = 64;
+
+    private:
+        struct ThreadBuffer;
+
+        TraceRecorder() = default;
+        ~TraceRecorder();
+        TraceRecorder(const TraceRecorder &) = delete;
+        TraceRecorder &operator=(const TraceRecorder &) = delete;
+
+        ThreadBuffer *currentThreadBuffer();
+        bool writeChromeTrace(const std::string &outputPath, std::string *error);
+
+        static std::atomic<bool> s_enabled;
+        std::atomic<uint64_t> m_generation{0};
+        std::atomic<int64_t> m_originNs{0}; // steady_clock 纪元起的纳秒
+        std::mutex m_mutex;                 // 保护线程缓冲区列表与 start/stop
+        std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+        int m_nextTid = 1;
+    };
+
+    // 作用域区间：启用时在构造与析构处取时间并记录
+    class TraceSpan
+    {
+    public:
+        explicit TraceSpan(const char *name, const char *category = "render")
+            : m_name(name), m_category(category), m_active(TraceRecorder::enabled())
+        {
+            if (m_active)
+            {
+                m_begin = std::chrono::steady_clock::now();
+            }
+        }
+
+        ~TraceSpan()
+        {
+            if (m_active)
+            {
+                TraceRecorder::instance().record(m_name, m_category, m_begin, std::chrono::steady_clock::now());
+            }
+        }
+
+        TraceSpan(const TraceSpan &) = delete;
+        TraceSpan &operator=(const TraceSpan &) = delete;
+
+    private:
+        const char *m_name;
+        const char *m_category;
+        bool m_active;
+        std::chrono::steady_clock::time_point m_begin;
+    };
+
+} // namespace VideoCreator
+
+// 定义 VIDEOCREATOR_DISABLE_TRACING 时追踪点完全编译掉
+#ifdef VIDEOCREATOR_DISABLE_TRACING
+#define VC_TRACE_SCOPE(name, category) ((void)0)
+#define VC_TRACE_THREAD_NAME(name) ((void)0)
+#else
+#define VC_TRACE_CONCAT_INNER(a, b) a##b
+#define VC_TRACE_CONCAT(a, b) VC_TRACE_CONCAT_INNER(a, b)
+#define VC_TRACE_SCOPE(name, category) ::VideoCreator::TraceSpan VC_TRACE_CONCAT(vcTraceSpan_, __LINE__)(name, category)
+#define VC_TRACE_THREAD_NAME(name) ::VideoCreator::TraceRecorder::setThreadName(name)
+#endif
+
+#endif // TRACE_RECORDER_H